@@ -1,13 +1,56 @@
 #include "audiooutputmanager.h"
+#include "Util/cusdr_audioMix.h"
 #include <QMediaDevices>
 #include <QDebug>
 #include <cstring>
 #include <algorithm>
 
+// receiver audio comes out of WDSP at 48 kHz
+static const int kSampleRate = 48000;
+
 AudioOutputManager::AudioOutputManager(QObject* parent)
     : QObject(parent)
 {
+    // everything the audio path needs is allocated here, up front
+    for (auto& ra : m_receivers)
+        ra.fifo.reset(new QHSpscBuffer<float>(FifoFrames * 2));
+
+    m_mixBuf.resize(PeriodFrames * 2);
+    m_receiverBuf.resize(PeriodFrames * 2);
+
     refreshDeviceList();
+
+    m_mixerThread = new QThread();
+    m_mixerContext = new QObject();
+    m_mixerContext->moveToThread(m_mixerThread);
+    m_mixerThread->start(QThread::HighPriority);
+
+    onMixer([this] { startMixer(); });
+}
+
+AudioOutputManager::~AudioOutputManager()
+{
+    // the sinks and the timer belong to the mixer thread: end them there
+    QMetaObject::invokeMethod(m_mixerContext, [this] {
+        delete m_mixTimer;
+        m_mixTimer = nullptr;
+        closeAllSinks();
+    }, Qt::BlockingQueuedConnection);
+
+    m_mixerThread->quit();
+    m_mixerThread->wait();
+
+    delete m_mixerContext;
+    delete m_mixerThread;
+}
+
+void AudioOutputManager::startMixer()
+{
+    // with nothing to write, look again after about half a period
+    m_mixTimer = new QTimer(m_mixerContext);
+    m_mixTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_mixTimer, &QTimer::timeout, m_mixerContext, [this] { mix(); });
+    m_mixTimer->start(qMax(1, PeriodFrames * 500 / kSampleRate));
 }
 
 QVector<QAudioDevice> AudioOutputManager::availableDevices() const
@@ -20,151 +63,312 @@ void AudioOutputManager::refreshDeviceList()
     emit deviceListChanged();
 }
 
-void AudioOutputManager::assignReceiverToDevice(const QString& receiverId, const QAudioDevice& device)
+int AudioOutputManager::findReceiver(const QString& receiverId) const
 {
-    QMutexLocker locker(&m_mutex);
+    // ids are written before the count is published and never change after
+    const int count = m_receiverCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        if (m_receivers[i].id == receiverId)
+            return i;
+    }
+    return -1;
+}
 
-    if (m_receivers.contains(receiverId)) {
-        auto& ra = m_receivers[receiverId];
-        if (ra.sink) {
-            ra.sink->stop();
-            delete ra.sink;
-            ra.sink = nullptr;
-            ra.io = nullptr;
-        }
+int AudioOutputManager::takeReceiver(const QString& receiverId)
+{
+    // m_mutex held: the only place slots are added
+    int r = findReceiver(receiverId);
+    if (r >= 0)
+        return r;
+
+    r = m_receiverCount.load(std::memory_order_relaxed);
+    if (r == MAX_RECEIVERS) {
+        qDebug() << "AudioOutputManager: no slot left for receiver" << receiverId;
+        return -1;
     }
 
-    QAudioFormat fmt;
-    if (m_receivers.contains(receiverId) && m_receivers[receiverId].format.isValid())
-        fmt = m_receivers[receiverId].format;
-    else
-        fmt = device.preferredFormat();
+    m_receivers[r].id = receiverId;
+    m_receiverCount.store(r + 1, std::memory_order_release);
+    return r;
+}
 
-    auto* sink = new QAudioSink(device, fmt, this);
-    QIODevice* io = sink->start();
+QAudioFormat AudioOutputManager::sinkFormat(const QAudioDevice& device, QAudioFormat format)
+{
+    if (!format.isValid())
+        format = device.preferredFormat();
+
+    // the mixer produces 48 kHz stereo and converts to int16 or float only
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(2);
+    if (format.sampleFormat() != QAudioFormat::Float)
+        format.setSampleFormat(QAudioFormat::Int16);
 
-    m_receivers[receiverId] = { device, fmt, sink, io, nullptr, QByteArray() };
+    return format;
 }
 
-void AudioOutputManager::removeReceiver(const QString& receiverId)
+void AudioOutputManager::closeSink(QAudioSink*& sink, QIODevice*& io)
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_receivers.contains(receiverId)) {
-        auto& ra = m_receivers[receiverId];
-        if (ra.sink) {
-            ra.sink->stop();
-            delete ra.sink;
-        }
-        m_receivers.remove(receiverId);
+    if (sink) {
+        sink->stop();
+        delete sink;
+        sink = nullptr;
+        io = nullptr;
     }
 }
 
+void AudioOutputManager::openReceiverSink(ReceiverAudio& ra)
+{
+    closeSink(ra.sink, ra.io);
+
+    ra.format = sinkFormat(ra.device, ra.format);
+    ra.sink = new QAudioSink(ra.device, ra.format, m_mixerContext);
+    ra.io = ra.sink->start();
+}
+
+void AudioOutputManager::assignReceiverToDevice(const QString& receiverId, const QAudioDevice& device)
+{
+    int r;
+    {
+        QMutexLocker locker(&m_mutex);
+        r = takeReceiver(receiverId);
+    }
+    if (r < 0)
+        return;
+
+    onMixer([this, r, device] {
+        auto& ra = m_receivers[r];
+        ra.device = device;
+        openReceiverSink(ra);
+        ra.muted.store(false, std::memory_order_relaxed);
+    });
+}
+
+void AudioOutputManager::removeReceiver(const QString& receiverId)
+{
+    const int r = findReceiver(receiverId);
+    if (r < 0)
+        return;
+
+    // the slot stays, so writeAudio() never sees it go away
+    m_receivers[r].muted.store(true, std::memory_order_relaxed);
+
+    onMixer([this, r] {
+        auto& ra = m_receivers[r];
+        closeSink(ra.sink, ra.io);
+        ra.device = QAudioDevice();
+        ra.format = QAudioFormat();
+        ra.dsp = nullptr;
+    });
+}
+
 void AudioOutputManager::setReceiverFormat(const QString& receiverId, const QAudioFormat& format)
 {
-    QMutexLocker locker(&m_mutex);
-    if (!m_receivers.contains(receiverId))
+    const int r = findReceiver(receiverId);
+    if (r < 0)
         return;
-    m_receivers[receiverId].format = format;
-    assignReceiverToDevice(receiverId, m_receivers[receiverId].device);
+
+    onMixer([this, r, format] {
+        auto& ra = m_receivers[r];
+        ra.format = format;
+        if (ra.sink)
+            openReceiverSink(ra);
+    });
 }
 
 void AudioOutputManager::setReceiverDspCallback(const QString& receiverId, DspCallback cb)
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_receivers.contains(receiverId))
-        m_receivers[receiverId].dsp = cb;
+    const int r = findReceiver(receiverId);
+    if (r >= 0)
+        onMixer([this, r, cb] { m_receivers[r].dsp = cb; });
 }
 
 void AudioOutputManager::setMixDspCallback(DspCallback cb)
+{
+    onMixer([this, cb] { m_mixDsp = cb; });
+}
+
+void AudioOutputManager::setReceiverGain(const QString& receiverId, float gain)
 {
     QMutexLocker locker(&m_mutex);
-    m_mixDsp = cb;
+
+    const int r = takeReceiver(receiverId);
+    if (r >= 0)
+        m_receivers[r].gain.store(std::max(gain, 0.0f), std::memory_order_relaxed);
 }
 
-void AudioOutputManager::writeAudio(const QString& receiverId, const float* interleavedLR, int frames)
+void AudioOutputManager::setReceiverPan(const QString& receiverId, float pan)
 {
     QMutexLocker locker(&m_mutex);
 
-    if (m_mixAll && m_mixSink && m_mixIO) {
-        // Collect per-receiver samples for mixing
-        // For simplicity, we'll just sum all writeAudio() calls this period (could be more sophisticated in practice)
-        m_mixBuf.resize(frames * 2 * sizeof(float));
-        float* mix = reinterpret_cast<float*>(m_mixBuf.data());
-        std::memcpy(mix, interleavedLR, frames * 2 * sizeof(float));
-        // Apply per-receiver DSP if set
-        if (m_receivers.contains(receiverId) && m_receivers[receiverId].dsp)
-            m_receivers[receiverId].dsp(mix, frames);
-        // Could sum other receivers here if needed
-        // Apply global DSP
-        if (m_mixDsp)
-            m_mixDsp(mix, frames);
-        // Convert to int16
-        QByteArray pcm(frames * 2 * sizeof(qint16), 0);
-        floatToInt16(mix, reinterpret_cast<qint16*>(pcm.data()), frames);
-        m_mixIO->write(pcm);
-        return;
-    }
+    const int r = takeReceiver(receiverId);
+    if (r >= 0)
+        m_receivers[r].pan.store(std::clamp(pan, -1.0f, 1.0f), std::memory_order_relaxed);
+}
 
-    // Not mixing: Per-receiver output
-    if (!m_receivers.contains(receiverId))
+void AudioOutputManager::writeAudio(const QString& receiverId, const float* interleavedLR, int frames)
+{
+    if (frames <= 0)
         return;
 
-    auto& ra = m_receivers[receiverId];
-    float* data = const_cast<float*>(interleavedLR);
-    // DSP
-    if (ra.dsp)
-        ra.dsp(data, frames);
-    // Convert to int16 PCM
-    ra.buf.resize(frames * 2 * sizeof(qint16));
-    floatToInt16(data, reinterpret_cast<qint16*>(ra.buf.data()), frames);
-    if (ra.io)
-        ra.io->write(ra.buf);
+    int r = findReceiver(receiverId);
+    if (r < 0) {
+        // first write of this receiver: the only time the writer locks
+        QMutexLocker locker(&m_mutex);
+        r = takeReceiver(receiverId);
+        if (r < 0)
+            return;
+    }
+
+    // whole frames only: every write and read moves an even number of
+    // values, so what fits is always whole frames too
+    m_receivers[r].fifo->write(interleavedLR, frames * 2);
 }
 
 void AudioOutputManager::setMixAllToOneDevice(bool enabled, const QAudioDevice& device)
 {
-    QMutexLocker locker(&m_mutex);
-    m_mixAll = enabled;
+    onMixer([this, enabled, device] {
+        m_mixAll = enabled;
 
-    if (m_mixSink) {
-        m_mixSink->stop();
-        delete m_mixSink;
-        m_mixSink = nullptr;
-        m_mixIO = nullptr;
-    }
-    if (enabled) {
-        m_mixDevice = device;
-        QAudioFormat fmt = device.preferredFormat();
-        m_mixSink = new QAudioSink(device, fmt, this);
-        m_mixIO = m_mixSink->start();
-        m_mixBuf.clear();
-    }
+        closeSink(m_mixSink, m_mixIO);
+        if (enabled) {
+            m_mixDevice = device;
+            m_mixFormat = sinkFormat(device, QAudioFormat());
+            m_mixSink = new QAudioSink(device, m_mixFormat, m_mixerContext);
+            m_mixIO = m_mixSink->start();
+        }
+    });
 }
 
 void AudioOutputManager::closeAllSinks()
 {
-    QMutexLocker locker(&m_mutex);
+    // mixer thread
     for (auto& ra : m_receivers) {
-        if (ra.sink) {
-            ra.sink->stop();
-            delete ra.sink;
-            ra.sink = nullptr;
-            ra.io = nullptr;
-        }
+        closeSink(ra.sink, ra.io);
+        ra.muted.store(true, std::memory_order_relaxed);
     }
-    m_receivers.clear();
-    if (m_mixSink) {
-        m_mixSink->stop();
-        delete m_mixSink;
-        m_mixSink = nullptr;
-        m_mixIO = nullptr;
+    closeSink(m_mixSink, m_mixIO);
+}
+
+void AudioOutputManager::mix()
+{
+    // as many periods as the sinks have room and the receivers data for
+    while (m_mixAll ? mixPeriod() : routePeriods())
+        ;
+}
+
+int AudioOutputManager::periodFrames(QAudioSink* sink, const QAudioFormat& format)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (!sink || bytesPerFrame <= 0)
+        return 0;
+
+    return (int)std::min<qint64>(PeriodFrames, sink->bytesFree() / bytesPerFrame);
+}
+
+int AudioOutputManager::readReceiver(ReceiverAudio& ra, int frames)
+{
+    // a receiver takes part once it has a whole period; one that lags
+    // behind the others simply joins a period later
+    if (ra.fifo->count() < frames * 2)
+        return 0;
+
+    if (ra.muted.load(std::memory_order_relaxed)) {
+        ra.fifo->read(nullptr, frames * 2);
+        return 0;
     }
+
+    ra.fifo->read(m_receiverBuf.data(), frames * 2);
+    if (ra.dsp)
+        ra.dsp(m_receiverBuf.data(), frames);
+    return frames;
 }
 
-void AudioOutputManager::floatToInt16(const float* in, qint16* out, int frames)
+void AudioOutputManager::panGains(const ReceiverAudio& ra, float& gainL, float& gainR)
 {
-    for (int i = 0; i < frames * 2; ++i) {
-        float v = std::clamp(in[i], -1.0f, 1.0f);
-        out[i] = static_cast<qint16>(v * 32767.0f);
+    // balance: the center leaves both channels at full gain
+    const float gain = ra.gain.load(std::memory_order_relaxed);
+    const float pan = ra.pan.load(std::memory_order_relaxed);
+
+    gainL = gain * std::min(1.0f, 1.0f - pan);
+    gainR = gain * std::min(1.0f, 1.0f + pan);
+}
+
+void AudioOutputManager::writeSink(QIODevice* io, const QAudioFormat& format, float* lr, int frames)
+{
+    // converted in place: int16 takes the front half of the float buffer
+    if (format.sampleFormat() == QAudioFormat::Float) {
+        clipAudio(lr, frames * 2);
+        io->write(reinterpret_cast<const char*>(lr), frames * 2 * sizeof(float));
+    } else {
+        audioToInt16(lr, reinterpret_cast<qint16*>(lr), frames * 2);
+        io->write(reinterpret_cast<const char*>(lr), frames * 2 * sizeof(qint16));
+    }
+}
+
+bool AudioOutputManager::mixPeriod()
+{
+    if (!m_mixIO)
+        return false;
+
+    const int frames = periodFrames(m_mixSink, m_mixFormat);
+    if (frames < PeriodFrames)
+        return false;
+
+    const int count = m_receiverCount.load(std::memory_order_acquire);
+    bool ready = false;
+    for (int i = 0; i < count && !ready; ++i)
+        ready = m_receivers[i].fifo->count() >= frames * 2;
+    if (!ready)
+        return false;
+
+    float* mix = m_mixBuf.data();
+    std::fill(mix, mix + frames * 2, 0.0f);
+
+    for (int i = 0; i < count; ++i) {
+        auto& ra = m_receivers[i];
+        if (!readReceiver(ra, frames))
+            continue;
+
+        float gainL, gainR;
+        panGains(ra, gainL, gainR);
+        mixStereo(m_receiverBuf.constData(), mix, frames, gainL, gainR);
+    }
+
+    if (m_mixDsp)
+        m_mixDsp(mix, frames);
+
+    writeSink(m_mixIO, m_mixFormat, mix, frames);
+    return true;
+}
+
+bool AudioOutputManager::routePeriods()
+{
+    bool wrote = false;
+    const int count = m_receiverCount.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i) {
+        auto& ra = m_receivers[i];
+
+        // nowhere to go: drop it rather than let it go stale
+        if (!ra.io) {
+            ra.fifo->read(nullptr, ra.fifo->count());
+            continue;
+        }
+
+        const int frames = periodFrames(ra.sink, ra.format);
+        if (frames < PeriodFrames || !readReceiver(ra, frames))
+            continue;
+
+        float gainL, gainR;
+        panGains(ra, gainL, gainR);
+
+        float* out = m_mixBuf.data();
+        std::fill(out, out + frames * 2, 0.0f);
+        mixStereo(m_receiverBuf.constData(), out, frames, gainL, gainR);
+
+        writeSink(ra.io, ra.format, out, frames);
+        wrote = true;
     }
+
+    return wrote;
 }
@@ -4,25 +4,48 @@
 #include <QAudioSink>
 #include <QAudioDevice>
 #include <QAudioFormat>
-#include <QMap>
 #include <QMutex>
+#include <QThread>
+#include <QTimer>
 #include <QVector>
 #include <QString>
+#include <atomic>
 #include <functional>
+#include <memory>
+
+#include "cusdr_settings.h"
+#include "Util/cusdr_spscQueue.h"
 
 /**
  * AudioOutputManager (Stereo + DSP hook version)
  * - Manages stereo audio device output for multiple receivers.
  * - Allows assigning a DSP callback per receiver or for the mixed output.
+ *
+ * writeAudio() only copies into a fixed-size lock-free FIFO per receiver.
+ * A mixer thread drains the FIFOs whenever a sink has room for another
+ * period: in mix-all mode it sums every receiver with its gain and pan into
+ * one buffer, otherwise each receiver goes to its own device. Samples are
+ * converted in place to the sink's int16 or float format. After a
+ * receiver's first write nothing is allocated on either side.
+ *
+ * The sinks are created, written and deleted on the mixer thread only: the
+ * setters queue their sink and callback changes to a context object living
+ * there, and a timer on that thread's event loop runs the mixer.
  */
 class AudioOutputManager : public QObject
 {
     Q_OBJECT
 public:
     explicit AudioOutputManager(QObject* parent = nullptr);
+    ~AudioOutputManager() override;
 
     using DspCallback = std::function<void(float* lr, int frames)>;
 
+    // frames written to a sink at a time, ~5 ms at 48 kHz
+    static const int PeriodFrames = 256;
+    // frames a receiver FIFO holds, ~170 ms at 48 kHz
+    static const int FifoFrames = 8192;
+
     // List all available output devices
     QVector<QAudioDevice> availableDevices() const;
 
@@ -41,7 +64,12 @@ public:
     // Set DSP callback for the mixed output (all receivers mixed, then processed here)
     void setMixDspCallback(DspCallback cb);
 
-    // Feed stereo float samples to a receiver's output (interleaved L/R)
+    // Gain (linear) and pan (-1 left .. 0 center .. +1 right) of a receiver
+    void setReceiverGain(const QString& receiverId, float gain);
+    void setReceiverPan(const QString& receiverId, float pan);
+
+    // Feed stereo float samples to a receiver's output (interleaved L/R).
+    // One thread per receiver; samples that do not fit the FIFO are dropped.
     void writeAudio(const QString& receiverId, const float* interleavedLR, int frames);
 
     // Enable/disable mixing all receivers to one device
@@ -52,28 +80,66 @@ signals:
 
 private:
     struct ReceiverAudio {
+        // set once when the slot is taken, read lock-free by writeAudio()
+        QString id;
+
+        // own device, used when not mixing; mixer thread only
         QAudioDevice device;
         QAudioFormat format;
         QAudioSink* sink = nullptr;
         QIODevice* io = nullptr;
         DspCallback dsp;
-        QByteArray buf; // temp buffer for conversion
+
+        std::atomic<bool> muted{false};
+        std::atomic<float> gain{1.0f};
+        std::atomic<float> pan{0.0f};
+
+        // interleaved L/R
+        std::unique_ptr<QHSpscBuffer<float>> fifo;
     };
 
-    QMap<QString, ReceiverAudio> m_receivers;
+    ReceiverAudio m_receivers[MAX_RECEIVERS];
+    std::atomic<int> m_receiverCount{0};
+
+    // serializes taking receiver slots
     mutable QMutex m_mutex;
 
-    // For "mix all" mode
+    // For "mix all" mode; mixer thread only
     bool m_mixAll = true;
     QAudioDevice m_mixDevice;
+    QAudioFormat m_mixFormat;
     QAudioSink* m_mixSink = nullptr;
     QIODevice* m_mixIO = nullptr;
     DspCallback m_mixDsp;
-    QByteArray m_mixBuf;
+
+    // mixer thread buffers, PeriodFrames stereo frames each
+    QVector<float> m_mixBuf;
+    QVector<float> m_receiverBuf;
+
+    QThread* m_mixerThread = nullptr;
+    // lives on m_mixerThread; queued calls to it run there
+    QObject* m_mixerContext = nullptr;
+    QTimer* m_mixTimer = nullptr;
+
+    // runs fn on the mixer thread
+    template<typename Fn>
+    void onMixer(Fn fn) { QMetaObject::invokeMethod(m_mixerContext, std::move(fn), Qt::QueuedConnection); }
 
     void refreshDeviceList();
     void closeAllSinks();
 
-    // Interleaved stereo float -> signed 16-bit PCM
-    static void floatToInt16(const float* in, qint16* out, int frames);
+    int findReceiver(const QString& receiverId) const;
+    int takeReceiver(const QString& receiverId);
+    void openReceiverSink(ReceiverAudio& ra);
+    static void closeSink(QAudioSink*& sink, QIODevice*& io);
+    static QAudioFormat sinkFormat(const QAudioDevice& device, QAudioFormat format);
+
+    void startMixer();
+    void mix();
+    bool mixPeriod();
+    bool routePeriods();
+    int readReceiver(ReceiverAudio& ra, int frames);
+    static int periodFrames(QAudioSink* sink, const QAudioFormat& format);
+    static void writeSink(QIODevice* io, const QAudioFormat& format, float* lr, int frames);
+    static void panGains(const ReceiverAudio& ra, float& gainL, float& gainR);
 };
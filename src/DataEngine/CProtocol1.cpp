@@ -12,6 +12,9 @@ CProtocol1::CProtocol1()
     , m_firstTimeRxInit(0)
     , m_rxSamples(0)
     , m_fwCount(0)
+    , m_decoderReceivers(0)
+    , m_decodeSamples(&CProtocol1::decodeSamples<0>)
+    , m_unpackIQ24(unpackIQ24Function())
 {
     m_metisGetDataSignature.resize(3);
     m_metisGetDataSignature[0] = (char)0xEF;
@@ -48,79 +51,121 @@ QList<quint16> CProtocol1::getRequiredPorts() {
     return { (quint16)Settings::instance()->getMetisPort() };
 }
 
-void CProtocol1::processInputBuffer(const QByteArray& buffer, DataEngine* de, quint16 sourcePort) {
-    Q_UNUSED(sourcePort)
-    int s = 0;
-    int maxSamples;
+namespace {
+
+// A Protocol 1 USB frame is 3 SYNC bytes and 5 C&C bytes followed by as many
+// whole sample frames as fit: one 24 bit I/Q pair per receiver plus a 16 bit
+// mic sample. Unused bytes at the end of the 512 byte frame are padding.
+constexpr int kP1FrameHeaderSize = 8;
+
+struct TP1FrameLayout {
+    int sampleFrameSize;
+    int samplesPerFrame;
+};
+
+constexpr TP1FrameLayout p1FrameLayout(int receivers) {
+    return { 6 * receivers + 2, (IO_BUFFER_SIZE - kP1FrameHeaderSize) / (6 * receivers + 2) };
+}
+
+constexpr TP1FrameLayout kP1FrameLayouts[MAX_RECEIVERS + 1] = {
+    { 0, 0 },
+    p1FrameLayout(1), p1FrameLayout(2), p1FrameLayout(3), p1FrameLayout(4),
+    p1FrameLayout(5), p1FrameLayout(6), p1FrameLayout(7), p1FrameLayout(8)
+};
+
+// end of the sample data per receiver count, as in the Protocol 1 spec
+constexpr int kP1SampleDataEnd[MAX_RECEIVERS + 1] = {
+    0, 512-0, 512-0, 512-4, 512-10, 512-24, 512-10, 512-20, 512-4
+};
+
+constexpr bool p1FrameLayoutsMatchSpec() {
+    for (int rx = 1; rx <= MAX_RECEIVERS; rx++) {
+        if (kP1FrameHeaderSize + kP1FrameLayouts[rx].samplesPerFrame * kP1FrameLayouts[rx].sampleFrameSize
+                != kP1SampleDataEnd[rx])
+            return false;
+    }
+    return true;
+}
 
-    if (buffer.at(s++) == SYNC && buffer.at(s++) == SYNC && buffer.at(s++) == SYNC)
+static_assert(p1FrameLayoutsMatchSpec(), "Protocol 1 frame layout table does not match the spec");
+
+} // namespace
+
+void CProtocol1::selectFrameDecoder(int receivers) {
+    switch (receivers)
+    {
+        case 1: m_decodeSamples = &CProtocol1::decodeSamples<1>; break;
+        case 2: m_decodeSamples = &CProtocol1::decodeSamples<2>; break;
+        case 3: m_decodeSamples = &CProtocol1::decodeSamples<3>; break;
+        case 4: m_decodeSamples = &CProtocol1::decodeSamples<4>; break;
+        case 5: m_decodeSamples = &CProtocol1::decodeSamples<5>; break;
+        case 6: m_decodeSamples = &CProtocol1::decodeSamples<6>; break;
+        case 7: m_decodeSamples = &CProtocol1::decodeSamples<7>; break;
+        case 8: m_decodeSamples = &CProtocol1::decodeSamples<8>; break;
+        default: m_decodeSamples = &CProtocol1::decodeSamples<0>; break;
+    }
+    m_decoderReceivers = receivers;
+}
+
+// RX is the receiver count the layout is specialized for; 0 reads it from
+// io.receivers at run time.
+template<int RX>
+void CProtocol1::decodeSamples(const unsigned char* data, DataEngine* de) {
+    const int receivers = RX ? RX : de->io.receivers;
+    const int frameSize = RX ? kP1FrameLayouts[RX].sampleFrameSize : p1FrameLayout(receivers).sampleFrameSize;
+    int frames = RX ? kP1FrameLayouts[RX].samplesPerFrame : p1FrameLayout(receivers).samplesPerFrame;
+    int s = kP1FrameHeaderSize;
+
+    // extract the samples, in runs that end where a receiver block fills up
+    while (frames > 0)
     {
-        // extract C&C bytes
-        decodeCCBytes(buffer.mid(3, 5), &de->io);
-        s += 5;
+        const int n = qMin(frames, BUFFER_SIZE - m_rxSamples);
 
-        switch (de->io.receivers)
+        // demultiplex each of the receivers (n > 0: the block is never full here)
+        for (int r = 0; r < receivers; r++)
         {
-            case 1: maxSamples = 512-0;  break;
-            case 2: maxSamples = 512-0;  break;
-            case 3: maxSamples = 512-4;  break;
-            case 4: maxSamples = 512-10; break;
-            case 5: maxSamples = 512-24; break;
-            case 6: maxSamples = 512-10; break;
-            case 7: maxSamples = 512-20; break;
-            case 8: maxSamples = 512-4;  break;
-            case 9: maxSamples = 512-0;  break;
-            case 10: maxSamples = 512-8;  break;
-            case 11: maxSamples = 512-28;  break;
-            case 12: maxSamples = 512-60;  break;
-            case 13: maxSamples = 512-24;  break;
-            case 14: maxSamples = 512-74;  break;
-            case 15: maxSamples = 512-44;  break;
-            case 16: maxSamples = 512-14;  break;
-            case 17: maxSamples = 512-88;  break;
-            case 18: maxSamples = 512-64;  break;
-            case 19: maxSamples = 512-40;  break;
-            case 20: maxSamples = 512-16;  break;
-            default: maxSamples = 512; break;
+            if (de->RX.at(r)->qtwdsp)
+                m_unpackIQ24(data + s + 6 * r, frameSize, n, &de->RX[r]->m_rawIQ[m_rxSamples]);
         }
 
-        // extract the samples
-        while (s < maxSamples)
-        {
-            // extract each of the receivers
-            for (int r = 0; r < de->io.receivers; r++)
-            {
-                m_leftSample   = (int)((  signed char) buffer.at(s++)) << 16;
-                m_leftSample  += (int)((unsigned char) buffer.at(s++)) << 8;
-                m_leftSample  += (int)((unsigned char) buffer.at(s++));
-                m_rightSample  = (int)((  signed char) buffer.at(s++)) << 16;
-                m_rightSample += (int)((unsigned char) buffer.at(s++)) << 8;
-                m_rightSample += (int)((unsigned char) buffer.at(s++));
+        const unsigned char *mic = data + s + (n - 1) * frameSize + 6 * receivers;
+        m_micSample = (int)((signed char) mic[0]) << 8;
+        m_micSample += (int)mic[1];
+        m_micSample_float = (float) m_micSample / 32767.0f * de->io.mic_gain; // 16 bit sample
 
+        s += n * frameSize;
+        frames -= n;
+        m_rxSamples += n;
+
+        // when we have enough rx samples we start the DSP processing.
+        if (m_rxSamples == BUFFER_SIZE) {
+            for (int r = 0; r < receivers; r++) {
                 if (de->RX.at(r)->qtwdsp) {
-                    de->RX[r]->m_rawIQ[m_rxSamples * 2] = m_leftSample;
-                    de->RX[r]->m_rawIQ[m_rxSamples * 2 + 1] = m_rightSample;
+                    de->RX[r]->enqueueRawData(de->io.iqPacketReceived);
+                    de->m_dspWorkerPool.notify(r);
                 }
             }
+            m_rxSamples = 0;
+        }
+    }
+}
 
-            m_micSample = (int)((signed char) buffer.at(s++)) << 8;
-            m_micSample += (int)((unsigned char) buffer.at(s++));
-            m_micSample_float = (float) m_micSample / 32767.0f * de->io.mic_gain; // 16 bit sample
+void CProtocol1::processInputBuffer(const QByteArray& buffer, DataEngine* de, quint16 sourcePort) {
+    Q_UNUSED(sourcePort)
 
-            m_rxSamples++;
+    if (buffer.size() < IO_BUFFER_SIZE || de->io.receivers <= 0) return;
 
-            // when we have enough rx samples we start the DSP processing.
-            if (m_rxSamples == BUFFER_SIZE) {
-                for (int r = 0; r < de->io.receivers; r++) {
-                    if (de->RX.at(r)->qtwdsp) {
-                        de->RX[r]->enqueueRawData();
-                        QMetaObject::invokeMethod(de->RX.at(r), "dspProcessing", Qt::QueuedConnection);
-                    }
-                }
-                m_rxSamples = 0;
-            }
-        }
-    }
+    const unsigned char *data = (const unsigned char *) buffer.constData();
+    if (data[0] != SYNC || data[1] != SYNC || data[2] != SYNC) return;
+
+    // extract C&C bytes
+    decodeCCBytes(QByteArray::fromRawData(buffer.constData() + 3, 5), &de->io);
+
+    // the layout is only looked up again when the receiver count changes
+    if (de->io.receivers != m_decoderReceivers)
+        selectFrameDecoder(de->io.receivers);
+
+    (this->*m_decodeSamples)(data, de);
 }
 
 void CProtocol1::decodeCCBytes(const QByteArray& buffer, THPSDRParameter* io) {
@@ -488,13 +533,16 @@ QByteArray CProtocol1::formatInitFrame(int rx, THPSDRParameter* io, quint16& por
 }
 
 QByteArray CProtocol1::formatOutputPacket(const QByteArray& audioData, uint32_t& sequence) {
-    QByteArray outDatagram;
-    uint32_t outseq = qFromBigEndian(sequence);
-    outDatagram.resize(0);
-    outDatagram += m_deviceSendDataSignature;
-    QByteArray seq(reinterpret_cast<const char*>(&outseq), sizeof(outseq));
-    outDatagram += seq;
+    QByteArray outDatagram(METIS_HEADER_SIZE, '\0');
+    formatOutputHeader(reinterpret_cast<unsigned char*>(outDatagram.data()), sequence);
     outDatagram += audioData;
-    sequence++;
     return outDatagram;
 }
+
+// Metis header: EF FE 01 02 and the big-endian sequence number
+int CProtocol1::formatOutputHeader(unsigned char* header, uint32_t& sequence) {
+    memcpy(header, m_deviceSendDataSignature.constData(), 4);
+    qToBigEndian(sequence, header + 4);
+    sequence++;
+    return METIS_HEADER_SIZE;
+}
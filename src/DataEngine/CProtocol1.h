@@ -3,6 +3,7 @@
 
 #include "IHPSDRProtocol.h"
 #include "cusdr_settings.h"
+#include "Util/cusdr_iqUnpack.h"
 #include <QtEndian>
 
 class CProtocol1 : public IHPSDRProtocol {
@@ -21,12 +22,18 @@ public:
     QByteArray formatStartStop(char value, quint16& port) override;
     QByteArray formatInitFrame(int rx, THPSDRParameter* io, quint16& port) override;
     QByteArray formatOutputPacket(const QByteArray& audioData, uint32_t& sequence) override;
+    int formatOutputHeader(unsigned char* header, uint32_t& sequence) override;
 
     int getPayloadSize() override { return BUFFER_SIZE; }
     int getHeaderSize() override { return METIS_HEADER_SIZE; }
     QList<quint16> getRequiredPorts() override;
 
 private:
+    typedef void (CProtocol1::*DecodeSamplesFn)(const unsigned char* data, DataEngine* de);
+
+    void selectFrameDecoder(int receivers);
+    template<int RX> void decodeSamples(const unsigned char* data, DataEngine* de);
+
     QByteArray m_metisGetDataSignature;
     QByteArray m_deviceSendDataSignature;
 
@@ -35,11 +42,12 @@ private:
     int     m_firstTimeRxInit;
     int     m_rxSamples;
     int     m_fwCount;
+    int     m_decoderReceivers;
+    DecodeSamplesFn m_decodeSamples;
+    UnpackIQ24Fn    m_unpackIQ24;
 
     double  m_lsample;
     double  m_rsample;
-    int     m_leftSample;
-    int     m_rightSample;
     int     m_micSample;
     float   m_micSample_float;
 };
@@ -11,7 +11,7 @@
 // Uncomment to log the Alex0 32-bit word on every HP packet encode
 //#define LOG_P2_HP_ALEX
 
-CProtocol2::CProtocol2() : m_lastSequence(0), m_lastPacketLen(0) {
+CProtocol2::CProtocol2() : m_lastSequence(0), m_lastPacketLen(0), m_unpackIQ24(unpackIQ24Function()) {
     memset(m_rxSamplesPerDDC, 0, sizeof(m_rxSamplesPerDDC));
 }
 
@@ -61,7 +61,6 @@ void CProtocol2::processInputBuffer(const QByteArray& buffer, DataEngine* de, qu
     static quint64 p2ProcessCalls = 0;
     static quint64 p2DspKickCount = 0;
     static quint64 p2NoQtWdspCount = 0;
-    static quint64 p2DspInvokeFailCount = 0;
     static quint64 p2RouteLogCount = 0;
 
     if (buffer.isEmpty()) return;
@@ -106,7 +105,8 @@ void CProtocol2::processInputBuffer(const QByteArray& buffer, DataEngine* de, qu
 
     int& rxSamples = m_rxSamplesPerDDC[ddcIndex];
     Receiver *rx = de->RX.at(ddcIndex);
-    int s = 0; // IQ payload starts at the beginning of the buffer
+    // IQ payload starts at the beginning of the buffer
+    const unsigned char *data = (const unsigned char *) buffer.constData();
     int samplesInPacket = buffer.size() / 6;
 
     ++p2RouteLogCount;
@@ -124,18 +124,12 @@ void CProtocol2::processInputBuffer(const QByteArray& buffer, DataEngine* de, qu
                  << " BUFFER_SIZE=" << BUFFER_SIZE;
     }
 
-    for (int i = 0; i < samplesInPacket && s + 6 <= buffer.size(); i++) {
-        int iSample = (int)((signed char)buffer.at(s++)) << 16;
-        iSample |= (int)((unsigned char)buffer.at(s++)) << 8;
-        iSample |= (int)((unsigned char)buffer.at(s++));
-
-        int qSample = (int)((signed char)buffer.at(s++)) << 16;
-        qSample |= (int)((unsigned char)buffer.at(s++)) << 8;
-        qSample |= (int)((unsigned char)buffer.at(s++));
+    // unpack in runs that end where the receiver block fills up
+    for (int i = 0; i < samplesInPacket; ) {
+        const int n = qMin(samplesInPacket - i, BUFFER_SIZE - rxSamples);
 
         if (rx->qtwdsp) {
-            rx->m_rawIQ[rxSamples*2] = iSample;
-            rx->m_rawIQ[rxSamples*2+1] = qSample;
+            m_unpackIQ24(data + 6 * i, 6, n, &rx->m_rawIQ[rxSamples]);
         } else {
             ++p2NoQtWdspCount;
             if ((p2NoQtWdspCount % 1000) == 1) {
@@ -143,23 +137,17 @@ void CProtocol2::processInputBuffer(const QByteArray& buffer, DataEngine* de, qu
             }
         }
 
-        rxSamples++;
+        i += n;
+        rxSamples += n;
         if (rxSamples == BUFFER_SIZE) {
             if (rx->qtwdsp) {
-                rx->enqueueRawData();
-                bool invoked = QMetaObject::invokeMethod(rx, "dspProcessing", Qt::QueuedConnection);
+                rx->enqueueRawData(de->io.iqPacketReceived);
+                de->m_dspWorkerPool.notify(ddcIndex);
                 ++p2DspKickCount;
                 if ((p2DspKickCount % 100) == 1) {
                     P2_ROUTE_DEBUG << "dspKick rx=" << ddcIndex
                                    << " srcPort=" << sourcePort
-                                   << " count=" << p2DspKickCount
-                                   << " invoked=" << invoked;
-                }
-                if (!invoked) {
-                    ++p2DspInvokeFailCount;
-                    if ((p2DspInvokeFailCount % 10) == 1) {
-                        qDebug() << "P2 DSP invoke failed count=" << p2DspInvokeFailCount;
-                    }
+                                   << " count=" << p2DspKickCount;
                 }
             }
             rxSamples = 0;
@@ -600,44 +588,22 @@ QByteArray CProtocol2::formatOutputPacket(const QByteArray& audioData, uint32_t&
     //   Bytes 0-3  : sequence number (big-endian uint32)
     //   Bytes 4-1443: 240 × 6 bytes — I(3 bytes) Q(3 bytes), 24-bit signed big-endian
     //
-    // Source: P1 output_buffer (512 bytes, IO_BUFFER_SIZE):
-    //   Bytes 0-7:     Metis/P1 header (8 bytes, not used here)
-    //   Bytes 8+n*8+0,+1 : L RX audio  (unused for TX)
-    //   Bytes 8+n*8+2,+3 : R RX audio  (unused for TX)
-    //   Bytes 8+n*8+4,+5 : TX I  (16-bit signed big-endian)
-    //   Bytes 8+n*8+6,+7 : TX Q  (16-bit signed big-endian)
-    //   63 samples total: (512 - 8) / 8 = 63
-    //
-    // 16→24-bit conversion: [hi, lo, 0x00] preserves sign and scales correctly.
-    // Samples 63-239 are zero-padded (silent) since we only have 63 per call.
-
-    const int NUM_P2_SAMPLES = 240;           // hpsdrsim tx_thread expects exactly this
-    const int P1_HEADER      = 8;             // IO_HEADER_SIZE
-    const int P1_SAMPLE_BYTES= 8;             // L(2)+R(2)+I(2)+Q(2)
-    const int P1_SAMPLES     = 63;            // (512 - 8) / 8
+    // audioData holds the native payload (240 packed I/Q pairs, as packIQ24()
+    // writes them); a short payload is padded with silence. The streaming TX
+    // path builds the same packets in place in DucPacketizer.
 
-    QByteArray pkt(4 + NUM_P2_SAMPLES * 6, '\0');
+    QByteArray pkt(DUC_PACKET_SIZE, '\0');
     unsigned char* p = reinterpret_cast<unsigned char*>(pkt.data());
 
-    // Sequence (big-endian)
-    uint32_t seq = qToBigEndian(sequence);
-    memcpy(p, &seq, 4);
-    p += 4;
-
-    const unsigned char* src = reinterpret_cast<const unsigned char*>(audioData.constData());
-    const int nSamples = (audioData.size() >= P1_HEADER)
-                         ? qMin((audioData.size() - P1_HEADER) / P1_SAMPLE_BYTES, P1_SAMPLES)
-                         : 0;
-
-    for (int i = 0; i < nSamples; ++i) {
-        const unsigned char* s = src + P1_HEADER + i * P1_SAMPLE_BYTES;
-        // TX I at byte-offset +4,+5; TX Q at +6,+7
-        p[0] = s[4]; p[1] = s[5]; p[2] = 0x00;  // I: hi, lo, 0
-        p[3] = s[6]; p[4] = s[7]; p[5] = 0x00;  // Q: hi, lo, 0
-        p += 6;
-    }
-    // Bytes beyond nSamples*6 are already zero-initialised.
+    formatOutputHeader(p, sequence);
+
+    const int payload = qMin((int)audioData.size(), DUC_SAMPLES_PER_PACKET * DUC_SAMPLE_BYTES);
+    memcpy(p + DUC_HEADER_SIZE, audioData.constData(), payload);
 
-    sequence++;
     return pkt;
 }
+
+// DUC IQ header: just the big-endian sequence number
+int CProtocol2::formatOutputHeader(unsigned char* header, uint32_t& sequence) {
+    return DucPacketizer::formatHeader(header, sequence);
+}
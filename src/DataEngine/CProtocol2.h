@@ -2,6 +2,7 @@
 #define CPROTOCOL2_H
 
 #include "IHPSDRProtocol.h"
+#include "Util/cusdr_iqUnpack.h"
 #include <QtEndian>
 
 class CProtocol2 : public IHPSDRProtocol {
@@ -20,6 +21,7 @@ public:
     QByteArray formatStartStop(char value, quint16& port) override;
     QByteArray formatInitFrame(int rx, THPSDRParameter* io, quint16& port) override;
     QByteArray formatOutputPacket(const QByteArray& audioData, uint32_t& sequence) override;
+    int formatOutputHeader(unsigned char* header, uint32_t& sequence) override;
 
     int getPayloadSize() override { return 1428; } // 1444-byte DDC packet minus 16-byte header
     // Protocol 2 DDC data packet header (per spec v4.3 p.51):
@@ -45,6 +47,8 @@ private:
     // Stored by isPacketValid() and read by getPacketType() to discriminate
     // between DDC-data packets (large) and High-Priority-Status packets (small).
     mutable int m_lastPacketLen;
+    // SIMD unpack kernel, selected once instead of per call
+    UnpackIQ24Fn m_unpackIQ24;
 };
 
 #endif // CPROTOCOL2_H
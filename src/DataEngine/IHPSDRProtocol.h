@@ -26,6 +26,8 @@ public:
     virtual QByteArray formatStartStop(char value, quint16& port) = 0;
     virtual QByteArray formatInitFrame(int rx, THPSDRParameter* io, quint16& port) = 0;
     virtual QByteArray formatOutputPacket(const QByteArray& audioData, uint32_t& sequence) = 0;
+    // writes the header of the next TX data packet to 'header', returns its size
+    virtual int formatOutputHeader(unsigned char* header, uint32_t& sequence) = 0;
 
     // Hardware specific
     virtual int getPayloadSize() = 0;
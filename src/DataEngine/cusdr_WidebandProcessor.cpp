@@ -6,6 +6,8 @@
 
 #include "cusdr_dataEngine.h"
 #include "cusdr_WidebandProcessor.h"
+#include "Util/cusdr_displayScheduler.h"
+#include "Util/cusdr_iqUnpack.h"
 
 void AudioOutProcessor::processDeviceData() {
 
@@ -41,14 +43,18 @@ WideBandDataProcessor::WideBandDataProcessor(THPSDRParameter *ioData, QSDR::_Ser
 	, io(ioData)
 	, set(Settings::instance())
 	, m_serverMode(serverMode)
+	, m_timer(nullptr)
 	, m_size(size)
-	, m_bytes(0)
-	, m_stopped(false)
+	, m_fftSize(validFftSize(set->getWidebandFftSize()))
+	, m_overlap(set->getWidebandOverlap())
+	, m_frameRate(set->getWidebandFrameRate())
+	, m_step(0)
+	, m_segments(0)
 {
 	int result;
 	m_wbSpectrumAveraging = set->getSpectrumAveragingCnt(-1);
 	cpxWBIn.resize(WIDEBAND_BUFFER_SIZE);
-	specBuf.resize(NUM_PIXELS * 2);
+	specBuf.resize(NUM_PIXELS);
     XCreateAnalyzer(WIDEBAND_DISPLAY_NUMBER, &result, 262144, 1, 1, nullptr);
 	if(result != 0) {
 		WIDEBAND_PROCESSOR_DEBUG <<  "wideband XCreateAnalyzer failed:" << result;
@@ -58,21 +64,32 @@ WideBandDataProcessor::WideBandDataProcessor(THPSDRParameter *ioData, QSDR::_Ser
 	setWbSpectrumAveraging(this, -1,m_wbSpectrumAveraging);
 }
 
+// the analyzer takes powers of two from 1024 up to one whole frame: round to
+// the nearest of those
+int WideBandDataProcessor::validFftSize(int fftSize) const {
+
+	int size = 1024;
+	while (size < m_size && fftSize > size + size / 2)
+		size *= 2;
+
+	return size;
+}
+
 void  WideBandDataProcessor::initWidebandAnalyzer() {
 
 		int flp[] = {0};
 		double keep_time = 0.1;
 		int n_pixout = 1;
 		int spur_elimination_ffts = 1;
-		int data_type = 1;
-		int fft_size = 8192;
+		int data_type = 0;	// the ADC samples are real: half the FFT work
+		int fft_size = m_fftSize;
 		int window_type = 4;
 		double kaiser_pi = 14.0;
-		int overlap = 0; //1024; //4096;
+		int overlap = 0;	// done here, on whole frames: see getSpectrumData()
 		int clip = 0;
 		int span_clip_l = 0;
 		int span_clip_h = 0;
-		int pixels = NUM_PIXELS * 2;
+		int pixels = NUM_PIXELS;	// real input: 0 .. fs/2 only
 		int stitches = 1;
 		int avm = 0;
 		double tau = 0.001 * 120.0;
@@ -82,13 +99,18 @@ void  WideBandDataProcessor::initWidebandAnalyzer() {
 
 		int max_w = fft_size + (int) min(keep_time * (double) 10, keep_time * (double) fft_size * (double) 10);
 		//overlap = (int)max(0.0, ceil(fft_size - (double)w->sample_rate / (double)w->fps));
+
+		// segments start every m_step samples and all lie within the frame
+		m_step = qMax(1, fft_size * (100 - m_overlap) / 100);
+		m_segments = (m_size - fft_size) / m_step + 1;
+
 		SetAnalyzer(WIDEBAND_DISPLAY_NUMBER,
 					n_pixout,
 					spur_elimination_ffts, //number of LO frequencies = number of ffts used in elimination
 					data_type, //0 for real input data (I only); 1 for complex input data (I & Q)
 					flp, //vector with one elt for each LO frequency, 1 if high-side LO, 0 otherwise
 					fft_size, //size of the fft, i.e., number of input samples
-					WIDEBAND_BUFFER_SIZE, //number of samples transferred for each OpenBuffer()/CloseBuffer()
+					fft_size, //number of samples transferred for each OpenBuffer()/CloseBuffer()
 					window_type, //integer specifying which window function to use
 					kaiser_pi, //PiAlpha parameter for Kaiser window
 					overlap, //number of samples each fft (other than the first) is to re-use from the previous
@@ -105,6 +127,9 @@ void  WideBandDataProcessor::initWidebandAnalyzer() {
 
 		SetDisplayDetectorMode(WIDEBAND_DISPLAY_NUMBER, 0, DETECTOR_MODE_AVERAGE);
 		SetDisplayAverageMode(WIDEBAND_DISPLAY_NUMBER, 0,  AVERAGE_MODE_RECURSIVE);
+
+		WIDEBAND_PROCESSOR_DEBUG << "analyzer: fft " << fft_size << ", " << m_segments
+								 << " segments per frame, " << m_frameRate << " frames/s";
 }
 
 WideBandDataProcessor::~WideBandDataProcessor() {
@@ -115,47 +140,71 @@ WideBandDataProcessor::~WideBandDataProcessor() {
 
 void WideBandDataProcessor::stop() {
 
-	m_stopped = true;
+	// the timer belongs to the processor's thread: stop it there
+	if (QThread::currentThread() != thread() && thread()->isRunning())
+		QMetaObject::invokeMethod(this, [this] { if (m_timer) m_timer->stop(); },
+								  Qt::BlockingQueuedConnection);
 }
 
 void WideBandDataProcessor::processWideBandData() {
-	forever {
-		processWideBandInputBuffer(io->wb_queue.dequeue());
 
-		m_mutex.lock();
-		if (m_stopped) {
-			m_stopped = false;
-			m_mutex.unlock();
-			break;
-		}
-		m_mutex.unlock();
+	if (!m_timer) {
+
+		m_timer = new QTimer(this);
+		m_timer->setTimerType(Qt::PreciseTimer);
+		connect(m_timer, &QTimer::timeout, this, &WideBandDataProcessor::analyzeFrame);
 	}
+	m_timer->start(qRound(1000.0 / m_frameRate));
 }
 
-void WideBandDataProcessor::processWideBandInputBuffer(const QByteArray &buffer) {
+void WideBandDataProcessor::setWidebandAnalyzer(QObject *sender, int fftSize, int overlap, int frameRate) {
+
+	Q_UNUSED (sender)
+
+	m_mutex.lock();
+	m_fftSize = validFftSize(fftSize);
+	m_overlap = qBound(0, overlap, 75);
+	m_frameRate = qBound(1, frameRate, 60);
+	initWidebandAnalyzer();
+	setAveraging();
+	m_mutex.unlock();
+
+	if (m_timer && m_timer->isActive())
+		m_timer->start(qRound(1000.0 / m_frameRate));
+}
+
+void WideBandDataProcessor::analyzeFrame() {
+
+	// nobody looks at the wide band spectrum: leave the frame where it is
+	if (!CDisplayScheduler::instance()->isShown(CDisplayScheduler::Wideband))
+		return;
+
+	// nothing new since the last tick: the display keeps the last spectrum
+	int length = 0;
+	const uchar *frame = io->wb_frames.tryAcquire(length);
+	if (!frame)
+		return;
+
+	processWideBandInputBuffer(frame, length);
+	io->wb_frames.release();
+}
+
+void WideBandDataProcessor::processWideBandInputBuffer(const uchar *frame, int length) {
+
 	int size;
 	if (io->mercuryFW > 32 || io->hermesFW > 11)
 		size = 2 * BIGWIDEBANDSIZE;
 	else
 		size = 2 * SMALLWIDEBANDSIZE;
 
-	qint64 length = buffer.length();
 	if (length != size) {
 		WIDEBAND_PROCESSOR_DEBUG << "wrong wide band buffer length: " << length << "size " << size <<  "ver " << io->hermesFW ;
 		return;
 	}
 
-    const int numSamples = length / 2;
-    const int8_t* rawData = reinterpret_cast<const int8_t*>(buffer.constData());
-    const double scale = 1.0 / 32767.0;
-    cpx* outPtr = cpxWBIn.data();
-
-	for (int i = 0; i < numSamples; ++i) {
-        // HPSDR Wideband data is 16-bit Little Endian
-        int16_t sample = (int16_t)((uint16_t)(rawData[2*i] & 0xFF) | ((uint16_t)rawData[2*i+1] << 8));
-		outPtr[i].re = (double)sample * scale;
-		outPtr[i].im = 0.0;
-	}
+    // HPSDR wideband data is 16-bit little endian; the analyzer only reads the
+    // real parts (data_type 0)
+    unpackReal16(frame, length / 2, cpxWBIn.data());
 	getSpectrumData();
 }
 
@@ -163,10 +212,12 @@ void WideBandDataProcessor::getSpectrumData(){
 	int spectrumDataReady;
 
 	m_mutex.lock();
-    Spectrum0(1, WIDEBAND_DISPLAY_NUMBER, 0, 0,(double *) cpxWBIn.data());
+	// overlapping segments of one contiguous frame, one FFT each
+	for (int s = 0; s < m_segments; s++)
+		Spectrum0(1, WIDEBAND_DISPLAY_NUMBER, 0, 0, (double *)(cpxWBIn.data() + s * m_step));
 	GetPixels(WIDEBAND_DISPLAY_NUMBER,0,specBuf.data(), &spectrumDataReady);
 	if (spectrumDataReady)
-			emit wbSpectrumBufferChanged(specBuf.mid(NUM_PIXELS,specBuf.length()));
+			emit wbSpectrumBufferChanged(specBuf);
 	m_mutex.unlock();
 }
 
@@ -176,11 +227,17 @@ void WideBandDataProcessor::setWbSpectrumAveraging(QObject* sender, int rx, int
 	if (rx != -1) return;
 	m_mutex.lock();
 	m_wbSpectrumAveraging = value;
+	setAveraging();
+	m_mutex.unlock();
+}
+
+// m_mutex held. The averaging time is in spectra, i.e. frames at m_frameRate.
+void WideBandDataProcessor::setAveraging() {
+
 	double t=0.001*m_wbSpectrumAveraging;
-	double  m_display_avb = exp(-1.0 / ((double)10 * t));
-	int  m_display_average = max(2, (int)min(60, (double)10 * t));
+	double  m_display_avb = exp(-1.0 / ((double)m_frameRate * t));
+	int  m_display_average = max(2, (int)min(60, (double)m_frameRate * t));
 	SetDisplayAvBackmult(WIDEBAND_DISPLAY_NUMBER, 0, m_display_avb);
 	SetDisplayNumAverage(WIDEBAND_DISPLAY_NUMBER, 0, m_display_average);
-	m_mutex.unlock();
 }
 
@@ -11,6 +11,8 @@
 #include "Util/qcircularbuffer.h"
 #include "QtWDSP/qtwdsp_dspEngine.h"
 
+#include <QTimer>
+
 #ifndef CUDASDR_CUSDR_WIDEBANDPROCESSOR_H
 #define CUDASDR_CUSDR_WIDEBANDPROCESSOR_H
 
@@ -19,6 +21,14 @@
 #define WIDEBAND_DISPLAY_NUMBER 9
 // *********************************************************************
 // Wide band data processor class
+//
+// Runs on its own thread, paced by a timer at the configured frame rate
+// rather than by EP4 arrival: each tick takes the newest complete frame,
+// if there is one and the wideband display is shown, and cuts it into FFT
+// segments of the configured size and overlap. Each segment is handed to
+// the analyzer as one contiguous block, so no FFT spans the gap between
+// two frames. The cost is frame rate x segments per frame FFTs a second,
+// whatever the radio sends.
 
 class WideBandDataProcessor : public QObject {
 
@@ -32,11 +42,10 @@ public:
 public slots:
     void	stop();
     void	processWideBandData();
+    void	setWidebandAnalyzer(QObject *sender, int fftSize, int overlap, int frameRate);
 
 private slots:
-    void	processWideBandInputBuffer(const QByteArray &buffer);
-
-    void 	getSpectrumData();
+    void	analyzeFrame();
 
 private:
     THPSDRParameter*	io;
@@ -44,20 +53,27 @@ private:
 
     CPX					cpxWBIn;
     QMutex				m_mutex;
-    QByteArray			m_WBDatagram;
     QString				m_message;
 
     QSDR::_ServerMode		m_serverMode;
     QVector<float> 		specBuf;
+    QTimer*				m_timer;
 
     int				m_size;
-    int				m_bytes;
+    int				m_fftSize;
+    int				m_overlap;
+    int				m_frameRate;
+    int				m_step;			// samples between two segments
+    int				m_segments;		// FFTs per frame
 
     int 			m_wbSpectrumAveraging;
-    volatile bool	m_stopped;
 
     unsigned char	m_ibuffer[IO_BUFFER_SIZE * IO_BUFFERS];
+    int  validFftSize(int fftSize) const;
     void initWidebandAnalyzer();
+    void setAveraging();
+    void processWideBandInputBuffer(const uchar *frame, int length);
+    void getSpectrumData();
 
 signals:
     void	messageEvent(QString message);
@@ -370,6 +370,12 @@ void DataEngine::setupConnections() {
             this,
             SLOT(setRepeaterMode(bool)));
 
+	CHECKED_CONNECT(
+		set,
+		SIGNAL(iqRecordingChanged(QObject *, bool)),
+		this,
+		SLOT(setIQRecording(QObject *, bool)));
+
 
     CHECKED_CONNECT(
             set,
@@ -466,6 +472,7 @@ bool DataEngine::startDataEngineWithoutConnection() {
         initReceivers(1);
 		if (!m_dataIO)	createDataIO();
 		if (!m_dataProcessor)	createDataProcessor();
+		m_dspWorkerPool.start(RX);
 
 
 
@@ -493,6 +500,84 @@ bool DataEngine::startDataEngineWithoutConnection() {
 	}
 }
 
+//********************************************************
+// headless IQ replay
+bool DataEngine::startReplay(int protocol, int rcvrs) {
+
+	DATA_ENGINE_DEBUG << "replay: protocol " << protocol << " with " << rcvrs << " receiver(s)";
+
+	if (m_protocol) delete m_protocol;
+	if (protocol == 2)
+		m_protocol = new CProtocol2();
+	else
+		m_protocol = new CProtocol1();
+	io.protocol = m_protocol;
+
+	if (!initReceivers(rcvrs)) {
+
+		DATA_ENGINE_DEBUG << "replay: failed to initialize receivers";
+		return false;
+	}
+
+	m_dataIO = new DataIO(&io);
+
+	m_dataProcessor = new DataProcessor(this, QSDR::SDRMode, QSDR::Metis);
+	m_dataProcThread = new QThreadEx();
+	m_dataProcessor->moveToThread(m_dataProcThread);
+
+	CHECKED_CONNECT(
+			m_dataIO,
+			SIGNAL(readydata()),
+			m_dataProcessor,
+			SLOT(processReadData()));
+
+	for (int i = 0; i < rcvrs; i++) {
+
+		RX.at(i)->setConnectedStatus(true);
+		m_dspThreadList.at(i)->start(QThread::NormalPriority);
+	}
+	m_dspWorkerPool.start(RX);
+
+	return startDataProcessor(QThread::NormalPriority);
+}
+
+void DataEngine::stopReplay() {
+
+	// decoder first: the worker pool must not be stopped under a running decoder
+	if (m_dataProcThread) {
+
+		stopDataProcessor();
+		m_dataProcThread = nullptr;
+	}
+
+	for (const auto &rx : RX)
+		if (rx->qtwdsp) rx->qtwdsp->stopChannel();
+	SleeperThread::msleep(5);
+
+	m_dspWorkerPool.stop();
+
+	foreach (QThread* thread, m_dspThreadList) {
+
+		thread->quit();
+		thread->wait();
+	}
+	qDeleteAll(m_dspThreadList.begin(), m_dspThreadList.end());
+	m_dspThreadList.clear();
+
+	qDeleteAll(RX.begin(), RX.end());
+	RX.clear();
+	set->setRxList(RX);
+
+	delete m_dataIO;
+	m_dataIO = nullptr;
+
+	delete m_protocol;
+	m_protocol = nullptr;
+	io.protocol = nullptr;
+
+	DATA_ENGINE_DEBUG << "replay: shut down done.";
+}
+
 bool DataEngine::findHPSDRDevices() {
 
 	if (!m_discoverer) createDiscoverer();
@@ -964,6 +1049,7 @@ bool DataEngine::start() {
 	}	// end switch (m_serverMode)
 
 	if (RX.count() != rcvrs || m_dspThreadList.count() != rcvrs) {
+		m_dspWorkerPool.stop();
 		if (!m_dspThreadList.isEmpty()) {
 			foreach (QThread* thread, m_dspThreadList) {
 				thread->quit();
@@ -1031,6 +1117,10 @@ bool DataEngine::start() {
 		m_dataIO->set_wbBuffers(set->getWidebandBuffers());
 	}
 
+	// receiver DSP runs on the worker pool, the receiver threads above only
+	// handle the receivers' control slots
+	m_dspWorkerPool.start(RX);
+
 /*
     if (!startAudioInputProcessor(QThread::NormalPriority))
     {
@@ -1145,6 +1235,7 @@ void DataEngine::stop() {
 				// stop the threads
 				//SleeperThread::msleep(100);
 				stopDataIO();
+				set->setIQRecording(this, false);
 				SleeperThread::msleep(100);
 				stopDataProcessor();
 				if (m_wbDataProcessor)
@@ -1191,6 +1282,8 @@ void DataEngine::stop() {
 		}
 		SleeperThread::msleep(5); // let any in-flight fexchange0 observe run=0
 
+		m_dspWorkerPool.stop();
+
 		// clear receiver thread list
 		foreach (QThread* thread, m_dspThreadList) {
 
@@ -1348,6 +1441,7 @@ bool DataEngine::initReceivers(int rcvrs) {
 	io.receivers = rcvrs;
 
 	io.timing = 0;
+	io.iqPacketReceived = 0;
 	m_configure = io.receivers + 1;
 
 	// init cc Rc parameters
@@ -1850,8 +1944,7 @@ void DataEngine::stopDataProcessor() {
 
 		if (m_serverMode == QSDR::SDRMode ) {
 
-			while (!io.iq_queue.isEmpty())
-				io.iq_queue.dequeue();
+			io.iq_queue.clear();
 
 			DATA_ENGINE_DEBUG << "iq_queue empty.";
 		}
@@ -1904,6 +1997,12 @@ void DataEngine::createWideBandDataProcessor() {
 
 
 
+	CHECKED_CONNECT(
+			set,
+			SIGNAL(widebandAnalyzerChanged(QObject*, int, int, int)),
+			m_wbDataProcessor,
+			SLOT(setWidebandAnalyzer(QObject*, int, int, int)));
+
 	CHECKED_CONNECT(
 			m_wbDataProcessor,
 			SIGNAL(wbSpectrumBufferChanged(const qVectorFloat&)),
@@ -1944,8 +2043,6 @@ void DataEngine::stopWideBandDataProcessor() {
 	if (m_wbDataProcThread->isRunning()) {
 					
 		m_wbDataProcessor->stop();
-		if (io.wb_queue.isEmpty())
-			io.wb_queue.enqueue(m_datagram);
 
 		m_wbDataProcThread->quit();
 		m_wbDataProcThread->wait();
@@ -2405,11 +2502,9 @@ void DataEngine::setNumberOfRx(QObject *sender, int value) {
 	}
 	io.mutex.unlock();
 
-	DATA_ENGINE_DEBUG << "[RX-ADD] flushing IQ queue (" << io.iq_queue.count() << " items) and WB queue (" << io.wb_queue.count() << " items)";
-	while (!io.iq_queue.isEmpty())
-		io.iq_queue.dequeue();
-	while (!io.wb_queue.isEmpty())
-		io.wb_queue.dequeue();
+	DATA_ENGINE_DEBUG << "[RX-ADD] flushing IQ queue (" << io.iq_queue.count() << " items) and WB frame";
+	io.iq_queue.clear();
+	io.wb_frames.clear();
 
 	if (set->getCurrentReceiver() >= value) {
 		set->setCurrentReceiver(this, 0);
@@ -2455,6 +2550,51 @@ void DataEngine::setTimeStamp(QObject *sender, bool value) {
 		DATA_ENGINE_DEBUG << "set time stamp off";
 }
 
+void DataEngine::setIQRecording(QObject *sender, bool value) {
+
+	Q_UNUSED(sender)
+
+	IQRecorder &recorder = io.iq_recorder;
+	if (!value) {
+
+		if (!recorder.isRecording()) return;
+		recorder.stop();
+
+		QString msg = QString("IQ recording %1: %2 datagrams, %3 dropped")
+							.arg(recorder.fileName())
+							.arg(recorder.records())
+							.arg(recorder.droppedRecords());
+		if (!recorder.errorString().isEmpty())
+			msg.append(" (").append(recorder.errorString()).append(")");
+
+		DATA_ENGINE_DEBUG << qPrintable(msg);
+		set->setSystemMessage(msg, 8000);
+		return;
+	}
+
+	if (!m_networkDeviceRunning || !io.protocol) {
+
+		set->setSystemMessage("IQ recording needs a running HPSDR device.", 4000);
+		set->setIQRecording(this, false);
+		return;
+	}
+
+	QDir dir(set->cfg_dir);
+	dir.mkpath("recordings");
+	const QString fileName = dir.filePath(
+		QDateTime::currentDateTime().toString("'recordings/iq-'yyyyMMdd-HHmmss'.cuiq'"));
+
+	QString error;
+	const int protocol = (set->getCurrentMetisCard().protocol == 2) ? 2 : 1;
+	if (!recorder.start(fileName, protocol, set->getSampleRate(), set->getNumberOfReceivers(), &error)) {
+
+		set->setSystemMessage(error, 8000);
+		set->setIQRecording(this, false);
+		return;
+	}
+	set->setSystemMessage(QString("recording IQ to %1").arg(fileName), 4000);
+}
+
 void DataEngine::setRxSocketState(int rx, const char* prop, QString str) {
 
 	RX[rx]->setProperty(prop, str);
@@ -2607,9 +2747,10 @@ DataProcessor::DataProcessor(
 	, m_serverMode(serverMode)
 	, m_hwInterface(hwMode)
 	, m_socketConnected(false)
-	, m_setNetworkDeviceHeader(true)
 	, m_sendSequence(0)
 	, m_oldSendSequence(0)
+	, m_ducSequence(0)
+	, m_txFrame(nullptr)
 	, m_bytes(0)
 	, m_offset(0)
 	, m_length(0)
@@ -2649,6 +2790,8 @@ DataProcessor::~DataProcessor() {
 void DataProcessor::stop() {
 
 	m_stopped = true;
+
+	m_txSender.stop();
 }
 
 void DataProcessor::startControlTimer() {
@@ -2871,9 +3014,15 @@ void DataProcessor::displayDataProcessorSocketError(QAbstractSocket::SocketError
 void DataProcessor::processDeviceData() {
 
 	DATA_PROCESSOR_DEBUG << "Data Processor thread: " << this->thread();
+
+	// a new run starts with an empty DUC ring and packet clock
+	m_ducPacketizer.reset();
+
 	forever {
 
 		TIQPacket packet = de->io.iq_queue.dequeue();
+		CPipelineStats::instance()->setQueueDepth(CPipelineStats::IQPacketQueue, de->io.iq_queue.count());
+		de->io.iqPacketReceived = packet.received;
 		processInputBuffer(packet.payload, packet.sourcePort);
 
 		if (de->io.iq_queue.isFull()) {
@@ -2912,7 +3061,7 @@ void DataProcessor::setOutputBuffer(int rx, const CPX &buffer) {
 }
 
 // full_txBuffer() fires for both P1 and P2 when the output_buffer is full (every 63 samples).
-// For P2, writeData() now sends a proper 1444-byte DUC IQ packet to port 1029.
+// For P2, TX IQ does not go out from here: writeDucData() sends full 240-sample DUC packets.
 // sendAudio() handles RX audio → sound card (same for both protocols).
 void DataProcessor::full_txBuffer(){
 
@@ -2964,6 +3113,7 @@ void DataProcessor::send_hpsdr_data(int rx, const CPX &buffer, int buffersize) {
     // Only send audio for the currently selected receiver.
     if (rx != de->io.currentReceiver) return;
     rx_audio_ptr = 0;
+    const bool protocol2 = (set->getCurrentMetisCard().protocol == 2);
 /* buffer rx audio */
     for (int j = 0; j < buffersize; j++)
         {
@@ -2984,6 +3134,10 @@ void DataProcessor::send_hpsdr_data(int rx, const CPX &buffer, int buffersize) {
 
     }
     rx_audio_ptr=0;
+
+    // the RX audio runs off the radio clock at 48 kHz and paces the DUC packets
+    if (protocol2)
+        writeDucData(de->io.ccTx.mox || de->io.ccTx.ptt, buffersize);
 }
 
 
@@ -3179,6 +3333,9 @@ void DataProcessor::get_tx_iqData(){
 
 		Spectrum0(1, TX_ID, 0, 0, (double *) m_iq_output_buffer.data());
 
+        // Protocol 2 takes the IQ at full resolution
+        if (set->getCurrentMetisCard().protocol == 2)
+            m_ducPacketizer.write(m_iq_output_buffer.constData(), DSP_SAMPLE_SIZE);
 
 /* Queue the tx data */
         int idx = 0;
@@ -3488,39 +3645,60 @@ void DataProcessor::encodeCCBytes() {
 }
 
 
+// the TX stream goes out from DataIO's bound socket, once it has one
+int DataProcessor::txSocketDescriptor() const {
+
+	DataIO *dataIO = de->m_dataIO;
+	return dataIO ? dataIO->txSocketDescriptor() : -1;
+}
+
+// Protocol 2 TX IQ: once per block of 48 kHz RX audio samples, a 1444-byte DUC
+// packet to port 1029 for every 240 samples at 192 kHz the block covers. The
+// packetizer writes the samples straight into the sender's frames.
+void DataProcessor::writeDucData(bool transmitting, int samples) {
+
+    for (int packets = m_ducPacketizer.advance(samples); packets > 0; packets--) {
+
+        TTxFrame *frame = m_txSender.acquire();
+        m_ducPacketizer.fill(transmitting, frame->payload);
+
+        frame->headerSize = de->m_protocol->formatOutputHeader(frame->header, m_ducSequence);
+        frame->payloadSize = DUC_SAMPLES_PER_PACKET * DUC_SAMPLE_BYTES;
+
+        m_txSender.start(txSocketDescriptor(), m_deviceAddress, DUC_PORT, TX_P2_PERIOD_US);
+        m_txSender.commit(frame);
+    }
+}
+
 void DataProcessor::writeData() {
     if (!de->m_protocol) return;
 
-    // Protocol 2: formatOutputPacket returns the complete 1444-byte DUC IQ packet.
-    // Send it in a single call to port 1029; bypass the P1 two-call toggle.
-    if (de->set->getCurrentMetisCard().protocol == 2) {
-        QByteArray ducPkt = de->m_protocol->formatOutputPacket(de->io.audioDatagram, m_sendSequence);
-        if (de->sendSocket->writeDatagram(ducPkt, m_deviceAddress, 1029) < 0) {
-            DATA_PROCESSOR_DEBUG << "P2 TX: error sending DUC IQ:" << de->sendSocket->errorString();
-        }
-        m_oldSendSequence = m_sendSequence - 1; // keep tracking consistent
-        return;
-    }
+    // Protocol 2 sends TX IQ from writeDucData(), not per P1 output buffer.
+    if (de->set->getCurrentMetisCard().protocol == 2) return;
 
-	if (m_setNetworkDeviceHeader) {
-        m_outDatagram = de->m_protocol->formatOutputPacket(de->io.audioDatagram, m_sendSequence);
-        m_setNetworkDeviceHeader = false;
+	// two 512-byte USB frames per Metis datagram, copied once, straight
+	// into the frame the sender will put on the wire
+	if (!m_txFrame) {
+        m_txFrame = m_txSender.acquire();
+        memcpy(m_txFrame->payload, de->io.audioDatagram.constData(), IO_BUFFER_SIZE);
     }
 	else {
-		m_outDatagram += de->io.audioDatagram;
+        memcpy(m_txFrame->payload + IO_BUFFER_SIZE, de->io.audioDatagram.constData(), IO_BUFFER_SIZE);
 
-        quint16 dataPort = (de->set->getCurrentMetisCard().protocol == 2) ? 1029 : DEVICE_PORT;
+        m_txFrame->headerSize = de->m_protocol->formatOutputHeader(m_txFrame->header, m_sendSequence);
+        m_txFrame->payloadSize = 2 * IO_BUFFER_SIZE;
 
-		if (de->sendSocket->writeDatagram(m_outDatagram, m_deviceAddress, dataPort) < 0) {
-			DATA_PROCESSOR_DEBUG << "error sending data to device: " << de->sendSocket->errorString();
+        if (!m_txSender.start(txSocketDescriptor(), m_deviceAddress, DEVICE_PORT, TX_P1_PERIOD_US)) {
+			DATA_PROCESSOR_DEBUG << "cannot start the TX sender";
 		}
+        m_txSender.commit(m_txFrame);
+        m_txFrame = nullptr;
 
 		if (m_sendSequence != m_oldSendSequence + 1) {
 			DATA_PROCESSOR_DEBUG << "output sequence error: old = " << m_oldSendSequence << "; new =" << m_sendSequence;
 		}
 
 		m_oldSendSequence = m_sendSequence;
-		m_setNetworkDeviceHeader = true;
     }
 }
 
@@ -3690,12 +3868,15 @@ void DataProcessor::processReadData()
 	TIQPacket packet;
     while(!de->io.iq_queue.isEmpty()) {
 	  packet = de->io.iq_queue.dequeue();
+	  CPipelineStats::instance()->setQueueDepth(CPipelineStats::IQPacketQueue, de->io.iq_queue.count());
+	  de->io.iqPacketReceived = packet.received;
 	  const QByteArray &buf = packet.payload;
       if (de->io.protocol && de->io.protocol->getHeaderSize() == METIS_HEADER_SIZE) {
           // Protocol 1: each UDP packet carries two 512-byte frames.
-          // The payload (1024 bytes) must be split and processed separately.
-		  processInputBuffer(buf.left(512), 0);
-		  processInputBuffer(buf.mid(512, 512), 0);
+          // The payload (1024 bytes) must be split and processed separately;
+          // use raw views so the pooled datagram is not copied.
+		  processInputBuffer(QByteArray::fromRawData(buf.constData(), 512), 0);
+		  processInputBuffer(QByteArray::fromRawData(buf.constData() + 512, 512), 0);
       } else {
           // Protocol 2: each DDC port sends one continuous IQ stream per
           // packet.  Pass the entire payload as a single buffer.
@@ -54,12 +54,15 @@
 #include "cusdr_settings.h"
 #include "cusdr_dataIO.h"
 #include "cusdr_receiver.h"
+#include "cusdr_dspWorkerPool.h"
 #include "cusdr_audioReceiver.h"
 #include "cusdr_discoverer.h"
 #include "Util/qcircularbuffer.h"
 #include "QtWDSP/qtwdsp_dspEngine.h"
 #include "cusdr_WidebandProcessor.h"
 #include "cusdr_transmitter.h"
+#include "cusdr_ducPacketizer.h"
+#include "cusdr_txSender.h"
 #include "AudioEngine/cusdr_audio_input.h"
 #include "AudioEngine/cusdr_iambic.h"
 
@@ -110,6 +113,7 @@ public:
 
     Transmitter         TX;
     QList<Receiver*> 	RX;
+    DspWorkerPool       m_dspWorkerPool;
 
 	QUdpSocket*			sendSocket{};
     QUdpSocket*         m_controlSocket{};
@@ -132,6 +136,13 @@ public:
 
     QFile           *file{};
 
+	// Headless IQ replay (cusdr_iqReplay.h): receivers, decoder and DSP pool
+	// without a device. DataIO gets no thread or socket, the replay loop
+	// calls DataIO::replayDatagram() itself.
+	bool	startReplay(int protocol, int receivers);
+	void	stopReplay();
+	DataProcessor*	getDataProcessor() const	{ return m_dataProcessor; }
+
 public slots:
 
 	bool	initDataEngine();
@@ -168,6 +179,7 @@ public slots:
 	void	setDither(QObject *sender, int value);
 	void	setRandom(QObject *sender, int value);
 	void	setTimeStamp(QObject *sender, bool value);
+	void	setIQRecording(QObject *sender, bool value);
 	void	set10MhzSource(QObject *sender, int source);
 	void	set122_88MhzSource(QObject *sender, int source);
     void	setMicSource(int source);
@@ -452,7 +464,6 @@ private:
     int             mic_buffer_index;
     QByteArray      m_tx_iqdata;
 	QByteArray		m_IQDatagram;
-	QByteArray		m_outDatagram;
     QByteArray      temp_audioIn;
 	QString			m_message;
     float           tx_mic_data[DSP_SAMPLE_SIZE];
@@ -463,7 +474,6 @@ private:
     QElapsedTimer	m_ADCChangedTime;
 
 	bool			m_socketConnected;
-	bool			m_setNetworkDeviceHeader;
 	bool			m_chirpGateBit;
 	bool			m_chirpBit;
 	bool			m_chirpStart;
@@ -490,6 +500,15 @@ private:
 	quint32			m_sendSequence;
 	quint32			m_oldSendSequence;
 
+	// Protocol 2 TX IQ, sent on its own sequence to the DUC port
+	DucPacketizer	m_ducPacketizer;
+	quint32			m_ducSequence;
+
+	// TX datagrams are built in place in the sender's pool and paced out
+	// by its thread; m_txFrame is the P1 frame half filled by writeData()
+	TxSender		m_txSender;
+	TTxFrame*		m_txFrame;
+
 	volatile bool	m_stopped;
     QTimer*         m_controlTimer;
     void            get_tx_iqData();
@@ -500,6 +519,8 @@ private:
     void    add_tx_iq_sample(double i, double q);
 
     void full_txBuffer();
+    void writeDucData(bool transmitting, int samples);
+    int  txSocketDescriptor() const;
 
     void fetch_MicData();
 
@@ -65,6 +65,13 @@ DataIO::DataIO(THPSDRParameter *ioData)
 	, set(Settings::instance())
 	, io(ioData)
     , m_dataIOSocket(nullptr)
+	, m_rxData(nullptr)
+#ifdef DATAIO_USE_RECVMMSG
+	, m_useRecvmmsg(qgetenv("CUSDR_RECVMMSG") != "0")
+#endif
+	, m_recvSyscalls(0)
+	, m_recvDatagrams(0)
+	, m_txSocketDescriptor(-1)
 	, m_dataIOSocketOn(false)
 	, m_networkDeviceRunning(false)
 	, m_setNetworkDeviceHeader(true)
@@ -74,6 +81,7 @@ DataIO::DataIO(THPSDRParameter *ioData)
 	, m_oldSequenceWideBand(0xFFFFFFFF)
 	, m_wbBuffers(31)
 	, m_wbCount(0)
+	, m_wbBytes(0)
 	, m_socketBufferSize(set->getSocketBufferSize())
 	, m_sendEP4(false)
 	, m_manualBufferSize(set->getManualSocketBufferSize())
@@ -86,7 +94,6 @@ DataIO::DataIO(THPSDRParameter *ioData)
 	// Protocol 2: up to 1444 bytes (DDC IQ data packet)
 	m_datagram.resize(1444);
 	m_iqbuffer.resize(1024);
-	m_wbDatagram.resize(0);
 	m_twoFramesDatagram.resize(0);
 
 	m_sendSequence = 0L;
@@ -94,6 +101,11 @@ DataIO::DataIO(THPSDRParameter *ioData)
 
 	m_packetLossTime.start();
 
+#ifdef DATAIO_USE_RECVMMSG
+	if (!m_useRecvmmsg)
+		DATAIO_DEBUG << "recvmmsg disabled by CUSDR_RECVMMSG=0, using readDatagram()";
+#endif
+
 	  connect(set, &Settings::sampleRateChanged, 
             this, &DataIO::setSampleRate);
 
@@ -166,6 +178,7 @@ bool isLocalAddress(const QHostAddress& address) {
 
 DataIO::~DataIO() {
     stop();
+    m_txSocketDescriptor.store(-1, std::memory_order_release);
     for (auto socket : m_sockets) {
         if (socket) {
             socket->close();
@@ -195,6 +208,10 @@ void DataIO::initDataReceiverSocket() {
         ports = io->protocol->getRequiredPorts();
     }
 
+    // the TX sender keeps its own dup() of the old socket until the
+    // DataProcessor stops it
+    m_txSocketDescriptor.store(-1, std::memory_order_release);
+
     // Close and clear existing extra sockets
     for (auto socket : m_sockets) {
         if (socket) {
@@ -254,6 +271,9 @@ void DataIO::initDataReceiverSocket() {
         }
     }
 
+	if (m_dataIOSocket)
+		m_txSocketDescriptor.store((int) m_dataIOSocket->socketDescriptor(), std::memory_order_release);
+
 	m_dataIOSocketOn = true;
 }
 
@@ -262,6 +282,12 @@ void DataIO::readDeviceData() {
     QUdpSocket* socket = qobject_cast<QUdpSocket*>(sender());
     if (!socket || !io->protocol) return;
 
+#ifdef DATAIO_USE_RECVMMSG
+    if (m_useRecvmmsg) {
+        readDeviceDataBatched(socket, isProtocol2(io->protocol));
+        return;
+    }
+#endif
     if (isProtocol2(io->protocol)) {
         readDeviceDataP2(socket);
     } else {
@@ -269,134 +295,312 @@ void DataIO::readDeviceData() {
     }
 }
 
+qint64 DataIO::readDatagramIntoPool(QUdpSocket* socket, CPacketBuffer& packet, QHostAddress* senderAddress, quint16* senderPort) {
+    // Read straight into a pooled slot so the IQ payload can be handed to the
+    // decoder without a copy. If the pool is exhausted the datagram is still
+    // drained from the socket (into m_datagram) and the IQ part is dropped.
+    packet = io->iq_pool.acquire();
+    qint64 size;
+    if (packet.isNull()) {
+        if ((io->iq_pool.exhaustedCount() % 1000) == 1) {
+            DATAIO_DEBUG << "packet pool exhausted, count = " << io->iq_pool.exhaustedCount();
+        }
+        size = socket->readDatagram(m_datagram.data(), m_datagram.size(), senderAddress, senderPort);
+        m_rxData = m_datagram.constData();
+    }
+    else {
+        size = socket->readDatagram(packet.data(), packet.capacity(), senderAddress, senderPort);
+        packet.setSize(size > 0 ? (int)size : 0);
+        m_rxData = packet.constData();
+    }
+    countReceiveSyscall(size > 0 ? 1 : 0);
+    return size;
+}
+
+void DataIO::countReceiveSyscall(int datagrams) {
+    const quint64 calls = m_recvSyscalls.fetch_add(1, std::memory_order_relaxed) + 1;
+    const quint64 total = m_recvDatagrams.fetch_add(datagrams, std::memory_order_relaxed) + datagrams;
+
+    if ((calls % 20000) == 0) {
+        DATAIO_DEBUG << "receive: " << total << " datagrams in " << calls
+                     << " syscalls (" << getDatagramsPerSyscall() << " per syscall)";
+    }
+}
+
+double DataIO::getDatagramsPerSyscall() const {
+    const quint64 calls = m_recvSyscalls.load(std::memory_order_relaxed);
+    if (calls == 0) return 0.0;
+    return (double)m_recvDatagrams.load(std::memory_order_relaxed) / (double)calls;
+}
+
 void DataIO::readDeviceDataP1(QUdpSocket* socket) {
+    CPacketBuffer packet;
+    bool enqueued = false;
     while (socket->hasPendingDatagrams()) {
         QMutexLocker locker(&io->networkIOMutex);
         QHostAddress senderAddress;
         quint16 senderPort = 0;
-        qint64 size = socket->readDatagram(m_datagram.data(), m_datagram.size(), &senderAddress, &senderPort);
-        if (!io->protocol || !io->protocol->isPacketValid((const unsigned char*)m_datagram.data(), size)) continue;
-
-        int type = io->protocol->getPacketType((const unsigned char*)m_datagram.data());
-        if (type == kPacketTypeP1IqPrimary || type == kPacketTypeP1IqLoopback) { // IQ data (P1 EP6 or EP2 loopback)
-            m_sequence = io->protocol->getSequence((const unsigned char*)m_datagram.data());
-            if (m_sequence != m_oldSequence + 1) {
-                if (m_packetLossTime.elapsed() > 100) {
-                    set->setPacketLoss(2);
-                    m_packetLossTime.restart();
+        qint64 size = readDatagramIntoPool(socket, packet, &senderAddress, &senderPort);
+        enqueued |= processDatagramP1(packet, size);
+    }
+    if (enqueued) emit (readydata());
+}
+
+void DataIO::readDeviceDataP2(QUdpSocket* socket) {
+    CPacketBuffer packet;
+    bool enqueued = false;
+    while (socket->hasPendingDatagrams()) {
+        QMutexLocker locker(&io->networkIOMutex);
+        QHostAddress senderAddress;
+        quint16 senderPort = 0;
+        qint64 size = readDatagramIntoPool(socket, packet, &senderAddress, &senderPort);
+        enqueued |= processDatagramP2(socket, packet, size, senderAddress, senderPort);
+    }
+    if (enqueued) emit (readydata());
+}
+
+#ifdef DATAIO_USE_RECVMMSG
+void DataIO::readDeviceDataBatched(QUdpSocket* socket, bool protocol2) {
+    const int fd = (int)socket->socketDescriptor();
+    bool enqueued = false;
+    int slots = 0;
+    int received = 0;
+
+    do {
+        // one pool slot per message; a short batch means the pool is nearly
+        // exhausted, an empty one falls through to the per-datagram path.
+        for (slots = 0; slots < RECV_BATCH_SIZE; slots++) {
+            m_recvBatch[slots] = io->iq_pool.acquire();
+            if (m_recvBatch[slots].isNull()) break;
+
+            m_recvIov[slots].iov_base = m_recvBatch[slots].data();
+            m_recvIov[slots].iov_len = m_recvBatch[slots].capacity();
+            memset(&m_recvMsgs[slots], 0, sizeof(m_recvMsgs[slots]));
+            m_recvMsgs[slots].msg_hdr.msg_name = &m_recvAddr[slots];
+            m_recvMsgs[slots].msg_hdr.msg_namelen = sizeof(m_recvAddr[slots]);
+            m_recvMsgs[slots].msg_hdr.msg_iov = &m_recvIov[slots];
+            m_recvMsgs[slots].msg_hdr.msg_iovlen = 1;
+        }
+        if (slots == 0) break;
+
+        received = ::recvmmsg(fd, m_recvMsgs, slots, MSG_DONTWAIT, nullptr);
+        countReceiveSyscall(received > 0 ? received : 0);
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            // not supported here (ENOSYS, seccomp, ...): stay on readDatagram()
+            DATAIO_DEBUG << "recvmmsg failed (" << strerror(errno) << "), using readDatagram()";
+            m_useRecvmmsg = false;
+        }
+        if (received > 0) {
+            QMutexLocker locker(&io->networkIOMutex);
+            for (int i = 0; i < received; i++) {
+                const qint64 size = m_recvMsgs[i].msg_len;
+                m_recvBatch[i].setSize((int)size);
+                m_rxData = m_recvBatch[i].constData();
+
+                if (protocol2) {
+                    m_recvSenderAddress.setAddress(ntohl(m_recvAddr[i].sin_addr.s_addr));
+                    enqueued |= processDatagramP2(socket, m_recvBatch[i], size,
+                                                  m_recvSenderAddress, ntohs(m_recvAddr[i].sin_port));
+                } else {
+                    enqueued |= processDatagramP1(m_recvBatch[i], size);
                 }
             }
-            m_oldSequence = m_sequence;
+        }
 
-            if (!io->iq_queue.isFull()) {
-                const int hdrSize = io->protocol->getHeaderSize();
-                io->iq_queue.enqueue(TIQPacket(m_datagram.mid(hdrSize, size - hdrSize), 0));
-                emit (readydata());
-            }
+        for (int i = 0; i < slots; i++)
+            m_recvBatch[i].reset();
+
+    } while (received == slots);
+
+    if (enqueued) emit (readydata());
+
+    // Draining the descriptor behind QUdpSocket's back leaves its internal
+    // "pending datagram" flag set, after which Qt stops emitting readyRead.
+    // One regular readDatagram() clears the flag and re-enables the read
+    // notifier, so it cannot be skipped even when the socket is empty. It
+    // counts as a receive syscall; on an empty socket it fails with
+    // TemporaryError, anything else is a real socket error.
+    CPacketBuffer packet;
+    QHostAddress senderAddress;
+    quint16 senderPort = 0;
+    qint64 size = readDatagramIntoPool(socket, packet, &senderAddress, &senderPort);
+    if (size < 0 && socket->error() != QAbstractSocket::TemporaryError) {
+        DATAIO_DEBUG << "re-arm read failed: " << socket->errorString();
+    }
+    if (size > 0) {
+        bool tailEnqueued;
+        {
+            QMutexLocker locker(&io->networkIOMutex);
+            tailEnqueued = protocol2
+                ? processDatagramP2(socket, packet, size, senderAddress, senderPort)
+                : processDatagramP1(packet, size);
         }
-        else if (type == kPacketTypeWideband) {
-            processWidebandPacket(size);
+        if (tailEnqueued) emit (readydata());
+
+        if (protocol2) readDeviceDataP2(socket);
+        else readDeviceDataP1(socket);
+    }
+}
+#endif
+
+bool DataIO::replayDatagram(const char* data, int size, quint16 senderPort) {
+    // Same path as a datagram read from the socket, with the capture copied
+    // into a pool slot instead of recvmmsg() / readDatagram(). There is no
+    // socket, so the P2 DDC is taken from senderPort alone.
+    if (!io->protocol || size <= 0 || size > m_datagram.size()) return false;
+
+    CPacketBuffer packet = io->iq_pool.acquire();
+    if (packet.isNull() || packet.capacity() < size) {
+        packet.reset();
+        memcpy(m_datagram.data(), data, size);
+        m_rxData = m_datagram.constData();
+    }
+    else {
+        memcpy(packet.data(), data, size);
+        packet.setSize(size);
+        m_rxData = packet.constData();
+    }
+    countReceiveSyscall(1);
+
+    bool enqueued;
+    {
+        QMutexLocker locker(&io->networkIOMutex);
+        enqueued = isProtocol2(io->protocol)
+            ? processDatagramP2(nullptr, packet, size, QHostAddress(), senderPort)
+            : processDatagramP1(packet, size);
+    }
+    if (enqueued) emit (readydata());
+    return enqueued;
+}
+
+bool DataIO::processDatagramP1(CPacketBuffer& packet, qint64 size) {
+    const unsigned char* data = (const unsigned char*)m_rxData;
+    if (!io->protocol || !io->protocol->isPacketValid(data, size)) return false;
+
+    int type = io->protocol->getPacketType(data);
+    if (type == kPacketTypeP1IqPrimary || type == kPacketTypeP1IqLoopback) { // IQ data (P1 EP6 or EP2 loopback)
+        m_sequence = io->protocol->getSequence(data);
+        if (m_sequence != m_oldSequence + 1) {
+            if (m_packetLossTime.elapsed() > 100) {
+                set->setPacketLoss(2);
+                m_packetLossTime.restart();
+            }
         }
+        m_oldSequence = m_sequence;
+
+        const qint64 now = cusdrMonotonicUs();
+        io->iq_recorder.record(m_rxData, (int) size, 1024, now);
+
+        if (packet.isNull()) return false;
+
+        const int hdrSize = io->protocol->getHeaderSize();
+        return io->iq_queue.tryEnqueue(TIQPacket(std::move(packet), hdrSize, size - hdrSize, 0, now));
     }
+    else if (type == kPacketTypeWideband) {
+        processWidebandPacket(size);
+    }
+    return false;
 }
 
-void DataIO::readDeviceDataP2(QUdpSocket* socket) {
+bool DataIO::processDatagramP2(QUdpSocket* socket, CPacketBuffer& packet, qint64 size, const QHostAddress& senderAddress, quint16 senderPort) {
     static quint64 p2DatagramsSeen = 0;
     static quint64 p2IqPacketsSeen = 0;
     static quint64 p2HpPacketsSeen = 0;
     static quint64 p2WidePacketsSeen = 0;
 
-    while (socket->hasPendingDatagrams()) {
-        QMutexLocker locker(&io->networkIOMutex);
-        QHostAddress senderAddress;
-        quint16 senderPort = 0;
-        qint64 size = socket->readDatagram(m_datagram.data(), m_datagram.size(), &senderAddress, &senderPort);
-        ++p2DatagramsSeen;
+    const unsigned char* data = (const unsigned char*)m_rxData;
+    const quint16 localPort = socket ? socket->localPort() : 0;
+    ++p2DatagramsSeen;
 
-        if ((p2DatagramsSeen % 500) == 1) {
-            P2_NET_DEBUG << "P2 RX datagram: localPort=" << socket->localPort()
+    if ((p2DatagramsSeen % 500) == 1) {
+        P2_NET_DEBUG << "P2 RX datagram: localPort=" << localPort
+                     << " sender=" << senderAddress.toString()
+                     << " senderPort=" << senderPort
+                     << " size=" << size
+                     << " total=" << p2DatagramsSeen;
+    }
+
+    if (!io->protocol || !io->protocol->isPacketValid(data, size)) return false;
+
+    // Protocol 2 simulator may source wideband packets from an ephemeral
+    // UDP source port. Classify by packet size first, then by port.
+    if (size == 1040) { // Wideband ADC packet: 16-byte header + 1024 payload
+        ++p2WidePacketsSeen;
+        if ((p2WidePacketsSeen % 100) == 1) {
+            P2_NET_DEBUG << "P2 wideband: localPort=" << localPort
                          << " sender=" << senderAddress.toString()
                          << " senderPort=" << senderPort
-                         << " size=" << size
-                         << " total=" << p2DatagramsSeen;
+                         << " wideTotal=" << p2WidePacketsSeen;
         }
-
-        if (!io->protocol || !io->protocol->isPacketValid((const unsigned char*)m_datagram.data(), size)) continue;
-
-        // Protocol 2 simulator may source wideband packets from an ephemeral
-        // UDP source port. Classify by packet size first, then by port.
-        if (size == 1040) { // Wideband ADC packet: 16-byte header + 1024 payload
-            ++p2WidePacketsSeen;
-            if ((p2WidePacketsSeen % 100) == 1) {
-                P2_NET_DEBUG << "P2 wideband: localPort=" << socket->localPort()
-                             << " sender=" << senderAddress.toString()
-                             << " senderPort=" << senderPort
-                             << " wideTotal=" << p2WidePacketsSeen;
+        processWidebandPacket(size);
+    }
+    else if (size >= 1444) { // DDC IQ packet (typically 1444 bytes)
+        ++p2IqPacketsSeen;
+        m_sequence = io->protocol->getSequence(data);
+
+        if (m_sequence != m_oldSequence + 1) {
+            if (m_packetLossTime.elapsed() > 100) {
+                set->setPacketLoss(2);
+                m_packetLossTime.restart();
             }
-            processWidebandPacket(size);
         }
-        else if (size >= 1444) { // DDC IQ packet (typically 1444 bytes)
-            ++p2IqPacketsSeen;
-            m_sequence = io->protocol->getSequence((const unsigned char*)m_datagram.data());
-
-            if (m_sequence != m_oldSequence + 1) {
-                if (m_packetLossTime.elapsed() > 100) {
-                    set->setPacketLoss(2);
-                    m_packetLossTime.restart();
-                }
-            }
-            m_oldSequence = m_sequence;
+        m_oldSequence = m_sequence;
 
-            if (!io->iq_queue.isFull()) {
-                const int hdrSize = io->protocol->getHeaderSize();
-                quint16 effectiveSourcePort = senderPort;
-                if (effectiveSourcePort < 1035 || effectiveSourcePort >= (1035 + MAX_RECEIVERS)) {
-                    effectiveSourcePort = m_socketLogicalPorts.value(socket, socket->localPort());
-                }
-                io->iq_queue.enqueue(TIQPacket(m_datagram.mid(hdrSize, size - hdrSize), effectiveSourcePort));
-
-                if ((p2IqPacketsSeen % 500) == 1) {
-                    P2_NET_DEBUG << "P2 IQ enqueue: localPort=" << socket->localPort()
-                                 << " senderPort=" << senderPort
-                                 << " effectiveSourcePort=" << effectiveSourcePort
-                                 << " size=" << size
-                                 << " hdr=" << hdrSize
-                                 << " payload=" << (size - hdrSize)
-                                 << " queueCount=" << io->iq_queue.count()
-                                 << " iqTotal=" << p2IqPacketsSeen;
-                }
-                emit (readydata());
-            } else {
-                P2_NET_DEBUG << "P2 IQ queue FULL: localPort=" << socket->localPort()
+        quint16 effectiveSourcePort = senderPort;
+        if (socket && (effectiveSourcePort < 1035 || effectiveSourcePort >= (1035 + MAX_RECEIVERS))) {
+            effectiveSourcePort = m_socketLogicalPorts.value(socket, localPort);
+        }
+
+        const qint64 now = cusdrMonotonicUs();
+        io->iq_recorder.record(m_rxData, (int) size, effectiveSourcePort, now);
+
+        if (packet.isNull()) return false;
+
+        const int hdrSize = io->protocol->getHeaderSize();
+        if (io->iq_queue.tryEnqueue(TIQPacket(std::move(packet), hdrSize, size - hdrSize, effectiveSourcePort, now))) {
+
+            if ((p2IqPacketsSeen % 500) == 1) {
+                P2_NET_DEBUG << "P2 IQ enqueue: localPort=" << localPort
                              << " senderPort=" << senderPort
+                             << " effectiveSourcePort=" << effectiveSourcePort
                              << " size=" << size
+                             << " hdr=" << hdrSize
+                             << " payload=" << (size - hdrSize)
+                             << " queueCount=" << io->iq_queue.count()
                              << " iqTotal=" << p2IqPacketsSeen;
             }
+            return true;
+        } else {
+            P2_NET_DEBUG << "P2 IQ queue FULL: localPort=" << localPort
+                         << " senderPort=" << senderPort
+                         << " size=" << size
+                         << " iqTotal=" << p2IqPacketsSeen;
         }
-        else if (size == 60) { // High Priority Status (P2)
-            ++p2HpPacketsSeen;
-            if ((p2HpPacketsSeen % 100) == 1) {
-                P2_NET_DEBUG << "P2 HP status: localPort=" << socket->localPort()
-                             << " sender=" << senderAddress.toString()
-                             << " senderPort=" << senderPort
-                             << " hpTotal=" << p2HpPacketsSeen;
-            }
-            io->protocol->decodeCCBytes(m_datagram.left(size), io);
+    }
+    else if (size == 60) { // High Priority Status (P2)
+        ++p2HpPacketsSeen;
+        if ((p2HpPacketsSeen % 100) == 1) {
+            P2_NET_DEBUG << "P2 HP status: localPort=" << localPort
+                         << " sender=" << senderAddress.toString()
+                         << " senderPort=" << senderPort
+                         << " hpTotal=" << p2HpPacketsSeen;
         }
-        else {
-            if ((p2DatagramsSeen % 500) == 1) {
-                P2_NET_DEBUG << "P2 unclassified datagram: localPort=" << socket->localPort()
-                             << " sender=" << senderAddress.toString()
-                             << " senderPort=" << senderPort
-                             << " size=" << size;
-            }
+        io->protocol->decodeCCBytes(QByteArray::fromRawData(m_rxData, size), io);
+    }
+    else {
+        if ((p2DatagramsSeen % 500) == 1) {
+            P2_NET_DEBUG << "P2 unclassified datagram: localPort=" << localPort
+                         << " sender=" << senderAddress.toString()
+                         << " senderPort=" << senderPort
+                         << " size=" << size;
         }
     }
+    return false;
 }
 
 void DataIO::processWidebandPacket(qint64 size) {
     if (!io->protocol) return;
-    m_sequenceWideBand = io->protocol->getSequence((const unsigned char*)m_datagram.data());
+    m_sequenceWideBand = io->protocol->getSequence((const unsigned char*)m_rxData);
 
     if (m_sequenceWideBand != m_oldSequenceWideBand + 1) {
         DATAIO_DEBUG << "wideband readData missed " << m_sequenceWideBand - m_oldSequenceWideBand << " packages.";
@@ -410,16 +614,23 @@ void DataIO::processWidebandPacket(qint64 size) {
     if ((m_wbBuffers & (m_sequenceWideBand & 0xFF)) == 0) {
         m_sendEP4 = true;
         m_wbCount = 0;
-        m_wbDatagram.resize(0);
+        m_wbBytes = 0;
     }
 
     if (m_sendEP4) {
+        // the payloads land straight in the frame the wideband processor reads
         const int hdrSize = io->protocol->getHeaderSize();
-        m_wbDatagram.append(m_datagram.mid(hdrSize, size - hdrSize));
+        const int payload = (int)size - hdrSize;
+        if (m_wbBytes + payload > io->wb_frames.capacity()) {
+            m_sendEP4 = false;
+            return;
+        }
+
+        memcpy(io->wb_frames.fillBuffer() + m_wbBytes, m_rxData + hdrSize, payload);
+        m_wbBytes += payload;
         if (m_wbCount++ == m_wbBuffers) {
             m_sendEP4 = false;
-            io->wb_queue.enqueue(m_wbDatagram);
-            m_wbDatagram.resize(0);
+            io->wb_frames.publish(m_wbBytes);
         }
     }
 }
@@ -39,6 +39,23 @@
 #include "cusdr_settings.h"
 #include "soundout.h"
 
+#include <atomic>
+
+// recvmmsg() is available: the receive sockets are drained in batches
+// instead of one readDatagram() per packet. Set CUSDR_RECVMMSG=0 in the
+// environment to use the plain QUdpSocket path at runtime.
+#if defined(Q_OS_LINUX)
+#define DATAIO_USE_RECVMMSG
+#endif
+
+#ifdef DATAIO_USE_RECVMMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <cerrno>
+#include <cstring>
+#define RECV_BATCH_SIZE		32
+#endif
+
 #ifdef LOG_DATAIO
 #   define DATAIO_DEBUG qDebug().nospace() << "DataIO::\t"
 #else
@@ -55,6 +72,18 @@ public:
     void set_wbBuffers(int val);
 	~DataIO();
 
+	// average number of datagrams returned per receive syscall
+	double	getDatagramsPerSyscall() const;
+
+	// descriptor of the bound socket commands go out on, for the TX sender
+	// to send from as well; -1 while there is none. Any thread.
+	int		txSocketDescriptor() const	{ return m_txSocketDescriptor.load(std::memory_order_acquire); }
+
+	// Runs one captured datagram through the receive path as if it had been
+	// read from the socket (IQ replay). Returns true if IQ data was queued for
+	// the decoder.
+	bool	replayDatagram(const char* data, int size, quint16 senderPort);
+
 public slots:
 	void	stop();
 	void	initDataReceiverSocket();
@@ -76,7 +105,14 @@ private slots:
 private:
 	void readDeviceDataP1(QUdpSocket* socket);
 	void readDeviceDataP2(QUdpSocket* socket);
+#ifdef DATAIO_USE_RECVMMSG
+	void readDeviceDataBatched(QUdpSocket* socket, bool protocol2);
+#endif
+	bool processDatagramP1(CPacketBuffer& packet, qint64 size);
+	bool processDatagramP2(QUdpSocket* socket, CPacketBuffer& packet, qint64 size, const QHostAddress& senderAddress, quint16 senderPort);
 	void processWidebandPacket(qint64 size);
+	qint64 readDatagramIntoPool(QUdpSocket* socket, CPacketBuffer& packet, QHostAddress* senderAddress, quint16* senderPort);
+	void countReceiveSyscall(int datagrams);
 
 	Settings*		set;
 	QUdpSocket*	    m_dataIOSocket;
@@ -85,11 +121,23 @@ private:
 	//QMutex			m_mutex;
 	QByteArray		m_commandDatagram;
 	QByteArray		m_datagram;
-	QByteArray		m_wbDatagram;
+	const char*		m_rxData;		// current datagram: pool slot or m_datagram
 	QByteArray		m_twoFramesDatagram;
 	QByteArray		m_outDatagram;
 	QString			m_message;
 	unsigned char 	m_buffer[1500];
+
+#ifdef DATAIO_USE_RECVMMSG
+	bool				m_useRecvmmsg;
+	struct mmsghdr		m_recvMsgs[RECV_BATCH_SIZE];
+	struct iovec		m_recvIov[RECV_BATCH_SIZE];
+	struct sockaddr_in	m_recvAddr[RECV_BATCH_SIZE];
+	CPacketBuffer		m_recvBatch[RECV_BATCH_SIZE];
+	QHostAddress		m_recvSenderAddress;
+#endif
+	std::atomic<quint64>	m_recvSyscalls;
+	std::atomic<quint64>	m_recvDatagrams;
+	std::atomic<int>		m_txSocketDescriptor;
 	QByteArray  	m_iqbuffer;
 
     QElapsedTimer	m_packetLossTime;
@@ -111,6 +159,7 @@ private:
     std::unique_ptr<CSoundOut> m_pSoundCardOut;
 	int		m_wbBuffers;
 	int		m_wbCount;
+	int		m_wbBytes;		// of io->wb_frames.fillBuffer()
 	int		m_socketBufferSize;
 
 	bool	m_sendEP4;
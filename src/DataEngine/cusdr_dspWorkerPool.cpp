@@ -0,0 +1,218 @@
+/**
+* @file  cusdr_dspWorkerPool.cpp
+* @brief receiver DSP worker thread pool for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_dspWorkerPool.h"
+
+#if defined(DSP_WORKERS_PIN_TO_CORES) && defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// A worker hands a busy receiver back to the run queue after this many
+// blocks, so one receiver cannot hold a worker while others are waiting.
+#define DSP_WORKER_BATCH	8
+
+DspWorkerPool::DspWorkerPool()
+	: m_queued(0)
+	, m_stopping(false)
+{
+}
+
+DspWorkerPool::~DspWorkerPool() {
+
+	stop();
+}
+
+// Must only be called while the protocol decoder is stopped.
+void DspWorkerPool::start(const QList<Receiver *> &receivers, int threads) {
+
+	stop();
+	if (receivers.isEmpty()) return;
+
+	if (threads <= 0)
+		threads = QThread::idealThreadCount();
+	threads = qBound(1, threads, (int) receivers.count());
+
+	for (int i = 0; i < threads; i++)
+		m_runQueues.push_back(std::make_unique<TRunQueue>());
+
+	for (int i = 0; i < receivers.count(); i++) {
+
+		auto slot = std::make_unique<TReceiverSlot>();
+		slot->rx = receivers.at(i);
+		slot->home = i % threads;
+		m_receivers.push_back(std::move(slot));
+	}
+
+	for (int i = 0; i < threads; i++) {
+
+		m_workers.push_back(std::make_unique<Worker>(this, i));
+		m_workers.back()->setObjectName(QString("DSP worker %1").arg(i));
+		m_workers.back()->start(QThread::NormalPriority);
+	}
+
+	DSP_POOL_DEBUG << "started " << threads << " DSP worker(s) for " << receivers.count() << " receiver(s)";
+
+	// pick up blocks that were queued before the pool was running
+	for (int i = 0; i < (int) m_receivers.size(); i++)
+		if (m_receivers[i]->rx->hasIQBlocks()) notify(i);
+}
+
+// Must only be called while the protocol decoder is stopped.
+void DspWorkerPool::stop() {
+
+	if (m_workers.empty()) return;
+
+	m_stopping.store(true);
+	{
+		QMutexLocker locker(&m_waitMutex);
+		m_waitCondition.wakeAll();
+	}
+	for (auto &worker : m_workers)
+		worker->wait();
+
+	m_workers.clear();
+	m_runQueues.clear();
+	m_receivers.clear();
+	m_queued.store(0);
+	m_stopping.store(false);
+
+	DSP_POOL_DEBUG << "DSP workers stopped";
+}
+
+void DspWorkerPool::notify(int rx) {
+
+	if (rx < 0 || rx >= (int) m_receivers.size()) return;
+	TReceiverSlot &slot = *m_receivers[rx];
+
+	// pairs with the fence in runReceiver(): either the worker sees the block
+	// that has just been published, or we see the receiver unscheduled.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (slot.scheduled.exchange(true)) return;
+
+	// count first, so m_queued never drops below the number of queued entries
+	m_queued.fetch_add(1);
+	{
+		TRunQueue &queue = *m_runQueues[slot.home];
+		QMutexLocker locker(&queue.mutex);
+		queue.ready.push_back(rx);
+	}
+
+	QMutexLocker locker(&m_waitMutex);
+	m_waitCondition.wakeOne();
+}
+
+qint64 DspWorkerPool::cpuTimeUs() const {
+
+	qint64 total = 0;
+	for (const auto &worker : m_workers)
+		total += worker->cpuTimeUs();
+	return total;
+}
+
+bool DspWorkerPool::takeWork(int worker, int &rx) {
+
+	const int queues = (int) m_runQueues.size();
+	for (int i = 0; i < queues; i++) {
+
+		TRunQueue &queue = *m_runQueues[(worker + i) % queues];
+		QMutexLocker locker(&queue.mutex);
+		if (queue.ready.empty()) continue;
+
+		// own queue in FIFO order, steal the most recently queued receiver
+		// from the far end of the others
+		if (i == 0) {
+			rx = queue.ready.front();
+			queue.ready.pop_front();
+		}
+		else {
+			rx = queue.ready.back();
+			queue.ready.pop_back();
+		}
+		m_queued.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+
+void DspWorkerPool::runReceiver(int rx) {
+
+	TReceiverSlot &slot = *m_receivers[rx];
+
+	for (;;) {
+
+		int blocks = 0;
+		while (blocks < DSP_WORKER_BATCH && slot.rx->dspProcessing())
+			blocks++;
+
+		if (blocks == DSP_WORKER_BATCH) {
+
+			// still busy: requeue it behind the others, it stays scheduled
+			m_queued.fetch_add(1);
+			TRunQueue &queue = *m_runQueues[slot.home];
+			QMutexLocker locker(&queue.mutex);
+			queue.ready.push_back(rx);
+			return;
+		}
+
+		slot.scheduled.store(false);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!slot.rx->hasIQBlocks()) return;
+
+		// A block was published after the ring looked empty. Carry on with it
+		// unless notify() has already queued the receiver again.
+		if (slot.scheduled.exchange(true)) return;
+	}
+}
+
+void DspWorkerPool::workerLoop(int worker) {
+
+	while (!m_stopping.load()) {
+
+		int rx;
+		if (takeWork(worker, rx)) {
+
+			runReceiver(rx);
+			continue;
+		}
+
+		QMutexLocker locker(&m_waitMutex);
+		while (m_queued.load() == 0 && !m_stopping.load())
+			m_waitCondition.wait(&m_waitMutex);
+	}
+}
+
+void DspWorkerPool::Worker::run() {
+
+	m_cpuClock.attach();
+
+#if defined(DSP_WORKERS_PIN_TO_CORES) && defined(Q_OS_LINUX)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(m_index % QThread::idealThreadCount(), &cpus);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+		DSP_POOL_DEBUG << "could not pin DSP worker " << m_index;
+#endif
+
+	m_pool->workerLoop(m_index);
+}
@@ -0,0 +1,119 @@
+/**
+* @file  cusdr_dspWorkerPool.h
+* @brief receiver DSP worker thread pool for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_DSP_WORKER_POOL_H
+#define CUSDR_DSP_WORKER_POOL_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "cusdr_receiver.h"
+
+// Uncomment to pin each DSP worker to its own core (Linux only).
+//#define DSP_WORKERS_PIN_TO_CORES
+
+#ifdef LOG_DSP_POOL
+#   define DSP_POOL_DEBUG qDebug().nospace() << "DspWorkerPool::\t"
+#else
+#   define DSP_POOL_DEBUG nullDebug()
+#endif
+
+// Fixed set of threads that run Receiver::dspProcessing() for all receivers.
+//
+// The protocol decoder publishes a block into the receiver's IQ ring and
+// calls notify(rx). A receiver is queued on at most one worker at a time, so
+// its ring keeps a single consumer. Each receiver has a home worker; an idle
+// worker steals queued receivers from the others, so a receiver that falls
+// behind does not wait for its home worker while another core is idle.
+
+class DspWorkerPool {
+
+public:
+	DspWorkerPool();
+	~DspWorkerPool();
+
+	DspWorkerPool(const DspWorkerPool &) = delete;
+	DspWorkerPool &operator=(const DspWorkerPool &) = delete;
+
+	// threads = 0 uses one worker per core, but never more than receivers.
+	void	start(const QList<Receiver *> &receivers, int threads = 0);
+	void	stop();
+	bool	isRunning() const	{ return !m_workers.empty(); }
+
+	// called by the decoder thread after publishing a block for receiver rx
+	void	notify(int rx);
+
+	// CPU time used by all workers since start(), in us (Linux only)
+	qint64	cpuTimeUs() const;
+
+private:
+	class Worker : public QThread {
+
+	public:
+		Worker(DspWorkerPool *pool, int index) : m_pool(pool), m_index(index) {}
+
+		qint64	cpuTimeUs() const	{ return m_cpuClock.cpuUs(); }
+
+	protected:
+		void run() override;
+
+	private:
+		DspWorkerPool*	m_pool;
+		int				m_index;
+		CThreadCpuClock	m_cpuClock;
+	};
+
+	struct alignas(CUSDR_CACHE_LINE_SIZE) TRunQueue {
+
+		QMutex			mutex;
+		std::deque<int>	ready;
+	};
+
+	struct alignas(CUSDR_CACHE_LINE_SIZE) TReceiverSlot {
+
+		Receiver*			rx = nullptr;
+		int					home = 0;
+		std::atomic<bool>	scheduled{false};
+	};
+
+	bool	takeWork(int worker, int &rx);
+	void	runReceiver(int rx);
+	void	workerLoop(int worker);
+
+	std::vector<std::unique_ptr<TReceiverSlot>>	m_receivers;
+	std::vector<std::unique_ptr<TRunQueue>>		m_runQueues;
+	std::vector<std::unique_ptr<Worker>>		m_workers;
+
+	QMutex				m_waitMutex;
+	QWaitCondition		m_waitCondition;
+	std::atomic<int>	m_queued;
+	std::atomic<bool>	m_stopping;
+};
+
+#endif // CUSDR_DSP_WORKER_POOL_H
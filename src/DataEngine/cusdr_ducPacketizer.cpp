@@ -0,0 +1,172 @@
+/**
+* @file  cusdr_ducPacketizer.cpp
+* @brief Protocol 2 DUC (TX IQ) packetizer for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+//#define LOG_DUC_PACKETIZER
+
+// use: DUC_PACKETIZER_DEBUG
+
+#include "cusdr_ducPacketizer.h"
+#include "Util/cusdr_iqUnpack.h"
+
+#include <cstring>
+
+DucPacketizer::DucPacketizer()
+	: m_ringHead(0)
+	, m_ringCount(0)
+	, m_clock(0)
+	, m_primed(false)
+	, m_stats(CPipelineStats::instance())
+{
+	m_upsampler.Init(DSP_SAMPLE_SIZE, DUC_INPUT_RATE, DUC_SAMPLE_RATE);
+
+	// the resampler may produce one sample more than the ratio says
+	m_upsampled.resize(DSP_SAMPLE_SIZE * DUC_INTERPOLATION + DUC_INTERPOLATION);
+	m_ring.resize(DUC_RING_SAMPLES * DUC_SAMPLE_BYTES);
+}
+
+void DucPacketizer::reset() {
+
+	m_ringHead = 0;
+	m_ringCount = 0;
+	m_clock = 0;
+	m_primed = false;
+	m_stats->setQueueDepth(CPipelineStats::DucRing, 0);
+}
+
+void DucPacketizer::write(const cpx *iq, int count) {
+
+	const double rate = (double) DUC_INPUT_RATE / DUC_SAMPLE_RATE;
+
+	while (count > 0) {
+
+		const int block = qMin(count, (int) DSP_SAMPLE_SIZE);
+
+		// exactly 1:4, so every sample is one pass over a fixed phase
+		const int n = m_upsampler.Resample(
+							block,
+							rate,
+							reinterpret_cast<const TYPECPX *>(iq),
+							reinterpret_cast<TYPECPX *>(m_upsampled.data()));
+
+		push(m_upsampled.constData(), n);
+
+		iq += block;
+		count -= block;
+	}
+}
+
+int DucPacketizer::advance(int samples) {
+
+	m_clock += samples * DUC_INTERPOLATION;
+
+	const int packets = m_clock / DUC_SAMPLES_PER_PACKET;
+	m_clock -= packets * DUC_SAMPLES_PER_PACKET;
+
+	return packets;
+}
+
+void DucPacketizer::fill(bool transmitting, uchar *payload) {
+
+	const int bytes = DUC_SAMPLES_PER_PACKET * DUC_SAMPLE_BYTES;
+
+	if (!transmitting) {
+
+		m_ringHead = 0;
+		m_ringCount = 0;
+		m_primed = false;
+	}
+	else if (!m_primed && m_ringCount >= DUC_PREFILL_SAMPLES) {
+
+		m_primed = true;
+	}
+
+	if (!m_primed) {
+
+		memset(payload, 0, bytes);
+	}
+	else if (m_ringCount >= DUC_SAMPLES_PER_PACKET) {
+
+		pop(payload, DUC_SAMPLES_PER_PACKET);
+	}
+	else {
+
+		// send what there is, pad the rest with silence and refill
+		const int available = m_ringCount;
+		pop(payload, available);
+		memset(payload + available * DUC_SAMPLE_BYTES, 0, bytes - available * DUC_SAMPLE_BYTES);
+
+		m_primed = false;
+		m_stats->add(CPipelineStats::DucUnderruns);
+		DUC_PACKETIZER_DEBUG << "TX IQ underrun at packet " << m_stats->counter(CPipelineStats::DucPackets);
+	}
+
+	m_stats->add(CPipelineStats::DucPackets);
+	m_stats->setQueueDepth(CPipelineStats::DucRing, m_ringCount);
+}
+
+int DucPacketizer::formatHeader(uchar *header, quint32 &sequence) {
+
+	qToBigEndian(sequence, header);
+	sequence++;
+
+	return DUC_HEADER_SIZE;
+}
+
+void DucPacketizer::push(const cpx *iq, int count) {
+
+	if (count > DUC_RING_SAMPLES) {
+
+		iq += count - DUC_RING_SAMPLES;
+		count = DUC_RING_SAMPLES;
+	}
+
+	// keep the latency bounded: drop the oldest samples
+	const int overflow = m_ringCount + count - DUC_RING_SAMPLES;
+	if (overflow > 0) {
+
+		m_ringHead = (m_ringHead + overflow) % DUC_RING_SAMPLES;
+		m_ringCount -= overflow;
+
+		m_stats->add(CPipelineStats::DucOverruns);
+		DUC_PACKETIZER_DEBUG << "TX IQ overrun, dropped " << overflow << " samples";
+	}
+
+	const int tail = (m_ringHead + m_ringCount) % DUC_RING_SAMPLES;
+	const int first = qMin(count, DUC_RING_SAMPLES - tail);
+
+	packIQ24(iq, first, m_ring.data() + tail * DUC_SAMPLE_BYTES);
+	packIQ24(iq + first, count - first, m_ring.data());
+
+	m_ringCount += count;
+}
+
+void DucPacketizer::pop(uchar *dst, int count) {
+
+	const int first = qMin(count, DUC_RING_SAMPLES - m_ringHead);
+
+	memcpy(dst, m_ring.constData() + m_ringHead * DUC_SAMPLE_BYTES, first * DUC_SAMPLE_BYTES);
+	memcpy(dst + first * DUC_SAMPLE_BYTES, m_ring.constData(), (count - first) * DUC_SAMPLE_BYTES);
+
+	m_ringHead = (m_ringHead + count) % DUC_RING_SAMPLES;
+	m_ringCount -= count;
+}
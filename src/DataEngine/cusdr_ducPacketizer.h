@@ -0,0 +1,118 @@
+/**
+* @file  cusdr_ducPacketizer.h
+* @brief Protocol 2 DUC (TX IQ) packetizer for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_DUC_PACKETIZER_H
+#define CUSDR_DUC_PACKETIZER_H
+
+#include <QVector>
+#include <QtEndian>
+
+#include "cusdr_settings.h"
+#include "polyphaseresampler.h"
+#include "Util/cusdr_pipelineStats.h"
+#include "QtDSP/qtdsp_qComplex.h"
+
+#ifdef LOG_DUC_PACKETIZER
+#   define DUC_PACKETIZER_DEBUG qDebug().nospace() << "DucPacketizer::\t"
+#else
+#   define DUC_PACKETIZER_DEBUG nullDebug()
+#endif
+
+// Protocol 2 DUC IQ packet (PC -> SDR, port 1029), spec v4.3:
+//   Bytes 0-3   : sequence number (big-endian)
+//   Bytes 4-1443: 240 I/Q pairs, 24-bit signed big-endian (I2 I1 I0 Q2 Q1 Q0)
+#define DUC_PORT				1029
+#define DUC_HEADER_SIZE			4
+#define DUC_SAMPLE_BYTES		6
+#define DUC_SAMPLES_PER_PACKET	240
+#define DUC_PACKET_SIZE			(DUC_HEADER_SIZE + DUC_SAMPLES_PER_PACKET * DUC_SAMPLE_BYTES)
+
+// the DUC runs at 192 kHz, the TX DSP output and the clock we pace by at 48 kHz
+#define DUC_SAMPLE_RATE			192000
+#define DUC_INPUT_RATE			48000
+#define DUC_INTERPOLATION		(DUC_SAMPLE_RATE / DUC_INPUT_RATE)
+
+// 16 DSP blocks at 192 kHz, ~85 ms
+#define DUC_RING_SAMPLES		(16 * DSP_SAMPLE_SIZE)
+
+// TX IQ arrives a DSP block at a time while packets leave evenly, so the
+// ring has to hold a block and a packet before sending starts
+#define DUC_PREFILL_SAMPLES		(DSP_SAMPLE_SIZE * DUC_INTERPOLATION + DUC_SAMPLES_PER_PACKET)
+
+// Turns the TX IQ of the transmitter into Protocol 2 DUC packets.
+//
+// write() takes the 48 kHz output of the TX channel, interpolates it to the
+// DUC rate and stores it at 24-bit resolution in a ring of its own.
+// advance() is told how many 48 kHz samples of the RX audio stream, which
+// runs off the radio's clock, went by; every 60 of them (240 samples at
+// 192 kHz) a packet is due and fill() writes its payload, so packets are made
+// at the 800 per second the DUC consumes, no matter how the TX blocks arrive.
+// formatHeader() writes the header; the sending is left to the caller.
+//
+// Sending starts once the ring holds DUC_PREFILL_SAMPLES. When it cannot
+// fill a packet after that, the packet is padded with silence, counted as an
+// underrun and the ring fills up again before sending resumes; when write()
+// finds the ring full, the oldest samples are dropped and counted as an
+// overrun. While receiving, packets carry silence and the ring is kept empty.
+// Packets, underruns, overruns and the ring depth go to CPipelineStats.
+//
+// All calls come from the DataProcessor thread; there is no locking.
+
+class DucPacketizer {
+
+public:
+	DucPacketizer();
+
+	void	reset();
+
+	void	write(const cpx *iq, int count);
+
+	// moves the packet clock on by 'samples' 48 kHz samples and returns the
+	// number of packets that became due
+	int		advance(int samples);
+
+	// writes the DUC_SAMPLES_PER_PACKET samples of the next due packet
+	void	fill(bool transmitting, uchar *payload);
+
+	// writes the big-endian sequence number and moves it on; returns the
+	// header size
+	static int	formatHeader(uchar *header, quint32 &sequence);
+
+private:
+	void	push(const cpx *iq, int count);
+	void	pop(uchar *dst, int count);
+
+	CPolyphaseResampler	m_upsampler;
+	QVector<cpx>	m_upsampled;
+
+	QVector<uchar>	m_ring;
+	int				m_ringHead;
+	int				m_ringCount;
+
+	int				m_clock;
+	bool			m_primed;
+
+	CPipelineStats	*m_stats;
+};
+
+#endif // CUSDR_DUC_PACKETIZER_H
@@ -0,0 +1,570 @@
+/**
+* @file  cusdr_iqReplay.cpp
+* @brief headless replay of captured radio traffic through the receive pipeline
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_iqReplay.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QtEndian>
+
+namespace {
+
+// In the fast mode the feeder holds back while more than this many datagrams
+// wait for the decoder, or a receiver's IQ ring has less than this many free
+// blocks, so nothing is dropped for want of room.
+constexpr int REPLAY_MAX_QUEUED_DATAGRAMS = 16;
+constexpr int REPLAY_RING_HEADROOM = 8;
+
+constexpr quint16 P1_DEVICE_PORT = 1024;
+constexpr quint16 P2_DDC_PORT = 1035;
+constexpr int P2_DDC_PACKET_SIZE = 1444;
+
+inline quint16 be16(const uchar *p) { return qFromBigEndian<quint16>(p); }
+
+inline quint16 rd16(const uchar *p, bool bigEndian) {
+	return bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+inline quint32 rd32(const uchar *p, bool bigEndian) {
+	return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
+
+}
+
+IQReplay::IQReplay(const TIQReplayConfig &config)
+	: m_config(config)
+	, m_de(nullptr)
+	, m_ddcPorts(0)
+	, m_protocol(0)
+	, m_elapsedUs(0)
+	, m_feedCpuUs(0)
+	, m_decodeCpuUs(0)
+	, m_dspCpuUs(0)
+	, m_blocks(0)
+	, m_lateBlocks(0)
+	, m_droppedBlocks(0)
+	, m_droppedDatagrams(0)
+	, m_fedDatagrams(0)
+	, m_receivers(0)
+{
+}
+
+IQReplay::~IQReplay() {
+
+	delete m_de;
+}
+
+bool IQReplay::load(QString *error) {
+
+	QFile file(m_config.fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+
+		*error = QString("cannot open %1: %2").arg(m_config.fileName, file.errorString());
+		return false;
+	}
+
+	bool ok;
+	if (file.peek(8) == QByteArray(IQREC_MAGIC, 8)) {
+
+		file.close();
+		ok = loadRecording(error);
+	}
+	else {
+
+		const QByteArray capture = file.readAll();
+		if (capture.size() < 4) {
+
+			*error = QString("%1 is not a capture file").arg(m_config.fileName);
+			return false;
+		}
+
+		m_data.reserve(capture.size());
+		ok = (qFromLittleEndian<quint32>(capture.constData()) == 0x0A0D0D0A)
+			? loadPcapNg(capture, error)
+			: loadPcap(capture, error);
+	}
+	if (!ok) return false;
+
+	if (m_datagrams.isEmpty()) {
+
+		*error = QString("no Protocol 1 or Protocol 2 IQ datagrams in %1").arg(m_config.fileName);
+		return false;
+	}
+
+	IQ_REPLAY_DEBUG << "loaded " << m_datagrams.count() << " Protocol " << m_protocol
+					<< " IQ datagrams from " << qPrintable(m_config.fileName);
+	return true;
+}
+
+bool IQReplay::loadPcap(const QByteArray &capture, QString *error) {
+
+	const uchar *p = (const uchar *) capture.constData();
+	const qint64 size = capture.size();
+
+	bool bigEndian;
+	bool nanoseconds;
+	switch (qFromLittleEndian<quint32>(p)) {
+
+		case 0xA1B2C3D4: bigEndian = false; nanoseconds = false; break;
+		case 0xA1B23C4D: bigEndian = false; nanoseconds = true;  break;
+		case 0xD4C3B2A1: bigEndian = true;  nanoseconds = false; break;
+		case 0x4D3CB2A1: bigEndian = true;  nanoseconds = true;  break;
+
+		default:
+			*error = QString("%1 is neither a pcap nor a pcapng file").arg(m_config.fileName);
+			return false;
+	}
+	if (size < 24) {
+
+		*error = QString("%1: truncated pcap header").arg(m_config.fileName);
+		return false;
+	}
+
+	const int linkType = rd32(p + 20, bigEndian) & 0xFFFF;
+
+	qint64 pos = 24;
+	while (pos + 16 <= size) {
+
+		const qint64 seconds = rd32(p + pos, bigEndian);
+		const qint64 fraction = rd32(p + pos + 4, bigEndian);
+		const qint64 length = rd32(p + pos + 8, bigEndian);
+		pos += 16;
+
+		if (length > size - pos) break;	// capture cut off mid-packet
+
+		addFrame(linkType, p + pos, (int) length, seconds * 1000000 + (nanoseconds ? fraction / 1000 : fraction));
+		pos += length;
+	}
+	return true;
+}
+
+// A recording made with the network widget's record button (cusdr_iqRecorder.h)
+// holds the datagrams as DataIO received them, including the P2 DDC port.
+bool IQReplay::loadRecording(QString *error) {
+
+	IQRecording recording;
+	if (!recording.open(m_config.fileName, error)) return false;
+
+	const TIQRecHeader &header = recording.header();
+	if (header.protocol != 1 && header.protocol != 2) {
+
+		*error = QString("%1: unknown protocol %2").arg(m_config.fileName).arg(header.protocol);
+		return false;
+	}
+
+	// the radio settings of the recording, unless given on the command line
+	if (m_config.sampleRate == 0)
+		m_config.sampleRate = (int) header.sampleRate;
+	if (m_config.receivers == 0 && header.protocol == 1)
+		m_config.receivers = (int) header.receivers;
+
+	for (IQRecording::Cursor c = recording.begin(); !c.atEnd(); c.next()) {
+
+		const TIQRecRecord &record = c.record();
+		addDatagram((int) header.protocol, (const uchar *) c.data(), record.size, record.port, record.time);
+	}
+	return true;
+}
+
+bool IQReplay::loadPcapNg(const QByteArray &capture, QString *error) {
+
+	const uchar *p = (const uchar *) capture.constData();
+	const qint64 size = capture.size();
+
+	bool bigEndian = false;
+	QVector<int> linkTypes;
+	QVector<double> ticksPerSecond;
+	qint64 lastTime = 0;
+
+	qint64 pos = 0;
+	while (pos + 12 <= size) {
+
+		const quint32 type = rd32(p + pos, bigEndian);
+		if (type == 0x0A0D0D0A) {
+
+			// section header: byte order, and the interface list starts over
+			const quint32 byteOrder = qFromLittleEndian<quint32>(p + pos + 8);
+			if (byteOrder == 0x1A2B3C4D)
+				bigEndian = false;
+			else if (byteOrder == 0x4D3C2B1A)
+				bigEndian = true;
+			else {
+
+				*error = QString("%1: bad pcapng section header").arg(m_config.fileName);
+				return false;
+			}
+			linkTypes.clear();
+			ticksPerSecond.clear();
+		}
+
+		const qint64 length = rd32(p + pos + 4, bigEndian);
+		if (length < 12 || length > size - pos) break;
+
+		const uchar *body = p + pos + 8;
+		const int bodyLength = (int) length - 12;
+
+		switch (type) {
+
+			case 1: {	// interface description
+				if (bodyLength < 8) break;
+
+				double tps = 1e6;
+				int opt = 8;
+				while (opt + 4 <= bodyLength) {
+
+					const int code = rd16(body + opt, bigEndian);
+					const int optLength = rd16(body + opt + 2, bigEndian);
+					if (code == 0 || opt + 4 + optLength > bodyLength) break;
+
+					if (code == 9 && optLength >= 1) {	// if_tsresol
+
+						const int v = body[opt + 4];
+						tps = 1.0;
+						for (int i = 0; i < (v & 0x7F); i++)
+							tps *= (v & 0x80) ? 2.0 : 10.0;
+					}
+					opt += 4 + ((optLength + 3) & ~3);
+				}
+				linkTypes.append(rd16(body, bigEndian));
+				ticksPerSecond.append(tps);
+				break;
+			}
+
+			case 6: {	// enhanced packet
+				if (bodyLength < 20) break;
+
+				const quint32 iface = rd32(body, bigEndian);
+				const quint64 ticks = ((quint64) rd32(body + 4, bigEndian) << 32) | rd32(body + 8, bigEndian);
+				const int captured = (int) rd32(body + 12, bigEndian);
+				if (iface >= (quint32) linkTypes.count() || captured > bodyLength - 20) break;
+
+				lastTime = (qint64) ((double) ticks * 1e6 / ticksPerSecond.at(iface));
+				addFrame(linkTypes.at(iface), body + 20, captured, lastTime);
+				break;
+			}
+
+			case 3: {	// simple packet: interface 0, no time stamp
+				if (bodyLength < 4 || linkTypes.isEmpty()) break;
+
+				const int captured = qMin((int) rd32(body, bigEndian), bodyLength - 4);
+				addFrame(linkTypes.at(0), body + 4, captured, lastTime);
+				break;
+			}
+
+			default:
+				break;
+		}
+		pos += length;
+	}
+	return true;
+}
+
+void IQReplay::addFrame(int linkType, const uchar *frame, int length, qint64 time) {
+
+	// find the IPv4 header
+	int ip;
+	switch (linkType) {
+
+		case 1: {	// Ethernet, optionally VLAN tagged
+			if (length < 14) return;
+
+			int offset = 12;
+			quint16 etherType = be16(frame + offset);
+			while ((etherType == 0x8100 || etherType == 0x88A8) && offset + 6 <= length) {
+
+				offset += 4;
+				etherType = be16(frame + offset);
+			}
+			if (etherType != 0x0800) return;
+			ip = offset + 2;
+			break;
+		}
+
+		case 113:	// Linux cooked capture
+			if (length < 16 || be16(frame + 14) != 0x0800) return;
+			ip = 16;
+			break;
+
+		case 276:	// Linux cooked capture v2
+			if (length < 20 || be16(frame) != 0x0800) return;
+			ip = 20;
+			break;
+
+		case 0:		// BSD loopback, address family in host byte order
+		case 108:	// OpenBSD loopback, network byte order
+			if (length < 4 || (qFromLittleEndian<quint32>(frame) != 2 && qFromBigEndian<quint32>(frame) != 2)) return;
+			ip = 4;
+			break;
+
+		case 12:
+		case 101:
+		case 228:	// raw IPv4
+			ip = 0;
+			break;
+
+		default:
+			return;
+	}
+
+	const uchar *ipHeader = frame + ip;
+	const int ipLength = length - ip;
+	if (ipLength < 20 || (ipHeader[0] >> 4) != 4 || ipHeader[9] != 17) return;
+	if ((be16(ipHeader + 6) & 0x3FFF) != 0) return;	// fragment
+
+	const int headerLength = (ipHeader[0] & 0x0F) * 4;
+	if (ipLength < headerLength + 8) return;
+
+	const uchar *udp = ipHeader + headerLength;
+	const quint16 sourcePort = be16(udp);
+	const uchar *payload = udp + 8;
+	const int payloadLength = qMin((int) be16(udp + 4) - 8, ipLength - headerLength - 8);
+	if (payloadLength <= 0) return;
+
+	// only the radio's receive IQ stream: Protocol 1 EP6 frames from port
+	// 1024, Protocol 2 DDC packets from ports 1035 and up
+	int protocol;
+	if (sourcePort == P1_DEVICE_PORT && payloadLength >= 8 &&
+		payload[0] == 0xEF && payload[1] == 0xFE && payload[2] == 0x01 && payload[3] == 0x06)
+	{
+		protocol = 1;
+	}
+	else if (sourcePort >= P2_DDC_PORT && sourcePort < P2_DDC_PORT + MAX_RECEIVERS &&
+			 payloadLength >= P2_DDC_PACKET_SIZE)
+	{
+		protocol = 2;
+	}
+	else
+		return;
+
+	addDatagram(protocol, payload, payloadLength, sourcePort, time);
+}
+
+void IQReplay::addDatagram(int protocol, const uchar *payload, int payloadLength, quint16 sourcePort, qint64 time) {
+
+	if (m_protocol == 0)
+		m_protocol = protocol;
+	else if (protocol != m_protocol)
+		return;
+
+	if (protocol == 2)
+		m_ddcPorts |= 1u << (sourcePort - P2_DDC_PORT);
+
+	TReplayDatagram datagram;
+	datagram.time = time;
+	datagram.offset = m_data.size();
+	datagram.size = payloadLength;
+	datagram.sourcePort = sourcePort;
+
+	m_data.append((const char *) payload, payloadLength);
+	m_datagrams.append(datagram);
+}
+
+bool IQReplay::run(QString *error) {
+
+	Settings *set = Settings::instance();
+	if (m_config.sampleRate > 0)
+		set->setSampleRate(nullptr, m_config.sampleRate);
+
+	m_receivers = m_config.receivers;
+	if (m_receivers <= 0) {
+
+		m_receivers = (m_protocol == 2)
+			? 32 - qCountLeadingZeroBits(m_ddcPorts)
+			: set->getNumberOfReceivers();
+	}
+	m_receivers = qBound(1, m_receivers, MAX_RECEIVERS);
+
+	m_de = new DataEngine();
+	if (!m_de->startReplay(m_protocol, m_receivers)) {
+
+		*error = "could not start the receive pipeline";
+		return false;
+	}
+
+	QMetaObject::invokeMethod(
+		m_de->getDataProcessor(),
+		[this]() { m_decodeClock.attach(); },
+		Qt::BlockingQueuedConnection);
+	m_feedClock.attach();
+
+	const qint64 feedCpu = m_feedClock.cpuUs();
+	const qint64 decodeCpu = m_decodeClock.cpuUs();
+	const qint64 dspCpu = m_de->m_dspWorkerPool.cpuTimeUs();
+	CPipelineStats::instance()->reset();
+
+	// a loop lasts the length of the capture plus one datagram interval
+	const qint64 captureStart = m_datagrams.first().time;
+	qint64 loopLength = m_datagrams.last().time - captureStart;
+	if (m_datagrams.count() > 1)
+		loopLength += loopLength / (m_datagrams.count() - 1);
+
+	const qint64 start = cusdrMonotonicUs();
+	qint64 lastEvents = start;
+
+	for (int loop = 0; loop < qMax(1, m_config.loops); loop++) {
+
+		for (const TReplayDatagram &datagram : std::as_const(m_datagrams)) {
+
+			if (m_config.realtime) {
+
+				const qint64 due = start + loop * loopLength + (datagram.time - captureStart);
+				const qint64 wait = due - cusdrMonotonicUs();
+				if (wait > 0) QThread::usleep(wait);
+			}
+			else
+				waitForPipeline();
+
+			if (!m_de->m_dataIO->replayDatagram(m_data.constData() + datagram.offset, datagram.size, datagram.sourcePort))
+				m_droppedDatagrams++;
+			m_fedDatagrams++;
+
+			// the receivers' spectrum and meter signals are queued to this thread
+			const qint64 now = cusdrMonotonicUs();
+			if (now - lastEvents > 20000) {
+
+				QCoreApplication::processEvents();
+				lastEvents = now;
+			}
+		}
+	}
+	drainPipeline();
+	m_elapsedUs = cusdrMonotonicUs() - start;
+
+	m_feedCpuUs = m_feedClock.cpuUs() - feedCpu;
+	m_decodeCpuUs = m_decodeClock.cpuUs() - decodeCpu;
+	m_dspCpuUs = m_de->m_dspWorkerPool.cpuTimeUs() - dspCpu;
+
+	for (Receiver *rx : std::as_const(m_de->RX)) {
+
+		const TDspStats stats = rx->getDspStats();
+		m_blocks += stats.blocks;
+		m_lateBlocks += stats.lateBlocks;
+		m_droppedBlocks += stats.droppedBlocks;
+	}
+
+	m_de->stopReplay();
+	return true;
+}
+
+void IQReplay::waitForPipeline() {
+
+	forever {
+
+		bool busy = m_de->io.iq_queue.count() >= REPLAY_MAX_QUEUED_DATAGRAMS;
+		for (Receiver *rx : std::as_const(m_de->RX))
+			busy |= rx->m_iqRing.count() > rx->m_iqRing.capacity() - REPLAY_RING_HEADROOM;
+
+		if (!busy) return;
+		QThread::usleep(20);
+	}
+}
+
+void IQReplay::drainPipeline() {
+
+	forever {
+
+		bool busy = !m_de->io.iq_queue.isEmpty();
+		for (Receiver *rx : std::as_const(m_de->RX))
+			busy |= rx->hasIQBlocks();
+
+		if (!busy) break;
+		QThread::msleep(1);
+	}
+
+	// the last blocks may still be in processDSP()
+	quint64 blocks = processedBlocks();
+	forever {
+
+		QThread::msleep(5);
+		const quint64 now = processedBlocks();
+		if (now == blocks) break;
+		blocks = now;
+	}
+}
+
+quint64 IQReplay::processedBlocks() const {
+
+	quint64 blocks = 0;
+	for (Receiver *rx : std::as_const(m_de->RX))
+		blocks += rx->getDspStats().blocks;
+	return blocks;
+}
+
+bool IQReplay::hasDrops() const {
+
+	return m_droppedBlocks > 0 || m_droppedDatagrams > 0;
+}
+
+QString IQReplay::report() const {
+
+	const int sampleRate = Settings::instance()->getSampleRate();
+	const double seconds = qMax((qint64) 1, m_elapsedUs) / 1e6;
+	const double samplesPerSecond = (double) m_blocks * BUFFER_SIZE / seconds;
+	const double realtimeFactor = samplesPerSecond / ((double) sampleRate * m_receivers);
+	const double blocks = qMax((quint64) 1, m_blocks);
+
+	QStringList lines;
+	lines << QString("capture:    %1, %2 datagrams, Protocol %3, %4 receiver(s) at %5 Hz")
+				.arg(m_config.fileName)
+				.arg(m_datagrams.count())
+				.arg(m_protocol)
+				.arg(m_receivers)
+				.arg(sampleRate);
+	lines << QString("mode:       %1, %2 loop(s), %3 datagrams fed")
+				.arg(QString(m_config.realtime ? "realtime" : "as fast as possible"))
+				.arg(qMax(1, m_config.loops))
+				.arg(m_fedDatagrams);
+	lines << QString("throughput: %1 samples/s over %2 s (%3 x realtime)")
+				.arg(samplesPerSecond, 0, 'f', 0)
+				.arg(seconds, 0, 'f', 3)
+				.arg(realtimeFactor, 0, 'f', 2);
+	lines << QString("blocks:     %1 processed, %2 dropped, %3 late; %4 datagrams dropped")
+				.arg(m_blocks)
+				.arg(m_droppedBlocks)
+				.arg(m_lateBlocks)
+				.arg(m_droppedDatagrams);
+	lines << QString("cpu:        feed/DataIO %1 ms, decode %2 ms, DSP %3 ms (%4 / %5 / %6 us per block)")
+				.arg(m_feedCpuUs / 1000)
+				.arg(m_decodeCpuUs / 1000)
+				.arg(m_dspCpuUs / 1000)
+				.arg(m_feedCpuUs / blocks, 0, 'f', 1)
+				.arg(m_decodeCpuUs / blocks, 0, 'f', 1)
+				.arg(m_dspCpuUs / blocks, 0, 'f', 1);
+	lines << CPipelineStats::instance()->report();
+
+	// one line for scripts
+	lines << QString("RESULT samples_per_s=%1 blocks=%2 dropped_blocks=%3 late_blocks=%4 dropped_datagrams=%5 "
+					 "feed_cpu_us=%6 decode_cpu_us=%7 dsp_cpu_us=%8 elapsed_us=%9")
+				.arg(samplesPerSecond, 0, 'f', 0)
+				.arg(m_blocks)
+				.arg(m_droppedBlocks)
+				.arg(m_lateBlocks)
+				.arg(m_droppedDatagrams)
+				.arg(m_feedCpuUs)
+				.arg(m_decodeCpuUs)
+				.arg(m_dspCpuUs)
+				.arg(m_elapsedUs);
+
+	return lines.join('\n');
+}
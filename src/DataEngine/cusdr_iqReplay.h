@@ -0,0 +1,118 @@
+/**
+* @file  cusdr_iqReplay.h
+* @brief headless replay of captured radio traffic through the receive pipeline
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_IQ_REPLAY_H
+#define CUSDR_IQ_REPLAY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "cusdr_dataEngine.h"
+
+#ifdef LOG_IQ_REPLAY
+#   define IQ_REPLAY_DEBUG qDebug().nospace() << "IQReplay::\t"
+#else
+#   define IQ_REPLAY_DEBUG nullDebug()
+#endif
+
+// Replays a capture of a Protocol 1 (Metis / Hermes) or Protocol 2 radio's
+// UDP traffic through DataIO, the protocol decoder and
+// Receiver::dspProcessing, without GL widgets or a device:
+//
+//   cudaSDR --replay capture.pcap [--realtime] [--receivers n] [--rate hz]
+//           [--loops n]
+//
+// The capture is a libpcap or pcapng file (tcpdump -w, Wireshark), or a
+// recording made by IQRecorder, and is read into memory before the run. By
+// default the datagrams are fed as fast as the pipeline takes them: the
+// feeder waits rather than overflow a queue, so the result is the sustained
+// throughput. With --realtime they are paced by the capture time stamps and
+// whatever does not keep up is dropped, as with a radio.
+
+typedef struct _iqReplayConfig {
+
+	QString	fileName;
+	bool	realtime;
+	int		receivers;		// 0: DDC ports in the capture (P2), settings (P1)
+	int		sampleRate;		// 0: from the settings
+	int		loops;
+
+} TIQReplayConfig;
+
+class IQReplay {
+
+public:
+	explicit IQReplay(const TIQReplayConfig &config);
+	~IQReplay();
+
+	bool	load(QString *error);
+	bool	run(QString *error);
+	bool	hasDrops() const;
+
+	// samples/s, drops, per stage CPU and the pipeline latency histograms
+	QString	report() const;
+
+private:
+	typedef struct _replayDatagram {
+
+		qint64	time;			// capture time stamp, us
+		int		offset;			// into m_data
+		int		size;
+		quint16	sourcePort;
+
+	} TReplayDatagram;
+
+	bool	loadPcap(const QByteArray &file, QString *error);
+	bool	loadPcapNg(const QByteArray &file, QString *error);
+	bool	loadRecording(QString *error);
+	void	addFrame(int linkType, const uchar *frame, int length, qint64 time);
+	void	addDatagram(int protocol, const uchar *payload, int payloadLength, quint16 sourcePort, qint64 time);
+	void	waitForPipeline();
+	void	drainPipeline();
+	quint64	processedBlocks() const;
+
+	TIQReplayConfig				m_config;
+	DataEngine*					m_de;
+
+	QByteArray					m_data;
+	QVector<TReplayDatagram>	m_datagrams;
+	quint32						m_ddcPorts;		// bit n: DDC n seen (P2)
+	int							m_protocol;		// 0 until the first IQ datagram
+
+	CThreadCpuClock	m_feedClock;
+	CThreadCpuClock	m_decodeClock;
+
+	qint64	m_elapsedUs;
+	qint64	m_feedCpuUs;
+	qint64	m_decodeCpuUs;
+	qint64	m_dspCpuUs;
+	quint64	m_blocks;
+	quint64	m_lateBlocks;
+	quint64	m_droppedBlocks;
+	quint64	m_droppedDatagrams;
+	quint64	m_fedDatagrams;
+	int		m_receivers;
+};
+
+#endif // CUSDR_IQ_REPLAY_H
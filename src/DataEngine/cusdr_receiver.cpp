@@ -30,9 +30,12 @@
 // use: RECEIVER_DEBUG
 
 #include "cusdr_receiver.h"
+#include "GL/cusdr_spectrumDisplayWorker.h"
+#include "Util/cusdr_displayScheduler.h"
 
 namespace {
 constexpr int HIGH_RATE_TRANSITION_DROP_BUFFERS = 12;
+constexpr quint64 DSP_STATS_LOG_INTERVAL = 4000;
 }
 
 Receiver::Receiver(int rx)
@@ -49,7 +52,11 @@ Receiver::Receiver(int rx)
 {
 	setReceiverData(set->getReceiverDataList().at(m_receiver));
 
-	InitCPX(inBuf, BUFFER_SIZE, 0.0f);
+	for (int i = 0; i < m_iqRing.capacity(); i++)
+		InitCPX(m_iqRing.slot(i).samples, BUFFER_SIZE, 0.0f);
+	InitCPX(m_iqOverflowBlock, BUFFER_SIZE, 0.0f);
+	claimIQBlock();
+
 	InitCPX(outBuf, BUFFER_SIZE, 0.0f);
     InitCPX(audioOutputBuf, BUFFER_SIZE, 0.0f);
     setAudioBufferSize();
@@ -66,7 +73,6 @@ Receiver::Receiver(int rx)
 
 Receiver::~Receiver() {
     qDebug() << "Destroy Receiver " << m_receiver;
-    inBuf.clear();
     outBuf.clear();
 	if (m_audioOutput) {
 #ifdef USE_INTERNAL_AUDIO
@@ -213,25 +219,30 @@ bool Receiver::initQtWDSPInterface() {
     return true;
 }
 
-void Receiver::enqueueRawData() {
-    QVector<int32_t> rawBlock;
-    rawBlock.reserve(BUFFER_SIZE * 2);
-    for (int i = 0; i < BUFFER_SIZE * 2; ++i) {
-        rawBlock.append(m_rawIQ[i]);
-    }
+void Receiver::claimIQBlock() {
+    m_iqWriteBlock = m_iqRing.claim();
+    m_rawIQ = m_iqWriteBlock ? m_iqWriteBlock->samples.data() : m_iqOverflowBlock.data();
+}
 
-    if (m_iqQueue.isFull()) {
-        RECEIVER_DEBUG << "iqQueue full! dropping oldest packet";
-        m_iqQueue.dequeue();
+void Receiver::enqueueRawData(qint64 received) {
+    // The decoder has filled m_rawIQ in place. m_iqRing is single producer /
+    // single consumer, so when it was full the block went to the overflow
+    // buffer and the newest samples are dropped.
+    if (!m_iqWriteBlock) {
+        m_iqDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        RECEIVER_DEBUG << "iqRing full! dropping newest block";
+    } else {
+        m_iqWriteBlock->received = received;
+        m_iqWriteBlock->published = cusdrMonotonicUs();
+        m_iqRing.publish();
     }
-    m_iqQueue.enqueue(rawBlock);
+    claimIQBlock();
 }
 
 void Receiver::enqueueData() {
     // Legacy support or internal use
-    if (m_iqQueue.isFull()) {
-        RECEIVER_DEBUG << "iqQueue full! dropping oldest packet";
-        m_iqQueue.dequeue();
+    if (m_iqRing.count() == m_iqRing.capacity()) {
+        RECEIVER_DEBUG << "iqRing full!";
     }
     // Convert CPX to raw int for now if this is ever called, or just do nothing
 }
@@ -243,54 +254,58 @@ void Receiver::stop() {
 	m_mutex.unlock();
 }
 
-void Receiver::dspProcessing() {
-	static quint64 dspEntryCount = 0;
-	static quint64 dspEmptyQueueCount = 0;
+bool Receiver::dspProcessing() {
 
-	++dspEntryCount;
-	if ((dspEntryCount % 100) == 1) {
-		RECEIVER_DEBUG << "dspProcessing entry rx=" << m_receiver
-					   << " count=" << dspEntryCount
-					   << " iqQueue=" << m_iqQueue.count();
-	}
+	TIQBlock *iqBlock = m_iqRing.front();
+	if (!iqBlock) return false;
 
-	if (m_iqQueue.isEmpty()) {
-		++dspEmptyQueueCount;
-		if ((dspEmptyQueueCount % 100) == 1) {
-			RECEIVER_DEBUG << "dspProcessing empty iqQueue rx=" << m_receiver
-						   << " emptyCount=" << dspEmptyQueueCount;
-		}
-		return;
-	}
+	CPipelineStats *pipeline = CPipelineStats::instance();
+	pipeline->setQueueDepth(CPipelineStats::ReceiverRing0 + m_receiver, m_iqRing.count());
 
+	// no analyzer work for a receiver whose spectrum is not on screen
+	const CDisplayScheduler *display = CDisplayScheduler::instance();
+	const int displayStream = CDisplayScheduler::Receiver0 + m_receiver;
+	const bool spectrumShown = display->isShown(displayStream);
+
+	qint64 blockTime;
+	qint64 dspStart, dspEnd;
 	{
 		QMutexLocker locker(&m_mutex);
+
+		// setSampleRate() runs on the receiver thread and only flags the
+		// flush; the ring is emptied here, on the consumer side.
+		if (m_flushIQRing) {
+			m_iqRing.clear();
+			m_flushIQRing = false;
+			return true;
+		}
 		if (m_rateTransitionDropBuffers > 0) {
-			m_iqQueue.dequeue();
+			m_iqRing.pop();
 			--m_rateTransitionDropBuffers;
-			return;
+			return true;
 		}
+
+		// The decoder has written normalized samples straight into the ring
+		// slot; it is processed in place and only then handed back. Holding
+		// m_mutex keeps setSampleRate() from rebuilding the channel meanwhile.
+		dspStart = cusdrMonotonicUs();
+		qtwdsp->processDSP(iqBlock->samples, audioOutputBuf, spectrumShown);
+		dspEnd = cusdrMonotonicUs();
+		blockTime = (qint64) BUFFER_SIZE * 1000000 / m_samplerate;
 	}
-    
-    QVector<int32_t> rawIQ = m_iqQueue.dequeue();
-    
-    // Perform 24-bit integer to double conversion in this thread
-    // This offloads work from the bottleneck DataProcessor thread.
-    const double scale = 1.0 / 8388607.0;
-    cpx* inPtr = inBuf.data(); // Trigger detach once
-    const int32_t* rawPtr = rawIQ.constData();
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        inPtr[i].re = (double)rawPtr[2*i] * scale;
-        inPtr[i].im = (double)rawPtr[2*i+1] * scale;
-    }
+	const qint64 received = iqBlock->received;
+	const qint64 published = iqBlock->published;
+	m_iqRing.pop();
+
+	if (received > 0)
+		pipeline->record(CPipelineStats::NetworkToDecoded, published - received);
+	pipeline->record(CPipelineStats::DecodedToDspStart, dspStart - published);
+	pipeline->record(CPipelineStats::ProcessDSP, dspEnd - dspStart);
 
     int spectrumDataReady;
-    
-    mutex.lock();
-    qtwdsp->processDSP(inBuf, audioOutputBuf);
-    mutex.unlock();
 
-      if (highResTimer->getElapsedTimeInMicroSec() >= getDisplayDelay()) {
+      if (spectrumShown &&
+          display->frameDue(displayStream, (qint64) highResTimer->getElapsedTimeInMicroSec(), getDisplayDelay())) {
 
         
         if (m_state == RadioState::RX)
@@ -301,8 +316,15 @@ void Receiver::dspProcessing() {
         }
 
         if (spectrumDataReady) {
-            newSpectrum = qtwdsp->spectrumBuffer;  // Direct assignment
-            emit spectrumBufferChanged(m_receiver, newSpectrum);
+            // the receiver panel's display worker gets its own copy; the
+            // queued signal copies the spectrum again, so it is only sent
+            // while a panel that takes it (the 3D panadapter) is shown
+            SpectrumDisplayWorker::post(m_receiver, qtwdsp->spectrumBuffer.constData(), qtwdsp->spectrumBuffer.size());
+
+            if (display->isShown(CDisplayScheduler::ReceiverSignal0 + m_receiver)) {
+                newSpectrum = qtwdsp->spectrumBuffer;  // Direct assignment
+                emit spectrumBufferChanged(m_receiver, newSpectrum);
+            }
         }
         
         highResTimer->start();
@@ -319,7 +341,48 @@ void Receiver::dspProcessing() {
         m_audioOutput->writeAudio(interleaveFromCPX(audioOutputBuf, m_audiobuffersize));
 #endif
         emit audioBufferSignal(m_receiver, audioOutputBuf, m_audiobuffersize);
+
+        // only the current receiver feeds an audio sink
+        const qint64 audioWritten = cusdrMonotonicUs();
+        pipeline->record(CPipelineStats::DspEndToAudio, audioWritten - dspEnd);
+        if (received > 0)
+            pipeline->record(CPipelineStats::NetworkToAudio, audioWritten - received);
+    }
+
+    // latency from the block's hand-over by the decoder to the end of its
+    // processing; it is late if the next block was already due.
+    const qint64 latency = cusdrMonotonicUs() - published;
+    const quint64 blocks = m_dspBlocks.fetch_add(1, std::memory_order_relaxed) + 1;
+    m_dspLatencySum.fetch_add((quint64) latency, std::memory_order_relaxed);
+    if (latency > blockTime)
+        m_dspLateBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    qint64 maxLatency = m_dspLatencyMax.load(std::memory_order_relaxed);
+    while (latency > maxLatency &&
+           !m_dspLatencyMax.compare_exchange_weak(maxLatency, latency, std::memory_order_relaxed)) {}
+
+    if ((blocks % DSP_STATS_LOG_INTERVAL) == 0) {
+        const TDspStats stats = getDspStats();
+        RECEIVER_DEBUG << "dsp rx=" << m_receiver
+                       << " blocks=" << stats.blocks
+                       << " late=" << stats.lateBlocks
+                       << " dropped=" << stats.droppedBlocks
+                       << " avgLatency=" << stats.avgLatency << "us"
+                       << " maxLatency=" << stats.maxLatency << "us"
+                       << " iqRing=" << m_iqRing.count();
     }
+    return true;
+}
+
+TDspStats Receiver::getDspStats() const {
+    TDspStats stats;
+    stats.blocks = m_dspBlocks.load(std::memory_order_relaxed);
+    stats.lateBlocks = m_dspLateBlocks.load(std::memory_order_relaxed);
+    stats.droppedBlocks = m_iqDroppedBlocks.load(std::memory_order_relaxed);
+    stats.avgLatency = stats.blocks
+        ? (double) m_dspLatencySum.load(std::memory_order_relaxed) / (double) stats.blocks : 0.0;
+    stats.maxLatency = m_dspLatencyMax.load(std::memory_order_relaxed);
+    return stats;
 }
 
 QVector<float> Receiver::interleaveFromCPX(const CPX& in, int size) {
@@ -338,6 +401,9 @@ QVector<float> Receiver::interleaveFromCPX(const CPX& in, int size) {
 void Receiver::setSampleRate(QObject *sender, int value) {
 	Q_UNUSED(sender)
 
+	// dspProcessing() reads the rate under m_mutex on a pool thread
+	QMutexLocker locker(&m_mutex);
+
 	if (m_samplerate == value) return;
     const int previousRate = m_samplerate;
 
@@ -373,7 +439,6 @@ void Receiver::setSampleRate(QObject *sender, int value) {
 	}
 
 	if (qtwdsp) {
-        m_mutex.lock();
 
 		// Queue flush and drop-counter are now handled unconditionally below.
 		const bool highRateTransition = (previousRate >= 768000 || m_samplerate >= 768000);
@@ -383,13 +448,11 @@ void Receiver::setSampleRate(QObject *sender, int value) {
 
 		// Flush the queue and drop a few buffers after any rate transition so
 		// fexchange0 is not called on the channel while it is being rebuilt.
-		while (!m_iqQueue.isEmpty())
-			m_iqQueue.dequeue();
+		// The DSP worker empties the ring the next time it runs.
+		m_flushIQRing = true;
 		m_rateTransitionDropBuffers = HIGH_RATE_TRANSITION_DROP_BUFFERS;
 
         qtwdsp->setSampleRate(this, m_samplerate);
-        m_mutex.unlock();
-
     }
 	else
 		RECEIVER_DEBUG << "qtdsp down: cannot set sample rate!\n";
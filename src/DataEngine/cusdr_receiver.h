@@ -45,6 +45,28 @@
 #   define RECEIVER_DEBUG nullDebug()
 #endif
 
+// number of preallocated BUFFER_SIZE sample blocks between the protocol
+// decoder and the DSP thread, per receiver
+#define IQ_BLOCK_RING_SIZE	64
+
+typedef struct _iqBlock {
+
+	CPX		samples;
+	qint64	received;	// cusdrMonotonicUs() arrival of the datagram that completed the block
+	qint64	published;	// cusdrMonotonicUs() time the decoder handed the block over
+
+} TIQBlock;
+
+typedef struct _dspStats {
+
+	quint64	blocks;			// blocks run through the DSP
+	quint64	lateBlocks;		// blocks whose DSP finished later than one block time after arrival
+	quint64	droppedBlocks;	// blocks dropped because the ring was full
+	double	avgLatency;		// mean arrival -> DSP done latency, in us
+	qint64	maxLatency;		// worst arrival -> DSP done latency, in us
+
+} TDspStats;
+
 
 class Receiver : public QObject {
 
@@ -102,15 +124,24 @@ public:
     std::unique_ptr<HResTimer>	highResTimer;
 	ReceiverAudioOutput *m_audioOutput = nullptr;
 
-	CPX			inBuf;
     CPX			outBuf;
     CPX			audioOutputBuf;
 
-    QHQueue<QVector<int32_t>> m_iqQueue;
-    int32_t     m_rawIQ[BUFFER_SIZE * 2];
+    // blocks the protocol decoder fills in place and dspProcessing()
+    // consumes in place
+    QHSpscRing<TIQBlock> m_iqRing{IQ_BLOCK_RING_SIZE};
+    // block the decoder is currently filling with normalized samples
+    // (unpackIQ24); points to m_iqOverflowBlock while the ring is full
+    cpx*        m_rawIQ = nullptr;
+
+    // Runs the DSP on the oldest queued block; returns false if there was
+    // none. Called by the DspWorkerPool, never by two threads at once.
+    bool    dspProcessing();
+    bool    hasIQBlocks() const	{ return !m_iqRing.isEmpty(); }
+    TDspStats getDspStats() const;
 
 public slots:
-    void    enqueueRawData();
+    void    enqueueRawData(qint64 received = 0);
 	void	setReceiverData(TReceiver data);
 	void	setAudioMode(QObject* sender, int mode);
 	void	setServerMode(QSDR::_ServerMode mode);
@@ -138,7 +169,6 @@ public slots:
 	void	setdBmPanScaleMax(qreal value);
 	void	setMercuryAttenuators(const QList<int> &attenuators);
 
-	void	dspProcessing();
 	void	stop();
 
 private slots:
@@ -169,6 +199,7 @@ private slots:
 
 private:
 
+    void    claimIQBlock();
     QVector<float> convertToFloatInterleaved(const QVector<CPX>& in);
     QVector<float> interleaveFromCPX(const CPX& in, int size = -1);
 	Settings*				set;
@@ -196,6 +227,16 @@ private:
     QElapsedTimer				m_smeterTime;
 	QMutex				m_mutex;
 
+	TIQBlock*			m_iqWriteBlock = nullptr;
+	CPX					m_iqOverflowBlock;
+	bool				m_flushIQRing = false;
+
+	std::atomic<quint64>	m_dspBlocks{0};
+	std::atomic<quint64>	m_dspLateBlocks{0};
+	std::atomic<quint64>	m_iqDroppedBlocks{0};
+	std::atomic<quint64>	m_dspLatencySum{0};
+	std::atomic<qint64>		m_dspLatencyMax{0};
+
 	volatile bool	m_stopped;
 
 	int		m_receiver;
@@ -0,0 +1,297 @@
+/**
+* @file  cusdr_txSender.cpp
+* @brief paced, batched UDP transmit path for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+//#define LOG_TX_SENDER
+
+#include "cusdr_txSender.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+// the sender gives up on periods it slept through beyond this and resyncs
+#define TX_SENDER_MAX_BEHIND	8
+
+TxSender::TxSender()
+	: m_thread(nullptr)
+	, m_socket(-1)
+	, m_sourceSocket(-1)
+	, m_port(0)
+	, m_periodUs(0)
+	, m_frames(new TTxFrame[TX_SENDER_SLOTS])
+	, m_head(0)
+	, m_tail(0)
+	, m_running(false)
+	, m_stop(false)
+	, m_stats(CPipelineStats::instance())
+{
+	memset(&m_destination, 0, sizeof(m_destination));
+	memset(&m_spare, 0, sizeof(m_spare));
+}
+
+TxSender::~TxSender() {
+
+	stop();
+}
+
+bool TxSender::start(int socketDescriptor, const QHostAddress &address, quint16 port, qint64 periodUs) {
+
+	// called for every frame: the settings are only written here, on the
+	// producer thread, so reading them needs no lock
+	if (m_running.load(std::memory_order_acquire) && m_sourceSocket == socketDescriptor &&
+		m_port == port && m_periodUs == periodUs && m_address == address)
+		return true;
+
+	QMutexLocker locker(&m_mutex);
+	stopLocked();
+
+	if (socketDescriptor < 0)
+		return false;
+
+	m_socket = ::dup(socketDescriptor);
+	if (m_socket < 0) {
+
+		TX_SENDER_DEBUG << "cannot duplicate socket " << socketDescriptor << ": " << strerror(errno);
+		return false;
+	}
+
+	m_sourceSocket = socketDescriptor;
+	m_address = address;
+	m_port = port;
+	m_periodUs = periodUs;
+
+	memset(&m_destination, 0, sizeof(m_destination));
+	m_destination.sin_family = AF_INET;
+	m_destination.sin_port = htons(port);
+	m_destination.sin_addr.s_addr = htonl(address.toIPv4Address());
+
+	// what was queued for the old destination is dropped; the tail stays
+	// put, so a frame the producer is still building keeps its slot
+	m_head.store(m_tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+	m_stop.store(false, std::memory_order_relaxed);
+	m_running.store(true, std::memory_order_release);
+
+	m_thread = new SenderThread(this);
+	m_thread->start(QThread::TimeCriticalPriority);
+
+	TX_SENDER_DEBUG << "sending to " << qPrintable(address.toString()) << ":" << port
+					<< " every " << periodUs << " us";
+	return true;
+}
+
+void TxSender::stop() {
+
+	QMutexLocker locker(&m_mutex);
+	stopLocked();
+}
+
+void TxSender::stopLocked() {
+
+	if (m_thread) {
+
+		m_stop.store(true, std::memory_order_release);
+		m_thread->wait();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	if (m_socket >= 0) {
+
+		::close(m_socket);
+		m_socket = -1;
+	}
+	m_sourceSocket = -1;
+
+	m_running.store(false, std::memory_order_release);
+}
+
+TTxFrame *TxSender::acquire() {
+
+	const quint32 tail = m_tail.load(std::memory_order_relaxed);
+	const quint32 head = m_head.load(std::memory_order_acquire);
+
+	if (tail - head >= TX_SENDER_SLOTS)
+		return &m_spare;
+
+	return &m_frames[tail & (TX_SENDER_SLOTS - 1)];
+}
+
+void TxSender::commit(TTxFrame *frame) {
+
+	if (frame == &m_spare) {
+
+		m_stats->add(CPipelineStats::TxOverruns);
+		return;
+	}
+
+	const quint32 tail = m_tail.load(std::memory_order_relaxed);
+	m_tail.store(tail + 1, std::memory_order_release);
+}
+
+static void sleepUntil(qint64 us) {
+
+#if defined(Q_OS_LINUX)
+	// cusdrMonotonicUs() is steady_clock, i.e. CLOCK_MONOTONIC
+	timespec ts;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+	const qint64 wait = us - cusdrMonotonicUs();
+	if (wait > 0)
+		::usleep(wait);
+#endif
+}
+
+void TxSender::senderLoop() {
+
+	const qint64 period = m_periodUs;
+	qint64 next = cusdrMonotonicUs() + period;
+	bool primed = false;
+
+	while (!m_stop.load(std::memory_order_acquire)) {
+
+		sleepUntil(next);
+
+		const qint64 now = cusdrMonotonicUs();
+		const qint64 lateness = now - next;
+		m_stats->record(CPipelineStats::TxTimer, qAbs(lateness));
+
+		// one frame for this period, plus one for each we slept through
+		int due = 1;
+		if (lateness > 0)
+			due += (int) qMin<qint64>(lateness / period, TX_SENDER_MAX_BEHIND);
+
+		const quint32 head = m_head.load(std::memory_order_relaxed);
+		const int depth = (int) (m_tail.load(std::memory_order_acquire) - head);
+
+		// (re)build the cushion before the first frame and after an underrun
+		if (!primed)
+			primed = depth >= TX_SENDER_DEPTH;
+
+		int sent = 0;
+		if (primed) {
+
+			if (depth == 0) {
+
+				m_stats->add(CPipelineStats::TxUnderruns);
+				primed = false;
+			}
+			else {
+
+				// well over the cushion: catch up a frame at a time
+				const int count = depth > 2 * TX_SENDER_DEPTH ? due + 1 : due;
+
+				sent = sendFrames(head, qMin(count, depth));
+				if (lateness > period / 2)
+					m_stats->add(CPipelineStats::TxLate, sent);
+			}
+		}
+
+		// the radio's clock sets the real frame rate: keeping the queue at
+		// its target depth trims our period to it, by 2 % at most
+		const int error = depth - sent - TX_SENDER_DEPTH;
+		const qint64 trim = qBound(-period / 50, error * period / 200, period / 50);
+
+		next += due * period - (primed ? trim : 0);
+		if (now - next > TX_SENDER_MAX_BEHIND * period)
+			next = now + period;
+	}
+}
+
+int TxSender::sendFrames(quint32 head, int count) {
+
+	int done = 0;
+	while (done < count) {
+
+		const int batch = qMin(count - done, TX_SENDER_BATCH);
+
+		iovec	iov[TX_SENDER_BATCH][2];
+		msghdr	msg[TX_SENDER_BATCH];
+
+		for (int i = 0; i < batch; i++) {
+
+			TTxFrame *frame = &m_frames[(head + done + i) & (TX_SENDER_SLOTS - 1)];
+
+			iov[i][0].iov_base = frame->header;
+			iov[i][0].iov_len = frame->headerSize;
+			iov[i][1].iov_base = frame->payload;
+			iov[i][1].iov_len = frame->payloadSize;
+
+			memset(&msg[i], 0, sizeof(msghdr));
+			msg[i].msg_name = &m_destination;
+			msg[i].msg_namelen = sizeof(m_destination);
+			msg[i].msg_iov = iov[i];
+			msg[i].msg_iovlen = 2;
+		}
+
+		int n;
+#if defined(TX_SENDER_USE_SENDMMSG)
+		mmsghdr mmsg[TX_SENDER_BATCH];
+		for (int i = 0; i < batch; i++) {
+
+			mmsg[i].msg_hdr = msg[i];
+			mmsg[i].msg_len = 0;
+		}
+
+		do {
+			n = ::sendmmsg(m_socket, mmsg, batch, 0);
+		} while (n < 0 && errno == EINTR);
+		m_stats->add(CPipelineStats::TxSyscalls);
+#else
+		for (n = 0; n < batch; n++) {
+
+			ssize_t result;
+			do {
+				result = ::sendmsg(m_socket, &msg[n], 0);
+			} while (result < 0 && errno == EINTR);
+			m_stats->add(CPipelineStats::TxSyscalls);
+
+			if (result < 0)
+				break;
+		}
+		if (n == 0)
+			n = -1;
+#endif
+
+		// a datagram the stack refused is lost like one lost on the wire:
+		// it is not retried, the next period has its own
+		if (n <= 0) {
+
+			TX_SENDER_DEBUG << "send failed: " << strerror(errno);
+			n = 1;
+		}
+		else
+			m_stats->add(CPipelineStats::TxFramesSent, n);
+
+		done += n;
+		m_head.store(head + done, std::memory_order_release);
+	}
+
+	return done;
+}
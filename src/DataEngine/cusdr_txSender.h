@@ -0,0 +1,157 @@
+/**
+* @file  cusdr_txSender.h
+* @brief paced, batched UDP transmit path for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_TX_SENDER_H
+#define CUSDR_TX_SENDER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QHostAddress>
+
+#include "cusdr_settings.h"
+#include "Util/cusdr_pipelineStats.h"
+
+#include <atomic>
+#include <memory>
+
+#include <netinet/in.h>
+
+#ifdef LOG_TX_SENDER
+#   define TX_SENDER_DEBUG qDebug().nospace() << "TxSender::\t"
+#else
+#   define TX_SENDER_DEBUG nullDebug()
+#endif
+
+// Send with one sendmmsg() per batch; elsewhere one sendmsg() per frame.
+#if defined(Q_OS_LINUX)
+#define TX_SENDER_USE_SENDMMSG
+#endif
+
+#define TX_FRAME_HEADER_SIZE	16
+#define TX_FRAME_PAYLOAD_SIZE	1440	// P2 DUC payload, the largest we send
+
+#define TX_SENDER_SLOTS			64		// power of two
+#define TX_SENDER_BATCH			16		// frames per syscall at most
+#define TX_SENDER_DEPTH			4		// frames kept queued ahead of the timer
+
+// P1: two 63-sample USB frames per datagram at 48 kHz
+// P2: 240 DUC samples per packet at 192 kHz
+#define TX_P1_PERIOD_US			2625
+#define TX_P2_PERIOD_US			1250
+
+// One datagram. Header and payload are built in place, apart from each
+// other, and go out as two iovecs.
+typedef struct _txFrame {
+
+	uchar	header[TX_FRAME_HEADER_SIZE];
+	int		headerSize;
+	int		payloadSize;
+	uchar	payload[TX_FRAME_PAYLOAD_SIZE];
+
+} TTxFrame;
+
+// Transmit path for the TX data stream (P1 EP2 frames, P2 DUC packets).
+//
+// The producer, the DataProcessor thread, builds each frame in place in a
+// fixed pool and commits it; nothing is allocated or copied on the way out.
+// A sender thread of its own wakes on an absolute timer once per frame
+// period and sends the frames that are due, as many as it slept through in
+// one batch. The producer runs off the radio's clock and the timer off the
+// PC's, so the queue depth trims the period by up to 2 % to keep
+// TX_SENDER_DEPTH frames queued.
+//
+// Stats go to CPipelineStats, next to the receive path's, and show up in
+// its report (network widget, dump, IQ replay): the timer's wake-up error
+// as the TxTimer histogram, frames sent, syscalls, frames sent more than
+// half a period late, underruns (the timer found nothing to send) and
+// overruns (the pool was full and the frame was dropped).
+//
+// Frames go out through DataIO's bound socket, so the radio sees them come
+// from the port it answers and takes commands on, the same as the rest of
+// our traffic. The sender sends on a dup() of that descriptor: DataIO is
+// torn down before the DataProcessor, and the dup keeps the socket open
+// until the sender thread has stopped.
+
+class TxSender {
+
+public:
+	TxSender();
+	~TxSender();
+
+	// (re)starts the sender on a socket (DataIO's bound descriptor, -1
+	// while it has none) for a destination and frame period; a no-op while
+	// it already runs with the same settings. Producer thread only.
+	bool	start(int socketDescriptor, const QHostAddress &address, quint16 port, qint64 periodUs);
+	void	stop();
+
+	// producer side: the frame to build next, then hand it over. When the
+	// pool is full acquire() returns a spare frame that commit() drops.
+	TTxFrame	*acquire();
+	void		commit(TTxFrame *frame);
+
+	quint64	sent() const		{ return m_stats->counter(CPipelineStats::TxFramesSent); }
+	quint64	syscalls() const	{ return m_stats->counter(CPipelineStats::TxSyscalls); }
+	quint64	late() const		{ return m_stats->counter(CPipelineStats::TxLate); }
+	quint64	underruns() const	{ return m_stats->counter(CPipelineStats::TxUnderruns); }
+	quint64	overruns() const	{ return m_stats->counter(CPipelineStats::TxOverruns); }
+
+	// timer wake-up error, us
+	const CLatencyHistogram &jitter() const	{ return m_stats->stage(CPipelineStats::TxTimer); }
+
+private:
+	class SenderThread : public QThread {
+	public:
+		explicit SenderThread(TxSender *sender) : m_sender(sender) {}
+	protected:
+		void run() override { m_sender->senderLoop(); }
+	private:
+		TxSender *m_sender;
+	};
+
+	void	senderLoop();
+	int		sendFrames(quint32 head, int count);
+	void	stopLocked();
+
+	QMutex			m_mutex;
+	SenderThread*	m_thread;
+	int				m_socket;		// our dup() of m_sourceSocket
+	int				m_sourceSocket;
+
+	QHostAddress	m_address;
+	quint16			m_port;
+	qint64			m_periodUs;
+	sockaddr_in		m_destination;
+
+	std::unique_ptr<TTxFrame[]>	m_frames;
+	TTxFrame					m_spare;
+
+	alignas(64) std::atomic<quint32>	m_head;
+	alignas(64) std::atomic<quint32>	m_tail;
+
+	std::atomic<bool>		m_running;
+	std::atomic<bool>		m_stop;
+
+	CPipelineStats*			m_stats;
+};
+
+#endif // CUSDR_TX_SENDER_H
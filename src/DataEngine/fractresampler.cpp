@@ -72,9 +72,9 @@ CFractResampler::CFractResampler()
 CFractResampler::~CFractResampler()
 {
 	if(m_pSinc)
-		delete m_pSinc;
+		delete [] m_pSinc;
 	if(m_pInputBuf)
-		delete m_pInputBuf;
+		delete [] m_pInputBuf;
 }
 //
 
@@ -91,7 +91,7 @@ TYPEREAL window;
 	if(NULL == m_pSinc)
 		m_pSinc = new  TYPEREAL[SINC_LENGTH];
 	if(m_pInputBuf)
-		delete m_pInputBuf;
+		delete [] m_pInputBuf;
 	m_pInputBuf = new TYPECPX[MaxInputSize];
 	for(i=0; i<MaxInputSize; i++)
 	{
@@ -0,0 +1,433 @@
+/**
+* @file  polyphaseresampler.cpp
+* @brief polyphase FIR resampler with precomputed float coefficient banks
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "polyphaseresampler.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POLYPHASE_X86
+#include <immintrin.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////
+// Local defines
+//////////////////////////////////////////////////////////////////////
+#define POLYPHASE_SINC_PERIODS	32		// periods of the lower of the two rates the filter spans
+#define POLYPHASE_KAISER_BETA	10.0	// about 100 dB stopband
+#define POLYPHASE_PHASES		256		// bank phases per input sample at full bandwidth
+
+#define MAX_SOUNDCARDVAL 32767.0
+
+typedef struct _polyphaseKernels {
+
+	float	(*dot)(const float *, const float *, int);
+	void	(*dot2)(const float *, const float *, const float *, int, float *, float *);
+
+} TPolyphaseKernels;
+
+static float dotScalar(const float *c, const float *x, int n) {
+
+	float acc = 0.0f;
+	for (int i = 0; i < n; i++)
+		acc += c[i] * x[i];
+
+	return acc;
+}
+
+static void dot2Scalar(const float *c, const float *re, const float *im, int n, float *yre, float *yim) {
+
+	float accRe = 0.0f;
+	float accIm = 0.0f;
+	for (int i = 0; i < n; i++) {
+
+		accRe += c[i] * re[i];
+		accIm += c[i] * im[i];
+	}
+
+	*yre = accRe;
+	*yim = accIm;
+}
+
+#ifdef POLYPHASE_X86
+
+__attribute__((target("avx2,fma")))
+static inline float hsumAvx(__m256 v) {
+
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_movehdup_ps(s));
+	return _mm_cvtss_f32(s);
+}
+
+// n is a multiple of 8 (m_Taps)
+__attribute__((target("avx2,fma")))
+static float dotAvx2(const float *c, const float *x, int n) {
+
+	__m256 acc = _mm256_setzero_ps();
+	for (int i = 0; i < n; i += 8)
+		acc = _mm256_fmadd_ps(_mm256_loadu_ps(c + i), _mm256_loadu_ps(x + i), acc);
+
+	return hsumAvx(acc);
+}
+
+__attribute__((target("avx2,fma")))
+static void dot2Avx2(const float *c, const float *re, const float *im, int n, float *yre, float *yim) {
+
+	__m256 accRe = _mm256_setzero_ps();
+	__m256 accIm = _mm256_setzero_ps();
+	for (int i = 0; i < n; i += 8) {
+
+		const __m256 k = _mm256_loadu_ps(c + i);
+		accRe = _mm256_fmadd_ps(k, _mm256_loadu_ps(re + i), accRe);
+		accIm = _mm256_fmadd_ps(k, _mm256_loadu_ps(im + i), accIm);
+	}
+
+	*yre = hsumAvx(accRe);
+	*yim = hsumAvx(accIm);
+}
+
+#endif // POLYPHASE_X86
+
+static TPolyphaseKernels selectKernels(const char **name) {
+
+	TPolyphaseKernels k;
+
+#ifdef POLYPHASE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+
+		k.dot	= dotAvx2;
+		k.dot2	= dot2Avx2;
+		*name = "avx2";
+		return k;
+	}
+#endif
+	k.dot	= dotScalar;
+	k.dot2	= dot2Scalar;
+	*name = "scalar";
+	return k;
+}
+
+static const char *s_kernelName = nullptr;
+
+static const TPolyphaseKernels &kernels() {
+
+	static const TPolyphaseKernels k = selectKernels(&s_kernelName);
+	return k;
+}
+
+const char* CPolyphaseResampler::Kernel() {
+
+	kernels();
+	return s_kernelName;
+}
+
+// modified Bessel function of the first kind, order 0, for the Kaiser window
+static double besselI0(double x) {
+
+	const double q = 0.25 * x * x;
+	double term = 1.0;
+	double sum = 1.0;
+	for (int k = 1; k < 64 && term > 1e-17 * sum; k++) {
+
+		term *= q / ((double)k * (double)k);
+		sum += term;
+	}
+	return sum;
+}
+
+static int gcd(int a, int b) {
+
+	while (b) {
+
+		int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Construction
+//////////////////////////////////////////////////////////////////////
+CPolyphaseResampler::CPolyphaseResampler()
+	: m_MaxInput(0)
+	, m_Taps(0)
+	, m_Phases(0)
+	, m_L(1)
+	, m_M(1)
+	, m_Rational(false)
+	, m_NominalRate(1.0)
+	, m_Base(0)
+	, m_Frac(0.0)
+{
+}
+
+//////////////////////////////////////////////////////////////////////
+// Design the coefficient bank for InRate -> OutRate and clear the
+// history. Allocates; call it before streaming, not from the stream.
+//////////////////////////////////////////////////////////////////////
+void CPolyphaseResampler::Init(int MaxInputSize, int InRate, int OutRate) {
+
+	const int g = gcd(InRate, OutRate);
+	m_L = OutRate / g;
+	m_M = InRate / g;
+	m_NominalRate = (double)m_M / (double)m_L;
+	m_Rational = (m_L <= POLYPHASE_MAX_RATIONAL);
+
+	// going down, the filter stretches to the output rate so it still
+	// spans POLYPHASE_SINC_PERIODS output periods
+	const double cutoff = qMin(1.0, (double)OutRate / (double)InRate);
+	const int taps = (int)ceil(POLYPHASE_SINC_PERIODS / cutoff);
+	m_Taps = (taps + 7) & ~7;
+
+	// the exact path needs every multiple of 1/L; a fine bank also keeps the
+	// linear interpolation between phases of the fractional path below 16 bit
+	// noise. The passband shrinks with the cutoff and so does the bank,
+	// taps x phases stays about 32 x 256.
+	m_Phases = (int)ceil(POLYPHASE_PHASES * cutoff);
+	if (m_Rational)
+		m_Phases = m_L * ((m_Phases + m_L - 1) / m_L);
+
+	DesignBank(cutoff);
+
+	m_MaxInput = MaxInputSize;
+	m_Re.fill(0.0f, m_Taps + MaxInputSize);
+	m_Im.fill(0.0f, m_Taps + MaxInputSize);
+
+	// where every later call starts, one sample past the first full window;
+	// starting earlier would give the first call more than InLength / Rate + 1
+	// outputs
+	m_Base = m_Taps / 2;
+	m_Frac = 0.0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Phase p holds the taps for an output p / m_Phases of an input sample
+// after the centre tap. Tap k sits d = k - (m_Taps / 2 - 1) - p / m_Phases
+// input samples from the output: a Kaiser windowed sinc, each phase
+// scaled to unity gain at DC. Phase m_Phases is phase 0 moved by
+// one sample, for the interpolation at the top of the range.
+//////////////////////////////////////////////////////////////////////
+void CPolyphaseResampler::DesignBank(double cutoff) {
+
+	m_Bank.resize((m_Phases + 1) * m_Taps);
+
+	QVector<double> h(m_Taps);
+
+	const double half = m_Taps / 2.0;
+	const double norm = besselI0(POLYPHASE_KAISER_BETA);
+	for (int p = 0; p <= m_Phases; p++) {
+
+		float *c = m_Bank.data() + p * m_Taps;
+		const double frac = (double)p / (double)m_Phases;
+
+		double sum = 0.0;
+		for (int k = 0; k < m_Taps; k++) {
+
+			const double d = k - (half - 1.0) - frac;
+			const double x = K_PI * cutoff * d;
+			const double sinc = (fabs(x) < 1e-12) ? 1.0 : sin(x) / x;
+
+			const double r = d / half;
+			const double window = (fabs(r) < 1.0) ? besselI0(POLYPHASE_KAISER_BETA * sqrt(1.0 - r * r)) / norm : 0.0;
+
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		for (int k = 0; k < m_Taps; k++)
+			c[k] = (float)(h[k] / sum);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// Append InLength samples to the history and produce every output whose
+// window is complete, handing each one to output(n, re, im).
+//////////////////////////////////////////////////////////////////////
+template<bool Complex, class Output>
+int CPolyphaseResampler::Process(int InLength, TYPEREAL Rate, Output output) {
+
+	const TPolyphaseKernels &k = kernels();
+
+	float *re = m_Re.data();
+	float *im = m_Im.data();
+	const float *bank = m_Bank.constData();
+
+	// last window start that still fits the buffer
+	const int end = InLength + m_Taps / 2;
+	const int offset = m_Taps / 2 - 1;
+
+	int outsamples = 0;
+	if (m_Rational && Rate == m_NominalRate) {
+
+		// exact path: the position advances by M / L in whole phases
+		int phase = (int)lround(m_Frac * m_L);
+		if (phase == m_L) {
+
+			phase = 0;
+			m_Base++;
+		}
+
+		const int stride = m_Phases / m_L;
+		while (m_Base < end) {
+
+			const float *c = bank + phase * stride * m_Taps;
+			const int start = m_Base - offset;
+
+			float yre = 0.0f, yim = 0.0f;
+			if (Complex)
+				k.dot2(c, re + start, im + start, m_Taps, &yre, &yim);
+			else
+				yre = k.dot(c, re + start, m_Taps);
+
+			output(outsamples++, yre, yim);
+
+			phase += m_M;
+			m_Base += phase / m_L;
+			phase %= m_L;
+		}
+		m_Frac = (double)phase / (double)m_L;
+	}
+	else {
+
+		// fractional path: interpolate between the two nearest phases
+		while (m_Base < end) {
+
+			const double pos = m_Frac * m_Phases;
+			const int p = qMin((int)pos, m_Phases - 1);
+			const float a = (float)(pos - p);
+
+			const float *c0 = bank + p * m_Taps;
+			const float *c1 = c0 + m_Taps;
+			const int start = m_Base - offset;
+
+			float yre = 0.0f, yim = 0.0f;
+			if (Complex) {
+
+				float re0, im0, re1, im1;
+				k.dot2(c0, re + start, im + start, m_Taps, &re0, &im0);
+				k.dot2(c1, re + start, im + start, m_Taps, &re1, &im1);
+				yre = re0 + a * (re1 - re0);
+				yim = im0 + a * (im1 - im0);
+			}
+			else {
+
+				const float y0 = k.dot(c0, re + start, m_Taps);
+				const float y1 = k.dot(c1, re + start, m_Taps);
+				yre = y0 + a * (y1 - y0);
+			}
+
+			output(outsamples++, yre, yim);
+
+			m_Frac += Rate;
+			const int step = (int)m_Frac;
+			m_Base += step;
+			m_Frac -= step;
+		}
+	}
+
+	// keep the last m_Taps samples as history for the next call
+	m_Base -= InLength;
+	memmove(re, re + InLength, m_Taps * sizeof(float));
+	if (Complex)
+		memmove(im, im + InLength, m_Taps * sizeof(float));
+
+	return outsamples;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Resample InLength samples in pInBuf and place into pOutBuf.
+// Rate is the input rate / output rate.
+// returns number of samples in pOutBuf.
+//////////////////////////////////////////////////////////////////////
+int CPolyphaseResampler::Resample(int InLength, TYPEREAL Rate, const TYPECPX* pInBuf, TYPECPX* pOutBuf) {
+
+	float *re = m_Re.data() + m_Taps;
+	float *im = m_Im.data() + m_Taps;
+	for (int i = 0; i < InLength; i++) {
+
+		re[i] = (float)pInBuf[i].re;
+		im[i] = (float)pInBuf[i].im;
+	}
+
+	return Process<true>(InLength, Rate, [pOutBuf](int n, float yre, float yim) {
+
+		pOutBuf[n].re = yre;
+		pOutBuf[n].im = yim;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////
+// As above, scaled by gain and clipped into stereo 16 bit samples.
+//////////////////////////////////////////////////////////////////////
+int CPolyphaseResampler::Resample(int InLength, TYPEREAL Rate, const TYPECPX* pInBuf, TYPESTEREO16* pOutBuf, TYPEREAL gain) {
+
+	float *re = m_Re.data() + m_Taps;
+	float *im = m_Im.data() + m_Taps;
+	for (int i = 0; i < InLength; i++) {
+
+		re[i] = (float)pInBuf[i].re;
+		im[i] = (float)pInBuf[i].im;
+	}
+
+	return Process<true>(InLength, Rate, [pOutBuf, gain](int n, float yre, float yim) {
+
+		TYPEREAL l = qBound(-MAX_SOUNDCARDVAL, yre * gain, MAX_SOUNDCARDVAL);
+		TYPEREAL r = qBound(-MAX_SOUNDCARDVAL, yim * gain, MAX_SOUNDCARDVAL);
+		pOutBuf[n].re = (qint16)l;
+		pOutBuf[n].im = (qint16)r;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////
+// Real input into real output.
+//////////////////////////////////////////////////////////////////////
+int CPolyphaseResampler::Resample(int InLength, TYPEREAL Rate, const TYPEREAL* pInBuf, TYPEREAL* pOutBuf) {
+
+	float *re = m_Re.data() + m_Taps;
+	for (int i = 0; i < InLength; i++)
+		re[i] = (float)pInBuf[i];
+
+	return Process<false>(InLength, Rate, [pOutBuf](int n, float y, float) {
+
+		pOutBuf[n] = y;
+	});
+}
+
+//////////////////////////////////////////////////////////////////////
+// Real input, scaled by gain and clipped into mono 16 bit samples.
+//////////////////////////////////////////////////////////////////////
+int CPolyphaseResampler::Resample(int InLength, TYPEREAL Rate, const TYPEREAL* pInBuf, TYPEMONO16* pOutBuf, TYPEREAL gain) {
+
+	float *re = m_Re.data() + m_Taps;
+	for (int i = 0; i < InLength; i++)
+		re[i] = (float)pInBuf[i];
+
+	return Process<false>(InLength, Rate, [pOutBuf, gain](int n, float y, float) {
+
+		pOutBuf[n] = (TYPEMONO16)qBound(-MAX_SOUNDCARDVAL, y * gain, MAX_SOUNDCARDVAL);
+	});
+}
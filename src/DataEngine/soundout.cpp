@@ -12,6 +12,7 @@
 //  2011-08-07  Changed some debug output
 //  2015-01-24  RRK, Minor mods, adding to cudaSDR
 //  2025-09-08  Updated for Qt 6 audio APIs
+//  2026-10-17  Lock-free output queue, PI rate control
 /////////////////////////////////////////////////////////////////////
 
 //==========================================================================================
@@ -47,16 +48,25 @@
 #include <QMediaDevices>
 #include <QAudioSink>
 #include <math.h>
+#include <string.h>
 #include <atomic>
 #include <algorithm>
 #define SOUNDCARD_RATE 48000    // output soundcard sample rate
-#define FILTERQLEVEL_ALPHA 0.001
-#define P_GAIN 2.38e-7      // Proportional gain
-
-#define TRUE 1
-#define FALSE 0
-
-#define TEST_ERROR 1.0
+#define SOUND_MAX_INPUT 8192    // input samples per resampler call
+
+// Rate control: after each soundcard read the ring is held at OUTQ_TARGET
+// frames and the soundcard buffer is asked for SINK_BUFFER_MS, which keeps
+// the total latency under 50 ms.
+// The loop is tuned for a natural frequency of 0.2 rad/s at a damping of 0.7,
+// settling in ~20 s, slow enough that level jitter does not turn into pitch.
+#define OUTQ_TARGET_MS 12
+#define OUTQ_TARGET (SOUNDCARD_RATE * OUTQ_TARGET_MS / 1000)
+#define SINK_BUFFER_MS 20
+#define LEVEL_TAU 1.0                               // s, level filter time constant
+#define RATE_UPDATE_FRAMES (SOUNDCARD_RATE / 10)    // controller period, 100 ms
+#define PI_KP 5.8e-6                                // per frame of level error
+#define PI_KI 8.3e-7                                // per frame second
+#define MAX_CORRECTION 1000e-6                      // +-1000 ppm
 
 // Thread-safe quit flag
 static std::atomic_bool threadQuit{true};
@@ -71,12 +81,25 @@ CSoundOut::CSoundOut(QObject *parent) :
     m_pOutput(nullptr),
     m_UserDataRate(SOUNDCARD_RATE),
     m_OutRatio(1.0),
-    m_RateCorrection(0.0),
+    m_BlockTime(10),
+    m_Channels(2),
+    m_BlockingMode(false),
+    m_StereoOut(true),
     m_Gain(1.0),
+    m_RateCorrection(0.0),
+    m_AveOutQLevel(0.0),
+    m_Integral(0.0),
+    m_RateUpdateCount(0),
+    m_ReportedXruns(0),
     m_Startup(true),
-    m_BlockingMode(false)
+    m_ResetQueue(false),
+    m_SinkFrames(0),
+    m_Underruns(0),
+    m_Overruns(0),
+    m_OutQueue(OUTQSIZE * 2)
 {
-    m_OutResampler.Init(8192);
+    m_OutResampler.Init(SOUND_MAX_INPUT, SOUNDCARD_RATE, SOUNDCARD_RATE);
+    m_ResampleBuf.resize((SOUND_MAX_INPUT + 2) * 2);
 }
 
 CSoundOut::~CSoundOut()
@@ -137,6 +160,7 @@ bool CSoundOut::Start(int OutDevIndx, bool StereoOut, double UsrDataRate, bool B
 {
     long mvolume = 0;
     m_StereoOut = StereoOut;
+    m_Channels = StereoOut ? 2 : 1;
     m_BlockingMode = BlockingMode;
 
     // Get available audio output devices using Qt6 API
@@ -193,8 +217,11 @@ bool CSoundOut::Start(int OutDevIndx, bool StereoOut, double UsrDataRate, bool B
     // Initialize the data queue variables
     m_UserDataRate = 1; // Force user data rate to be changed
     ChangeUserDataRate(UsrDataRate);
+    m_Integral = 0.0;
+    m_RateCorrection = 0.0;
 
-    // Start the audio output
+    // Start the audio output; a short device buffer, the ring does the rest
+    m_pAudioSink->setBufferSize(format.bytesForDuration(SINK_BUFFER_MS * 1000));
     m_pOutput = m_pAudioSink->start();
 
     // Set system volume if using default device
@@ -232,44 +259,31 @@ void CSoundOut::Stop()
     }
 }
 
-/////////////////////////////////////////////////////////////////////
-// Sets/changes user data input rate
-/////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////
 // Resets the output queue and forces a clean startup.
 // Call this after a sample rate change to prevent stale queue data
-// causing choppy audio when the DSP resumes.
+// causing choppy audio when the DSP resumes. Only the soundcard thread
+// may take samples out of the ring, so it empties it on its next read.
 /////////////////////////////////////////////////////////////////////
 void CSoundOut::Reset()
 {
-    QMutexLocker locker(&m_Mutex);
-    for (int i = 0; i < OUTQSIZE; i++) {
-        m_OutQueueMono[i] = 0;
-        m_OutQueueStereo[i].re = 0;
-        m_OutQueueStereo[i].im = 0;
-    }
-    m_OutQHead = 0;
-    m_OutQTail = 0;
-    m_OutQLevel = 0;
-    m_AveOutQLevel = OUTQSIZE / 2;
-    m_Startup = true;
+    m_ResetQueue.store(true, std::memory_order_release);
 }
 
+/////////////////////////////////////////////////////////////////////
+// Sets/changes user data input rate
+/////////////////////////////////////////////////////////////////////
 void CSoundOut::ChangeUserDataRate(double UsrDataRate)
 {
     if (m_UserDataRate != UsrDataRate) {
         m_UserDataRate = UsrDataRate;
-        for (int i = 0; i < OUTQSIZE; i++) {
-            m_OutQueueMono[i] = 0;
-            m_OutQueueStereo[i].re = 0;
-            m_OutQueueStereo[i].im = 0;
-        }
         m_OutRatio = m_UserDataRate / SOUNDCARD_RATE;
-        m_OutQHead = 0;
-        m_OutQTail = 0;
-        m_OutQLevel = 0;
-        m_AveOutQLevel = OUTQSIZE / 2;
-        m_Startup = true;
+        m_OutResampler.Init(SOUND_MAX_INPUT, (int)m_UserDataRate, SOUNDCARD_RATE);
+
+        // room for the most a call can produce with the correction at its limit
+        const int maxframes = (int)(SOUND_MAX_INPUT / (m_OutRatio * (1.0 - MAX_CORRECTION))) + 2;
+        m_ResampleBuf.resize(maxframes * 2);
+        Reset();
     }
     qDebug() << "SoundOutRatio Rate" << (1.0 / m_OutRatio) << m_UserDataRate;
 }
@@ -280,7 +294,6 @@ void CSoundOut::ChangeUserDataRate(double UsrDataRate)
 /////////////////////////////////////////////////////////////////////
 void CSoundOut::SetVolume(qint32 vol)
 {
-    QMutexLocker locker(&m_Mutex);
     if (vol == 0) {
         m_Gain = 0.0;
     } else if (vol <= 99) {
@@ -294,262 +307,160 @@ void CSoundOut::SetVolume(qint32 vol)
     }
 }
 
+double CSoundOut::LatencyMs() const
+{
+    const int frames = m_OutQueue.count() / m_Channels + m_SinkFrames.load(std::memory_order_relaxed);
+    return frames * 1000.0 / SOUNDCARD_RATE;
+}
+
+double CSoundOut::RateCorrectionPpm() const
+{
+    return m_RateCorrection.load(std::memory_order_relaxed) * 1e6;
+}
+
 ////////////////////////////////////////////////////////////////
 // Called by application to put COMPLEX input into
 // STEREO 2 channel soundcard output queue
 ////////////////////////////////////////////////////////////////
-// ... [includes and preamble unchanged] ...
-
-// At the top, add if needed:
-#include <QDateTime>
-
-// ... [rest of your code] ...
-
-void CSoundOut::PutOutQueue(int numsamples, TYPECPX* pData)
+void CSoundOut::PutOutQueue(int numsamples, TYPECPX *pData)
 {
-    TYPESTEREO16 RData[OUTQSIZE];
-    int i;
-    bool overflow = false;
-
-    if ((0 == numsamples) || threadQuit)
+    if ((numsamples <= 0) || threadQuit)
         return;
 
-    // ------- DEBUG: Log input to PutOutQueue -------
-  //  qDebug() << "numsamples in:" << numsamples << "Queue level before:" << m_OutQLevel;
+    const double rate = m_OutRatio * (1.0 + m_RateCorrection.load(std::memory_order_relaxed));
+    const double gain = m_Gain.load(std::memory_order_relaxed);
+    TYPESTEREO16 *out = reinterpret_cast<TYPESTEREO16 *>(m_ResampleBuf.data());
 
-    // Resample
-    int resampled_count = m_OutResampler.Resample(numsamples, TEST_ERROR * m_OutRatio * (1.0 + m_RateCorrection),
-                                                  pData, RData, m_Gain);
+    while (numsamples > 0) {
+        const int n = std::min(numsamples, SOUND_MAX_INPUT);
+        const int frames = m_OutResampler.Resample(n, rate, pData, out, gain);
 
-    // ------- DEBUG: Resampler output stats -------
-    double maxval = 0;
-    for (int j = 0; j < resampled_count; ++j) {
-        double abs_re = static_cast<double>(std::abs(RData[j].re));
-        double abs_im = static_cast<double>(std::abs(RData[j].im));
-        maxval = std::max(maxval, std::max(abs_re, abs_im));
+        Put(m_ResampleBuf.constData(), frames * 2);
+        pData += n;
+        numsamples -= n;
     }
-//    qDebug() << "[PutOutQueue:CPX] Resampler output count:" << resampled_count << "Max abs:" << maxval;
-
-    if (m_BlockingMode) {
-        for (i = 0; i < resampled_count; i++) {
-            while (((m_OutQHead + 1) & (OUTQSIZE - 1)) == m_OutQTail)
-                msleep(10);
-            m_OutQueueStereo[m_OutQHead++] = RData[i];
-            m_OutQHead &= (OUTQSIZE - 1);
-            m_OutQLevel++;
-        }
-    } else {
-        QMutexLocker locker(&m_Mutex);
-        for (i = 0; i < resampled_count; i++) {
-            m_OutQueueStereo[m_OutQHead++] = RData[i];
-            m_OutQHead &= (OUTQSIZE - 1);
-            m_OutQLevel++;
-            if (m_OutQHead == m_OutQTail) {
-                m_OutQTail += OUTQSIZE / 4;
-                m_OutQTail &= (OUTQSIZE - 1);
-                m_OutQLevel -= OUTQSIZE / 4;
-                i = resampled_count;
-                overflow = true;
-            }
-        }
-        if (overflow) {
-            qWarning() << "[PutOutQueue:CPX] Snd Overflow";
-            m_AveOutQLevel = m_OutQLevel;
-        }
-        m_AveOutQLevel = (1.0 - FILTERQLEVEL_ALPHA) * m_AveOutQLevel + FILTERQLEVEL_ALPHA * (double)m_OutQLevel;
-    }
-
-    // ------- DEBUG: Queue level after PutOutQueue -------
-//    qDebug() << "[PutOutQueue:CPX] Queue level after:" << m_OutQLevel;
 }
 
-void CSoundOut::PutOutQueue(int numsamples, TYPEREAL* pData)
+////////////////////////////////////////////////////////////////
+// Called by application to put REAL input into
+// MONO soundcard output queue
+////////////////////////////////////////////////////////////////
+void CSoundOut::PutOutQueue(int numsamples, TYPEREAL *pData)
 {
-    TYPEMONO16 RData[OUTQSIZE];
-    int i;
-    bool overflow = false;
-
-    if ((0 == numsamples) || threadQuit)
+    if ((numsamples <= 0) || threadQuit)
         return;
 
-    // ------- DEBUG: Log input to PutOutQueue -------
- //   qDebug() << "[PutOutQueue:REAL] << "numsamples in:" << numsamples << "Queue level before:" << m_OutQLevel;
+    const double rate = m_OutRatio * (1.0 + m_RateCorrection.load(std::memory_order_relaxed));
+    const double gain = m_Gain.load(std::memory_order_relaxed);
 
-    // Resample
-    int resampled_count = m_OutResampler.Resample(numsamples, TEST_ERROR * m_OutRatio * (1.0 + m_RateCorrection),
-                                                  pData, RData, m_Gain);
+    while (numsamples > 0) {
+        const int n = std::min(numsamples, SOUND_MAX_INPUT);
+        const int frames = m_OutResampler.Resample(n, rate, pData, m_ResampleBuf.data(), gain);
 
-    // ------- DEBUG: Resampler output stats -------
-    double maxval = 0;
-    for (int j = 0; j < resampled_count; ++j)
-        maxval = std::max(maxval, std::abs(static_cast<double>(RData[j])));
-    // qDebug() << "[PutOutQueue:REAL] Resampler output count:" << resampled_count << "Max abs:" << maxval;
+        Put(m_ResampleBuf.constData(), frames);
+        pData += n;
+        numsamples -= n;
+    }
+}
 
+////////////////////////////////////////////////////////////////
+// Stores count samples in the ring. Non-blocking mode never waits:
+// what does not fit is dropped and counted as an overrun.
+////////////////////////////////////////////////////////////////
+void CSoundOut::Put(const qint16 *pData, int count)
+{
     if (m_BlockingMode) {
-        for (i = 0; i < resampled_count; i++) {
-            while (((m_OutQHead + 1) & (OUTQSIZE - 1)) == m_OutQTail)
-                msleep(10);
-            m_OutQueueMono[m_OutQHead++] = RData[i];
-            m_OutQHead &= (OUTQSIZE - 1);
-            m_OutQLevel++;
-        }
-    } else {
-        QMutexLocker locker(&m_Mutex);
-        for (i = 0; i < resampled_count; i++) {
-            m_OutQueueMono[m_OutQHead++] = RData[i];
-            m_OutQHead &= (OUTQSIZE - 1);
-            m_OutQLevel++;
-            if (m_OutQHead == m_OutQTail) {
-                m_OutQTail += OUTQSIZE / 4;
-                m_OutQTail &= (OUTQSIZE - 1);
-                m_OutQLevel -= OUTQSIZE / 4;
-                i = resampled_count;
-                overflow = true;
-            }
+        while (count > 0 && !threadQuit) {
+            const int n = m_OutQueue.write(pData, count);
+            pData += n;
+            count -= n;
+            if (count > 0)
+                msleep(1);
         }
-        if (overflow) {
-            qWarning() << "[PutOutQueue:REAL] Snd Overflow";
-            m_AveOutQLevel = m_OutQLevel;
-        }
-        m_AveOutQLevel = (1.0 - FILTERQLEVEL_ALPHA) * m_AveOutQLevel + FILTERQLEVEL_ALPHA * (double)m_OutQLevel;
+        return;
     }
 
-    // ------- DEBUG: Queue level after PutOutQueue -------
-//    qDebug() << "[PutOutQueue:REAL] Queue level after:" << m_OutQLevel;
+    // the ring only ever holds whole frames, so the part that fits is too
+    if (m_OutQueue.write(pData, count) < count)
+        m_Overruns.fetch_add(1, std::memory_order_relaxed);
 }
 
-void CSoundOut::GetOutQueue(int numsamples, TYPEMONO16* pData)
+////////////////////////////////////////////////////////////////
+// Soundcard thread: fills pData with numframes frames. Plays silence
+// until the read would leave OUTQ_TARGET frames behind, and again after
+// the ring ran dry.
+////////////////////////////////////////////////////////////////
+void CSoundOut::GetOutQueue(int numframes, qint16 *pData)
 {
-    int i;
-    bool underflow = false;
+    const int count = numframes * m_Channels;
 
-    QMutexLocker locker(&m_Mutex);
+    if (m_ResetQueue.exchange(false, std::memory_order_acquire)) {
+        m_OutQueue.read(nullptr, m_OutQueue.count());
+        m_Integral = 0.0;
+        m_RateCorrection = 0.0;
+        m_Startup = true;
+    }
 
     if (m_Startup) {
-        for (i = 0; i < numsamples; i++)
-            pData[i] = 0;
-
-        if (m_OutQLevel > OUTQSIZE / 2) {
-            m_Startup = false;
-            m_RateUpdateCount = -5 * SOUNDCARD_RATE;
-            m_PpmError = 0;
-            m_AveOutQLevel = m_OutQLevel;
-            m_UpdateToggle = true;
-        } else {
+        if (m_OutQueue.count() < (OUTQ_TARGET + numframes) * m_Channels) {
+            memset(pData, 0, count * sizeof(qint16));
             return;
         }
+        // the integral keeps the clock offset learned so far
+        m_Startup = false;
+        m_AveOutQLevel = OUTQ_TARGET;
+        m_RateUpdateCount = 0;
     }
 
-    for (i = 0; i < numsamples; i++) {
-        if (m_OutQHead != m_OutQTail) {
-            pData[i] = m_OutQueueMono[m_OutQTail++];
-            m_OutQTail &= (OUTQSIZE - 1);
-            m_OutQLevel--;
-        } else {
-            // ------- DEBUG: Underflow event -------
-            qWarning() << "[GetOutQueue:MONO] Snd Underflow at" << QDateTime::currentDateTime().toString()
-                       << "Queue level:" << m_OutQLevel;
-            m_OutQTail -= (OUTQSIZE / 4);
-            m_OutQTail &= (OUTQSIZE - 1);
-            pData[i] = m_OutQueueMono[m_OutQTail];
-            m_OutQLevel += (OUTQSIZE / 4);
-            underflow = true;
-        }
-    }
-
-    // ------- DEBUG: Queue status after GetOutQueue -------
-  //  qDebug() << "[GetOutQueue:MONO] Queue level after:" << m_OutQLevel;
-
-    if (m_BlockingMode) return;
-
-    m_AveOutQLevel = (1.0 - FILTERQLEVEL_ALPHA) * m_AveOutQLevel + FILTERQLEVEL_ALPHA * m_OutQLevel;
-
-    if (underflow) {
-        // Additional underflow marker
-        qWarning() << "[GetOutQueue:MONO] Underflow - m_AveOutQLevel reset to" << m_AveOutQLevel;
+    const int n = m_OutQueue.read(pData, count);
+    if (n < count) {
+        memset(pData + n, 0, (count - n) * sizeof(qint16));
+        m_Underruns.fetch_add(1, std::memory_order_relaxed);
+        m_Startup = true;
+        return;
     }
 
-    m_RateUpdateCount += numsamples;
-    if (m_RateUpdateCount >= SOUNDCARD_RATE) {
-        CalcError();
-        m_RateUpdateCount = 0;
-    }
+    // in blocking mode the producer is paced by the ring instead
+    if (!m_BlockingMode)
+        CalcError(numframes);
 }
 
-void CSoundOut::GetOutQueue(int numsamples, TYPESTEREO16* pData)
+////////////////////////////////////////////////////////////////
+// PI control of the ring level, run by the soundcard thread after
+// each read. A level above target means the input clock is fast,
+// so each output sample must consume more input (a larger ratio).
+////////////////////////////////////////////////////////////////
+void CSoundOut::CalcError(int numframes)
 {
-    int i;
-    bool underflow = false;
-
-    QMutexLocker locker(&m_Mutex);
+    // same filter time constant whatever size the soundcard reads
+    const double level = (double)(m_OutQueue.count() / m_Channels);
+    const double alpha = std::min(1.0, numframes / (LEVEL_TAU * SOUNDCARD_RATE));
+    m_AveOutQLevel += alpha * (level - m_AveOutQLevel);
 
-    if (m_Startup) {
-        for (i = 0; i < numsamples; i++) {
-            pData[i].re = 0;
-            pData[i].im = 0;
-        }
-
-        if (m_OutQLevel > OUTQSIZE / 2) {
-            m_Startup = false;
-            m_RateUpdateCount = -5 * SOUNDCARD_RATE;
-            m_PpmError = 0;
-            m_AveOutQLevel = m_OutQLevel;
-            m_UpdateToggle = true;
-        } else {
-            return;
-        }
-    }
-
-    for (i = 0; i < numsamples; i++) {
-        if (m_OutQHead != m_OutQTail) {
-            pData[i] = m_OutQueueStereo[m_OutQTail++];
-            m_OutQTail &= (OUTQSIZE - 1);
-            m_OutQLevel--;
-        } else {
-            // ------- DEBUG: Underflow event -------
-            qWarning() << "[GetOutQueue:STEREO] Snd Underflow at" << QDateTime::currentDateTime().toString()
-                       << "Queue level:" << m_OutQLevel;
-            m_OutQTail -= (OUTQSIZE / 4);
-            m_OutQTail &= (OUTQSIZE - 1);
-            pData[i] = m_OutQueueStereo[m_OutQTail];
-            m_OutQLevel += (OUTQSIZE / 4);
-            underflow = true;
-        }
-    }
-
-    // ------- DEBUG: Queue status after GetOutQueue -------
-  // qDebug() << "[GetOutQueue:STEREO] Queue level after:" << m_OutQLevel;
+    m_RateUpdateCount += numframes;
+    if (m_RateUpdateCount < RATE_UPDATE_FRAMES)
+        return;
 
-    if (m_BlockingMode) return;
+    const double dt = (double)m_RateUpdateCount / SOUNDCARD_RATE;
+    m_RateUpdateCount = 0;
 
-    m_AveOutQLevel = (1.0 - FILTERQLEVEL_ALPHA) * m_AveOutQLevel + FILTERQLEVEL_ALPHA * m_OutQLevel;
+    const double error = m_AveOutQLevel - OUTQ_TARGET;
 
-    if (underflow) {
-        // Additional underflow marker
-        qWarning() << "[GetOutQueue:STEREO] Underflow - m_AveOutQLevel reset to" << m_AveOutQLevel;
-    }
+    // anti-windup: stop integrating while the output is at its limit
+    const double integral = m_Integral + error * dt;
+    double correction = PI_KP * error + PI_KI * integral;
+    if (fabs(correction) < MAX_CORRECTION)
+        m_Integral = integral;
+    else
+        correction = std::clamp(correction, -MAX_CORRECTION, MAX_CORRECTION);
 
-    m_RateUpdateCount += numsamples;
-    if (m_RateUpdateCount >= SOUNDCARD_RATE) {
-        CalcError();
-        m_RateUpdateCount = 0;
-    }
-}
+    m_RateCorrection.store(correction, std::memory_order_relaxed);
 
-////////////////////////////////////////////////////////////////
-// Called alternately from the Get routines to update the
-// error correction process
-////////////////////////////////////////////////////////////////
-void CSoundOut::CalcError()
-{
-    double error;
-    error = (double)(m_AveOutQLevel - OUTQSIZE/2 );	//neg==level is too low  pos == level is to high
-    error = error * P_GAIN;
-    m_RateCorrection = error;
-    m_PpmError = (int)( m_RateCorrection*1e6 );
-    if( abs(m_PpmError) > 500)
-    {
-        qDebug()<<"SoundOut "<<m_PpmError << m_AveOutQLevel;
+    const quint64 xruns = Underruns() + Overruns();
+    if (xruns != m_ReportedXruns) {
+        m_ReportedXruns = xruns;
+        qDebug() << "SoundOut underruns" << Underruns() << "overruns" << Overruns()
+                 << "ppm" << RateCorrectionPpm() << "latency ms" << LatencyMs();
     }
 }
 
@@ -561,19 +472,18 @@ void CSoundOut::run()
         if (m_pAudioSink->state() == QAudio::IdleState ||
             m_pAudioSink->state() == QAudio::ActiveState) {
 
+            const int frameBytes = m_Channels * (int)sizeof(qint16);
             qint64 len = m_pAudioSink->bytesFree();
 
-            if (len > 0) {
+            m_SinkFrames.store((int)((m_pAudioSink->bufferSize() - len) / frameBytes),
+                               std::memory_order_relaxed);
+
+            if (len >= frameBytes) {
                 if (len > SOUND_WRITEBUFSIZE)
                     len = SOUND_WRITEBUFSIZE;
 
-                if (m_StereoOut) {
-                    len &= ~(0x03);
-                    GetOutQueue(len / 4, (TYPESTEREO16*)m_pData);
-                } else {
-                    len &= ~(0x01);
-                    GetOutQueue(len / 2, (TYPEMONO16*)m_pData);
-                }
+                len -= len % frameBytes;
+                GetOutQueue((int)(len / frameBytes), (qint16*)m_pData);
 
                 m_pOutput->write((char*)m_pData, len);
             } else {
@@ -1,11 +1,12 @@
 #pragma once
 
 #include <QThread>
-#include <QMutex>
 #include <QAudioDevice>
 #include <QAudioSink>
 #include <QIODevice>
-#include "fractresampler.h"
+#include <QVector>
+#include "polyphaseresampler.h"
+#include "Util/cusdr_spscQueue.h"
 #include <alsa/asoundlib.h>
 #include <alsa/mixer.h>
 #include <atomic>
@@ -14,9 +15,11 @@
 #define OUTQSIZE 4096
 #define SOUND_WRITEBUFSIZE 4096
 
-// Forward declaration for the resampler class
-class CFractResampler;
-
+// Audio from the DSP thread reaches the soundcard thread through a
+// wait-free single producer / single consumer ring. The soundcard thread
+// keeps the ring at a fixed fill level with a PI controller that trims
+// the resampler ratio, which locks the radio's and the soundcard's clocks
+// together at a latency set by the target instead of by buffer tuning.
 class CSoundOut : public QThread
 {
     Q_OBJECT
@@ -30,16 +33,23 @@ public:
     void ChangeUserDataRate(double UsrDataRate);
     void SetVolume(qint32 vol);
 
+    // producer side, one thread
     void PutOutQueue(int numsamples, TYPECPX *pData);
     void PutOutQueue(int numsamples, TYPEREAL *pData);
 
+    // status, safe from any thread
+    double LatencyMs() const;       // ring + soundcard buffer
+    double RateCorrectionPpm() const;
+    quint64 Underruns() const { return m_Underruns.load(std::memory_order_relaxed); }
+    quint64 Overruns() const  { return m_Overruns.load(std::memory_order_relaxed); }
+
 protected:
     void run() override;
 
 private:
-    void GetOutQueue(int numsamples, TYPEMONO16 *pData);
-    void GetOutQueue(int numsamples, TYPESTEREO16 *pData);
-    void CalcError();
+    void Put(const qint16 *pData, int count);
+    void GetOutQueue(int numframes, qint16 *pData);
+    void CalcError(int numframes);
 
     QObject *m_pParent;
     QAudioDevice m_OutDeviceInfo;  // Qt6 device representation
@@ -48,27 +58,35 @@ private:
 
     double m_UserDataRate;
     double m_OutRatio;
-    double m_RateCorrection;
-    double m_Gain;
-    double m_AveOutQLevel;
     double m_BlockTime;
-    int m_OutQHead, m_OutQTail, m_OutQLevel;
-    int m_RateUpdateCount;
-    int m_PpmError;
-    bool m_Startup;
+    int m_Channels;
     bool m_BlockingMode;
     bool m_StereoOut;
-    bool m_UpdateToggle;
 
-    QMutex m_Mutex;
+    std::atomic<double> m_Gain;
+    std::atomic<double> m_RateCorrection;
+
+    // soundcard thread: rate control
+    double m_AveOutQLevel;
+    double m_Integral;
+    int m_RateUpdateCount;
+    quint64 m_ReportedXruns;
+    bool m_Startup;
+
+    std::atomic<bool> m_ResetQueue;
+    std::atomic<int> m_SinkFrames;
+    std::atomic<quint64> m_Underruns;
+    std::atomic<quint64> m_Overruns;
+
+    // Output queue: interleaved 16 bit samples, m_Channels per frame
+    QHSpscBuffer<qint16> m_OutQueue;
 
-    // Output Queues
-    TYPEMONO16 m_OutQueueMono[OUTQSIZE];
-    TYPESTEREO16 m_OutQueueStereo[OUTQSIZE];
+    // resampler output, one call's worth
+    QVector<qint16> m_ResampleBuf;
 
     // Data buffer for audio writes
     char m_pData[SOUND_WRITEBUFSIZE];
 
     // Resampler
-    CFractResampler m_OutResampler;
+    CPolyphaseResampler m_OutResampler;
 };
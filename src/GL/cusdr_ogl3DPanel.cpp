@@ -7,6 +7,8 @@
 */
 
 #include "cusdr_ogl3DPanel.h"
+#include "Util/cusdr_displayScheduler.h"
+#include "Util/cusdr_spectrumDecimate.h"
 
 #include <QGuiApplication>
 #include <QDebug>
@@ -20,6 +22,7 @@
 // Static constants definition
 const int QGL3DPanel::MAX_TIME_SLICES;
 const int QGL3DPanel::MAX_FREQ_BINS;
+const int QGL3DPanel::MAX_HEIGHTMAP_COLUMNS;
 
 QGL3DPanel::QGL3DPanel(QWidget *parent, int rx)
     : QOpenGLWidget(parent)
@@ -29,6 +32,14 @@ QGL3DPanel::QGL3DPanel(QWidget *parent, int rx)
     , m_vfoFrequency(set->getVfoFrequency(m_receiver))
     , m_sampleRate(set->getSampleRate())
     , m_shaderProgram(nullptr)
+    , m_heightmapProgram(nullptr)
+    , m_heightmapTextureId(0)
+    , m_heightmapVertexBuffer(nullptr)
+    , m_heightmapIndexBuffer(nullptr)
+    , m_heightmapVAO(nullptr)
+    , m_heightmapColumns(0)
+    , m_heightmapTopRow(0)
+    , m_heightmapRows(0)
     , m_gridVertexBuffer(nullptr)
     , m_gridVAO(nullptr)
     , m_gridVertexCount(0)
@@ -66,17 +77,15 @@ QGL3DPanel::QGL3DPanel(QWidget *parent, int rx)
     , m_dataUpdateCount(0)
     , m_meshUpdateCount(0)
     , m_lastDebugTime(0)
-    , m_meshWorker(nullptr)
 {
     // Initialize camera target and up vector
     m_cameraTarget = QVector3D(0, 0, 0);
     m_cameraUp = QVector3D(0, 1, 0);
-    
-    // Create and start mesh generation worker thread with high priority
-    m_meshWorker = new MeshGeneratorWorker(this);
-    connect(m_meshWorker, &MeshGeneratorWorker::meshReady, 
-            this, &QGL3DPanel::onMeshReady, Qt::QueuedConnection);
-    m_meshWorker->start(QThread::HighPriority);  // Run at higher priority for responsive mesh updates
+
+    // the receiver's spectrum is computed, and sent as spectrumBufferChanged,
+    // while this panel is on screen
+    CDisplayScheduler::instance()->addDisplay(this, CDisplayScheduler::Receiver0 + m_receiver);
+    CDisplayScheduler::instance()->addDisplay(this, CDisplayScheduler::ReceiverSignal0 + m_receiver);
 
     // Get dBm scale from receiver panadapter settings (same as 2D panel)
     QList<TReceiver> m_rxDataList = set->getReceiverDataList();
@@ -91,9 +100,9 @@ QGL3DPanel::QGL3DPanel(QWidget *parent, int rx)
         this, &QGL3DPanel::dBmScaleMinChanged);
 
 
-    // Initialize spectrum history
-    m_spectrumHistory.reserve(MAX_TIME_SLICES);
+    // Initialize spectrum buffers
     m_currentSpectrum.resize(m_spectrumWidth);
+    m_pendingSlice.reserve(MAX_HEIGHTMAP_COLUMNS);
     
     // Initialize camera position from spherical coordinates
     updateCamera();
@@ -128,31 +137,29 @@ QGL3DPanel::QGL3DPanel(QWidget *parent, int rx)
 }
 
 QGL3DPanel::~QGL3DPanel() {
-    // Stop worker thread first
-    if (m_meshWorker) {
-        m_meshWorker->stop();
-        m_meshWorker->wait();
-        delete m_meshWorker;
+    CDisplayScheduler::instance()->removeDisplay(this);
+
+    makeCurrent();
+    
+    // Clean up the spectrum heightmap
+    if (m_heightmapVAO) {
+        m_heightmapVAO->destroy();
+        delete m_heightmapVAO;
     }
     
-    makeCurrent();
+    if (m_heightmapVertexBuffer) {
+        m_heightmapVertexBuffer->destroy();
+        delete m_heightmapVertexBuffer;
+    }
     
-    // Clean up all time slice meshes
-    for (TimeSliceMesh& slice : m_timeSliceMeshes) {
-        if (slice.vao) {
-            slice.vao->destroy();
-            delete slice.vao;
-        }
-        if (slice.vertexBuffer) {
-            slice.vertexBuffer->destroy();
-            delete slice.vertexBuffer;
-        }
-        if (slice.indexBuffer) {
-            slice.indexBuffer->destroy();
-            delete slice.indexBuffer;
-        }
+    if (m_heightmapIndexBuffer) {
+        m_heightmapIndexBuffer->destroy();
+        delete m_heightmapIndexBuffer;
+    }
+    
+    if (m_heightmapTextureId) {
+        glDeleteTextures(1, &m_heightmapTextureId);
     }
-    m_timeSliceMeshes.clear();
     
     // Clean up grid resources
     if (m_gridVAO) {
@@ -166,6 +173,7 @@ QGL3DPanel::~QGL3DPanel() {
     }
     
     delete m_shaderProgram;
+    delete m_heightmapProgram;
     delete m_oglTextSmall;
     
     doneCurrent();
@@ -268,11 +276,175 @@ void QGL3DPanel::setupShaders() {
         qDebug() << "Failed to link shader program:" << m_shaderProgram->log();
         return;
     }
+    
+    m_heightmapProgram = new QOpenGLShaderProgram();
+    
+    // Heightmap vertex shader: a grid vertex carries only its (column, age).
+    // Its amplitude is fetched from the ring texture and turned into height
+    // and color here, so the dBm range, the color offset and the scales apply
+    // to the whole history at once.
+    const char* heightmapVertexShaderSource = R"(
+        #version 330 core
+        layout(location = 0) in vec2 gridPos;
+        
+        uniform sampler2D heightmap;
+        uniform mat4 mvpMatrix;
+        uniform int columns;
+        uniform int textureRows;
+        uniform int topRow;         // texture row of the newest slice
+        uniform float heightScale;
+        uniform float freqScale;
+        uniform float sliceDepth;
+        uniform float frontZ;
+        uniform float dBmMin;
+        uniform float dBmMax;
+        uniform float colorOffset;
+        
+        out vec3 fragColor;
+        out vec3 worldPos;
+        
+        // Enhanced waterfall colors, as amplitudeToColor() on the CPU
+        vec3 amplitudeToColor(float amplitude) {
+            float lowerThreshold = -160.0 + colorOffset;
+            float upperThreshold = -80.0 + colorOffset;
+            
+            if (amplitude <= lowerThreshold) return vec3(0.0, 0.0, 20.0 / 255.0);
+            if (amplitude >= upperThreshold) return vec3(1.0);
+            
+            float globalRange = (amplitude - lowerThreshold) / (upperThreshold - lowerThreshold);
+            
+            if (globalRange < 2.0/9.0)  // background to blue
+                return vec3(0.0, 0.0, (20.0 + globalRange * 4.5 * 235.0) / 255.0);
+            if (globalRange < 3.0/9.0)  // blue to blue-green
+                return vec3(0.0, (globalRange - 2.0/9.0) * 9.0, 1.0);
+            if (globalRange < 4.0/9.0)  // blue-green to green
+                return vec3(0.0, 1.0, 1.0 - (globalRange - 3.0/9.0) * 9.0);
+            if (globalRange < 5.0/9.0)  // green to red-green
+                return vec3((globalRange - 4.0/9.0) * 9.0, 1.0, 0.0);
+            if (globalRange < 7.0/9.0)  // red-green to red
+                return vec3(1.0, 1.0 - (globalRange - 5.0/9.0) * 4.5, 0.0);
+            if (globalRange < 8.0/9.0)  // red to red-blue
+                return vec3(1.0, 0.0, (globalRange - 7.0/9.0) * 9.0);
+            
+            float localRange = (globalRange - 8.0/9.0) * 9.0;  // red-blue to purple end
+            return vec3(0.75 + 0.25 * (1.0 - localRange), localRange * 0.5, 1.0);
+        }
+        
+        void main() {
+            int column = int(gridPos.x);
+            int age = int(gridPos.y);
+            float amplitude = texelFetch(heightmap, ivec2(column, (topRow + age) % textureRows), 0).r;
+            
+            // dBmMin at y = 0, dBmMax at y = 40, newest slice at the front
+            float x = (float(column) / float(columns) * 400.0 - 200.0) * freqScale;
+            float y = (amplitude - dBmMin) / (dBmMax - dBmMin) * 40.0 * heightScale;
+            float z = frontZ - float(age) * sliceDepth;
+            
+            worldPos = vec3(x, y, z);
+            gl_Position = mvpMatrix * vec4(worldPos, 1.0);
+            fragColor = amplitudeToColor(amplitude);
+        }
+    )";
+    
+    if (!m_heightmapProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, heightmapVertexShaderSource)) {
+        qDebug() << "Failed to compile heightmap vertex shader:" << m_heightmapProgram->log();
+        return;
+    }
+    
+    if (!m_heightmapProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)) {
+        qDebug() << "Failed to compile heightmap fragment shader:" << m_heightmapProgram->log();
+        return;
+    }
+    
+    if (!m_heightmapProgram->link()) {
+        qDebug() << "Failed to link heightmap shader program:" << m_heightmapProgram->log();
+        return;
+    }
 }
 
 void QGL3DPanel::setupMesh() {
-    // Per-slice rendering - meshes created dynamically as new spectra arrive
-    // No initial setup needed
+    // The spectrum surface is one VAO with a (column, age) vertex buffer and
+    // an index buffer; texture and buffers are sized by setupHeightmap() once
+    // the first slice arrives. The default format is a compatibility context,
+    // where a draw needs attribute 0 enabled, so the grid position is a real
+    // attribute rather than derived from gl_VertexID.
+    m_heightmapVAO = new QOpenGLVertexArrayObject();
+    m_heightmapVAO->create();
+    
+    m_heightmapVertexBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    m_heightmapVertexBuffer->create();
+    m_heightmapVertexBuffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+    
+    m_heightmapIndexBuffer = new QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
+    m_heightmapIndexBuffer->create();
+    m_heightmapIndexBuffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+}
+
+// The spectrum history lives in one GL_R32F texture, columns wide and
+// MAX_TIME_SLICES high, used as a ring of rows like the receiver panel's
+// waterfall: a new slice overwrites the oldest row with glTexSubImage2D and
+// becomes m_heightmapTopRow. The grid mesh is indexed by (age, column) and
+// never changes, so a slice costs one row upload and no buffer traffic.
+// Only a change of the spectrum width reallocates both and restarts the
+// history.
+void QGL3DPanel::setupHeightmap(int columns) {
+    if (m_heightmapTextureId == 0) {
+        glGenTextures(1, &m_heightmapTextureId);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, m_heightmapTextureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // rows are written before they are drawn, no need to clear them
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, columns, MAX_TIME_SLICES, 0, GL_RED, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // Vertex (age, column) sits at index age * columns + column
+    QVector<GLfloat> gridPositions;
+    gridPositions.reserve(MAX_TIME_SLICES * columns * 2);
+    
+    for (int age = 0; age < MAX_TIME_SLICES; age++) {
+        for (int column = 0; column < columns; column++) {
+            gridPositions << column << age;
+        }
+    }
+    
+    // Two triangles per cell, ordered from the newest slice back, so the
+    // first (rows - 1) * (columns - 1) * 6 indices draw the filled rows
+    QVector<GLuint> indices;
+    indices.reserve((MAX_TIME_SLICES - 1) * (columns - 1) * 6);
+    
+    for (int age = 0; age < MAX_TIME_SLICES - 1; age++) {
+        for (int column = 0; column < columns - 1; column++) {
+            GLuint i0 = age * columns + column;     // front edge
+            GLuint i1 = i0 + 1;
+            GLuint i2 = i0 + columns;               // back edge, one slice older
+            GLuint i3 = i2 + 1;
+            
+            indices << i0 << i1 << i2;
+            indices << i1 << i3 << i2;
+        }
+    }
+    
+    // The index buffer binding is VAO state: release the VAO before the buffer
+    m_heightmapVAO->bind();
+    
+    m_heightmapVertexBuffer->bind();
+    m_heightmapVertexBuffer->allocate(gridPositions.constData(), gridPositions.size() * sizeof(GLfloat));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+    
+    m_heightmapIndexBuffer->bind();
+    m_heightmapIndexBuffer->allocate(indices.constData(), indices.size() * sizeof(GLuint));
+    m_heightmapVAO->release();
+    m_heightmapIndexBuffer->release();
+    m_heightmapVertexBuffer->release();
+    
+    m_heightmapColumns = columns;
+    m_heightmapTopRow = 0;
+    m_heightmapRows = 0;
 }
 
 void QGL3DPanel::setupGrid() {
@@ -346,50 +518,26 @@ void QGL3DPanel::setupGrid() {
     m_gridVAO->release();
 }
 
-void QGL3DPanel::updateMesh() {
-    if (!m_newSliceAvailable || m_spectrumHistory.isEmpty() || !m_meshWorker) return;
+void QGL3DPanel::uploadSlice() {
+    if (!m_newSliceAvailable || m_pendingSlice.size() < 2) return;
     
-    // Skip if worker is still busy processing previous mesh
-    if (m_meshWorker->isBusy()) {
-        return;
+    // A new spectrum width starts a new history
+    if (m_pendingSlice.size() != m_heightmapColumns) {
+        setupHeightmap(m_pendingSlice.size());
     }
     
-    // Calculate LOD level based on camera distance
-    int lodLevel = calculateLODLevel();
-    
-    // Get the newest spectrum slice (index 0 is newest)
-    const QVector<float>& newestSlice = m_spectrumHistory.first();
+    // The oldest row becomes the newest
+    m_heightmapTopRow = (m_heightmapTopRow + MAX_TIME_SLICES - 1) % MAX_TIME_SLICES;
     
-    // Request mesh generation for just this one slice
-    m_meshWorker->generateSingleSliceMesh(newestSlice,
-                                          m_timeSliceMeshes.size(),  // Time index
-                                          m_spectrumWidth,
-                                          lodLevel,
-                                          m_heightScale,
-                                          m_frequencyScale,
-                                          m_timeScale,
-                                          m_waterfallOffset,
-                                          m_dBmPanMin,
-                                          m_dBmPanMax);
+    glBindTexture(GL_TEXTURE_2D, m_heightmapTextureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_heightmapTopRow, m_heightmapColumns, 1,
+                    GL_RED, GL_FLOAT, m_pendingSlice.constData());
+    glBindTexture(GL_TEXTURE_2D, 0);
     
+    m_heightmapRows = qMin(m_heightmapRows + 1, MAX_TIME_SLICES);
     m_newSliceAvailable = false;
 }
 
-void QGL3DPanel::onMeshReady(const MeshGeneratorWorker::MeshData& meshData) {
-    // This slot is called on the main thread when mesh generation is complete
-    
-    // Clean up old slices BEFORE adding new one if we're at capacity
-    if (m_timeSliceMeshes.size() >= MAX_TIME_SLICES) {
-        cleanupOldSlices();
-    }
-    
-    // Add the new slice to our collection
-    addNewSliceMesh(meshData);
-    
-    // Trigger repaint with new mesh
-    update();
-}
-
 void QGL3DPanel::paintGL() {
     // Frame counting for FPS calculation
     m_frameCount++;
@@ -400,9 +548,9 @@ void QGL3DPanel::paintGL() {
     // Update camera matrix (this should always work for mouse interaction)
     updateCamera();
     
-    // Update mesh when new slice available
+    // Upload the newest slice into the heightmap
     if (m_newSliceAvailable) {
-        updateMesh();
+        uploadSlice();
     }
     
     // Render 3D spectrum
@@ -417,13 +565,30 @@ void QGL3DPanel::paintGL() {
 }
 
 void QGL3DPanel::renderSpectrum3D() {
-    if (!m_shaderProgram || m_timeSliceMeshes.isEmpty()) return;
-    
-    // Bind shader program once
-    m_shaderProgram->bind();
-    
-    // Set base uniforms
-    m_shaderProgram->setUniformValue("heightScale", m_heightScale);
+    if (!m_heightmapProgram || !m_heightmapProgram->isLinked() || m_heightmapRows < 2) return;
+    
+    // Bind shader program and the heightmap
+    m_heightmapProgram->bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_heightmapTextureId);
+    
+    // Newest slice (age 0) at the front, older slices recede backward,
+    // the whole waterfall centered around Z=0
+    float sliceDepth = 4.0f * m_timeScale;
+    float centerOffset = (m_heightmapRows - 1) * sliceDepth / 2.0f;
+    
+    m_heightmapProgram->setUniformValue("heightmap", 0);
+    m_heightmapProgram->setUniformValue("mvpMatrix", m_projectionMatrix * m_viewMatrix * m_modelMatrix);
+    m_heightmapProgram->setUniformValue("columns", m_heightmapColumns);
+    m_heightmapProgram->setUniformValue("textureRows", MAX_TIME_SLICES);
+    m_heightmapProgram->setUniformValue("topRow", m_heightmapTopRow);
+    m_heightmapProgram->setUniformValue("heightScale", m_heightScale);
+    m_heightmapProgram->setUniformValue("freqScale", m_frequencyScale);
+    m_heightmapProgram->setUniformValue("sliceDepth", sliceDepth);
+    m_heightmapProgram->setUniformValue("frontZ", centerOffset);
+    m_heightmapProgram->setUniformValue("dBmMin", (GLfloat)m_dBmPanMin);
+    m_heightmapProgram->setUniformValue("dBmMax", (GLfloat)m_dBmPanMax);
+    m_heightmapProgram->setUniformValue("colorOffset", m_waterfallOffset);
     
     // Set polygon mode
     if (m_showWireframe) {
@@ -432,43 +597,20 @@ void QGL3DPanel::renderSpectrum3D() {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
     
-    // Render each time slice with individual translation
-    // Newer slices (index 0) are at front, older slices recede backward
-    // Center the entire waterfall display around Z=0
-    int numSlices = m_timeSliceMeshes.size();
-    float totalDepth = (numSlices - 1) * 4.0f * m_timeScale;
-    float centerOffset = totalDepth / 2.0f;  // Offset to center around Z=0
-    
-    for (int i = 0; i < numSlices; i++) {
-        // Simple visibility culling - skip slices that are definitely off-screen
-        if (!isSliceVisible(i)) {
-            continue;
-        }
-        
-        const TimeSliceMesh& slice = m_timeSliceMeshes[i];
-        
-        // Create model matrix with Z offset for this slice
-        // Index 0 is newest (at centerOffset), higher indices recede backward
-        QMatrix4x4 sliceModel = m_modelMatrix;
-        float zOffset = centerOffset - (float)i * 4.0f * m_timeScale;
-        sliceModel.translate(0.0f, 0.0f, zOffset);
-        
-        // Set MVP for this slice
-        QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * sliceModel;
-        m_shaderProgram->setUniformValue("mvpMatrix", mvpMatrix);
-        
-        // Bind this slice's VAO and render
-        slice.vao->bind();
-        glDrawElements(GL_TRIANGLES, slice.indexCount, GL_UNSIGNED_INT, 0);
-        slice.vao->release();
-    }
+    // One draw for the filled rows of the static grid
+    int indexCount = (m_heightmapRows - 1) * (m_heightmapColumns - 1) * 6;
+    
+    m_heightmapVAO->bind();
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
+    m_heightmapVAO->release();
     
     // Reset polygon mode
     if (m_showWireframe) {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
     
-    m_shaderProgram->release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_heightmapProgram->release();
 }
 
 void QGL3DPanel::renderGrid() {
@@ -602,7 +744,10 @@ void QGL3DPanel::renderVerticalScale() {
     // Calculate MVP matrix for 3D to screen conversion
     QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
     
-    // Render labels for major ticks only
+    // Render labels for major ticks only, in one draw call
+    m_oglTextSmall->setColor(Qt::white);
+    m_oglTextSmall->begin();
+    
     // Note: m_dBmPanMax (e.g., -40) is GREATER than m_dBmPanMin (e.g., -140)
     // So we need to iterate from max down to min (stepping by -20)
     for (int db = (int)m_dBmPanMax; db >= (int)m_dBmPanMin; db -= 20) {
@@ -623,7 +768,6 @@ void QGL3DPanel::renderVerticalScale() {
             // Only render if on screen
             if (screenX >= -100 && screenX < width() + 100 && screenY >= -100 && screenY < height() + 100) {
                 QString label = QString("%1").arg(db);
-                glColor3f(1.0f, 1.0f, 1.0f);
                 m_oglTextSmall->renderText(screenX, screenY, 1.0f, label);
             }
         }
@@ -638,11 +782,12 @@ void QGL3DPanel::renderVerticalScale() {
         float topScreenY = (1.0f - topNdcPos.y()) * 0.5f * height();
         
         if (topScreenX >= -100 && topScreenX < width() + 100 && topScreenY >= -100 && topScreenY < height() + 100) {
-            glColor3f(1.0f, 1.0f, 1.0f);
             m_oglTextSmall->renderText(topScreenX, topScreenY, 1.0f, "dBm");
         }
     }
     
+    m_oglTextSmall->end();
+    
     // Restore matrices
     glMatrixMode(GL_PROJECTION);
     glPopMatrix();
@@ -688,7 +833,7 @@ void QGL3DPanel::calculateVisibleRange(int& minTimeSlice, int& maxTimeSlice, int
     // Calculate view-projection matrix
     QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
     
-    int totalTimeSlices = qMin(m_spectrumHistory.size(), MAX_TIME_SLICES);
+    int totalTimeSlices = m_heightmapRows;
     
     // Mesh bounds in world space:
     // X: -200*freqScale to +200*freqScale
@@ -952,15 +1097,14 @@ void QGL3DPanel::setSpectrumData(const QVector<float>& spectrumData) {
     m_spectrumWidth = spectrumData.size();
     m_dataUpdateCount++;
     
-    // Add incoming spectrum to history
-    m_spectrumHistory.prepend(spectrumData);
-    if (m_spectrumHistory.size() > MAX_TIME_SLICES) {
-        m_spectrumHistory.removeLast();
-    }
-    
-    // Throttle mesh generation for new slices
+    // Throttle new slices; the newest one is uploaded by the next paintGL
     qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    if (currentTime - m_lastUpdateTime >= m_updateFrequencyMs) {
+    if (currentTime - m_lastUpdateTime >= m_updateFrequencyMs && m_spectrumWidth > 0) {
+        // Peak-preserving decimation to at most MAX_HEIGHTMAP_COLUMNS
+        int columns = qMin(m_spectrumWidth, MAX_HEIGHTMAP_COLUMNS);
+        m_pendingSlice.resize(columns);
+        decimatePeak(spectrumData.constData(), m_spectrumWidth, m_pendingSlice.data(), columns);
+        
         m_newSliceAvailable = true;
         m_lastUpdateTime = currentTime;
         m_meshUpdateCount++;
@@ -1050,90 +1194,12 @@ QColor QGL3DPanel::amplitudeToColor(float amplitude) {
     return color;
 }
 
-QColor QGL3DPanel::amplitudeToColorWithOffset(float amplitude, float offset) {
-    // Use the same Enhanced waterfall color algorithm as the RX panel
-    // This matches the getWaterfallColorAtPixel() Enhanced mode
-    
-    // Adjust the dB range and apply provided offset for color mapping
-    float lowerThreshold = -160.0f + offset;  // User-adjustable minimum color level
-    float upperThreshold = -80.0f + offset;   // Upper end adjusts with offset
-    
-    QColor color;
-    int r, g, b;
-    
-    if (amplitude <= lowerThreshold) {
-        // Use black/dark blue for lowest signals
-        color = QColor(0, 0, 20);
-    }
-    else if (amplitude >= upperThreshold) {
-        // White for highest signals  
-        color = QColor(255, 255, 255);
-    }
-    else {
-        // Enhanced waterfall color algorithm - exact copy from RX panel
-        float offset_amp = amplitude - lowerThreshold;
-        float globalRange = offset_amp / (upperThreshold - lowerThreshold);
-        
-        if (globalRange < 2.0f/9.0f) { // background to blue
-            float localRange = globalRange / (2.0f/9.0f);
-            r = (int)((1.0f - localRange) * 0);
-            g = (int)((1.0f - localRange) * 0);
-            b = (int)(20 + localRange * (255 - 20));
-        }
-        else if (globalRange < 3.0f/9.0f) { // blue to blue-green
-            float localRange = (globalRange - 2.0f/9.0f) / (1.0f/9.0f);
-            r = 0;
-            g = (int)(localRange * 255);
-            b = 255;
-        }
-        else if (globalRange < 4.0f/9.0f) { // blue-green to green
-            float localRange = (globalRange - 3.0f/9.0f) / (1.0f/9.0f);
-            r = 0;
-            g = 255;
-            b = (int)((1.0f - localRange) * 255);
-        }
-        else if (globalRange < 5.0f/9.0f) { // green to red-green
-            float localRange = (globalRange - 4.0f/9.0f) / (1.0f/9.0f);
-            r = (int)(localRange * 255);
-            g = 255;
-            b = 0;
-        }
-        else if (globalRange < 7.0f/9.0f) { // red-green to red
-            float localRange = (globalRange - 5.0f/9.0f) / (2.0f/9.0f);
-            r = 255;
-            g = (int)((1.0f - localRange) * 255);
-            b = 0;
-        }
-        else if (globalRange < 8.0f/9.0f) { // red to red-blue
-            float localRange = (globalRange - 7.0f/9.0f) / (1.0f/9.0f);
-            r = 255;
-            g = 0;
-            b = (int)(localRange * 255);
-        }
-        else { // red-blue to purple end
-            float localRange = (globalRange - 8.0f/9.0f) / (1.0f/9.0f);
-            r = (int)((0.75f + 0.25f * (1.0f - localRange)) * 255);
-            g = (int)(localRange * 255 * 0.5f);
-            b = 255;
-        }
-        
-        // Clamp values - no intensity reduction, keep original colors
-        r = qBound(0, r, 255);
-        g = qBound(0, g, 255);
-        b = qBound(0, b, 255);
-        
-        color = QColor(r, g, b);
-    }
-    
-    return color;
-}
-
 void QGL3DPanel::qglColor(QColor color) {
     glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
 }
 
 void QGL3DPanel::onUpdateTimer() {
-    // With per-slice rendering, just trigger repaints for smooth animation
+    // Slices are uploaded in paintGL, just trigger repaints for smooth animation
     if (m_isVisible) {
         update();
     }
@@ -1186,7 +1252,7 @@ void QGL3DPanel::updateDisplay() {
 
 // Performance optimization methods
 void QGL3DPanel::performUpdate() {
-    // With per-slice rendering, updates happen automatically when new data arrives
+    // Slices are uploaded in paintGL as new data arrives
     // This timer just triggers redraws for smooth animation
     if (m_isVisible) {
         update();
@@ -1260,106 +1326,3 @@ void QGL3DPanel::setWaterfallOffset(float offset) {
     // Trigger a color update for the waterfall
     update();
 }
-
-int QGL3DPanel::calculateLODLevel() const {
-    // Calculate LOD based on camera distance
-    // LOD 0 = full detail, LOD 1 = half, LOD 2 = quarter
-    if (m_cameraDistance > 250.0f) {
-        return 2;  // Quarter resolution when far away
-    } else if (m_cameraDistance > 150.0f) {
-        return 1;  // Half resolution at medium distance
-    }
-    return 0;  // Full resolution when close
-}
-
-bool QGL3DPanel::isSliceVisible(int sliceIndex) const {
-    Q_UNUSED(sliceIndex)
-    
-    // Simple visibility check - could be enhanced with proper frustum culling
-    // For now, just check if slice is within reasonable bounds
-    
-    // Always render if we have few slices
-    if (m_timeSliceMeshes.size() < 20) {
-        return true;
-    }
-    
-    // When we have many slices, we could cull based on camera view
-    // For now, render all slices (this is still much faster than regenerating)
-    return true;
-}
-
-void QGL3DPanel::cleanupOldSlices() {
-    // Remove oldest slices when we exceed maximum
-    while (m_timeSliceMeshes.size() > MAX_TIME_SLICES) {
-        TimeSliceMesh& oldSlice = m_timeSliceMeshes.last();
-        
-        // Ensure we have OpenGL context
-        makeCurrent();
-        
-        // Destroy OpenGL resources
-        if (oldSlice.vao) {
-            oldSlice.vao->destroy();
-            delete oldSlice.vao;
-        }
-        if (oldSlice.vertexBuffer) {
-            oldSlice.vertexBuffer->destroy();
-            delete oldSlice.vertexBuffer;
-        }
-        if (oldSlice.indexBuffer) {
-            oldSlice.indexBuffer->destroy();
-            delete oldSlice.indexBuffer;
-        }
-        
-        doneCurrent();
-        
-        m_timeSliceMeshes.removeLast();
-    }
-}
-
-void QGL3DPanel::addNewSliceMesh(const MeshGeneratorWorker::MeshData& meshData) {
-    makeCurrent();  // Ensure we have OpenGL context
-    
-    TimeSliceMesh newSlice;
-    
-    // Create VAO
-    newSlice.vao = new QOpenGLVertexArrayObject();
-    newSlice.vao->create();
-    newSlice.vao->bind();
-    
-    // Create and fill vertex buffer
-    newSlice.vertexBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-    newSlice.vertexBuffer->create();
-    newSlice.vertexBuffer->bind();
-    newSlice.vertexBuffer->allocate(meshData.vertices.constData(), 
-                                     meshData.vertices.size() * sizeof(float));
-    
-    // Create and fill index buffer
-    newSlice.indexBuffer = new QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-    newSlice.indexBuffer->create();
-    newSlice.indexBuffer->bind();
-    newSlice.indexBuffer->allocate(meshData.indices.constData(), 
-                                    meshData.indices.size() * sizeof(unsigned int));
-    
-    // Setup vertex attributes (must match shader)
-    m_shaderProgram->bind();
-    m_shaderProgram->enableAttributeArray(0);  // position
-    m_shaderProgram->setAttributeBuffer(0, GL_FLOAT, 0, 3, 6 * sizeof(float));
-    
-    m_shaderProgram->enableAttributeArray(1);  // color
-    m_shaderProgram->setAttributeBuffer(1, GL_FLOAT, 3 * sizeof(float), 3, 6 * sizeof(float));
-    m_shaderProgram->release();
-    
-    newSlice.vao->release();
-    
-    // Store metadata
-    newSlice.vertexCount = meshData.vertexCount;
-    newSlice.indexCount = meshData.indexCount;
-    newSlice.timeIndex = 0;  // Always at front
-    newSlice.lodLevel = calculateLODLevel();
-    
-    // Add to FRONT of collection (index 0 = newest)
-    // This pushes all old slices backward in the array
-    m_timeSliceMeshes.prepend(newSlice);
-    
-    doneCurrent();
-}
@@ -32,7 +32,6 @@
 #include "cusdr_settings.h"
 #include "cusdr_fonts.h"
 #include "cusdr_oglText.h"
-#include "cusdr_meshGeneratorWorker.h"
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
@@ -92,8 +91,9 @@ private:
     // Core rendering
     void setupShaders();
     void setupMesh();
+    void setupHeightmap(int columns);
     void setupGrid();
-    void updateMesh();
+    void uploadSlice();
     void renderSpectrum3D();
     void renderGrid();
     void renderAxes();
@@ -107,12 +107,7 @@ private:
     // Utility functions
     QVector3D spectrumToWorld(int freqBin, float amplitude, int timeSlice);
     QColor amplitudeToColor(float amplitude);
-    QColor amplitudeToColorWithOffset(float amplitude, float offset);
     void qglColor(QColor color);
-    void cleanupOldSlices();
-    void addNewSliceMesh(const MeshGeneratorWorker::MeshData& meshData);
-    int calculateLODLevel() const;
-    bool isSliceVisible(int sliceIndex) const;
     void calculateVisibleRange(int& minTimeSlice, int& maxTimeSlice, int& minFreqBin, int& maxFreqBin);
 
 private slots:
@@ -128,20 +123,19 @@ private:
     long m_vfoFrequency;
     float m_sampleRate;
     
-    // Per-slice mesh structure for efficient rendering
-    struct TimeSliceMesh {
-        QOpenGLBuffer* vertexBuffer;
-        QOpenGLBuffer* indexBuffer;
-        QOpenGLVertexArrayObject* vao;
-        int vertexCount;
-        int indexCount;
-        int timeIndex;  // Position in history (0 = newest)
-        int lodLevel;   // 0=full, 1=half, 2=quarter detail
-    };
-    
     // 3D Rendering infrastructure
-    QOpenGLShaderProgram* m_shaderProgram;
-    QVector<TimeSliceMesh> m_timeSliceMeshes;  // One mesh per time slice
+    QOpenGLShaderProgram* m_shaderProgram;      // grid and scale lines
+    QOpenGLShaderProgram* m_heightmapProgram;   // spectrum surface
+    
+    // Spectrum history: one float texture of MAX_TIME_SLICES rows used as a
+    // ring, drawn by one static grid mesh displaced in the vertex shader
+    GLuint m_heightmapTextureId;
+    QOpenGLBuffer* m_heightmapVertexBuffer;     // (column, age) per grid vertex
+    QOpenGLBuffer* m_heightmapIndexBuffer;
+    QOpenGLVertexArrayObject* m_heightmapVAO;
+    int m_heightmapColumns;     // texture width, 0 until allocated
+    int m_heightmapTopRow;      // texture row holding the newest slice
+    int m_heightmapRows;        // slices written since the texture was allocated
     
     // Grid rendering
     QOpenGLBuffer* m_gridVertexBuffer;
@@ -169,13 +163,14 @@ private:
     // Spectrum data management
     static const int MAX_TIME_SLICES = 300;  // Reduced for better real-time performance (was 300)
     static const int MAX_FREQ_BINS = 8192;  // Increased to handle 4096+ samples
-    QVector<QVector<float>> m_spectrumHistory;
+    static const int MAX_HEIGHTMAP_COLUMNS = 2048;  // wider spectra are peak-decimated
     QVector<float> m_currentSpectrum;
+    QVector<float> m_pendingSlice;  // decimated newest spectrum, uploaded in paintGL
     int m_spectrumWidth;
     int m_currentTimeSlice;
     
-    // Mesh update flags
-    bool m_newSliceAvailable;  // Flag indicating new spectrum slice needs mesh generation
+    // Texture update flags
+    bool m_newSliceAvailable;  // Flag indicating m_pendingSlice needs uploading
     
     // Performance optimization
     QTimer* m_updateTimer;
@@ -218,9 +213,6 @@ private:
     int m_meshUpdateCount;
     qint64 m_lastDebugTime;
 
-    // Threaded mesh generation
-    MeshGeneratorWorker* m_meshWorker;
-
 public slots:
     void spectrumDataChanged(const QVector<float>& data);
     void updateDisplay();
@@ -233,7 +225,6 @@ signals:
 
 private slots:
     void onUpdateTimer();
-    void onMeshReady(const MeshGeneratorWorker::MeshData& meshData);
 };
 
 #endif // _CUSDR_OGL3D_PANEL_H
@@ -494,8 +494,15 @@ void OGLDisplayPanel::paintGL() {
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
         paintRxRegion();
+
+        // the status labels go out in one draw call per font
+        m_oglTextSmall->begin();
+        m_oglTextSmallItalic->begin();
         paintUpperRegion();
         paintLowerRegion();
+        m_oglTextSmallItalic->end();
+        m_oglTextSmall->end();
+
         paintSMeter();
      //   renderSMeterB();
 
@@ -2777,6 +2784,17 @@ void OGLDisplayPanel::systemStateChanged(
 void OGLDisplayPanel::qglColor(QColor color)
 {
     glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+
+    // the text is colored from here, it does not read the GL color back
+    m_oglTextTiny->setColor(color);
+    m_oglTextSmall->setColor(color);
+    m_oglTextSmallItalic->setColor(color);
+    m_oglTextNormal->setColor(color);
+    m_oglTextBig->setColor(color);
+    m_oglTextBigItalic->setColor(color);
+    m_oglTextFreq1->setColor(color);
+    m_oglTextFreq2->setColor(color);
+    m_oglTextImpact->setColor(color);
 }
 
 
@@ -28,6 +28,8 @@
 
 #include "cusdr_oglDistancePanel.h"
 
+#include <QVarLengthArray>
+
 //#include <QtGui>
 //#include <QDebug>
 ////#include <QFileInfo>
@@ -174,6 +176,8 @@ QGLDistancePanel::~QGLDistancePanel() {
 	makeCurrent();
 	glFinish();
 
+	m_spectrumRenderer.destroy();
+
 	if (m_frequencyScaleFBO) {
 
 		delete m_frequencyScaleFBO;
@@ -344,6 +348,10 @@ void QGLDistancePanel::initializeGL() {
 	m_cnt = 0;
 
 	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	m_spectrumRenderer.destroy();
+	if (!m_spectrumRenderer.initialize())
+		qWarning() << "distance panel: OpenGL ES is not supported, panadapter disabled";
 }
 
 void QGLDistancePanel::paintGL() {
@@ -358,6 +366,7 @@ void QGLDistancePanel::paintReceiverDisplay() {
 	QRect mouse_rect(0, 0, 100, 100);
 	mouse_rect.moveCenter(m_mousePos);
 
+	m_spectrumRenderer.newFrame();
 	drawPanadapter();
 	drawPanHorizontalScale();
 	drawPanVerticalScale();
@@ -407,7 +416,6 @@ void QGLDistancePanel::paintChirpWSPRDisplay() {
 }
 
 void QGLDistancePanel::drawPanadapter() {
-	GLint vertexArrayLength = (GLint)m_panadapterBins.size();
 
 	GLint height = m_panRect.height();
 	GLint x1 = m_panRect.left();
@@ -415,23 +423,15 @@ void QGLDistancePanel::drawPanadapter() {
 	GLint x2 = x1 + m_panRect.width();
 	GLint y2 = y1 + m_panRect.height();
 
-	// y scale
-	float yScale;
-	float yScaleColor;
-	float yTop;
-	
 	qreal dBmRange = qAbs(m_dBmPanMax - m_dBmPanMin);
 
-	yScale = m_panRect.height() / dBmRange;
-	//yScaleColor = 4.0f / dBmRange;
-	yScaleColor = 10.0f / dBmRange;
-	yTop = (float) y2;
-	
 	if (m_dataEngineState == QSDR::DataEngineUp)
 		glClear(GL_DEPTH_BUFFER_BIT);
 	else
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	if (!m_spectrumRenderer.isValid()) return;
+
 	glEnable(GL_MULTISAMPLE);
 	glEnable(GL_LINE_SMOOTH);
 
@@ -439,134 +439,70 @@ void QGLDistancePanel::drawPanadapter() {
 	glEnable(GL_BLEND);
 	glLineWidth(1);
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+
 	// draw background
 	if (m_dataEngineState == QSDR::DataEngineUp) {
 
 		if (m_panGrid) {
 
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3f(0.15f, 0.15f, 0.3f);	glVertex3f(x1, y1, -3.0); // top left corner
-				glColor3f(0.15f, 0.15f, 0.3f);	glVertex3f(x2, y1, -3.0); // top right corner
-				glColor3f(0.15f, 0.15f, 0.51f);	glVertex3f(x1, y2, -3.0); // bottom left corner
-				glColor3f(0.15f, 0.15f, 0.61f);	glVertex3f(x2, y2, -3.0); // bottom right corner
-			glEnd();
+			m_spectrumRenderer.drawGradientRect(
+				m_panRect,
+				QColor::fromRgbF(0.15f, 0.15f, 0.3f),	// top left corner
+				QColor::fromRgbF(0.15f, 0.15f, 0.3f),	// top right corner
+				QColor::fromRgbF(0.15f, 0.15f, 0.51f),	// bottom left corner
+				QColor::fromRgbF(0.15f, 0.15f, 0.61f),	// bottom right corner
+				-3.0f);
 		}
 		else {
 
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3f(0.05f, 0.05f, 0.2f);	glVertex3f(x1, y1, -3.0); // top left corner
-				glColor3f(0.05f, 0.05f, 0.2f);	glVertex3f(x2, y1, -3.0); // top right corner
-				glColor3f(0.05f, 0.05f, 0.31f);	glVertex3f(x1, y2, -3.0); // bottom left corner
-				glColor3f(0.05f, 0.05f, 0.41f);	glVertex3f(x2, y2, -3.0); // bottom right corner
-			glEnd();
+			m_spectrumRenderer.drawGradientRect(
+				m_panRect,
+				QColor::fromRgbF(0.05f, 0.05f, 0.2f),	// top left corner
+				QColor::fromRgbF(0.05f, 0.05f, 0.2f),	// top right corner
+				QColor::fromRgbF(0.05f, 0.05f, 0.31f),	// bottom left corner
+				QColor::fromRgbF(0.05f, 0.05f, 0.41f),	// bottom right corner
+				-3.0f);
 		}
 	}
 	else {
 
-		drawGLRect(m_panRect, QColor(30, 30, 50, 155), -3.0f);
+		m_spectrumRenderer.drawRect(m_panRect, QColor(30, 30, 50, 155), -3.0f);
 	}
 
-	//glBegin(GL_TRIANGLE_STRIP);
-	//glColor3f(m_bkgRed,       m_bkgGreen,       m_bkgBlue);			glVertex3f(x1, y1, -3.0); // top left corner
-	//glColor3f(m_bkgRed,       m_bkgGreen,       m_bkgBlue);			glVertex3f(x2, y1, -3.0); // top right corner
-	//glColor3f(m_bkgRed * 1.2, m_bkgGreen * 1.2, m_bkgBlue * 1.2);	glVertex3f(x1, y2, -3.0); // bottom left corner
-	//glColor3f(m_bkgRed * 1.6, m_bkgGreen * 1.6, m_bkgBlue * 1.6);	glVertex3f(x2, y2, -3.0); // bottom right corner
-	//glEnd();
-
 	// set a scissor box
 	glScissor(x1, size().height() - y2, x2, height);
 	glEnable(GL_SCISSOR_TEST);
 
-	TGL3float *vertexArray = new TGL3float[vertexArrayLength];
-	TGL3float *vertexColorArray = new TGL3float[vertexArrayLength];
+	// the line color follows the level, done in the vertex shader
+	TSpectrumScale scale;
+	scale.x0 = 0.0f;
+	scale.xStep = (float)(1.0 / m_scaleMult);
+	scale.yBase = (float) y2;
+	scale.yScale = (float)(m_panRect.height() / dBmRange);
+	scale.colorScale = (float)(10.0f / dBmRange);
 
-	TGL3float *vertexArrayBg = new TGL3float[2*vertexArrayLength];
-	TGL3float *vertexColorArrayBg = new TGL3float[2*vertexArrayLength];
-	
-	switch (m_panMode) {
-
-		case (PanGraphicsMode) FilledLine:
-
-			for (int i = 0; i < vertexArrayLength; i++) {
-			
-				mutex.lock();
-				vertexColorArrayBg[2*i].x = m_redF;
-				vertexColorArrayBg[2*i].y = m_greenF;
-				vertexColorArrayBg[2*i].z = m_blueF;
-								
-				vertexColorArrayBg[2*i+1].x = 0.3 * m_redF;
-				vertexColorArrayBg[2*i+1].y = 0.3 * m_greenF;
-				vertexColorArrayBg[2*i+1].z = 0.3 * m_blueF;
-				
-				vertexColorArray[i].x = m_red   * (yScaleColor * m_panadapterBins.at(i));
-				vertexColorArray[i].y = m_green * (yScaleColor * m_panadapterBins.at(i));
-				vertexColorArray[i].z = m_blue  * (yScaleColor * m_panadapterBins.at(i));
-				mutex.unlock();
-
-				vertexArrayBg[2*i].x = (GLfloat)(i/m_scaleMult);
-				vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-				vertexArrayBg[2*i].z = -2.5;
-
-				vertexArrayBg[2*i+1].x = (GLfloat)(i/m_scaleMult);
-				vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-				vertexArrayBg[2*i+1].z = -2.5;
-	
-				vertexArray[i].x = (GLfloat)(i/m_scaleMult);
-				vertexArray[i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-				vertexArray[i].z = -1.0;
-			}
-			
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-				
-			glVertexPointer(3, GL_FLOAT, 0, vertexArrayBg);
-			glColorPointer(3, GL_FLOAT, 0, vertexColorArrayBg);
-			glDrawArrays(GL_QUAD_STRIP, 0, 2*vertexArrayLength);
+	m_spectrumRenderer.setSpectrum(m_panadapterBins.constData(), m_panadapterBins.size(), scale);
 
-			glVertexPointer(3, GL_FLOAT, 0, vertexArray);
-			glColorPointer(3, GL_FLOAT, 0, vertexColorArray);
-			glDrawArrays(GL_LINE_STRIP, 0, vertexArrayLength);
+	mutex.lock();
+	QColor lineColor = QColor::fromRgbF(m_red, m_green, m_blue);
+	QColor fillTopColor = QColor::fromRgbF(m_redF, m_greenF, m_blueF);
+	QColor fillBottomColor = QColor::fromRgbF(0.3f * m_redF, 0.3f * m_greenF, 0.3f * m_blueF);
+	QColor solidTopColor = QColor::fromRgbF(m_redST, m_greenST, m_blueST);
+	QColor solidBottomColor = QColor::fromRgbF(m_redSB, m_greenSB, m_blueSB);
+	mutex.unlock();
 
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY); 
+	switch (m_panMode) {
 
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
+		case (PanGraphicsMode) FilledLine:
 
+			m_spectrumRenderer.drawSpectrumFill(fillTopColor, fillBottomColor, -2.5f);
+			m_spectrumRenderer.drawSpectrumLine(lineColor, -1.0f);
 			break;
 
 		case (PanGraphicsMode) Line:
 
-			for (int i = 0; i < vertexArrayLength; i++) {
-	
-				mutex.lock();
-				vertexColorArray[i].x = m_red	* (yScaleColor * m_panadapterBins.at(i));
-				vertexColorArray[i].y = m_green * (yScaleColor * m_panadapterBins.at(i));
-				vertexColorArray[i].z = m_blue  * (yScaleColor * m_panadapterBins.at(i));
-				mutex.unlock();
-				
-				vertexArray[i].x = (GLfloat)(i/m_scaleMult);
-				vertexArray[i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-				vertexArray[i].z = -1.0;
-			}
-		
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-				
-			glVertexPointer(3, GL_FLOAT, 0, vertexArray);
-			glColorPointer(3, GL_FLOAT, 0, vertexColorArray);
-			glDrawArrays(GL_LINE_STRIP, 0, vertexArrayLength);
-			
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
-
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
-			
+			m_spectrumRenderer.drawSpectrumLine(lineColor, -1.0f);
 			break;
 
 		case (PanGraphicsMode) Solid:
@@ -574,49 +510,12 @@ void QGLDistancePanel::drawPanadapter() {
 			glDisable(GL_MULTISAMPLE);
 			glDisable(GL_LINE_SMOOTH);
 
-			for (int i = 0; i < vertexArrayLength; i++) {
-			
-				mutex.lock();
-				vertexColorArrayBg[2*i].x = m_redST;
-				vertexColorArrayBg[2*i].y = m_greenST;
-				vertexColorArrayBg[2*i].z = m_blueST;
-								
-				vertexColorArrayBg[2*i+1].x = m_redSB;
-				vertexColorArrayBg[2*i+1].y = m_greenSB;
-				vertexColorArrayBg[2*i+1].z = m_blueSB;
-				mutex.unlock();
-
-				vertexArrayBg[2*i].x = (GLfloat)(i/m_scaleMult);
-				vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-				vertexArrayBg[2*i].z = -2.0f;
-
-				vertexArrayBg[2*i+1].x = (GLfloat)(i/m_scaleMult);
-				vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-				vertexArrayBg[2*i+1].z = -2.0f;
-			}
-			
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-				
-			glVertexPointer(3, GL_FLOAT, 0, vertexArrayBg);
-			glColorPointer(3, GL_FLOAT, 0, vertexColorArrayBg);
-			//glDrawArrays(GL_QUAD_STRIP, 0, 2*vertexArrayLength);
-			glDrawArrays(GL_LINES, 0, 2*vertexArrayLength);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
-
-			//glEnable(GL_MULTISAMPLE);
-			//glEnable(GL_LINE_SMOOTH);
-
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
-
+			m_spectrumRenderer.drawSpectrumBars(solidTopColor, solidBottomColor, -2.0f);
 			break;
 	}
 
+	m_spectrumRenderer.end();
+
 	glDisable(GL_MULTISAMPLE);
 	glDisable(GL_LINE_SMOOTH);
 
@@ -783,12 +682,14 @@ void QGLDistancePanel::drawPanFilter() {
 
 	QRect filterRect = QRect(x1, y1, x2 - x1, y2 - y1);
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+
 	if ((x1 >= m_panRect.left() && x1 <= m_panRect.right()) ||
 		(x2 >= m_panRect.left() && x2 <= m_panRect.right()) ||
 		(x1 < m_panRect.left() && x2 > m_panRect.right()))
 	{
 		if (filterRect.height() > 5) 
-			drawGLRect(filterRect, color, 3.0);
+			m_spectrumRenderer.drawRect(filterRect, color, 3.0f);
 	}
 
 	// draw a line for the display center
@@ -801,18 +702,19 @@ void QGLDistancePanel::drawPanFilter() {
 			
 		color = set->getPanadapterColors().panCenterLineColor;
 
+		TGLColorVertex vertices[2] = {
+			glColorVertex(x, y1, 4.0f, color),
+			glColorVertex(x, y2, 4.0f, color)
+		};
+
 		//glDisable(GL_LINE_SMOOTH);
 		glDisable(GL_MULTISAMPLE);
 		glLineWidth(1);
-		glColor4ub(color.red(), color.green(), color.blue(), color.alpha());
-		glBegin(GL_LINES);
-			/*glVertex2i(x, y1);
-			glVertex2i(x, y2);*/
-			glVertex3f(x, y1, 4.0f);
-			glVertex3f(x, y2, 4.0f);
-		glEnd();
+		m_spectrumRenderer.drawVertices(GL_LINES, vertices, 2);
 		glEnable(GL_MULTISAMPLE);
 	}
+
+	m_spectrumRenderer.end();
 }
 
 void QGLDistancePanel::drawCrossHair() {
@@ -829,38 +731,39 @@ void QGLDistancePanel::drawCrossHair() {
 	glDisable(GL_LINE_SMOOTH);
 	glLineWidth(1.0f);
 
-    glColor4f(255, 255, 255, 80);
-
 	// set a scissor box
 	glScissor(rect.left(), rect.top(), rect.width() - 1, rect.height());
 	glEnable(GL_SCISSOR_TEST);
 
-	// horizontal line
-	glBegin(GL_LINES);
-		glVertex3f(m_dBmScalePanRect.right() - 2, y, 4.0f);
-		glVertex3f(rect.right() - 1, y, 4.0f);
-	glEnd();
-
-	// vertical line
-	glBegin(GL_LINES);
-		glVertex3f(x, rect.top() + 1, 4.0f);
-		glVertex3f(x, rect.bottom() - 1, 4.0f);
-	glEnd();
-
-	// cross hair
-    glColor4f(255,255,255,180);
-	glBegin(GL_LINES);
-		glVertex3f(x     , y - 20, 5.0f);
-		glVertex3f(x     , y + 20, 5.0f);
-		glVertex3f(x - 20, y, 5.0f);
-		glVertex3f(x + 20, y, 5.0f);
-	glEnd();
+	// glColor4f() clamped the old 0..255 values to opaque white
+	QColor color(255, 255, 255, 255);
+
+	const TGLColorVertex vertices[8] = {
+
+		// horizontal line
+		glColorVertex(m_dBmScalePanRect.right() - 2, y, 4.0f, color),
+		glColorVertex(rect.right() - 1, y, 4.0f, color),
+
+		// vertical line
+		glColorVertex(x, rect.top() + 1, 4.0f, color),
+		glColorVertex(x, rect.bottom() - 1, 4.0f, color),
+
+		// cross hair
+		glColorVertex(x, y - 20, 5.0f, color),
+		glColorVertex(x, y + 20, 5.0f, color),
+		glColorVertex(x - 20, y, 5.0f, color),
+		glColorVertex(x + 20, y, 5.0f, color)
+	};
+
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINES, vertices, 8);
+	m_spectrumRenderer.end();
 
 	// text only on panadapter
 	//if (m_mouseRegion == panadapterRegion) {
 		
 	QString str;
-    glColor4f(255, 255, 255, 255);
+    qglColor(QColor(255, 255, 255, 255));
 
 	int dx = m_panRect.width()/2 - x;
 	qreal unit = (qreal)((m_sampleRate * m_freqScaleZoomFactor) / m_panRect.width());
@@ -954,8 +857,7 @@ void QGLDistancePanel::drawDistanceSpectrum() {
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	vertexArrayLength = displayWidth;
-	TGL2float *vertexArray = new TGL2float[vertexArrayLength];
-	TGL3float *vertexColorArray = new TGL3float[vertexArrayLength];
+	QVector<TGLColorVertex> vertexArray(vertexArrayLength);
 
 	//TGL3float *vertexArrayBg = new TGL3float[2*vertexArrayLength];
 	//TGL3float *vertexColorArrayBg = new TGL3float[2*vertexArrayLength];
@@ -990,26 +892,13 @@ void QGLDistancePanel::drawDistanceSpectrum() {
 		m_spectrumVertexColorArrayBg[2*i].y = 0.20;
 		m_spectrumVertexColorArrayBg[2*i].z = 0.25;*/
 
-		vertexColorArray[i].x = m_redD;// * (yScaleColor * (m_distanceSpectrumBuffer[idx] - dBmMin));
-		vertexColorArray[i].y = m_greenD;// * (yScaleColor * (m_distanceSpectrumBuffer[idx] - dBmMin));
-		vertexColorArray[i].z = m_blueD;// * (yScaleColor * (m_distanceSpectrumBuffer[idx] - dBmMin));
-		
-		vertexArray[i].x = i;
-		vertexArray[i].y = yTop - yScale * (m_distanceSpectrumBuffer[idx] - m_dBmDistMin);
+		vertexArray[i] = glColorVertex(i, yTop - yScale * (m_distanceSpectrumBuffer[idx] - m_dBmDistMin), 0.0f,
+			QColor::fromRgbF(m_redD, m_greenD, m_blueD));// * (yScaleColor * (m_distanceSpectrumBuffer[idx] - dBmMin));
 	}
 	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-				
-	glVertexPointer(2, GL_FLOAT, 0, vertexArray);
-	glColorPointer(3, GL_FLOAT, 0, vertexColorArray);
-	glDrawArrays(GL_LINE_STRIP, 0, vertexArrayLength);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	delete[] vertexArray;
-	delete[] vertexColorArray;
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINE_STRIP, vertexArray.constData(), vertexArrayLength);
+	m_spectrumRenderer.end();
 	
 	// disable scissor box
 	glDisable(GL_SCISSOR_TEST);
@@ -1088,22 +977,29 @@ void QGLDistancePanel::drawDistHorizontalScale() {
 	glRasterPos3f(m_freqScaleDistancePanRect.width() - 30, m_freqScaleDistancePanRect.top() + textOffset_y, 0.0);
 	//writeBitmapString(GLUT_BITMAP_HELVETICA_10, str);
 
+	QColor scaleColor;
 	if (m_mouseRegion == freqScaleDistancePanRegion)
-		glColor3f(0.8f, 0.92f, 0.97f);
+		scaleColor = QColor::fromRgbF(0.8f, 0.92f, 0.97f);
 	else
-		glColor3f(0.65f, 0.76f, 0.81f);
+		scaleColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+
+	qglColor(scaleColor);
+
+	QVarLengthArray<TGLColorVertex, 128> ticks;
 
 	int len = m_distanceScale.mainPointPositions.length();
 	if (len > 0) {
 
-		glLineWidth(3);
-		glBegin(GL_LINES);
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(m_distanceScale.mainPointPositions.at(i), m_freqScaleDistancePanRect.top() + 1, 0.0f); // origin of the line
-			glVertex3f(m_distanceScale.mainPointPositions.at(i), m_freqScaleDistancePanRect.top() + 4, 0.0f); // ending point of the line
+			ticks.append(glColorVertex(m_distanceScale.mainPointPositions.at(i), m_freqScaleDistancePanRect.top() + 1, 0.0f, scaleColor)); // origin of the line
+			ticks.append(glColorVertex(m_distanceScale.mainPointPositions.at(i), m_freqScaleDistancePanRect.top() + 4, 0.0f, scaleColor)); // ending point of the line
 		}
-		glEnd();
+
+		glLineWidth(3);
+		m_spectrumRenderer.begin(size().width(), size().height());
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
 
 		for (int i = 0; i < len; i++) {
 		
@@ -1126,14 +1022,17 @@ void QGLDistancePanel::drawDistHorizontalScale() {
 	len = m_distanceScale.subPointPositions.length();
 	if (len > 0) {
 
-		glLineWidth(1);
-		glBegin(GL_LINES);
+		ticks.clear();
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(m_distanceScale.subPointPositions.at(i), m_freqScaleDistancePanRect.top() + 1, 0.0f); // origin of the line
-			glVertex3f(m_distanceScale.subPointPositions.at(i), m_freqScaleDistancePanRect.top() + 3, 0.0f); // ending point of the line
+			ticks.append(glColorVertex(m_distanceScale.subPointPositions.at(i), m_freqScaleDistancePanRect.top() + 1, 0.0f, scaleColor)); // origin of the line
+			ticks.append(glColorVertex(m_distanceScale.subPointPositions.at(i), m_freqScaleDistancePanRect.top() + 3, 0.0f, scaleColor)); // ending point of the line
 		}
-		glEnd();
+
+		glLineWidth(1);
+		m_spectrumRenderer.begin(size().width(), size().height());
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
 	}
 }
 
@@ -1166,24 +1065,32 @@ void QGLDistancePanel::drawDistVerticalScale() {
 	textRect.moveRight(14);
 	int yOld = -textRect.height();
 	
-	if (m_mouseRegion == dBmScaleDistancePanRegion)
-		glColor3f(0.8f, 0.92f, 0.97f);
-	else
-		glColor3f(0.65f, 0.76f, 0.81f);
+	QColor mainColor, subColor;
+	if (m_mouseRegion == dBmScaleDistancePanRegion) {
+
+		mainColor = QColor::fromRgbF(0.8f, 0.92f, 0.97f);
+		subColor = QColor::fromRgbF(0.5f, 0.62f, 0.67f);
+	}
+	else {
+
+		mainColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+		subColor = QColor::fromRgbF(0.35f, 0.46f, 0.51f);
+	}
+	QColor zeroColor = QColor::fromRgbF(0.2f, 0.87f, 0.87f);
 
+	// all ticks and the 0 dBm line in one layer
+	QVarLengthArray<TGLColorVertex, 128> lines;
 
 	glLineWidth(1);
 	int len = m_dBmScale.mainPointPositions.length();
 	
 	if (len > 0) {
 
-		glBegin(GL_LINES);
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(m_dBmScaleDistancePanRect.left(),     m_dBmScale.mainPointPositions.at(i), 0.0f);	// origin of the line
-			glVertex3f(m_dBmScaleDistancePanRect.left() + 4, m_dBmScale.mainPointPositions.at(i), 0.0f);	// ending point of the line
+			lines.append(glColorVertex(m_dBmScaleDistancePanRect.left(),     m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));	// origin of the line
+			lines.append(glColorVertex(m_dBmScaleDistancePanRect.left() + 4, m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));	// ending point of the line
 		}
-		glEnd();
 
 		for (int i = 0; i < len; i++) {
 
@@ -1207,37 +1114,23 @@ void QGLDistancePanel::drawDistVerticalScale() {
 				int zerodBmLine = m_dBmScale.mainPointPositions.at(i);
 				if (zerodBmLine > m_dBmScaleDistancePanRect.top() && zerodBmLine < m_dBmScaleDistancePanRect.bottom()) {
 		
-					glColor3f(0.2f, 0.87f, 0.87f);
-					glBegin(GL_LINES);
-					glVertex3f(m_distanceSpectrumRect.left(), zerodBmLine, 0.0f);						// origin of the line
-					glVertex3f(m_distanceSpectrumRect.width() - m_dBmScaleDistancePanRect.width() + 4, zerodBmLine, 0.0f);	// ending point of the line
-					glEnd();
-
-					if (m_mouseRegion == dBmScaleDistancePanRegion)
-						glColor3f(0.8f, 0.92f, 0.97f);
-					else
-						glColor3f(0.65f, 0.76f, 0.81f);
+					lines.append(glColorVertex(m_distanceSpectrumRect.left(), zerodBmLine, 0.0f, zeroColor));						// origin of the line
+					lines.append(glColorVertex(m_distanceSpectrumRect.width() - m_dBmScaleDistancePanRect.width() + 4, zerodBmLine, 0.0f, zeroColor));	// ending point of the line
 				}
 			}
 		}
 	}
 
-	if (m_mouseRegion == dBmScaleDistancePanRegion)
-		glColor3f(0.5f, 0.62f, 0.67f);
-	else
-		glColor3f(0.35f, 0.46f, 0.51f);
-
-	if (m_dBmScale.subPointPositions.length() > 0) {
+	for (int i = 0; i < m_dBmScale.subPointPositions.length(); i++) {
 
-		glBegin(GL_LINES);
-		for (int i = 0; i < m_dBmScale.subPointPositions.length(); i++) {
-
-			glVertex3f(m_dBmScaleDistancePanRect.left(),     m_dBmScale.subPointPositions.at(i), 0.0f);	// origin of the line
-			glVertex3f(m_dBmScaleDistancePanRect.left() + 2, m_dBmScale.subPointPositions.at(i), 0.0f);	// ending point of the line
-		}
-		glEnd();
+		lines.append(glColorVertex(m_dBmScaleDistancePanRect.left(),     m_dBmScale.subPointPositions.at(i), 0.0f, subColor));	// origin of the line
+		lines.append(glColorVertex(m_dBmScaleDistancePanRect.left() + 2, m_dBmScale.subPointPositions.at(i), 0.0f, subColor));	// ending point of the line
 	}
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINES, lines.constData(), lines.size());
+	m_spectrumRenderer.end();
+
 	//char* s = "dBm";
 	textRect.moveTop(m_dBmScaleDistancePanRect.top() + m_dBmScaleDistancePanRect.height() - textRect.height());
 	glColor3f(0.94f, 0.22f, 0.43f);
@@ -1292,30 +1185,28 @@ void QGLDistancePanel::renderPanVerticalScale() {
 	
 	if (len > 0) {
 
-		glColor3f(0.65f, 0.76f, 0.81f);
-		glLineWidth(1);
+		QVarLengthArray<TGLColorVertex, 128> ticks;
+		QColor mainColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+		QColor subColor = QColor::fromRgbF(0.45f, 0.56f, 0.61f);
 
-		glBegin(GL_LINES);
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(width,     m_dBmScale.mainPointPositions.at(i), 0.0f);	// origin of the line
-			glVertex3f(width - 4, m_dBmScale.mainPointPositions.at(i), 0.0f);	// ending point of the line
+			ticks.append(glColorVertex(width,     m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));	// origin of the line
+			ticks.append(glColorVertex(width - 4, m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));	// ending point of the line
 		}
-		glEnd();
 		
-		glColor3f(0.45f, 0.56f, 0.61f);
-		if (sublen > 0) {
-
-			glBegin(GL_LINES);
-			for (int i = 0; i < sublen; i++) {
+		for (int i = 0; i < sublen; i++) {
 
-				glVertex3f(width,     m_dBmScale.subPointPositions.at(i), 0.0f);	// origin of the line
-				glVertex3f(width - 2, m_dBmScale.subPointPositions.at(i), 0.0f);	// ending point of the line
-			}
-			glEnd();
+			ticks.append(glColorVertex(width,     m_dBmScale.subPointPositions.at(i), 0.0f, subColor));	// origin of the line
+			ticks.append(glColorVertex(width - 2, m_dBmScale.subPointPositions.at(i), 0.0f, subColor));	// ending point of the line
 		}
 
-		glColor3f(0.75f, 0.86f, 0.91f);
+		glLineWidth(1);
+		m_spectrumRenderer.begin(width, height);
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
+
+		qglColor(QColor::fromRgbF(0.75f, 0.86f, 0.91f));
 		for (int i = 0; i < len; i++) {
 
 			textRect.moveBottom(m_dBmScale.mainPointPositions.at(i) + textRect.height()/2);
@@ -1330,7 +1221,7 @@ void QGLDistancePanel::renderPanVerticalScale() {
 	}
 
 	textRect.moveTop(m_dBmScalePanRect.height() - textRect.height());
-	glColor3f(0.94f, 0.22f, 0.43f);
+	qglColor(QColor::fromRgbF(0.94f, 0.22f, 0.43f));
 	
 	str = QString("dBm");
 	m_oglTextSmall->renderText(textRect.x(), textRect.y(), str);
@@ -1370,18 +1261,24 @@ void QGLDistancePanel::renderPanHorizontalScale() {
     scaledTextRect.setWidth(m_fonts.smallFontMetrics->horizontalAdvance(fstr));
 	scaledTextRect.moveLeft(m_freqScalePanRect.width() - scaledTextRect.width());
 
-	glColor3f(0.65f, 0.76f, 0.81f);
+	QColor scaleColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+	qglColor(scaleColor);
+
+	QVarLengthArray<TGLColorVertex, 128> ticks;
+
 	int len = m_frequencyScale.mainPointPositions.length();
 	if (len > 0) {
 
-		glLineWidth(3);
-		glBegin(GL_LINES);
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(m_frequencyScale.mainPointPositions.at(i), 1.0f, 0.0f);
-			glVertex3f(m_frequencyScale.mainPointPositions.at(i), 4.0f, 0.0f);
+			ticks.append(glColorVertex(m_frequencyScale.mainPointPositions.at(i), 1.0f, 0.0f, scaleColor));
+			ticks.append(glColorVertex(m_frequencyScale.mainPointPositions.at(i), 4.0f, 0.0f, scaleColor));
 		}
-		glEnd();
+
+		glLineWidth(3);
+		m_spectrumRenderer.begin(m_freqScalePanRect.width(), m_freqScalePanRect.height());
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
 		
 		for (int i = 0; i < len; i++) {
 		
@@ -1409,17 +1306,20 @@ void QGLDistancePanel::renderPanHorizontalScale() {
 
 	if (m_frequencyScale.subPointPositions.length() > 0) {
 
-		glLineWidth(1);
-		glBegin(GL_LINES);
+		ticks.clear();
 		for (int i = 0; i < m_frequencyScale.subPointPositions.length(); i++) {
 
-			glVertex3f(m_frequencyScale.subPointPositions.at(i), 1.0f, 0.0f);
-			glVertex3f(m_frequencyScale.subPointPositions.at(i), 3.0f, 0.0f);
+			ticks.append(glColorVertex(m_frequencyScale.subPointPositions.at(i), 1.0f, 0.0f, scaleColor));
+			ticks.append(glColorVertex(m_frequencyScale.subPointPositions.at(i), 3.0f, 0.0f, scaleColor));
 		}
-		glEnd();
+
+		glLineWidth(1);
+		m_spectrumRenderer.begin(m_freqScalePanRect.width(), m_freqScalePanRect.height());
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
 	}
 
-	glColor3f(0.94f, 0.22f, 0.43f);
+	qglColor(QColor::fromRgbF(0.94f, 0.22f, 0.43f));
 	m_oglTextSmall->renderText(m_freqScalePanRect.width() - 30, textOffset_y, fstr);
 }
 
@@ -1428,10 +1328,12 @@ void QGLDistancePanel::renderPanadapterGrid() {
 	//GRAPHICS_DEBUG << "render panadapter grid";
 	//glLineStipple(1, 0xCCCC);
 	glClear(GL_COLOR_BUFFER_BIT);
-	glLineStipple(1, 0x9999);
-	glEnable(GL_LINE_STIPPLE);
 	glLineWidth(1.0f);
 
+	// dotted like glLineStipple(1, 0x9999), in the color drawPanadapterGrid() used to set
+	QColor color = QColor::fromRgbF(0.45f, 0.56f, 0.61f, 0.8f);
+	QVarLengthArray<TGLColorVertex, 128> vertices;
+
 	// vertical lines
 	int len = m_frequencyScale.mainPointPositions.length();
 	if (len > 0) {
@@ -1444,62 +1346,35 @@ void QGLDistancePanel::renderPanadapterGrid() {
 		GLint y1 = 1;
 		GLint y2 = m_panRect.bottom() - 1;
 
-		TGL2int *vertexArray = new TGL2int[len * 2];
-		int vertexArrayLen = 0;
-
-		TGL2int point1, point2;
-		point1.y = y1;
-		point2.y = y2;
 		for (int i = 0; i < len; i++) {
 
 			GLint x = m_frequencyScale.mainPointPositions.at(i);
 			if (x < x2) continue;
 			x += x1;
-			point1.x = x;
-			point2.x = x;
-			vertexArray[vertexArrayLen++] = point1;
-			vertexArray[vertexArrayLen++] = point2;
+			vertices.append(glColorVertex(x, y1, 0.0f, color));
+			vertices.append(glColorVertex(x, y2, 0.0f, color));
 		}
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(2, GL_INT, 0, vertexArray);
-		glDrawArrays(GL_LINES, 0, vertexArrayLen);
-		glDisableClientState(GL_VERTEX_ARRAY);
-
-		delete[] vertexArray;
 	}
 
 	// horizontal lines
 	len = m_dBmScale.mainPointPositions.length();
 	if (len > 0) {
 
-		TGL2float *vertexArray = new TGL2float[len * 2];
-		int vertexArrayLen = 0;
-
-		TGL2float point1, point2;
-		point1.x = m_panRect.left() + m_dBmScalePanRect.width();
-		point2.x = m_panRect.right();
+		GLfloat x1 = m_panRect.left() + m_dBmScalePanRect.width();
+		GLfloat x2 = m_panRect.right();
 		
 		for (int i = 0; i < len; i++) {
 
 			GLfloat y = m_dBmScale.mainPointPositions.at(i);
 			
-			point1.y = y;
-			point2.y = y;
-			
-			vertexArray[vertexArrayLen++] = point1;
-			vertexArray[vertexArrayLen++] = point2;
+			vertices.append(glColorVertex(x1, y, 0.0f, color));
+			vertices.append(glColorVertex(x2, y, 0.0f, color));
 		}
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(2, GL_FLOAT, 0, vertexArray);
-		glDrawArrays(GL_LINES, 0, vertexArrayLen);
-		glDisableClientState(GL_VERTEX_ARRAY);
-
-		delete[] vertexArray;
-
 	}
-	glDisable(GL_LINE_STIPPLE);
+
+	m_spectrumRenderer.begin(m_panRect.width(), m_panRect.height());
+	m_spectrumRenderer.drawVertices(GL_LINES, vertices.constData(), vertices.size(), 0x9999);
+	m_spectrumRenderer.end();
 }
  
 
@@ -1710,6 +1585,16 @@ void QGLDistancePanel::restoreGLState() {
     glPopMatrix();
     glPopAttrib();
 }
+
+void QGLDistancePanel::qglColor(QColor color) {
+
+	glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+
+	// the text is colored from here, it does not read the GL color back
+	m_oglTextTiny->setColor(color);
+	m_oglTextSmall->setColor(color);
+	m_oglTextNormal->setColor(color);
+}
  
 //********************************************************************
 // HMI control
@@ -2269,10 +2154,6 @@ void QGLDistancePanel::computeDisplayBins(const float *panBuffer) {
 
 	int newSampleSize = 0;
 	int deltaSampleSize = 0;
-	int idx = 0;
-	int lIdx = 0;
-	int rIdx = 0;
-	qreal localMax;
 	newSampleSize = (int)floor(4 * BUFFER_SIZE * m_freqScaleZoomFactor);
 	deltaSampleSize = 4 * BUFFER_SIZE - newSampleSize;
 
@@ -2309,28 +2190,14 @@ void QGLDistancePanel::computeDisplayBins(const float *panBuffer) {
 		GRAPHICS_DEBUG << "bins:" << bins;
 	}*/
 
-	m_panadapterBins.clear();
-	
-	for (int i = 0; i < m_panSpectrumBinsLength; i++) {
-			
-		idx = 0;
-		lIdx = (int)floor((qreal)(i * m_panScale / m_scaleMult));
-		rIdx = (int)floor((qreal)(i * m_panScale / m_scaleMult) + m_panScale / m_scaleMult);
-					
-		// max value; later we try mean value also!
-		localMax = -10000.0F;
-		for (int j = lIdx; j < rIdx; j++) {
-
-			if (panBuffer[j] > localMax) {
+	// peak of the bins under each pixel, starting half of the zoomed away
+	// bins into the buffer
+	m_panadapterBins.resize(m_panSpectrumBinsLength);
+	decimatePeak(panBuffer + deltaSampleSize/2, newSampleSize, m_panadapterBins.data(), m_panSpectrumBinsLength);
 
-				localMax = panBuffer[j];
-				idx = j;
-			}
-		}
-		idx += deltaSampleSize/2;
-				
-		m_panadapterBins << panBuffer[idx] - m_dBmPanMin - m_dBmPanLogGain;
-	}
+	const float panOffset = m_dBmPanMin + m_dBmPanLogGain;
+	for (int i = 0; i < m_panSpectrumBinsLength; i++)
+		m_panadapterBins[i] -= panOffset;
 }
 
 void QGLDistancePanel::setDistanceSpectrumBuffer(int sampleRate, qint64 length, const float *buffer) {
@@ -31,7 +31,9 @@
 #include "cusdr_oglInfo.h"
 #include "cusdr_settings.h"
 #include "cusdr_fonts.h"
+#include "Util/cusdr_spectrumDecimate.h"
 #include "cusdr_oglText.h"
+#include "cusdr_oglSpectrumRenderer.h"
 
 //#include <QtOpenGL/QOpenGLWidget>
 //#include <QImage>
@@ -97,13 +99,15 @@ private:
 	
 	QList<TReceiver>	m_rxDataList;
 	
-	QVector<qreal>					m_panadapterBins;
+	QVector<float>					m_panadapterBins;
 	QQueue<QVector<float> >			specAv_queue;
 
     QOpenGLFramebufferObject*			m_frequencyScaleFBO;
     QOpenGLFramebufferObject*			m_dBmScaleFBO;
     QOpenGLFramebufferObject*			m_panadapterGridFBO;
     QOpenGLFramebufferObject*			m_textureFBO;
+
+	OGLSpectrumRenderer		m_spectrumRenderer;
 	
 	QRect		m_panRect;
 	QRect		m_dBmScalePanRect;
@@ -255,6 +259,7 @@ private:
 	//******************************************************************
 	//QColor	getWaterfallColorAtPixel(qreal value);
 
+	void	qglColor(QColor color);
 	void	saveGLState();
 	void	restoreGLState();
 
@@ -32,6 +32,7 @@
 #include "cusdr_oglReceiverPanel.h"
 
 #include <QGuiApplication>
+#include <QVarLengthArray>
 #include <cstring>
 
 //#include <QtGui>
@@ -193,6 +194,9 @@ QGLReceiverPanel::QGLReceiverPanel(QWidget *parent, int rx)
 
 	timer = 0;
 	m_waterfallTextureId = 0;
+	m_waterfallTextureWidth = 0;
+	m_waterfallTextureHeight = 0;
+	m_waterfallTopRow = 0;
 
 	setupConnections();
 
@@ -245,13 +249,8 @@ QGLReceiverPanel::QGLReceiverPanel(QWidget *parent, int rx)
 
     m_frequencyScaleFBO = nullptr;
     m_dBmScaleFBO = nullptr;
-    m_textureFBO = nullptr;
-    m_waterfallLineFBO = nullptr;
-    m_waterfallFBO = nullptr;
     m_secScaleWaterfallFBO = nullptr;
 
-	m_waterfallLineCnt = 0;
-
 	m_haircrossOffsetRight = 30;
 	m_haircrossOffsetLeft = 116;
 	m_haircrossMaxRight = 110;
@@ -262,12 +261,25 @@ QGLReceiverPanel::QGLReceiverPanel(QWidget *parent, int rx)
 	else
 		m_scale = 1.0f;
 
+	m_displayWorker = new SpectrumDisplayWorker(m_receiver, this);
+	CHECKED_CONNECT(
+		m_displayWorker,
+		SIGNAL(frameReady()),
+		this,
+		SLOT(update()));
+	m_displayWorker->start();
+
+	CDisplayScheduler::instance()->addDisplay(this, CDisplayScheduler::Receiver0 + m_receiver);
 }
 
 QGLReceiverPanel::~QGLReceiverPanel() {
 
     qDebug() << "rx panel destructor" << m_receiver;
     disconnect(set, 0, this, 0);
+	CDisplayScheduler::instance()->removeDisplay(this);
+
+	delete m_displayWorker;
+	m_displayWorker = nullptr;
 	
 	if (m_frequencyScaleFBO) {
 
@@ -275,24 +287,6 @@ QGLReceiverPanel::~QGLReceiverPanel() {
         m_frequencyScaleFBO = nullptr;
 	}
 
-	if (m_waterfallLineFBO) {
-
-		delete m_waterfallLineFBO;
-        m_waterfallLineFBO = nullptr;
-	}
-		
-	if (m_waterfallFBO) {
-
-		delete m_waterfallFBO;
-        m_waterfallFBO = nullptr;
-	}
-
-	if (m_textureFBO) {
-
-		delete m_textureFBO;
-        m_textureFBO = nullptr;
-	}
-
 	if (m_dBmScaleFBO) {
 
 		delete m_dBmScaleFBO;
@@ -306,13 +300,14 @@ QGLReceiverPanel::~QGLReceiverPanel() {
         m_secScaleWaterfallFBO = nullptr;
 	}
 
+	makeCurrent();
 	if (m_waterfallTextureId != 0) {
 
-		makeCurrent();
 		glDeleteTextures(1, &m_waterfallTextureId);
 		m_waterfallTextureId = 0;
-		doneCurrent();
 	}
+	m_spectrumRenderer.destroy();
+	doneCurrent();
 
     while (!specAv_queue.isEmpty())
         specAv_queue.dequeue();
@@ -452,12 +447,6 @@ void QGLReceiverPanel::setupConnections() {
 		this, 
 		SLOT(setSpectrumAveragingCnt(int)));*/
 
-	CHECKED_CONNECT(
-		set,
-		SIGNAL(spectrumBufferChanged(int, const qVectorFloat&)),
-		this,
-		SLOT(setSpectrumBuffer(int, const qVectorFloat&)));
-
 	CHECKED_CONNECT(
 		set, 
 		SIGNAL(panGridStatusChanged(bool, int)),
@@ -607,9 +596,23 @@ void QGLReceiverPanel::initializeGL() {
 	m_cnt = 0;
 
 	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	m_spectrumRenderer.destroy();
+	if (!m_spectrumRenderer.initialize())
+		qWarning() << "rx panel" << m_receiver << ": OpenGL ES is not supported, panadapter disabled";
 }
 
 void QGLReceiverPanel::paintGL() {
+
+	// pick up the display worker's latest frame, also when this paint is
+	// skipped, so it keeps announcing new ones
+	if (m_dataEngineState == QSDR::DataEngineUp) {
+
+		updateDisplayView();
+		if (m_displayWorker->takeFrame())
+			m_waterfallDisplayUpdate = true;
+	}
+
 	switch (m_serverMode) {
 
 		case QSDR::NoServerMode:
@@ -654,6 +657,7 @@ void QGLReceiverPanel::paintReceiverDisplay() {
 	}
 	//m_displayTime.restart();
 
+    m_spectrumRenderer.newFrame();
     drawPanadapter();
     drawPanHorizontalScale();
     drawPanVerticalScale();
@@ -670,7 +674,7 @@ void QGLReceiverPanel::paintReceiverDisplay() {
         drawReceiverInfo();
 	}
 
-	if (m_waterfallDisplayUpdate && m_waterfallRect.height() > 10) {
+	if (m_waterfallRect.height() > 10) {
 
         drawWaterfall();
     //    drawWaterfallVerticalScale();
@@ -700,27 +704,21 @@ void QGLReceiverPanel::drawPanadapter() {
     // Device Pixel Ratio Awareness
     // Get device pixel ratio (float, so use devicePixelRatioF for accuracy)
     float dpr = devicePixelRatio();
-   GLint vertexArrayLength = (GLint)m_panadapterBins.size();
-//	qDebug() << "vertex array length:" << vertexArrayLength;
     GLint height = m_panRect.height();
     GLint x1 = m_panRect.left();
     GLint y1 = m_panRect.top();
     GLint x2 = x1 + m_panRect.width();
     GLint y2 = y1 + m_panRect.height();
 
-    // y scale
-    float yScale;
-    float yTop;
     qreal dBmRange = qAbs(m_dBmPanMax - m_dBmPanMin);
 
-    yScale = m_panRect.height() / dBmRange;
-    yTop = (float)y2;
-
     if (m_dataEngineState == QSDR::DataEngineUp)
         glClear(GL_DEPTH_BUFFER_BIT);
     else
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    if (!m_spectrumRenderer.isValid()) return;
+
     glEnable(GL_MULTISAMPLE);
     glEnable(GL_LINE_SMOOTH);
 
@@ -728,122 +726,64 @@ void QGLReceiverPanel::drawPanadapter() {
     glEnable(GL_BLEND);
     glLineWidth(1);
 
+    m_spectrumRenderer.begin(size().width(), size().height());
+
     // draw background
     if (m_dataEngineState == QSDR::DataEngineUp) {
 
         if (m_receiver == m_currentReceiver) {
-            glBegin(GL_TRIANGLE_STRIP);
-            glColor3f(0.8f * m_bkgRed, 0.8f * m_bkgGreen, 0.8f * m_bkgBlue); glVertex3f(x1, y1, -4.0); // top left
-            glColor3f(0.6f * m_bkgRed, 0.6f * m_bkgGreen, 0.6f * m_bkgBlue); glVertex3f(x2, y1, -4.0); // top right
-            glColor3f(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue); glVertex3f(x1, y2, -4.0); // bottom left
-            glColor3f(0.2f * m_bkgRed, 0.2f * m_bkgGreen, 0.2f * m_bkgBlue); glVertex3f(x2, y2, -4.0); // bottom right
-            glEnd();
+            m_spectrumRenderer.drawGradientRect(
+                m_panRect,
+                QColor::fromRgbF(0.8f * m_bkgRed, 0.8f * m_bkgGreen, 0.8f * m_bkgBlue), // top left
+                QColor::fromRgbF(0.6f * m_bkgRed, 0.6f * m_bkgGreen, 0.6f * m_bkgBlue), // top right
+                QColor::fromRgbF(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue), // bottom left
+                QColor::fromRgbF(0.2f * m_bkgRed, 0.2f * m_bkgGreen, 0.2f * m_bkgBlue), // bottom right
+                -4.0f);
         } else {
-            glBegin(GL_TRIANGLE_STRIP);
-            glColor3f(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue); glVertex3f(x1, y1, -4.0);
-            glColor3f(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue); glVertex3f(x2, y1, -4.0);
-            glColor3f(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue); glVertex3f(x1, y2, -4.0);
-            glColor3f(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue); glVertex3f(x2, y2, -4.0);
-            glEnd();
+            m_spectrumRenderer.drawRect(
+                m_panRect,
+                QColor::fromRgbF(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue),
+                -4.0f);
         }
     } else {
-        drawGLRect(m_panRect, QColor(30, 30, 50, 155), -4.0f);
+        m_spectrumRenderer.drawRect(m_panRect, QColor(30, 30, 50, 155), -4.0f);
     }
 
     // Set a DPR-aware scissor box
     glScissor(x1, (size().height() * dpr - y2 * dpr), (x2 - x1) * dpr, height * dpr);
     glEnable(GL_SCISSOR_TEST);
-    spectrumBufferMutex.lock();
-
-    TGL3float *vertexArray = new TGL3float[vertexArrayLength];
-    TGL3float *vertexColorArray = new TGL3float[vertexArrayLength];
-
-    TGL3float *vertexArrayBg = new TGL3float[2*vertexArrayLength];
-    TGL3float *vertexColorArrayBg = new TGL3float[2*vertexArrayLength];
-
-    TGL3float *vertexArrayBgPH = new TGL3float[2*vertexArrayLength];
-    TGL3float *vertexColorArrayBgPH = new TGL3float[2*vertexArrayLength];
 
-    TGL3float *vertexArrayPH = new TGL3float[vertexArrayLength];
-    TGL3float *vertexColorArrayPH = new TGL3float[vertexArrayLength];
+    // the bins go up once; fill, line and bars are drawn from them by the
+    // vertex shader
+    TSpectrumScale scale;
+    scale.x0 = 0.0f;
+    scale.yBase = (float)y2;
+    scale.yScale = (float)(m_panRect.height() / dBmRange);
+    scale.colorScale = 0.0f;
+
+    const TSpectrumDisplayFrame &frame = m_displayWorker->frame();
+    scale.xStep = frame.scaleMult > 0.0f ? 1.0f / frame.scaleMult : 1.0f;
+    m_spectrumRenderer.setSpectrum(frame.panBins.constData(), frame.panBins.size(), scale);
+
+    mutex.lock();
+    QColor lineColor = QColor::fromRgbF(m_red, m_green, m_blue);
+    QColor fillTopColor = QColor::fromRgbF(0.7f * m_redF, 0.7f * m_greenF, 0.7f * m_blueF);
+    QColor fillBottomColor = QColor::fromRgbF(0.3f * m_redF, 0.3f * m_greenF, 0.3f * m_blueF);
+    QColor solidTopColor = QColor::fromRgbF(m_redST, m_greenST, m_blueST);
+    QColor solidBottomColor = QColor::fromRgbF(m_redSB, m_greenSB, m_blueSB);
+    mutex.unlock();
 
     switch (m_panMode) {
 
         case (PanGraphicsMode) FilledLine:
 
-            for (int i = 0; i < vertexArrayLength; i++) {
-
-                mutex.lock();
-                vertexColorArrayBg[2*i].x = 0.7 * m_redF;
-                vertexColorArrayBg[2*i].y = 0.7 * m_greenF;
-                vertexColorArrayBg[2*i].z = 0.7 * m_blueF;
-
-                vertexColorArrayBg[2*i+1].x = 0.3 * m_redF;
-                vertexColorArrayBg[2*i+1].y = 0.3 * m_greenF;
-                vertexColorArrayBg[2*i+1].z = 0.3 * m_blueF;
-
-                vertexColorArray[i].x = m_red;
-                vertexColorArray[i].y = m_green;
-                vertexColorArray[i].z = m_blue;
-
-                mutex.unlock();
-
-                vertexArrayBg[2*i].x = (GLfloat)(i/m_scaleMult);
-                vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-                vertexArrayBg[2*i].z = -1.5;
-
-                vertexArrayBg[2*i+1].x = (GLfloat)(i/m_scaleMult);
-                vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-                vertexArrayBg[2*i+1].z = -1.5;
-
-                /*vertexArray[i].x = (GLfloat)(i/m_scaleMult);
-                vertexArray[i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-                vertexArray[i].z = -1.0;*/
-            }
-
-            glEnableClientState(GL_VERTEX_ARRAY);
-            glEnableClientState(GL_COLOR_ARRAY);
-
-            glVertexPointer(3, GL_FLOAT, 0, vertexArrayBg);
-            glColorPointer(3, GL_FLOAT, 0, vertexColorArrayBg);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 2*vertexArrayLength);
-
-            glVertexPointer(3, GL_FLOAT, 6*sizeof(float), vertexArrayBg);
-            glColorPointer(3, GL_FLOAT, 0, vertexColorArray);
-            glDrawArrays(GL_LINE_STRIP, 0, vertexArrayLength);
-
-            glDisableClientState(GL_VERTEX_ARRAY);
-            glDisableClientState(GL_COLOR_ARRAY);
-
+            m_spectrumRenderer.drawSpectrumFill(fillTopColor, fillBottomColor, -1.5f);
+            m_spectrumRenderer.drawSpectrumLine(lineColor, -1.0f);
             break;
 
         case (PanGraphicsMode) Line:
 
-            for (int i = 0; i < vertexArrayLength; i++) {
-
-                mutex.lock();
-                vertexColorArray[i].x = m_red;
-                vertexColorArray[i].y = m_green;
-                vertexColorArray[i].z = m_blue;
-
-                mutex.unlock();
-
-                vertexArray[i].x = (GLfloat)(i/m_scaleMult);
-                vertexArray[i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-                vertexArray[i].z = -1.0;
-            }
-
-            glEnableClientState(GL_VERTEX_ARRAY);
-            glEnableClientState(GL_COLOR_ARRAY);
-
-            glVertexPointer(3, GL_FLOAT, 0, vertexArray);
-            glColorPointer(3, GL_FLOAT, 0, vertexColorArray);
-            glDrawArrays(GL_LINE_STRIP, 0, vertexArrayLength);
-
-
-            glDisableClientState(GL_VERTEX_ARRAY);
-            glDisableClientState(GL_COLOR_ARRAY);
-
+            m_spectrumRenderer.drawSpectrumLine(lineColor, -1.0f);
             break;
 
         case (PanGraphicsMode) Solid:
@@ -851,55 +791,11 @@ void QGLReceiverPanel::drawPanadapter() {
             glDisable(GL_MULTISAMPLE);
             glDisable(GL_LINE_SMOOTH);
 
-            mutex.lock();
-            for (int i = 0; i < vertexArrayLength; i++) {
-
-                vertexColorArrayBg[2*i].x = m_redST;
-                vertexColorArrayBg[2*i].y = m_greenST;
-                vertexColorArrayBg[2*i].z = m_blueST;
-
-                vertexColorArrayBg[2*i+1].x = m_redSB;
-                vertexColorArrayBg[2*i+1].y = m_greenSB;
-                vertexColorArrayBg[2*i+1].z = m_blueSB;
-
-            mutex.unlock();
-
-                vertexArrayBg[2*i].x = (GLfloat)(i/m_scaleMult);
-                vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * m_panadapterBins.at(i));
-                vertexArrayBg[2*i].z = -1.0f;
-
-                vertexArrayBg[2*i+1].x = (GLfloat)(i/m_scaleMult);
-                vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-                //vertexArrayBg[2*i+1].y = (GLfloat)(m_panRect.bottom());
-                //vertexArrayBg[2*i].y = (GLfloat)(yScale * m_panadapterBins.at(i));
-                vertexArrayBg[2*i+1].z = -1.0f;
-            }
-
-            glEnableClientState(GL_VERTEX_ARRAY);
-            glEnableClientState(GL_COLOR_ARRAY);
-
-            glVertexPointer(3, GL_FLOAT, 0, vertexArrayBg);
-            glColorPointer(3, GL_FLOAT, 0, vertexColorArrayBg);
-            //glDrawArrays(GL_QUAD_STRIP, 0, 2*vertexArrayLength);
-            glDrawArrays(GL_LINES, 0, 2*vertexArrayLength);
-
-            glDisableClientState(GL_VERTEX_ARRAY);
-            glDisableClientState(GL_COLOR_ARRAY);
-
+            m_spectrumRenderer.drawSpectrumBars(solidTopColor, solidBottomColor, -1.0f);
             break;
     }
-    spectrumBufferMutex.unlock();
 
-    delete[] vertexArray;
-    delete[] vertexColorArray;
-    delete[] vertexArrayBg;
-    delete[] vertexColorArrayBg;
-    delete[] vertexArrayBgPH;
-    delete[] vertexColorArrayBgPH;
-    delete[] vertexArrayPH;
-    delete[] vertexColorArrayPH;
-
-    //glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    m_spectrumRenderer.end();
 
     glDisable(GL_MULTISAMPLE);
     glDisable(GL_LINE_SMOOTH);
@@ -992,24 +888,23 @@ void QGLReceiverPanel::renderPanVerticalScale() {
     painter.beginNativePainting();
 
     if (len > 0) {
-        glColor3f(0.65f, 0.76f, 0.81f);
-        glLineWidth(1);
-        glBegin(GL_LINES);
+        QVarLengthArray<TGLColorVertex, 128> ticks;
+        QColor mainColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+        QColor subColor = QColor::fromRgbF(0.45f, 0.56f, 0.61f);
+
         for (int i = 0; i < len; i++) {
-            glVertex3f(width, m_dBmScale.mainPointPositions.at(i), 0.0f);
-            glVertex3f(width - 4, m_dBmScale.mainPointPositions.at(i), 0.0f);
+            ticks.append(glColorVertex(width, m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));
+            ticks.append(glColorVertex(width - 4, m_dBmScale.mainPointPositions.at(i), 0.0f, mainColor));
         }
-        glEnd();
-
-        glColor3f(0.45f, 0.56f, 0.61f);
-        if (sublen > 0) {
-            glBegin(GL_LINES);
-            for (int i = 0; i < sublen; i++) {
-                glVertex3f(width, m_dBmScale.subPointPositions.at(i), 0.0f);
-                glVertex3f(width - 2, m_dBmScale.subPointPositions.at(i), 0.0f);
-            }
-            glEnd();
+        for (int i = 0; i < sublen; i++) {
+            ticks.append(glColorVertex(width, m_dBmScale.subPointPositions.at(i), 0.0f, subColor));
+            ticks.append(glColorVertex(width - 2, m_dBmScale.subPointPositions.at(i), 0.0f, subColor));
         }
+
+        glLineWidth(1);
+        m_spectrumRenderer.begin(paintDevice.size().width(), paintDevice.size().height());
+        m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+        m_spectrumRenderer.end();
     }
 
     painter.endNativePainting();
@@ -1085,53 +980,44 @@ void QGLReceiverPanel::drawPanadapterGrid() {
 
 	if (!m_panGrid) return;
 
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-
     glDisable(GL_MULTISAMPLE);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_LINE_STIPPLE);
-    glLineStipple(1, 0x5555);  // Dotted pattern
     glLineWidth(2.0f );
     
     // Use proper grid colors with transparency for non-current receiver
+    QColor color;
     if (m_receiver == m_currentReceiver)
-        glColor4f(m_redGrid, m_greenGrid, m_blueGrid, 1.0f);
+        color = QColor::fromRgbF(m_redGrid, m_greenGrid, m_blueGrid, 1.0f);
     else
-        glColor4f(m_redGrid, m_greenGrid, m_blueGrid, 0.8f);
-    
-    glBegin(GL_LINES);
+        color = QColor::fromRgbF(m_redGrid, m_greenGrid, m_blueGrid, 0.8f);
     
+    QVarLengthArray<TGLColorVertex, 128> vertices;
+
     // Vertical lines (frequency grid)
     int len = m_frequencyScale.mainPointPositions.length();
-    if (len > 0) {
-        for (int i = 0; i < len; i++) {
-            GLint x = m_frequencyScale.mainPointPositions.at(i);
-            glVertex2i(x, m_panRect.top());
-            glVertex2i(x, m_panRect.bottom());
-        }
+    for (int i = 0; i < len; i++) {
+        GLint x = m_frequencyScale.mainPointPositions.at(i);
+        vertices.append(glColorVertex(x, m_panRect.top(), 0.0f, color));
+        vertices.append(glColorVertex(x, m_panRect.bottom(), 0.0f, color));
     }
     
     // Horizontal lines (dBm grid)
     len = m_dBmScale.mainPointPositions.length();
-    if (len > 0) {
-        for (int i = 0; i < len; i++) {
-            GLint y = m_dBmScale.mainPointPositions.at(i);
-            glVertex2i(m_panRect.left(), y);
-            glVertex2i(m_panRect.right(), y);
-        }
+    for (int i = 0; i < len; i++) {
+        GLint y = m_dBmScale.mainPointPositions.at(i);
+        vertices.append(glColorVertex(m_panRect.left(), y, 0.0f, color));
+        vertices.append(glColorVertex(m_panRect.right(), y, 0.0f, color));
     }
     
-    glEnd();
+    // both directions in one dotted layer
+    m_spectrumRenderer.begin(size().width(), size().height());
+    m_spectrumRenderer.drawVertices(GL_LINES, vertices.constData(), vertices.size(), 0x5555);
+    m_spectrumRenderer.end();
     
     // Restore OpenGL state
-    glDisable(GL_LINE_STIPPLE);
     glDisable(GL_BLEND);
 
-	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 	glColor3f(0.65f, 0.76f, 0.81f);
 	glEnable(GL_MULTISAMPLE);
 
@@ -1152,33 +1038,31 @@ void QGLReceiverPanel::drawCenterLine() {
 		//color = set->getPanadapterColors().panCenterLineColor;
 		QColor col = QColor(80, 180, 240, 180);
 
-		glDisable(GL_MULTISAMPLE);
-        glLineWidth(3);
-		glColor4ub(col.red(), col.green(), col.blue(), col.alpha());
+		TGLColorVertex vertices[6];
+		int count = 0;
 
 		// center frequency line
-		glBegin(GL_LINES);
-			glVertex3f(x, y1 + 1, 3.5f);
-			glVertex3f(x, y - 1, 3.5f);
-		glEnd();
+		vertices[count++] = glColorVertex(x, y1 + 1, 3.5f, col);
+		vertices[count++] = glColorVertex(x, y - 1, 3.5f, col);
 			
 		x = m_panRect.left() + qRound((qreal)(m_panRect.width()/2.0f)  - m_deltaF * m_panRect.width() / m_freqScaleZoomFactor);
 		col = set->getPanadapterColors().panCenterLineColor;
-		glColor4ub(col.red(), col.green(), col.blue(), 255);
+		col.setAlpha(255);
 
 		// VFO frequency line
 		if (m_dragMouse && !m_panLocked) {
 
-			//glLineWidth(3);
-			glBegin(GL_LINES);
-				glVertex3f(x, m_freqScalePanRect.bottom() + 1, 3.0f);
-				glVertex3f(x, m_freqScalePanRect.bottom() + m_waterfallRect.height() - 1, 3.0f);
-			glEnd();
+			vertices[count++] = glColorVertex(x, m_freqScalePanRect.bottom() + 1, 3.0f, col);
+			vertices[count++] = glColorVertex(x, m_freqScalePanRect.bottom() + m_waterfallRect.height() - 1, 3.0f, col);
 		}
-		glBegin(GL_LINES);
-			glVertex3f(x, y1 + 1, 4.0f);
-			glVertex3f(x, y - 1, 4.0f);
-		glEnd();
+		vertices[count++] = glColorVertex(x, y1 + 1, 4.0f, col);
+		vertices[count++] = glColorVertex(x, y - 1, 4.0f, col);
+
+		glDisable(GL_MULTISAMPLE);
+        glLineWidth(3);
+		m_spectrumRenderer.begin(size().width(), size().height());
+		m_spectrumRenderer.drawVertices(GL_LINES, vertices, count);
+		m_spectrumRenderer.end();
 		glEnable(GL_MULTISAMPLE);
 	}
 
@@ -1230,25 +1114,41 @@ void QGLReceiverPanel::drawPanFilter() {
 	
 	m_filterRect = QRect(m_filterLeft, m_filterTop, m_filterRight - m_filterLeft, m_filterBottom - m_filterTop);
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+
 	if ((m_filterLeft >= m_panRect.left() && m_filterLeft <= m_panRect.right()) ||
 		(m_filterRight >= m_panRect.left() && m_filterRight <= m_panRect.right()) ||
 		(m_filterLeft < m_panRect.left() && m_filterRight > m_panRect.right()))
 	{
-		if (m_filterRect.height() > 5) drawGLRect(m_filterRect, color, 0.0f);
+		if (m_filterRect.height() > 5) m_spectrumRenderer.drawRect(m_filterRect, color, 0.0f);
 	}
-	// filter boundaries
+
+	// filter boundaries, both in one layer ahead of their text
+	TGLColorVertex boundaries[4];
+	int count = 0;
+
+	color = QColor(150, 150, 150, 230);
 	if (m_showFilterLeftBoundary) {
 
-		color = QColor(150, 150, 150, 230);
+		boundaries[count++] = glColorVertex(m_filterLeft, m_filterTop, 4.0f, color);
+		boundaries[count++] = glColorVertex(m_filterLeft, m_filterBottom, 4.0f, color);
+	}
+	if (m_showFilterRightBoundary) {
+
+		boundaries[count++] = glColorVertex(m_filterRight, m_filterTop, 4.0f, color);
+		boundaries[count++] = glColorVertex(m_filterRight, m_filterBottom, 4.0f, color);
+	}
+	if (count > 0) {
 
 		glDisable(GL_MULTISAMPLE);
 		glLineWidth(1);
-		qglColor(color);
-		glBegin(GL_LINES);
-			glVertex3f(m_filterLeft, m_filterTop, 4.0f);
-			glVertex3f(m_filterLeft, m_filterBottom, 4.0f);
-		glEnd();
+		m_spectrumRenderer.drawVertices(GL_LINES, boundaries, count);
 		glEnable(GL_MULTISAMPLE);
+	}
+
+	m_spectrumRenderer.end();
+
+	if (m_showFilterLeftBoundary) {
 
 		// text
 		QString str1 = QString("Filter Lo");
@@ -1281,17 +1181,6 @@ void QGLReceiverPanel::drawPanFilter() {
 
 	if (m_showFilterRightBoundary) {
 
-		color = QColor(150, 150, 150, 230);
-
-		glDisable(GL_MULTISAMPLE);
-		glLineWidth(1);
-		qglColor(color);
-		glBegin(GL_LINES);
-			glVertex3f(m_filterRight, m_filterTop, 4.0f);
-			glVertex3f(m_filterRight, m_filterBottom, 4.0f);
-		glEnd();
-		glEnable(GL_MULTISAMPLE);
-
 		// text
 		QString str1 = QString("Filter Hi");
 		QString str2 = frequencyString(m_filterUpperFrequency, true);
@@ -1323,260 +1212,88 @@ void QGLReceiverPanel::drawPanFilter() {
 	}
 }
 
+// The waterfall lives in one texture of m_waterfallRect's size that is used
+// as a ring of rows: a new line overwrites the oldest row with
+// glTexSubImage2D and becomes the top of the display. The quad starts its
+// texture coordinates at that row and wraps through GL_REPEAT, so nothing is
+// scrolled or re-uploaded; a line costs one row upload.
 void QGLReceiverPanel::drawWaterfall() {
+
 	if (m_waterfallRect.isEmpty()) return;
 
 	int top = m_waterfallRect.top();
 	int left = m_waterfallRect.left();
-    int width = m_waterfallRect.width();
-    int height = m_waterfallRect.height();
-	//int height = this->size().height();
+	int width = m_waterfallRect.width();
+	int height = m_waterfallRect.height();
 
+	if (m_dataEngineState != QSDR::DataEngineUp) {
 
-    glColor4f(1.0, 1.0, 1.0, 1.0);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_BLEND);
-
-	// check for framebuffer objects
-	if (set->getFBOPresence()) {
-		const bool useDirectWaylandPath = QGuiApplication::platformName().contains("wayland", Qt::CaseInsensitive);
-
-		if (useDirectWaylandPath) {
-
-			if (m_dataEngineState == QSDR::DataEngineUp) {
-
-				const int frameSize = width * height;
-				if (width > 0 && height > 0 && (m_waterfallUpdate || m_waterfallFramePixel.size() != frameSize)) {
-
-					m_waterfallFramePixel.clear();
-					m_waterfallFramePixel.resize(frameSize);
-
-					TGL_ubyteRGBA black;
-					black.red = 0; black.green = 0; black.blue = 0; black.alpha = 255;
-
-					for (int i = 0; i < frameSize; ++i)
-						m_waterfallFramePixel[i] = black;
-
-					m_waterfallLineCnt = 0;
-					m_waterfallUpdate = false;
-				}
-
-				if (frameSize > 0 && m_waterfallFramePixel.size() == frameSize) {
-
-					if (height > 1) {
-						std::memmove(
-							m_waterfallFramePixel.data() + width,
-							m_waterfallFramePixel.data(),
-							sizeof(TGL_ubyteRGBA) * width * (height - 1));
-					}
-
-					std::memcpy(
-						m_waterfallFramePixel.data(),
-						m_waterfallPixel.data(),
-						sizeof(TGL_ubyteRGBA) * width);
-
-					if (m_waterfallTextureId == 0)
-						glGenTextures(1, &m_waterfallTextureId);
-
-					GLint oldTex;
-					glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTex);
-
-					glBindTexture(GL_TEXTURE_2D, m_waterfallTextureId);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_waterfallFramePixel.data());
-
-					glEnable(GL_TEXTURE_2D);
-					glBegin(GL_QUADS);
-						glTexCoord2f(0, 0); glVertex2i(left,         top);
-						glTexCoord2f(1, 0); glVertex2i(left + width, top);
-						glTexCoord2f(1, 1); glVertex2i(left + width, top + height);
-						glTexCoord2f(0, 1); glVertex2i(left,         top + height);
-					glEnd();
-					glDisable(GL_TEXTURE_2D);
-
-					glBindTexture(GL_TEXTURE_2D, oldTex);
-
-					m_waterfallLineCnt++;
-					if (m_waterfallLineCnt > height) m_waterfallLineCnt = height;
-				}
-			}
-			else {
-
-				drawGLRect(m_waterfallRect, Qt::black);
-			}
-
-			return;
-		}
-	
-		// create the FBOs if not exist
-		if (!m_textureFBO || !m_waterfallLineFBO || !m_waterfallFBO || m_waterfallUpdate) {
-	
-			if (m_waterfallLineFBO) {
-
-				delete m_waterfallLineFBO;
-				m_waterfallLineFBO = 0;
-			}
-		
-			if (m_waterfallFBO) {
-
-				delete m_waterfallFBO;
-				m_waterfallFBO = 0;
-			}
-
-			if (m_textureFBO) {
-
-				delete m_textureFBO;
-				m_textureFBO = 0;
-			}
-
-			if (QOpenGLFramebufferObject::hasOpenGLFramebufferBlit()) {
-			
-				//QOpenGLFramebufferObjectFormat format;
-				//format.setSamples(2);
-				//format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
-
-				m_waterfallLineFBO = new QOpenGLFramebufferObject(width , 1);
-				//if (m_waterfallLineFBO)
-				//GRAPHICS_DEBUG << "m_waterfallLineFBO generated.";
-
-				m_waterfallFBO = new QOpenGLFramebufferObject(width, height);
-				//if (m_waterfallFBO)
-				//GRAPHICS_DEBUG << "m_waterfallFBO generated.";
-
-                m_textureFBO = new QOpenGLFramebufferObject(width, height);
-				//if (m_textureFBO)
-				//GRAPHICS_DEBUG << "m_textureFBO generated.";
-				
-				// Avoid linear filtering shimmer when shifting by single-pixel rows.
-				glBindTexture(GL_TEXTURE_2D, m_waterfallLineFBO->texture());
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-				glBindTexture(GL_TEXTURE_2D, m_waterfallFBO->texture());
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-				glBindTexture(GL_TEXTURE_2D, m_textureFBO->texture());
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-				glBindTexture(GL_TEXTURE_2D, 0);
-
-			}	
-			else {
-			
-				GRAPHICS_DEBUG << "has no OpenGL FramebufferBlit";
-			}
-
-			m_waterfallUpdate = false;
-            drawGLRect(m_waterfallRect, Qt::black);
-
-			m_waterfallLineCnt = 0;
-						
-			if (width > 0) {
-
-				m_waterfallPixel.clear();
-				m_waterfallPixel.resize(width);
-		
-				TGL_ubyteRGBA col;
-				col.red = 0; col.green = 0;	col.blue = 0; col.alpha = 255;
-		
-				for (int i = 0; i < width; i++) 
-					m_waterfallPixel[i] = col;
-			}
-		}
-
-		if (m_dataEngineState == QSDR::DataEngineUp) {
-
-			GLint oldTex;
-			glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTex);
-
-			m_waterfallLineFBO->bind();
-			glBindTexture(GL_TEXTURE_2D, m_waterfallLineFBO->texture());
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, m_waterfallPixel.data());
-			glBindTexture(GL_TEXTURE_2D, oldTex);
-			m_waterfallLineFBO->release();
-
-			m_waterfallLineCnt++;
-			if (m_waterfallLineCnt > height) m_waterfallLineCnt = height;
-
-			// draw the waterfall
-			glEnable(GL_TEXTURE_2D);
-			glBindTexture(GL_TEXTURE_2D, m_waterfallFBO->texture());
-	
-			glBegin(GL_QUADS);
-				glTexCoord2f(0, 1); glVertex2i(left,			top);			// top left corner
-				glTexCoord2f(1, 1); glVertex2i(left + width,	top);			// top right corner
-				glTexCoord2f(1, 0); glVertex2i(left + width,	top + height);	// bottom right corner
-				glTexCoord2f(0, 0); glVertex2i(left,			top + height);	// bottom left corner
-			glEnd();
-			glBindTexture(GL_TEXTURE_2D, oldTex);
-			glDisable(GL_TEXTURE_2D);
-
-			glPushAttrib(GL_VIEWPORT_BIT);
-            glViewport(0, 0, width, height);
-			setProjectionOrthographic(width, height);
-
-			// render to the next waterfall texture
-			m_textureFBO->bind();
+		drawGLRect(m_waterfallRect, Qt::black);
+		return;
+	}
 
-			glEnable(GL_TEXTURE_2D);
-			glBindTexture(GL_TEXTURE_2D, m_waterfallFBO->texture());
+	if (m_waterfallTextureId == 0 || m_waterfallUpdate ||
+		m_waterfallTextureWidth != width || m_waterfallTextureHeight != height)
+	{
+		if (m_waterfallTextureId == 0)
+			glGenTextures(1, &m_waterfallTextureId);
 
-			// the waterfall FBO
-			glBegin(GL_QUADS);
-				glTexCoord2f(0, 1); glVertex2i(0,	  1);			// top left corner
-				glTexCoord2f(1, 1); glVertex2i(width, 1);			// top right corner
-				glTexCoord2f(1, 0); glVertex2i(width, 1 + height);	// bottom right corner
-				glTexCoord2f(0, 0); glVertex2i(0,	  1 + height);	// bottom left corner
-			glEnd();
+		TGL_ubyteRGBA black;
+		black.red = 0; black.green = 0; black.blue = 0; black.alpha = 255;
+		const QVector<TGL_ubyteRGBA> blackFrame(width * height, black);
 
-			// the new waterfall line
-			glBindTexture(GL_TEXTURE_2D, m_waterfallLineFBO->texture());
-			
-			glBegin(GL_QUADS);
-				glTexCoord2f(0, 1); glVertex2i(0,		0);	// top left corner
-				glTexCoord2f(1, 1); glVertex2i(width,	0);	// top right corner
-				glTexCoord2f(1, 0); glVertex2i(width,	1);	// bottom right corner
-				glTexCoord2f(0, 0); glVertex2i(0,		1);	// bottom left corner
-			glEnd();
-			
-			m_textureFBO->release();
+		glBindTexture(GL_TEXTURE_2D, m_waterfallTextureId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, blackFrame.constData());
 
-			glDisable(GL_TEXTURE_2D);
-			glPopAttrib();
-			const qreal dprNow = devicePixelRatioF();
-			glViewport(0, 0, (GLsizei)(size().width() * dprNow), (GLsizei)(size().height() * dprNow));
-			setProjectionOrthographic(size().width(), size().height());
+		m_waterfallTextureWidth = width;
+		m_waterfallTextureHeight = height;
+		m_waterfallTopRow = 0;
+		m_waterfallUpdate = false;
+	}
+	else {
 
-			if (m_waterfallLineCnt < height) {
+		glBindTexture(GL_TEXTURE_2D, m_waterfallTextureId);
+	}
 
-				QRect rect(0, top + m_waterfallLineCnt, width, height - m_waterfallLineCnt);
-				drawGLRect(rect, QColor(0, 0, 0, 255), 3.0f);
-			}
-            m_waterfallFBO->release();
+	const QVector<quint32> &row = m_displayWorker->frame().waterfallRow;
+	if (m_waterfallDisplayUpdate && row.size() >= width) {
 
-			// Avoid an extra blit/copy pass: the newly rendered frame is already in
-			// m_textureFBO, so swap roles for the next draw/update cycle.
-			qSwap(m_waterfallFBO, m_textureFBO);
+		m_waterfallTopRow = (m_waterfallTopRow + height - 1) % height;
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_waterfallTopRow, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, row.constData());
+	}
 
+	const GLfloat t0 = (GLfloat) m_waterfallTopRow / height;
+	const GLfloat t1 = t0 + 1.0f;
 
-		}
-		else {
+	glColor4f(1.0, 1.0, 1.0, 1.0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_BLEND);
 
-			drawGLRect(m_waterfallRect, Qt::black);
-		}
-	}
-	else {
-	}
+	// one strip from client arrays; nothing is read back from GL
+	const TGL2float vertexArray[4] = {
+		{ (GLfloat) left,           (GLfloat) top },				// newest line
+		{ (GLfloat) (left + width), (GLfloat) top },
+		{ (GLfloat) left,           (GLfloat) (top + height) },	// oldest line
+		{ (GLfloat) (left + width), (GLfloat) (top + height) }
+	};
+	const TGL2float texCoordArray[4] = { { 0, t0 }, { 1, t0 }, { 0, t1 }, { 1, t1 } };
+
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, vertexArray);
+	glTexCoordPointer(2, GL_FLOAT, 0, texCoordArray);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+
+	// the scale and text code binds its own textures
+	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void QGLReceiverPanel::drawWaterfallVerticalScale() {
@@ -1651,31 +1368,33 @@ void QGLReceiverPanel::drawCrossHair() {
 	glDisable(GL_LINE_SMOOTH);
 	glLineWidth(1.0f * dpr);
 
-	qglColor(QColor(95, 95, 95, 255));
 	// set a scissor box
 	glScissor(rect.left() * dpr, rect.top() * dpr, rect.width() * dpr - 1, rect.height() * dpr);
 	glEnable(GL_SCISSOR_TEST);
 
-	// horizontal line
-	glBegin(GL_LINES);
-		glVertex3f(m_dBmScalePanRect.right() - 2, y, 4.0f);
-		glVertex3f(rect.right() - 1, y, 4.0f);
-	glEnd();
-
-	// vertical line
-	glBegin(GL_LINES);
-		glVertex3f(x, rect.top() + 1, 4.0f);
-		glVertex3f(x, rect.bottom() - 1, 4.0f);
-	glEnd();
-
-	// cross hair
-	qglColor(QColor(180, 180, 180, 255));
-	glBegin(GL_LINES);
-		glVertex3f(x     , y - crossHairSize, 5.0f);
-		glVertex3f(x     , y + crossHairSize, 5.0f);
-		glVertex3f(x - crossHairSize, y, 5.0f);
-		glVertex3f(x + crossHairSize, y, 5.0f);
-	glEnd();
+	QColor lineColor(95, 95, 95, 255);
+	QColor hairColor(180, 180, 180, 255);
+
+	const TGLColorVertex vertices[8] = {
+
+		// horizontal line
+		glColorVertex(m_dBmScalePanRect.right() - 2, y, 4.0f, lineColor),
+		glColorVertex(rect.right() - 1, y, 4.0f, lineColor),
+
+		// vertical line
+		glColorVertex(x, rect.top() + 1, 4.0f, lineColor),
+		glColorVertex(x, rect.bottom() - 1, 4.0f, lineColor),
+
+		// cross hair
+		glColorVertex(x, y - crossHairSize, 5.0f, hairColor),
+		glColorVertex(x, y + crossHairSize, 5.0f, hairColor),
+		glColorVertex(x - crossHairSize, y, 5.0f, hairColor),
+		glColorVertex(x + crossHairSize, y, 5.0f, hairColor)
+	};
+
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINES, vertices, 8);
+	m_spectrumRenderer.end();
 
 	// text	
 	QString dFstr;
@@ -1761,7 +1480,7 @@ void QGLReceiverPanel::drawCrossHair() {
 		m_oldMousePosX = m_mousePos.x();
 	}
 
-	glColor3f(0.94f, 0.82f, 0.43f);
+	qglColor(QColor::fromRgbF(0.94f, 0.82f, 0.43f));
 	if (m_smallSize)
 		m_oglTextSmall->renderText(tx, ty + 4*fontHeight, 5.0f, m_bandText);
 	else
@@ -1779,6 +1498,9 @@ void QGLReceiverPanel::drawVFOControl() {
 	int x1 = m_dBmScalePanRect.right() + 5;
 	int y1 = 3;
 
+	// all labels in one draw call
+	m_oglTextSmall->begin();
+
 	if (m_panLocked) {
 		
 		if (m_dataEngineState == QSDR::DataEngineUp) {
@@ -1901,6 +1623,8 @@ void QGLReceiverPanel::drawVFOControl() {
 		m_oglTextSmall->renderText(x+1, y-2, 3.0f, str);
 	}
 
+	m_oglTextSmall->end();
+
 	//qglColor(QColor(0, 0, 0));
 	//m_oglTextSmall->renderFreqText(x1+1, y1-2, 3.0f, str);
 
@@ -2155,13 +1879,16 @@ void QGLReceiverPanel::drawReceiverInfo() {
 void QGLReceiverPanel::drawAGCControl() {
 
 	glDisable(GL_MULTISAMPLE);
-	glLineStipple(1, 0x0C0C);
-	glEnable(GL_LINE_STIPPLE);
 	glLineWidth(1.0f);
 
 	glScissor(m_panRect.left(), size().height() - (m_panRect.top() + m_panRect.height()), m_panRect.left() + m_panRect.width(), m_panRect.height());
 	glEnable(GL_SCISSOR_TEST);
 
+	// a black shadow under each colored level line
+	QColor shadow(0, 0, 0, 255);
+	TGLColorVertex lines[12];
+	int count = 0;
+
 	if (m_agcMode == (AGCMode) agcOFF) {
 
 		m_agcFixedGainLevelPixel = dBmToGLPixel(m_panRect, m_dBmPanMax, m_dBmPanMin, -m_agcFixedGain);
@@ -2174,14 +1901,11 @@ void QGLReceiverPanel::drawAGCControl() {
 		m_oglTextSmall->renderText(m_panRect.right() - 34, m_agcFixedGainLevelPixel - 15, 5.0f, str);
 
 		// AGC fixed gain line
-		glBegin(GL_LINES);
-			qglColor(QColor(0, 0, 0, 255));
-			glVertex3f(m_dBmScalePanRect.right() - 1, m_agcFixedGainLevelPixel + 2, 4.0f);
-			glVertex3f(m_panRect.right() - 1, m_agcFixedGainLevelPixel, 4.0f);
-			qglColor(QColor(225, 125, 225, 255));
-			glVertex3f(m_dBmScalePanRect.right() - 3, m_agcFixedGainLevelPixel, 5.0f);
-			glVertex3f(m_panRect.right() - 1, m_agcFixedGainLevelPixel, 4.0f);
-		glEnd();
+		QColor color(225, 125, 225, 255);
+		lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 1, m_agcFixedGainLevelPixel + 2, 4.0f, shadow);
+		lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcFixedGainLevelPixel, 4.0f, shadow);
+		lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 3, m_agcFixedGainLevelPixel, 5.0f, color);
+		lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcFixedGainLevelPixel, 4.0f, color);
 
 	}
 	else {
@@ -2198,14 +1922,11 @@ void QGLReceiverPanel::drawAGCControl() {
 		m_oglTextSmall->renderText(m_panRect.right() - 34, m_agcThresholdPixel - 15, 5.0f, str);
 
 		// AGC threshold line
-		glBegin(GL_LINES);
-			qglColor(QColor(0, 0, 0, 255));
-			glVertex3f(m_dBmScalePanRect.right() - 1, m_agcThresholdPixel + 2, 4.0f);
-			glVertex3f(m_panRect.right() - 1, m_agcThresholdPixel, 4.0f);
-			qglColor(QColor(225, 125, 125, 255));
-			glVertex3f(m_dBmScalePanRect.right() - 3, m_agcThresholdPixel, 5.0f);
-			glVertex3f(m_panRect.right() - 1, m_agcThresholdPixel, 4.0f);
-		glEnd();
+		QColor color(225, 125, 125, 255);
+		lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 1, m_agcThresholdPixel + 2, 4.0f, shadow);
+		lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcThresholdPixel, 4.0f, shadow);
+		lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 3, m_agcThresholdPixel, 5.0f, color);
+		lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcThresholdPixel, 4.0f, color);
 
 		// AGC hang threshold line
 		if (m_agcHangEnabled) {
@@ -2216,19 +1937,19 @@ void QGLReceiverPanel::drawAGCControl() {
 			qglColor(QColor(125, 225, 125, 255));
 			m_oglTextSmall->renderText(m_panRect.right() - 34, m_agcHangLevelPixel - 15, 5.0f, str);
 
-			glBegin(GL_LINES);
-				qglColor(QColor(0, 0, 0, 255));
-				glVertex3f(m_dBmScalePanRect.right() - 1, m_agcHangLevelPixel + 2, 4.0f);
-				glVertex3f(m_panRect.right() - 1, m_agcHangLevelPixel, 4.0f);
-				qglColor(QColor(125, 225, 125, 255));
-				glVertex3f(m_dBmScalePanRect.right() - 3, m_agcHangLevelPixel, 5.0f);
-				glVertex3f(m_panRect.right() - 1, m_agcHangLevelPixel, 4.0f);
-			glEnd();
+			color = QColor(125, 225, 125, 255);
+			lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 1, m_agcHangLevelPixel + 2, 4.0f, shadow);
+			lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcHangLevelPixel, 4.0f, shadow);
+			lines[count++] = glColorVertex(m_dBmScalePanRect.right() - 3, m_agcHangLevelPixel, 5.0f, color);
+			lines[count++] = glColorVertex(m_panRect.right() - 1, m_agcHangLevelPixel, 4.0f, color);
 		}
 	}
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINES, lines, count, 0x0C0C);
+	m_spectrumRenderer.end();
+
 	glDisable(GL_SCISSOR_TEST);
-	glDisable(GL_LINE_STIPPLE);
 	glEnable(GL_MULTISAMPLE);
 }
  
@@ -2328,13 +2049,11 @@ void QGLReceiverPanel::renderPanadapterGrid() {
     // Set up OpenGL state for efficient line rendering
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_LINE_STIPPLE);  // Try solid lines first for visibility
-    // glEnable(GL_LINE_STIPPLE);
-    // glLineStipple(1, 0x5555);  // Dotted pattern (equivalent to Qt::DotLine)
     glLineWidth(2.0f);  // Make lines thicker for visibility
     
     // Draw all lines in one batch for maximum performance
-    glBegin(GL_LINES);
+    QColor color = QColor::fromRgbF(m_redGrid, m_greenGrid, m_blueGrid, 1.0f);
+    QVarLengthArray<TGLColorVertex, 128> vertices;
 
     // Vertical lines (frequency grid)
     int len = m_frequencyScale.mainPointPositions.length();
@@ -2345,8 +2064,8 @@ void QGLReceiverPanel::renderPanadapterGrid() {
         for (int i = 0; i < len; i++) {
             GLint x = m_frequencyScale.mainPointPositions.at(i) - m_panRect.left();  // Convert to relative coordinates
             if (x >= 0 && x < m_panRect.width()) {  // Only draw if within bounds
-                glVertex2i(x, y1);
-                glVertex2i(x, y2);
+                vertices.append(glColorVertex(x, y1, 0.0f, color));
+                vertices.append(glColorVertex(x, y2, 0.0f, color));
             }
         }
     }
@@ -2360,16 +2079,17 @@ void QGLReceiverPanel::renderPanadapterGrid() {
         for (int i = 0; i < len; i++) {
             GLint y = m_dBmScale.mainPointPositions.at(i) - m_panRect.top();  // Convert to relative coordinates
             if (y >= 0 && y < m_panRect.height()) {  // Only draw if within bounds
-                glVertex2i(x1, y);
-                glVertex2i(x2, y);
+                vertices.append(glColorVertex(x1, y, 0.0f, color));
+                vertices.append(glColorVertex(x2, y, 0.0f, color));
             }
         }
     }
 
-    glEnd();
+    m_spectrumRenderer.begin(m_panRect.width(), m_panRect.height());
+    m_spectrumRenderer.drawVertices(GL_LINES, vertices.constData(), vertices.size());
+    m_spectrumRenderer.end();
     
     // Restore OpenGL state
-    glDisable(GL_LINE_STIPPLE);
     glDisable(GL_BLEND);
    }
  
@@ -2420,30 +2140,28 @@ void QGLReceiverPanel::renderWaterfallVerticalScale() {
 
 	if (len > 0) {
 
-		glColor3f(0.65f, 0.76f, 0.81f);
-		glLineWidth(1);
+		QVarLengthArray<TGLColorVertex, 128> ticks;
+		QColor mainColor = QColor::fromRgbF(0.65f, 0.76f, 0.81f);
+		QColor subColor = QColor::fromRgbF(0.45f, 0.56f, 0.61f);
 
-		glBegin(GL_LINES);
 		for (int i = 0; i < len; i++) {
 
-			glVertex3f(width,     m_secScale.mainPointPositions.at(i), 0.0f);	// origin of the line
-			glVertex3f(width - 4, m_secScale.mainPointPositions.at(i), 0.0f);	// ending point of the line
+			ticks.append(glColorVertex(width,     m_secScale.mainPointPositions.at(i), 0.0f, mainColor));	// origin of the line
+			ticks.append(glColorVertex(width - 4, m_secScale.mainPointPositions.at(i), 0.0f, mainColor));	// ending point of the line
 		}
-		glEnd();
 
-		glColor3f(0.45f, 0.56f, 0.61f);
-		if (sublen > 0) {
+		for (int i = 0; i < sublen; i++) {
 
-			glBegin(GL_LINES);
-			for (int i = 0; i < sublen; i++) {
-
-				glVertex3f(width,     m_secScale.subPointPositions.at(i), 0.0f);	// origin of the line
-				glVertex3f(width - 2, m_secScale.subPointPositions.at(i), 0.0f);	// ending point of the line
-			}
-			glEnd();
+			ticks.append(glColorVertex(width,     m_secScale.subPointPositions.at(i), 0.0f, subColor));	// origin of the line
+			ticks.append(glColorVertex(width - 2, m_secScale.subPointPositions.at(i), 0.0f, subColor));	// ending point of the line
 		}
 
-		glColor3f(0.95f, 0.96f, 0.91f);
+		glLineWidth(1);
+		m_spectrumRenderer.begin(width, height);
+		m_spectrumRenderer.drawVertices(GL_LINES, ticks.constData(), ticks.size());
+		m_spectrumRenderer.end();
+
+		qglColor(QColor::fromRgbF(0.95f, 0.96f, 0.91f));
 		for (int i = 0; i < len; i++) {
 
 			textRect.moveBottom(m_secScale.mainPointPositions.at(i) + textRect.height()/2);
@@ -2461,7 +2179,7 @@ void QGLReceiverPanel::renderWaterfallVerticalScale() {
 	}
 
 	textRect.moveTop(height - textRect.height());
-	glColor3f(0.94f, 0.22f, 0.43f);
+	qglColor(QColor::fromRgbF(0.94f, 0.22f, 0.43f));
 
 	str = QString("sec");
 	if (m_smallSize)
@@ -3528,41 +3246,15 @@ void QGLReceiverPanel::freqRulerPositionChanged(QObject *sender, int rx, float p
 	}
 }
 
-void QGLReceiverPanel::setSpectrumBuffer(int rx, const qVectorFloat& buffer) {
-
-	if (m_receiver != rx) return;
+// Works out which spectrum bins the panadapter shows at the current zoom and
+// width and hands that to the display worker, which does the per frame
+// binning and coloring on its own thread.
+void QGLReceiverPanel::updateDisplayView() {
 
-	QVector<float> specBuf(m_spectrumSize);
-	QVector<float> waterBuf(m_spectrumSize);
-	waterBuf = buffer;
-
-
-	if (m_dataEngineState == QSDR::DataEngineUp) {
-
-		if (m_spectrumAveraging) {
-	
-			spectrumBufferMutex.lock();
-			specBuf = buffer;
-			computeDisplayBins(specBuf, waterBuf);
-			spectrumBufferMutex.unlock();
-		}
-		else {
-
-			specBuf = buffer;
-			if (m_dataEngineState == QSDR::DataEngineUp)
-				computeDisplayBins(specBuf, waterBuf);
-		}
-	}
-}
-
-void QGLReceiverPanel::computeDisplayBins(QVector<float>& buffer, QVector<float>& waterfallBuffer) {
+	if (m_panRectWidth <= 0) return;
 
 	//int m_sampleSize = 0;
 	int deltaSampleSize = 0;
-	int idx = 0;
-	int lIdx = 0;
-	int rIdx = 0;
-	qreal localMax;
 
 		m_sampleSize = (int)floor(m_fftMult * m_spectrumSize * m_freqScaleZoomFactor);
 		deltaSampleSize = m_spectrumSize - m_sampleSize;
@@ -3693,64 +3385,57 @@ void QGLReceiverPanel::computeDisplayBins(QVector<float>& buffer, QVector<float>
 		m_waterfallUpdate = true;
 	}
 
-	m_waterfallPixel.clear();
-	m_waterfallPixel.resize(4 * m_panRectWidth);
-
-	m_panadapterBins.clear();
+	// color the whole line through the lookup table
+	updateWaterfallLut();
 
-	for (int i = 0; i < m_panSpectrumBinsLength; i++) {
-		
-		//qreal max;
-		idx = 0;
-		lIdx = (int)qFloor((qreal)(i * m_panScale / m_scaleMult));
-		rIdx = (int)qFloor((qreal)(i * m_panScale / m_scaleMult) + m_panScale / m_scaleMult);
-					
-		// max value; later we try mean value also!
-		localMax = -10000.0F;
-
-		for (int j = lIdx; j < rIdx; j++) {
-
-			if (buffer.at(j) > localMax) {
-				idx = j;
-			}
-		}
+	// the bins are shifted by half of the difference between full spectrum
+	// size and reduced spectrum size due to zooming
+	TSpectrumDisplayView view;
+	view.first = deltaSampleSize/2;
+	view.sampleSize = m_sampleSize;
+	view.binsLength = m_panSpectrumBinsLength;
+	view.repeat = (int)(1/m_scaleMult);
+	view.rowLength = m_panRectWidth;
+	view.scaleMult = (float) m_scaleMult;
+	view.panOffset = m_mercuryAttenuator
+		? m_dBmPanMin + m_dBmPanLogGain + 20.0f
+		: m_dBmPanMin + m_dBmPanLogGain;
+	view.waterfallGain = m_mercuryAttenuator ? -m_dBmPanLogGain - 20.0f : -m_dBmPanLogGain;
 
+	m_displayWorker->setView(view);
+}
 
-		// shift the beginning of the bins by half of the difference between
-		// full spectrum size and reduced spectrum size due to zooming
-		idx += deltaSampleSize/2;
+// Rebuilds the waterfall lookup table when the color mode, the thresholds or
+// (via invalidate()) the colors have changed since the last line.
+void QGLReceiverPanel::updateWaterfallLut() {
 
-		QColor pColor;
+	const int lowerThreshold = (int)m_dBmPanMin - m_waterfallOffsetLo;
+	const int upperThreshold = (int)m_dBmPanMax + m_waterfallOffsetHi;
 
-//		if (buffer.at(idx) < -120)
-//		{
-//			val = -120 - buffer.at(idx);
-//			qDebug() << "calc " << buffer.at(idx) << "val  " << val;
-//		}
-		if (m_mercuryAttenuator) {
-			m_panadapterBins << buffer.at(idx) - m_dBmPanMin - m_dBmPanLogGain - 20.0f;
-			pColor = getWaterfallColorAtPixel(waterfallBuffer.at(idx) - m_dBmPanLogGain - 20.0f);
-		}
-		else {
-			m_panadapterBins << buffer.at(idx) - m_dBmPanMin - m_dBmPanLogGain;
-			pColor = getWaterfallColorAtPixel(waterfallBuffer.at(idx) - m_dBmPanLogGain);
-		}
+	if (m_waterfallLut.isValid() &&
+		m_waterfallLutMode == m_waterfallMode &&
+		m_waterfallLutLo == lowerThreshold &&
+		m_waterfallLutHi == upperThreshold &&
+		m_waterfallLutRange == m_waterfallColorRange)
+	{
+		return;
+	}
 
+	m_waterfallLut.build(lowerThreshold, upperThreshold, [this](qreal value) {
 
-		TGL_ubyteRGBA color;
-		color.red   = (uchar)(pColor.red());
-		color.green = (uchar)(pColor.green());
-		color.blue  = (uchar)(pColor.blue());
-		color.alpha = 255;
-		
-		for (int j = 0; j < (int)(1/m_scaleMult); j++) {
+		QColor color = getWaterfallColorAtPixel(value);
+		color.setAlpha(255);
+		return color;
+	});
 
-			m_waterfallPixel[(int)(i/m_scaleMult) + j] = color;
-		}
-	}
+	m_waterfallLutMode = m_waterfallMode;
+	m_waterfallLutLo = lowerThreshold;
+	m_waterfallLutHi = upperThreshold;
+	m_waterfallLutRange = m_waterfallColorRange;
+	m_displayWorker->setColorLut(m_waterfallLut);
 
-	m_waterfallDisplayUpdate = true;
-	update();
+	GRAPHICS_DEBUG << "waterfall LUT " << lowerThreshold << " .. " << upperThreshold
+				   << " dBm, kernel " << CColorLut::kernelName();
 }
 
 // get waterfall colors - taken from PowerSDR/KISS Konsole
@@ -4075,6 +3760,7 @@ void QGLReceiverPanel::setPanadapterColors() {
 	m_blueSB  = (GLfloat)(set->getPanadapterColors().panSolidBottomColor.blue() / 256.0);
 
 	m_waterfallMidColor = set->getPanadapterColors().waterfallColor.toRgb() ;
+	m_waterfallLut.invalidate();
 
 	QColor gridColor = m_gridColor;
 	m_gridColor = set->getPanadapterColors().gridLineColor;
@@ -4255,5 +3941,15 @@ void QGLReceiverPanel::showRadioPopup(bool value) {
 void QGLReceiverPanel::qglColor(QColor color)
 {
 		glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+
+		// the text is colored from here, it does not read the GL color back
+		m_oglTextTiny->setColor(color);
+		m_oglTextSmall->setColor(color);
+		m_oglTextNormal->setColor(color);
+		m_oglTextFreq1->setColor(color);
+		m_oglTextFreq2->setColor(color);
+		m_oglTextBig1->setColor(color);
+		m_oglTextBig2->setColor(color);
+		m_oglTextHuge->setColor(color);
 }
 
@@ -32,7 +32,11 @@
 #include "cusdr_settings.h"
 #include "cusdr_fonts.h"
 #include "Util/cusdr_buttons.h"
+#include "Util/cusdr_colorLut.h"
+#include "Util/cusdr_displayScheduler.h"
 #include "cusdr_oglText.h"
+#include "cusdr_oglSpectrumRenderer.h"
+#include "cusdr_spectrumDisplayWorker.h"
 #include "cusdr_radioPopupWidget.h"
 
 #include <QWheelEvent>
@@ -62,7 +66,6 @@ public slots:
 
 	//void setSpectrumBuffer(const float* buffer, int size);
 	//void setSpectrumBuffer(const qVectorFloat& buffer);
-	void setSpectrumBuffer(int rx, const qVectorFloat& buffer);
 	void setCtrFrequency(QObject* sender, int mode, int rx, long freq);
 	void setVFOFrequency(QObject* sender, int mode, int rx, long freq);
 
@@ -114,19 +117,22 @@ private:
 	
 	QList<TReceiver>			m_rxDataList;
 	
-	QVector<qreal>					m_panadapterBins;
-	QVarLengthArray<TGL_ubyteRGBA>	m_waterfallPixel;
-	QVarLengthArray<TGL_ubyteRGBA>	m_waterfallFramePixel;
+	SpectrumDisplayWorker*		m_displayWorker;
+
+	CColorLut					m_waterfallLut;
+	WaterfallColorMode			m_waterfallLutMode;
+	int							m_waterfallLutLo;
+	int							m_waterfallLutHi;
+	int							m_waterfallLutRange;
 
 	QQueue<QVector<float> >			specAv_queue;
 
 	QOpenGLFramebufferObject*	m_frequencyScaleFBO;
 	QOpenGLFramebufferObject*	m_dBmScaleFBO;
-    QOpenGLFramebufferObject*	m_textureFBO;
-	QOpenGLFramebufferObject*	m_waterfallLineFBO;
-	QOpenGLFramebufferObject*	m_waterfallFBO;
 	QOpenGLFramebufferObject*	m_secScaleWaterfallFBO;
 
+	OGLSpectrumRenderer			m_spectrumRenderer;
+
 	QRect						m_panRect;
 	QRect						m_dBmScalePanRect;
 	QRect						m_freqScalePanRect;
@@ -225,6 +231,9 @@ private:
 	
 	unsigned int timer;
 	GLuint		m_waterfallTextureId;
+	GLint		m_waterfallTextureWidth;
+	GLint		m_waterfallTextureHeight;
+	GLint		m_waterfallTopRow;
 
 	int			m_bigHeight;
 	int			m_bigWidth;
@@ -260,7 +269,6 @@ private:
 	int			m_haircrossMaxRight;
 	int			m_haircrossMinTop;
 	int			m_displayCenterlineHeight;
-	int			m_waterfallLineCnt;
 	int			m_adcStatus;
 	int			m_fps;
 	int			m_filterWidth;
@@ -341,6 +349,7 @@ private:
 	void	setupConnections();
 
 	QColor	getWaterfallColorAtPixel(qreal value);
+	void	updateWaterfallLut();
 
 	void	saveGLState();
 	void	restoreGLState();
@@ -369,7 +378,7 @@ private:
 
 	//void	computeDisplayBins(const QVector<float>& panBuffer, const float* waterfallBuffer);
 	//void	computeDisplayBins(QVector<float> &buffer);
-	void	computeDisplayBins(QVector<float>& panBuffer, QVector<float>& waterfallBuffer);
+	void	updateDisplayView();
 	void 	showText(float x, float y, float z, const QString &text, bool smallText);
 	void	showRadioPopup(bool value);
 
@@ -0,0 +1,652 @@
+/**
+* @file  cusdr_oglSpectrumRenderer.cpp
+* @brief shader based renderer for panadapter traces, fills, grids and lines
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_oglSpectrumRenderer.h"
+#include "cusdr_settings.h"
+
+#include <QOpenGLContext>
+#include <QMatrix4x4>
+
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT	0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT		0x0080
+#endif
+
+#define SPECTRUM_RENDERER_FENCE_TIMEOUT		50000000	// ns
+
+// A spectrum vertex is a bare bin value; its position comes from
+// gl_VertexID. Fill and bar layers read every value twice (u_pairs = 1), the
+// even vertex at the trace and the odd one on the base line; the line layer
+// reads one vertex per bin (u_pairs = 0) with a stride of two values.
+static const char *vertexSource = R"(
+	#version 130
+	in vec3 a_pos;
+	in vec4 a_color;
+	in float a_value;
+	uniform mat4 u_mvp;
+	uniform bool u_spectrum;
+	uniform int u_pairs;
+	uniform vec4 u_scale;
+	uniform float u_z;
+	uniform vec4 u_topColor;
+	uniform vec4 u_bottomColor;
+	uniform float u_colorScale;
+	out vec4 v_color;
+	out float v_dash;
+	void main() {
+		if (u_spectrum) {
+			float bin = float(gl_VertexID >> u_pairs);
+			float bottom = float(gl_VertexID & u_pairs);
+			float y = mix(u_scale.z - a_value * u_scale.w, u_scale.z, bottom);
+			gl_Position = u_mvp * vec4(u_scale.x + bin * u_scale.y, y, u_z, 1.0);
+			v_color = mix(u_topColor, u_bottomColor, bottom);
+			if (u_colorScale > 0.0)
+				v_color.rgb *= clamp(a_value * u_colorScale, 0.0, 1.0);
+			v_dash = 0.0;
+		}
+		else {
+			gl_Position = u_mvp * vec4(a_pos, 1.0);
+			v_color = a_color;
+			v_dash = a_pos.x + a_pos.y;
+		}
+	}
+)";
+
+// A non zero u_stipple dashes axis parallel lines with the 16 bit pattern of
+// glLineStipple, each bit covering u_stippleFactor pixels along the line
+static const char *fragmentSource = R"(
+	#version 130
+	in vec4 v_color;
+	in float v_dash;
+	uniform int u_stipple;
+	uniform float u_stippleFactor;
+	out vec4 fragColor;
+	void main() {
+		if (u_stipple != 0) {
+			int bit = int(mod(floor(v_dash / u_stippleFactor), 16.0));
+			if (((u_stipple >> bit) & 1) == 0)
+				discard;
+		}
+		fragColor = v_color;
+	}
+)";
+
+OGLSpectrumRenderer::OGLSpectrumRenderer()
+	: m_program(nullptr)
+	, m_vbo(0)
+	, m_attrPos(-1)
+	, m_attrColor(-1)
+	, m_attrValue(-1)
+	, m_uniformMvp(-1)
+	, m_uniformSpectrum(-1)
+	, m_uniformPairs(-1)
+	, m_uniformScale(-1)
+	, m_uniformZ(-1)
+	, m_uniformTopColor(-1)
+	, m_uniformBottomColor(-1)
+	, m_uniformColorScale(-1)
+	, m_uniformStipple(-1)
+	, m_uniformStippleFactor(-1)
+	, m_bufferStorage(nullptr)
+	, m_valid(false)
+	, m_persistent(false)
+	, m_fixedFunction(false)
+	, m_mapped(nullptr)
+	, m_frameBytes(0)
+	, m_region(0)
+	, m_used(0)
+	, m_spectrumOffset(-1)
+	, m_spectrumCount(0)
+{
+	for (int i = 0; i < SPECTRUM_RENDERER_FRAMES; i++)
+		m_fences[i] = nullptr;
+
+	memset(&m_spectrumScale, 0, sizeof(m_spectrumScale));
+}
+
+OGLSpectrumRenderer::~OGLSpectrumRenderer() {
+
+	// GL objects need the context; the panel calls destroy() before
+	if (m_valid)
+		qWarning() << "OGLSpectrumRenderer destroyed without destroy()";
+}
+
+bool OGLSpectrumRenderer::initialize() {
+
+	QOpenGLContext *context = QOpenGLContext::currentContext();
+	if (!context || context->isOpenGLES()) {
+
+		SPECTRUM_RENDERER_DEBUG << "needs a desktop OpenGL context";
+		return false;
+	}
+
+	initializeOpenGLFunctions();
+
+	if (context->format().version() < qMakePair(3, 0)) {
+
+		SPECTRUM_RENDERER_DEBUG << "OpenGL " << context->format().majorVersion() << "."
+								<< context->format().minorVersion() << ", using fixed function drawing";
+		return initializeFixedFunction();
+	}
+
+	m_program = new QOpenGLShaderProgram();
+	if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource))
+		qWarning() << "spectrum vertex shader:" << m_program->log();
+	if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource))
+		qWarning() << "spectrum fragment shader:" << m_program->log();
+	if (!m_program->link()) {
+
+		qWarning() << "spectrum shader link:" << m_program->log() << "- using fixed function drawing";
+		delete m_program;
+		m_program = nullptr;
+		return initializeFixedFunction();
+	}
+
+	m_attrPos				= m_program->attributeLocation("a_pos");
+	m_attrColor				= m_program->attributeLocation("a_color");
+	m_attrValue				= m_program->attributeLocation("a_value");
+	m_uniformMvp			= m_program->uniformLocation("u_mvp");
+	m_uniformSpectrum		= m_program->uniformLocation("u_spectrum");
+	m_uniformPairs			= m_program->uniformLocation("u_pairs");
+	m_uniformScale			= m_program->uniformLocation("u_scale");
+	m_uniformZ				= m_program->uniformLocation("u_z");
+	m_uniformTopColor		= m_program->uniformLocation("u_topColor");
+	m_uniformBottomColor	= m_program->uniformLocation("u_bottomColor");
+	m_uniformColorScale		= m_program->uniformLocation("u_colorScale");
+	m_uniformStipple		= m_program->uniformLocation("u_stipple");
+	m_uniformStippleFactor	= m_program->uniformLocation("u_stippleFactor");
+
+	m_vao.create();
+
+	if (context->format().version() >= qMakePair(4, 4) || context->hasExtension("GL_ARB_buffer_storage"))
+		m_bufferStorage = reinterpret_cast<BufferStorage>(context->getProcAddress("glBufferStorage"));
+
+	if (!createBuffer(SPECTRUM_RENDERER_FRAME_BYTES)) {
+
+		qWarning() << "spectrum renderer: no vertex buffer - using fixed function drawing";
+		m_vao.destroy();
+		delete m_program;
+		m_program = nullptr;
+		return initializeFixedFunction();
+	}
+
+	SPECTRUM_RENDERER_DEBUG << "vertex buffer " << (m_persistent ? "persistently mapped" : "orphaned per frame");
+
+	m_fixedFunction = false;
+	m_valid = true;
+	return true;
+}
+
+bool OGLSpectrumRenderer::initializeFixedFunction() {
+
+	m_fixedFunction = true;
+	m_valid = true;
+	return true;
+}
+
+void OGLSpectrumRenderer::destroy() {
+
+	if (!m_valid) return;
+
+	if (!m_fixedFunction) {
+
+		destroyBuffer();
+		m_vao.destroy();
+
+		delete m_program;
+		m_program = nullptr;
+	}
+
+	m_fixedBins.clear();
+	m_fixedVertices.clear();
+
+	m_fixedFunction = false;
+	m_valid = false;
+}
+
+bool OGLSpectrumRenderer::createBuffer(int frameBytes) {
+
+	m_frameBytes = frameBytes;
+	m_region = 0;
+	m_used = 0;
+
+	glGenBuffers(1, &m_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+	m_persistent = false;
+	if (m_bufferStorage) {
+
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const GLsizeiptr size = (GLsizeiptr) frameBytes * SPECTRUM_RENDERER_FRAMES;
+
+		m_bufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		m_mapped = static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+
+		if (m_mapped) {
+
+			m_persistent = true;
+		}
+		else {
+
+			// immutable storage cannot be respecified; start over without it
+			qWarning() << "spectrum renderer: persistent mapping failed, using glBufferSubData";
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glDeleteBuffers(1, &m_vbo);
+			m_bufferStorage = nullptr;
+
+			glGenBuffers(1, &m_vbo);
+			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		}
+	}
+
+	if (!m_persistent) {
+
+		glBufferData(GL_ARRAY_BUFFER, frameBytes, nullptr, GL_STREAM_DRAW);
+		m_staging.resize(frameBytes);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return m_vbo != 0;
+}
+
+void OGLSpectrumRenderer::destroyBuffer() {
+
+	for (int i = 0; i < SPECTRUM_RENDERER_FRAMES; i++) {
+
+		if (m_fences[i]) {
+
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = nullptr;
+		}
+	}
+
+	if (m_mapped) {
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_mapped = nullptr;
+	}
+
+	if (m_vbo) {
+
+		glDeleteBuffers(1, &m_vbo);
+		m_vbo = 0;
+	}
+
+	m_persistent = false;
+}
+
+void OGLSpectrumRenderer::newFrame() {
+
+	if (!m_valid) return;
+
+	if (m_fixedFunction) {
+
+		m_spectrumOffset = -1;
+		return;
+	}
+
+	if (m_persistent) {
+
+		// the fence covers everything drawn from this region so far
+		if (m_used > 0)
+			m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_region = (m_region + 1) % SPECTRUM_RENDERER_FRAMES;
+
+		if (m_fences[m_region]) {
+
+			GLenum result = glClientWaitSync(m_fences[m_region], GL_SYNC_FLUSH_COMMANDS_BIT, SPECTRUM_RENDERER_FENCE_TIMEOUT);
+			if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+				SPECTRUM_RENDERER_DEBUG << "region " << m_region << " still busy";
+
+			glDeleteSync(m_fences[m_region]);
+			m_fences[m_region] = nullptr;
+		}
+	}
+	else if (m_used > 0) {
+
+		// orphan: the driver hands out fresh storage while the GPU drains the old
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, m_frameBytes, nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	m_used = 0;
+	m_spectrumOffset = -1;
+}
+
+void OGLSpectrumRenderer::begin(int width, int height) {
+
+	if (!m_valid) return;
+
+	if (m_fixedFunction) {
+
+		// the same projection the shader gets, restored by end()
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho(0.0, (GLdouble) width, (GLdouble) height, 0.0, -5.0, 5.0);
+
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		return;
+	}
+
+	QMatrix4x4 mvp;
+	mvp.ortho(0.0f, (float) width, (float) height, 0.0f, -5.0f, 5.0f);
+
+	m_program->bind();
+	m_program->setUniformValue(m_uniformMvp, mvp);
+
+	m_vao.bind();
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+}
+
+void OGLSpectrumRenderer::end() {
+
+	if (!m_valid) return;
+
+	if (m_fixedFunction) {
+
+		glMatrixMode(GL_PROJECTION);
+		glPopMatrix();
+		glMatrixMode(GL_MODELVIEW);
+		glPopMatrix();
+		return;
+	}
+
+	// client side arrays of the fixed function code break with a bound buffer
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_vao.release();
+	m_program->release();
+}
+
+// Returns space for bytes of vertices in the current frame and their offset
+// in the buffer. A frame that outgrows its region moves to a larger buffer,
+// taking what it has written so far along at the same relative offsets.
+char *OGLSpectrumRenderer::allocate(int bytes, int *offset) {
+
+	bytes = (bytes + 15) & ~15;
+
+	if (m_used + bytes > m_frameBytes) {
+
+		int frameBytes = m_frameBytes;
+		while (m_used + bytes > frameBytes)
+			frameBytes *= 2;
+
+		QByteArray frame(m_persistent ? m_mapped + m_region * m_frameBytes : m_staging.constData(), m_used);
+		const int used = m_used;
+
+		destroyBuffer();
+		createBuffer(frameBytes);
+
+		if (used > 0) {
+
+			char *dst = m_persistent ? m_mapped : m_staging.data();
+			memcpy(dst, frame.constData(), used);
+			upload(0, used);
+		}
+
+		m_used = used;
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+		SPECTRUM_RENDERER_DEBUG << "frame space now " << frameBytes << " bytes";
+	}
+
+	const int base = m_persistent ? m_region * m_frameBytes : 0;
+	char *data = m_persistent ? m_mapped + base + m_used : m_staging.data() + m_used;
+
+	*offset = base + m_used;
+	m_used += bytes;
+
+	return data;
+}
+
+void OGLSpectrumRenderer::upload(int offset, int bytes) {
+
+	// a coherent mapping needs no upload
+	if (m_persistent || bytes <= 0) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, m_staging.constData() + offset);
+}
+
+//************************************************************************
+// geometry layers
+
+void OGLSpectrumRenderer::drawVertices(GLenum mode, const TGLColorVertex *vertices, int count, GLushort stipple, int factor) {
+
+	if (!m_valid || count <= 0) return;
+
+	if (m_fixedFunction) {
+
+		drawFixedFunction(mode, vertices, count, stipple, factor);
+		return;
+	}
+
+	const int bytes = count * (int) sizeof(TGLColorVertex);
+
+	int offset;
+	memcpy(allocate(bytes, &offset), vertices, bytes);
+	upload(offset, bytes);
+
+	glDisableVertexAttribArray(m_attrValue);
+	glEnableVertexAttribArray(m_attrPos);
+	glEnableVertexAttribArray(m_attrColor);
+	glVertexAttribPointer(m_attrPos, 3, GL_FLOAT, GL_FALSE, sizeof(TGLColorVertex),
+						  reinterpret_cast<void *>((qintptr) offset));
+	glVertexAttribPointer(m_attrColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TGLColorVertex),
+						  reinterpret_cast<void *>((qintptr) offset + 3 * sizeof(GLfloat)));
+
+	m_program->setUniformValue(m_uniformSpectrum, (GLint) 0);
+	m_program->setUniformValue(m_uniformStipple, (GLint) stipple);
+	m_program->setUniformValue(m_uniformStippleFactor, (GLfloat) qMax(factor, 1));
+
+	glDrawArrays(mode, 0, count);
+}
+
+void OGLSpectrumRenderer::drawFixedFunction(GLenum mode, const TGLColorVertex *vertices, int count, GLushort stipple, int factor) {
+
+	if (stipple) {
+
+		glLineStipple(qMax(factor, 1), stipple);
+		glEnable(GL_LINE_STIPPLE);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(TGLColorVertex), &vertices->x);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TGLColorVertex), &vertices->r);
+
+	glDrawArrays(mode, 0, count);
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	if (stipple)
+		glDisable(GL_LINE_STIPPLE);
+}
+
+void OGLSpectrumRenderer::drawRect(const QRect &rect, const QColor &color, float z) {
+
+	drawGradientRect(rect, color, color, color, color, z);
+}
+
+void OGLSpectrumRenderer::drawGradientRect(
+		const QRect &rect,
+		const QColor &topLeft,
+		const QColor &topRight,
+		const QColor &bottomLeft,
+		const QColor &bottomRight,
+		float z)
+{
+	if (rect.isEmpty()) return;
+
+	const float x1 = rect.left();
+	const float y1 = rect.top();
+	const float x2 = x1 + rect.width();
+	const float y2 = y1 + rect.height();
+
+	const TGLColorVertex vertices[4] = {
+		glColorVertex(x1, y1, z, topLeft),
+		glColorVertex(x2, y1, z, topRight),
+		glColorVertex(x1, y2, z, bottomLeft),
+		glColorVertex(x2, y2, z, bottomRight)
+	};
+
+	drawVertices(GL_TRIANGLE_STRIP, vertices, 4);
+}
+
+//************************************************************************
+// spectrum layers
+
+template<typename T>
+void OGLSpectrumRenderer::storeSpectrum(const T *bins, int count, const TSpectrumScale &scale) {
+
+	m_spectrumOffset = -1;
+	if (!m_valid || count <= 0) return;
+
+	if (m_fixedFunction) {
+
+		m_fixedBins.resize(count);
+		for (int i = 0; i < count; i++)
+			m_fixedBins[i] = (float) bins[i];
+
+		m_spectrumOffset = 0;
+		m_spectrumCount = count;
+		m_spectrumScale = scale;
+		return;
+	}
+
+	const int bytes = 2 * count * (int) sizeof(float);
+
+	int offset;
+	float *values = reinterpret_cast<float *>(allocate(bytes, &offset));
+	for (int i = 0; i < count; i++) {
+
+		values[2*i]   = (float) bins[i];
+		values[2*i+1] = (float) bins[i];
+	}
+	upload(offset, bytes);
+
+	// relative to the region, so the bins survive a buffer growth
+	m_spectrumOffset = offset - (m_persistent ? m_region * m_frameBytes : 0);
+	m_spectrumCount = count;
+	m_spectrumScale = scale;
+}
+
+void OGLSpectrumRenderer::setSpectrum(const float *bins, int count, const TSpectrumScale &scale) {
+
+	storeSpectrum(bins, count, scale);
+}
+
+void OGLSpectrumRenderer::setSpectrum(const qreal *bins, int count, const TSpectrumScale &scale) {
+
+	storeSpectrum(bins, count, scale);
+}
+
+void OGLSpectrumRenderer::drawSpectrumFill(const QColor &top, const QColor &bottom, float z) {
+
+	drawSpectrum(GL_TRIANGLE_STRIP, true, top, bottom, z);
+}
+
+void OGLSpectrumRenderer::drawSpectrumLine(const QColor &color, float z) {
+
+	drawSpectrum(GL_LINE_STRIP, false, color, color, z);
+}
+
+void OGLSpectrumRenderer::drawSpectrumBars(const QColor &top, const QColor &bottom, float z) {
+
+	drawSpectrum(GL_LINES, true, top, bottom, z);
+}
+
+void OGLSpectrumRenderer::drawSpectrum(GLenum mode, bool pairs, const QColor &top, const QColor &bottom, float z) {
+
+	if (!m_valid || m_spectrumOffset < 0) return;
+
+	if (m_fixedFunction) {
+
+		// what the vertex shader computes, on the CPU
+		const TSpectrumScale &s = m_spectrumScale;
+		const float colorScale = pairs ? 0.0f : s.colorScale;
+		const float *bins = m_fixedBins.constData();
+
+		m_fixedVertices.resize(pairs ? 2 * m_spectrumCount : m_spectrumCount);
+		TGLColorVertex *v = m_fixedVertices.data();
+
+		for (int i = 0; i < m_spectrumCount; i++) {
+
+			const float x = s.x0 + i * s.xStep;
+			TGLColorVertex trace = glColorVertex(x, s.yBase - bins[i] * s.yScale, z, top);
+
+			if (colorScale > 0.0f) {
+
+				const float k = qBound(0.0f, bins[i] * colorScale, 1.0f);
+				trace.r = (GLubyte)(trace.r * k);
+				trace.g = (GLubyte)(trace.g * k);
+				trace.b = (GLubyte)(trace.b * k);
+			}
+
+			if (pairs) {
+
+				*v++ = trace;
+				*v++ = glColorVertex(x, s.yBase, z, bottom);
+			}
+			else {
+
+				*v++ = trace;
+			}
+		}
+
+		drawFixedFunction(mode, m_fixedVertices.constData(), m_fixedVertices.size(), 0, 1);
+		return;
+	}
+
+	const int offset = m_spectrumOffset + (m_persistent ? m_region * m_frameBytes : 0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glDisableVertexAttribArray(m_attrPos);
+	glDisableVertexAttribArray(m_attrColor);
+	glEnableVertexAttribArray(m_attrValue);
+	glVertexAttribPointer(m_attrValue, 1, GL_FLOAT, GL_FALSE, pairs ? sizeof(float) : 2 * sizeof(float),
+						  reinterpret_cast<void *>((qintptr) offset));
+
+	m_program->setUniformValue(m_uniformSpectrum, (GLint) 1);
+	m_program->setUniformValue(m_uniformPairs, pairs ? 1 : 0);
+	m_program->setUniformValue(m_uniformScale,
+		m_spectrumScale.x0, m_spectrumScale.xStep, m_spectrumScale.yBase, m_spectrumScale.yScale);
+	m_program->setUniformValue(m_uniformZ, z);
+	m_program->setUniformValue(m_uniformTopColor, top);
+	m_program->setUniformValue(m_uniformBottomColor, bottom);
+	m_program->setUniformValue(m_uniformColorScale, pairs ? 0.0f : m_spectrumScale.colorScale);
+	m_program->setUniformValue(m_uniformStipple, (GLint) 0);
+
+	glDrawArrays(mode, 0, pairs ? 2 * m_spectrumCount : m_spectrumCount);
+}
@@ -0,0 +1,202 @@
+/**
+* @file  cusdr_oglSpectrumRenderer.h
+* @brief shader based renderer for panadapter traces, fills, grids and lines
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _CUSDR_OGL_SPECTRUM_RENDERER_H
+#define _CUSDR_OGL_SPECTRUM_RENDERER_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QColor>
+#include <QRect>
+#include <QVector>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+
+#ifdef LOG_SPECTRUM_RENDERER
+#   define SPECTRUM_RENDERER_DEBUG qDebug().nospace() << "SpectrumRenderer::\t"
+#else
+#   define SPECTRUM_RENDERER_DEBUG nullDebug()
+#endif
+
+#define SPECTRUM_RENDERER_FRAMES		3			// frames the GPU may still be reading
+#define SPECTRUM_RENDERER_FRAME_BYTES	(256 * 1024)	// initial vertex space per frame
+
+// A vertex of the plain geometry layers (grid, lines, rectangles), in widget
+// pixels like the fixed function code around it.
+typedef struct _glColorVertex {
+
+	GLfloat	x;
+	GLfloat	y;
+	GLfloat	z;
+	GLubyte	r;
+	GLubyte	g;
+	GLubyte	b;
+	GLubyte	a;
+
+} TGLColorVertex;
+
+inline TGLColorVertex glColorVertex(float x, float y, float z, const QColor &color) {
+
+	TGLColorVertex v = {
+		x, y, z,
+		(GLubyte) color.red(), (GLubyte) color.green(), (GLubyte) color.blue(), (GLubyte) color.alpha()
+	};
+	return v;
+}
+
+// Maps spectrum bins to widget pixels: bin i is drawn at x0 + i * xStep, a
+// bin value v (dB above the display floor) at yBase - v * yScale. With
+// colorScale > 0 the line color is scaled by v * colorScale, clamped to
+// [0, 1]; fills and bars keep their colors.
+typedef struct _spectrumScale {
+
+	float	x0;
+	float	xStep;
+	float	yBase;
+	float	yScale;
+	float	colorScale;
+
+} TSpectrumScale;
+
+// Draws the panadapter layers of a panel with one shader program and one
+// streaming vertex buffer. setSpectrum() uploads the display bins once per
+// frame as bare dB values; the fill, line and bar layers then each take a
+// single draw call, the vertex shader computing positions and colors from
+// the values and a few uniforms.
+//
+// The vertex buffer is a ring of SPECTRUM_RENDERER_FRAMES regions. Where the
+// driver has buffer storage (GL 4.4 or ARB_buffer_storage) it is mapped once,
+// persistently and coherently, and vertices are written straight into it; a
+// fence per region keeps a frame from overwriting data the GPU has not drawn
+// yet. Otherwise the buffer is orphaned once per frame and each layer is
+// uploaded with glBufferSubData.
+//
+// The program only uses core profile calls and attributes, so it coexists
+// with the fixed function state the panels keep using for text.
+//
+// Without OpenGL 3.0, or if the program does not link, the renderer falls
+// back to fixed function drawing from client side vertex arrays: begin()
+// pushes the same orthographic projection, the spectrum layers are expanded
+// into vertices on the CPU and stippled lines use glLineStipple. The panels
+// draw through the same calls either way. Only OpenGL ES is not supported.
+// All calls need the panel's GL context current.
+
+class OGLSpectrumRenderer : protected QOpenGLExtraFunctions {
+
+public:
+	OGLSpectrumRenderer();
+	~OGLSpectrumRenderer();
+
+	bool	initialize();
+	void	destroy();
+
+	bool	isValid() const				{ return m_valid; }
+	bool	isPersistent() const		{ return m_persistent; }
+	bool	isFixedFunction() const		{ return m_fixedFunction; }
+
+	// once per paint, before the first begin()
+	void	newFrame();
+
+	// binds the program for an orthographic widget of width x height pixels;
+	// fixed function drawing has to wait for end()
+	void	begin(int width, int height);
+	void	end();
+
+	// geometry layers; a non zero stipple dashes lines like
+	// glLineStipple(factor, stipple)
+	void	drawVertices(GLenum mode, const TGLColorVertex *vertices, int count, GLushort stipple = 0, int factor = 1);
+	void	drawRect(const QRect &rect, const QColor &color, float z);
+	void	drawGradientRect(
+				const QRect &rect,
+				const QColor &topLeft,
+				const QColor &topRight,
+				const QColor &bottomLeft,
+				const QColor &bottomRight,
+				float z);
+
+	// spectrum layers, all drawn from the bins of the last setSpectrum()
+	void	setSpectrum(const float *bins, int count, const TSpectrumScale &scale);
+	void	setSpectrum(const qreal *bins, int count, const TSpectrumScale &scale);
+	void	drawSpectrumFill(const QColor &top, const QColor &bottom, float z);
+	void	drawSpectrumLine(const QColor &color, float z);
+	void	drawSpectrumBars(const QColor &top, const QColor &bottom, float z);
+
+private:
+	Q_DISABLE_COPY(OGLSpectrumRenderer)
+
+	typedef void (QOPENGLF_APIENTRYP BufferStorage)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+	bool	createBuffer(int frameBytes);
+	void	destroyBuffer();
+	char	*allocate(int bytes, int *offset);
+	void	upload(int offset, int bytes);
+
+	bool	initializeFixedFunction();
+	void	drawFixedFunction(GLenum mode, const TGLColorVertex *vertices, int count, GLushort stipple, int factor);
+
+	template<typename T>
+	void	storeSpectrum(const T *bins, int count, const TSpectrumScale &scale);
+	void	drawSpectrum(GLenum mode, bool pairs, const QColor &top, const QColor &bottom, float z);
+
+	QOpenGLShaderProgram*		m_program;
+	QOpenGLVertexArrayObject	m_vao;
+	GLuint						m_vbo;
+
+	int		m_attrPos;
+	int		m_attrColor;
+	int		m_attrValue;
+	int		m_uniformMvp;
+	int		m_uniformSpectrum;
+	int		m_uniformPairs;
+	int		m_uniformScale;
+	int		m_uniformZ;
+	int		m_uniformTopColor;
+	int		m_uniformBottomColor;
+	int		m_uniformColorScale;
+	int		m_uniformStipple;
+	int		m_uniformStippleFactor;
+
+	BufferStorage	m_bufferStorage;	// nullptr: no persistent mapping
+
+	bool	m_valid;
+	bool	m_persistent;
+	bool	m_fixedFunction;
+	char*	m_mapped;			// persistent mapping, or nullptr
+	QByteArray	m_staging;		// one frame of vertices without a mapping
+
+	int		m_frameBytes;
+	int		m_region;
+	int		m_used;				// bytes used in the current region
+	GLsync	m_fences[SPECTRUM_RENDERER_FRAMES];
+
+	int		m_spectrumOffset;	// this frame's bins, -1: none
+	int		m_spectrumCount;
+	TSpectrumScale	m_spectrumScale;
+
+	// fixed function path: this frame's bins and the layer being expanded
+	QVector<float>			m_fixedBins;
+	QVector<TGLColorVertex>	m_fixedVertices;
+};
+
+#endif // _CUSDR_OGL_SPECTRUM_RENDERER_H
@@ -28,15 +28,44 @@
 
 #include "cusdr_oglText.h"
 
-const int TEXTURE_SIZE = 1024;
-	
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QImage>
+
+#include <cstddef>
+#include <cstring>
+
+#define OGL_TEXT_ATLAS_WIDTH		512
+#define OGL_TEXT_ATLAS_HEIGHT		128		// initial, doubled when full
+#define OGL_TEXT_ATLAS_MAX_HEIGHT	4096
+#define OGL_TEXT_LAYOUT_CACHE		512		// strings, cleared when exceeded
+
+// a glyph's cell in the atlas, in pixels
 struct CharData {
-		
-		GLuint textureId;
-        uint width;
-        uint height;
-        GLfloat s[2];
-        GLfloat t[2];
+
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+// one glyph of a laid out string, relative to the string's origin
+struct GlyphQuad {
+
+	GLfloat x[2];
+	GLfloat y[2];
+	GLfloat s[2];
+	GLfloat t[2];
+};
+
+struct TextVertex {
+
+	GLfloat x;
+	GLfloat y;
+	GLfloat z;
+	GLfloat s;
+	GLfloat t;
+	GLubyte color[4];
 };
 
 struct OGLTextPrivate {
@@ -44,134 +73,277 @@ struct OGLTextPrivate {
     OGLTextPrivate(const QFont &f, qreal devicePixelRatio);
     ~OGLTextPrivate();
 
-    void allocateTexture();
-    CharData &createCharacter(QChar c);
+    const CharData &createCharacter(QChar c);
+    const QVector<GlyphQuad> &layout(const QString &text);
+    void append(float x, float y, float z, const QString &text);
+    void uploadAtlas();
+    void flush();
 
     QFont font;
     QFontMetrics fontMetrics;
     qreal dpr;
 
     QHash<ushort, CharData> characters;
-    QList<GLuint> textures;
+    QHash<QString, QVector<GlyphQuad> > layouts;
+
+    // the atlas lives in memory and is copied to the texture where it changed
+    QImage atlas;
+    GLuint texture;
+    int textureHeight;		// 0: not allocated yet
+    int dirtyTop;
+    int dirtyBottom;
 
     GLint xOffset;
     GLint yOffset;
+
+    QVector<TextVertex> vertices;
+    GLuint vbo;
+    int batchDepth;
+    GLubyte color[4];		// of the strings appended from now on
 };
 
 OGLTextPrivate::OGLTextPrivate(const QFont &f, qreal devicePixelRatio)
-    : font(f), fontMetrics(f), dpr(devicePixelRatio), xOffset(0), yOffset(0) {
+    : font(f)
+    , fontMetrics(f)
+    , dpr(devicePixelRatio)
+    , atlas(OGL_TEXT_ATLAS_WIDTH, OGL_TEXT_ATLAS_HEIGHT, QImage::Format_Alpha8)
+    , texture(0)
+    , textureHeight(0)
+    , dirtyTop(OGL_TEXT_ATLAS_HEIGHT)
+    , dirtyBottom(0)
+    , xOffset(1)
+    , yOffset(1)
+    , vbo(0)
+    , batchDepth(0)
+{
     // Note: DPR is stored for potential future use
+    atlas.fill(0);
+    memset(color, 255, sizeof(color));
 }
 
 OGLTextPrivate::~OGLTextPrivate() {
-	
-	foreach (GLuint texture, textures)
+
+	// the panels delete their text objects with their context current
+	QOpenGLContext *context = QOpenGLContext::currentContext();
+	if (!context) return;
+
+	if (texture)
 		glDeleteTextures(1, &texture);
+
+	if (vbo)
+		context->functions()->glDeleteBuffers(1, &vbo);
 }
 
-void OGLTextPrivate::allocateTexture() {
-	
+const CharData &OGLTextPrivate::createCharacter(QChar c) {
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+	ushort unicodeC = c.unicode();
+
+	QHash<ushort, CharData>::const_iterator it = characters.constFind(unicodeC);
+	if (it != characters.constEnd())
+		return it.value();
+
+	int width = fontMetrics.horizontalAdvance(c);
+	int height = fontMetrics.height();
+
+	// next row, a pixel apart so nearest sampling never reaches a neighbour
+	if (xOffset + width + 1 >= atlas.width()) {
 
-    // the texture ends at the edges (clamp)
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		xOffset = 1;
+		yOffset += height + 1;
+	}
 
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	if (yOffset + height + 1 >= atlas.height()) {
 
-    // select modulate to mix texture with color for shading
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		if (atlas.height() < OGL_TEXT_ATLAS_MAX_HEIGHT) {
 
-    QImage image(TEXTURE_SIZE, TEXTURE_SIZE, QImage::Format_ARGB32);
-    image.fill(Qt::transparent);
-    image.convertToFormat(QImage::Format_RGBA8888).flipped();
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-    //glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+			// grow: the cells keep their pixels, the texture coordinates change
+			QImage grown(atlas.width(), 2 * atlas.height(), QImage::Format_Alpha8);
+			grown.fill(0);
+			for (int y = 0; y < atlas.height(); y++)
+				memcpy(grown.scanLine(y), atlas.constScanLine(y), atlas.bytesPerLine());
 
-    textures += texture;
+			// a batch collected so far points into the old height
+			for (TextVertex &v : vertices)
+				v.t *= 0.5f;
+
+			atlas = grown;
+		}
+		else {
+
+			// full after all: draw what refers to the old glyphs, then start
+			// over with what is needed from now on
+			flush();
+			atlas.fill(0);
+			characters.clear();
+			xOffset = 1;
+			yOffset = 1;
+		}
+
+		layouts.clear();
+		textureHeight = 0;
+	}
+
+	QPainter painter(&atlas);
+	painter.setRenderHints(QPainter::Antialiasing, true);
+	painter.setFont(font);
+	painter.setPen(Qt::white);
+
+	const QRect cell(xOffset, yOffset, width, height);
+	painter.setClipRect(cell);
+	painter.drawText(cell, Qt::TextSingleLine | Qt::TextDontClip | Qt::AlignCenter, c);
+	painter.end();
+
+	dirtyTop = qMin(dirtyTop, yOffset);
+	dirtyBottom = qMax(dirtyBottom, yOffset + height);
+
+	CharData &character = characters[unicodeC];
+	character.x = xOffset;
+	character.y = yOffset;
+	character.width = width;
+	character.height = height;
+
+	xOffset += width + 1;
+	return character;
 }
 
-CharData &OGLTextPrivate::createCharacter(QChar c) {
-	
-    ushort unicodeC = c.unicode();
-        if (characters.contains(unicodeC))
-            return characters[unicodeC];
-
-        if (textures.empty())
-            allocateTexture();
-
-        GLuint texture = textures.last();
-
-        GLsizei width = fontMetrics.horizontalAdvance(c);
-        GLsizei height = fontMetrics.height();
-
-        // Save OpenGL state before QPainter operations
-        GLint oldTexture;
-        glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexture);
-        const bool textureEnabled = glIsEnabled(GL_TEXTURE_2D);
-        
-        QPixmap pixmap(width, height);
-        pixmap.fill(Qt::transparent);
-
-        /*QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
-        if (!image.isNull()) {
-            image.fill(Qt::transparent);
-            QPainter p(&image);
-            if (&font) p.setFont(this->font);
-        }*/
-
-        QPainter painter;
-        painter.begin(&pixmap);
-        painter.setRenderHints(QPainter::Antialiasing  ,  true);
-        painter.setFont(font);
-//        painter.scale(dpr,dpr);
-        painter.setPen(Qt::white);
-
-        painter.drawText(pixmap.rect(),Qt::TextSingleLine | Qt::TextDontClip | Qt::AlignCenter, c);
-        painter.end();
-
-        // Restore OpenGL state after QPainter operations
-        if (textureEnabled) {
-            glEnable(GL_TEXTURE_2D);
-        } else {
-            glDisable(GL_TEXTURE_2D);
-        }
-        glBindTexture(GL_TEXTURE_2D, texture);
-
-        QImage image = pixmap.toImage().convertToFormat(QImage::Format_RGBA8888).flipped();
-        glTexSubImage2D(GL_TEXTURE_2D, 0, xOffset, yOffset, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
-
-        // Restore the original texture binding
-        glBindTexture(GL_TEXTURE_2D, oldTexture);
-
-        CharData& character = characters[unicodeC];
-        character.textureId = texture;
-        character.width = width;
-        character.height = height;
-        character.s[0] = static_cast<GLfloat>(xOffset) / TEXTURE_SIZE;
-        character.t[0] = static_cast<GLfloat>(yOffset) / TEXTURE_SIZE;
-        character.s[1] = static_cast<GLfloat>(xOffset + width) / TEXTURE_SIZE;
-        character.t[1] = static_cast<GLfloat>(yOffset + height) / TEXTURE_SIZE;
-
-        xOffset += width;
-        if (xOffset + fontMetrics.maxWidth() >= TEXTURE_SIZE) {
-
-            xOffset = 1;
-            yOffset += height;
-        }
-        if (yOffset + fontMetrics.height() >= TEXTURE_SIZE) {
-
-            allocateTexture();
-            yOffset = 1;
-        }
-        return character;
+const QVector<GlyphQuad> &OGLTextPrivate::layout(const QString &text) {
+
+	QHash<QString, QVector<GlyphQuad> >::const_iterator it = layouts.constFind(text);
+	if (it != layouts.constEnd())
+		return it.value();
+
+	// glyphs first: rasterizing one may grow the atlas and clear the cache
+	for (int i = 0; i < text.length(); ++i)
+		createCharacter(text.at(i));
+
+	if (layouts.size() >= OGL_TEXT_LAYOUT_CACHE)
+		layouts.clear();
+
+	QVector<GlyphQuad> &quads = layouts[text];
+	quads.reserve(text.length());
+
+	const GLfloat w = atlas.width();
+	const GLfloat h = atlas.height();
+	GLfloat x = 0;
+
+	for (int i = 0; i < text.length(); ++i) {
+
+		const CharData &c = createCharacter(text.at(i));
+
+		GlyphQuad quad;
+		quad.x[0] = x;
+		quad.x[1] = x + c.width;
+		quad.y[0] = 0;
+		quad.y[1] = c.height;
+		quad.s[0] = c.x / w;
+		quad.s[1] = (c.x + c.width) / w;
+		quad.t[0] = c.y / h;
+		quad.t[1] = (c.y + c.height) / h;
+		quads.append(quad);
+
+		x += c.width;
+	}
+
+	return quads;
+}
+
+void OGLTextPrivate::append(float x, float y, float z, const QString &text) {
+
+	if (text.isEmpty()) return;
+
+	const QVector<GlyphQuad> &quads = layout(text);
+
+	TextVertex v;
+	v.z = z;
+	memcpy(v.color, color, sizeof(color));
+
+	vertices.reserve(vertices.size() + 4 * quads.size());
+	for (const GlyphQuad &q : quads) {
+
+		v.x = x + q.x[0]; v.y = y + q.y[0]; v.s = q.s[0]; v.t = q.t[0]; vertices.append(v);
+		v.x = x + q.x[1]; v.y = y + q.y[0]; v.s = q.s[1]; v.t = q.t[0]; vertices.append(v);
+		v.x = x + q.x[1]; v.y = y + q.y[1]; v.s = q.s[1]; v.t = q.t[1]; vertices.append(v);
+		v.x = x + q.x[0]; v.y = y + q.y[1]; v.s = q.s[0]; v.t = q.t[1]; vertices.append(v);
+	}
+}
+
+// expects the atlas texture bound
+void OGLTextPrivate::uploadAtlas() {
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (textureHeight != atlas.height()) {
+
+		// the texture ends at the edges (clamp)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas.width(), atlas.height(), 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas.constBits());
+		textureHeight = atlas.height();
+	}
+	else if (dirtyTop < dirtyBottom) {
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyTop, atlas.width(), dirtyBottom - dirtyTop,
+						GL_ALPHA, GL_UNSIGNED_BYTE, atlas.constScanLine(dirtyTop));
+	}
+
+	dirtyTop = atlas.height();
+	dirtyBottom = 0;
+}
+
+void OGLTextPrivate::flush() {
+
+	if (vertices.isEmpty()) return;
+
+	QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+
+	// saved on the server, nothing is read back: texture enable, binding and
+	// environment, blending, and the current color the color array leaves
+	// undefined
+	glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+
+	if (!texture)
+		glGenTextures(1, &texture);
+
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	uploadAtlas();
+
+	// the panels draw their scales and S-meters with GL_REPLACE set, which
+	// would take the alpha from the atlas alone and drop the text color's
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// orphaned on every upload, the driver hands out fresh storage
+	if (!vbo)
+		f->glGenBuffers(1, &vbo);
+
+	f->glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	f->glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TextVertex), vertices.constData(), GL_STREAM_DRAW);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(TextVertex), reinterpret_cast<void *>(offsetof(TextVertex, x)));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), reinterpret_cast<void *>(offsetof(TextVertex, s)));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), reinterpret_cast<void *>(offsetof(TextVertex, color)));
+
+	glDrawArrays(GL_QUADS, 0, vertices.size());
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	// client side arrays of the panels break with a bound buffer
+	f->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glPopAttrib();
+
+	vertices.clear();
 }
 
 
@@ -197,99 +369,34 @@ QFontMetrics OGLText::fontMetrics() const {
 //! Renders text at given x, y.
 void OGLText::renderText(float x, float y, const QString &text) {
 
-    const bool GL_TEXTURE_2D_wasEnabled = glIsEnabled(GL_TEXTURE_2D);
-	GLint prev_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-	GLint prev_shade_model; glGetIntegerv(GL_SHADE_MODEL, &prev_shade_model);
-
-    glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
-    glPushMatrix();
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	if (prev_shade_model != GL_FLAT) glShadeModel(GL_FLAT);
-	if (!GL_TEXTURE_2D_wasEnabled) glEnable(GL_TEXTURE_2D);
-
-    GLuint texture = 0;
-    glTranslatef(x, y, 0);
-
-    for (int i = 0; i < text.length(); ++i) {
+	renderText(x, y, 0.0f, text);
+}
 
-    	//if (text.length() > 80)
-    	//	qDebug() << "*********************  OK";
+void OGLText::renderText(float x, float y, float z, const QString &text) {
 
-        CharData &c = d->createCharacter(text.at(i));
-        if (texture != c.textureId) {
+	d->append(x, y, z, text);
 
-            texture = c.textureId;
-            glBindTexture(GL_TEXTURE_2D, texture);
-        }
+	if (d->batchDepth == 0)
+		d->flush();
+}
 
-        glBegin(GL_QUADS);
-			glTexCoord2f(c.s[0], c.t[0]); glVertex2f(0, c.height);
-			glTexCoord2f(c.s[1], c.t[0]); glVertex2f(c.width, c.height);
-			glTexCoord2f(c.s[1], c.t[1]); glVertex2f(c.width, 0);
-			glTexCoord2f(c.s[0], c.t[1]); glVertex2f(0, 0);
-        glEnd();
+//! Collects the following renderText() calls into one draw call at end().
+void OGLText::begin() {
 
-        glTranslatef(c.width, 0, 0);
-    }
+	d->batchDepth++;
+}
 
-	glShadeModel(prev_shade_model);
-	glBindTexture(GL_TEXTURE_2D, prev_texture);
-	if (!GL_TEXTURE_2D_wasEnabled) glDisable(GL_TEXTURE_2D);
+void OGLText::end() {
 
-    glPopMatrix();
-    glPopAttrib();
+	if (d->batchDepth > 0 && --d->batchDepth == 0)
+		d->flush();
 }
 
-void OGLText::renderText(float x, float y, float z, const QString &text) {
+//! Sets the color of the following renderText() calls, white by default.
+void OGLText::setColor(const QColor &color) {
 
-    const bool GL_TEXTURE_2D_wasEnabled = glIsEnabled(GL_TEXTURE_2D);
-	GLint prev_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
-	GLint prev_shade_model; glGetIntegerv(GL_SHADE_MODEL, &prev_shade_model);
-
-    glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
-    glPushMatrix();
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	if (prev_shade_model != GL_FLAT) glShadeModel(GL_FLAT);
-	if (!GL_TEXTURE_2D_wasEnabled) glEnable(GL_TEXTURE_2D);
-
-    GLuint texture = 0;
-    glTranslatef(x, y, 0);
-    for (int i = 0; i < text.length(); ++i) {
-
-        CharData &c = d->createCharacter(text.at(i));
-        if (texture != c.textureId) {
-
-            texture = c.textureId;
-            glBindTexture(GL_TEXTURE_2D, texture);
-        }
-
-        /*glBegin(GL_QUADS);
-			glTexCoord2f(c.s[0], c.t[0]); glVertex2f(0, c.height);
-			glTexCoord2f(c.s[1], c.t[0]); glVertex2f(c.width, c.height);
-			glTexCoord2f(c.s[1], c.t[1]); glVertex2f(c.width, 0);
-			glTexCoord2f(c.s[0], c.t[1]); glVertex2f(0, 0);
-        glEnd();*/
-		glBegin(GL_QUADS);
-			glTexCoord2f(c.s[0], c.t[0]); glVertex3f(0, c.height, z);
-			glTexCoord2f(c.s[1], c.t[0]); glVertex3f(c.width, c.height, z);
-			glTexCoord2f(c.s[1], c.t[1]); glVertex3f(c.width, 0, z);
-			glTexCoord2f(c.s[0], c.t[1]); glVertex3f(0, 0, z);
-        glEnd();
-
-        glTranslatef(c.width, 0, 0);
-    }
-
-	glShadeModel(prev_shade_model);
-	glBindTexture(GL_TEXTURE_2D, prev_texture);
-	if (!GL_TEXTURE_2D_wasEnabled) glDisable(GL_TEXTURE_2D);
-
-    glPopMatrix();
-    glPopAttrib();
+	d->color[0] = (GLubyte) color.red();
+	d->color[1] = (GLubyte) color.green();
+	d->color[2] = (GLubyte) color.blue();
+	d->color[3] = (GLubyte) color.alpha();
 }
-
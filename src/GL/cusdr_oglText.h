@@ -37,12 +37,24 @@
 #include <QOpenGLTexture>
 #include <QPainter>
 class QChar;
+class QColor;
 class QFont;
 class QFontMetrics;
 class QString;
 
 class OGLTextPrivate;
 
+// Text in one font, drawn with the fixed function pipeline in the current
+// matrices and in the color last given to setColor(); the GL current color
+// is neither read nor changed.
+//
+// Glyphs are rasterized once into a single atlas texture per font, strings
+// are laid out once and kept in a cache, so static labels such as scale
+// numbers cost a hash lookup. A string becomes quads in a vertex buffer;
+// outside begin()/end() each renderText() is one draw call, between them
+// all strings of the batch go out in one draw call at end(). A batch must
+// not span a change of matrices, viewport or render target.
+
 class OGLText {
 
 public:
@@ -54,6 +66,11 @@ public:
     
     void renderText(float x, float y, const QString &text);
 	void renderText(float x, float y, float z, const QString &text);
+
+	void setColor(const QColor &color);
+
+	void begin();
+	void end();
   
 private:
     Q_DISABLE_COPY(OGLText)
@@ -35,6 +35,7 @@
 #include <QGuiApplication>
 #include <QScreen>
 #include <QWindow>
+#include <QVarLengthArray>
 
 #ifndef GL_MULTISAMPLE
 #define GL_MULTISAMPLE  0x809D
@@ -116,6 +117,8 @@ QGLWidebandPanel::QGLWidebandPanel(QWidget *parent)
 	m_wbSpectrumBuffer.fill(-1000.0f);
 	m_wbSpectrumBufferLength = m_wbSpectrumBuffer.size();
 
+	CDisplayScheduler::instance()->addDisplay(this, CDisplayScheduler::Wideband);
+
 	m_dBmPanLogGain = 0;//69; // allow user to calibrate this value
 	
 	if (m_specAveragingCnt > 0)
@@ -154,10 +157,14 @@ QGLWidebandPanel::QGLWidebandPanel(QWidget *parent)
 QGLWidebandPanel::~QGLWidebandPanel() {
 
 	disconnect(set, 0, this, 0);
+	CDisplayScheduler::instance()->removeDisplay(this);
 
 	while (!specAv_queue.isEmpty())
 		specAv_queue.dequeue();
 
+	makeCurrent();
+	m_spectrumRenderer.destroy();
+	doneCurrent();
 
     delete m_oglTextTiny;
     delete m_oglTextSmall;
@@ -229,56 +236,9 @@ void QGLWidebandPanel::initializeGL() {
 
 	m_cnt = 0;
 
-	// ── Core-profile shader program ──────────────────────────────────────────
-	static const char *vertSrc = R"(
-		#version 130
-		in vec3 a_pos;
-		in vec3 a_color;
-		uniform mat4 u_mvp;
-		out vec3 v_color;
-		void main() {
-			gl_Position = u_mvp * vec4(a_pos, 1.0);
-			v_color = a_color;
-		}
-	)";
-
-	static const char *fragSrc = R"(
-		#version 130
-		in vec3 v_color;
-		out vec4 fragColor;
-		void main() {
-			fragColor = vec4(v_color, 1.0);
-		}
-	)";
-
-	m_program = new QOpenGLShaderProgram(this);
-	if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertSrc))
-		qWarning() << "WB vertex shader:" << m_program->log();
-	if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragSrc))
-		qWarning() << "WB fragment shader:" << m_program->log();
-	if (!m_program->link())
-		qWarning() << "WB shader link:" << m_program->log();
-
-	m_attrPos    = m_program->attributeLocation("a_pos");
-	m_attrColor  = m_program->attributeLocation("a_color");
-	m_uniformMvp = m_program->uniformLocation("u_mvp");
-
-	// ── Persistent VAO + VBO (streaming, updated each draw) ─────────────────
-	m_vao.create();
-	m_vbo.create();
-	m_vbo.setUsagePattern(QOpenGLBuffer::StreamDraw);
-
-	m_vao.bind();
-	m_vbo.bind();
-	// stride = 6 floats (xyz + rgb), pointers set once in the VAO
-	glVertexAttribPointer(m_attrPos,   3, GL_FLOAT, GL_FALSE,
-	                      6 * sizeof(float), reinterpret_cast<void*>(0));
-	glVertexAttribPointer(m_attrColor, 3, GL_FLOAT, GL_FALSE,
-	                      6 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
-	glEnableVertexAttribArray(m_attrPos);
-	glEnableVertexAttribArray(m_attrColor);
-	m_vbo.release();
-	m_vao.release();
+	m_spectrumRenderer.destroy();
+	if (!m_spectrumRenderer.initialize())
+		qWarning() << "wideband panel: OpenGL ES is not supported, spectrum disabled";
 }
 
 void QGLWidebandPanel::paintGL() {
@@ -297,6 +257,7 @@ void QGLWidebandPanel::paintGL() {
 			
 			if (m_resizeTime.elapsed() > 200 || m_dataEngineState == QSDR::DataEngineDown) {
 			
+                m_spectrumRenderer.newFrame();
                 drawSpectrum();
                                drawHorizontalScale();
                 drawVerticalScale();
@@ -328,29 +289,6 @@ void QGLWidebandPanel::paintGL() {
 	}
 }
  
-//************************************************************************
-// Core-profile helpers
-
-void QGLWidebandPanel::setMvpOrtho(int w, int h)
-{
-	QMatrix4x4 mvp;
-	mvp.setToIdentity();
-	mvp.ortho(0.0f, (float)w, (float)h, 0.0f, -5.0f, 5.0f);
-	m_program->setUniformValue(m_uniformMvp, mvp);
-}
-
-// Draws N vertices from interleaved float data [x,y,z, r,g,b] × N.
-void QGLWidebandPanel::drawVertexColorArray(GLenum mode, const QVector<float> &data, int vertexCount)
-{
-	if (vertexCount <= 0 || data.size() < vertexCount * 6) return;
-	m_vao.bind();
-	m_vbo.bind();
-	m_vbo.allocate(data.constData(), data.size() * (int)sizeof(float));
-	glDrawArrays(mode, 0, vertexCount);
-	m_vbo.release();
-	m_vao.release();
-}
-
 //************************************************************************
 void QGLWidebandPanel::drawSpectrum() {
 
@@ -365,9 +303,6 @@ void QGLWidebandPanel::drawSpectrum() {
 	GLint vertexArrayLength = 0;
 
 	// x scale
-	int idx = 0;
-	int lIdx = 0;
-	int rIdx = 0;
 	int deltaIdx = 0;
 
 	qreal scaleMult = 1.0;
@@ -386,13 +321,10 @@ void QGLWidebandPanel::drawSpectrum() {
 	else if (frequencyScale < 1.0)
 		scaleMult = 0.5;
 	
-	qreal scale = frequencyScale / scaleMult;
-
 	// y scale
 	float yScale;
 	float yScaleColor;
 	float yTop;
-	float localMax;
 
 	//qreal dBmRange = qAbs(m_dBmPanMax - m_dBmPanMin);
 	qreal dBmRange;
@@ -418,27 +350,22 @@ void QGLWidebandPanel::drawSpectrum() {
 	glEnable(GL_BLEND);
 	glLineWidth(1);
 
+	m_spectrumRenderer.begin(size().width(), size().height());
+
 	// draw background
 	if (m_dataEngineState == QSDR::DataEngineUp) {
 
-		// Gradient background via shader (top→bottom, bright→dark)
-		if (m_program && m_program->isLinked()) {
-			m_program->bind();
-			setMvpOrtho(size().width(), size().height());
-			// interleaved: [x, y, z,  r, g, b] × 4  (GL_TRIANGLE_STRIP order TL TR BL BR)
-			QVector<float> bg = {
-				(float)x1,(float)y1,-4.0f, 0.8f*m_bkgRed,0.8f*m_bkgGreen,0.8f*m_bkgBlue,
-				(float)x2,(float)y1,-4.0f, 0.6f*m_bkgRed,0.6f*m_bkgGreen,0.6f*m_bkgBlue,
-				(float)x1,(float)y2,-4.0f, 0.4f*m_bkgRed,0.4f*m_bkgGreen,0.4f*m_bkgBlue,
-				(float)x2,(float)y2,-4.0f, 0.2f*m_bkgRed,0.2f*m_bkgGreen,0.2f*m_bkgBlue,
-			};
-			drawVertexColorArray(GL_TRIANGLE_STRIP, bg, 4);
-			m_program->release();
-		}
+		m_spectrumRenderer.drawGradientRect(
+			m_panRect,
+			QColor::fromRgbF(0.8f * m_bkgRed, 0.8f * m_bkgGreen, 0.8f * m_bkgBlue), // top left
+			QColor::fromRgbF(0.6f * m_bkgRed, 0.6f * m_bkgGreen, 0.6f * m_bkgBlue), // top right
+			QColor::fromRgbF(0.4f * m_bkgRed, 0.4f * m_bkgGreen, 0.4f * m_bkgBlue), // bottom left
+			QColor::fromRgbF(0.2f * m_bkgRed, 0.2f * m_bkgGreen, 0.2f * m_bkgBlue), // bottom right
+			-4.0f);
 	}
 	else {
 
-		drawGLRect(m_panRect, QColor(30, 30, 50, 155), -4.0f);
+		m_spectrumRenderer.drawRect(m_panRect, QColor(30, 30, 50, 155), -4.0f);
 	}
 
 	// set a scissor box
@@ -450,280 +377,66 @@ void QGLWidebandPanel::drawSpectrum() {
 	vertexArrayLength = (GLint)(scaleMult * width);
 	//WBGRAPHICS_DEBUG << "vertexArrayLength: " << vertexArrayLength;
 
-	TGL3float *vertexArray = new TGL3float[vertexArrayLength];
-	TGL3float *vertexColorArray = new TGL3float[vertexArrayLength];
-
-	TGL3float *vertexArrayBg = new TGL3float[2*vertexArrayLength];
-	TGL3float *vertexColorArrayBg = new TGL3float[2*vertexArrayLength];
-
-	switch (m_panMode) {
-
-		case (PanGraphicsMode) FilledLine: {
-			
-			for (int i = 0; i < vertexArrayLength; i++) {
-
-				idx = 0;
-				lIdx = (int)floor((qreal)(i * scale));
-				rIdx = (int)floor((qreal)(i * scale) + scale);
+	// peak of the bins under each pixel; pixels past the end of the buffer
+	// have no bin and stay at the floor
+	int binCount = 0;
+	m_wbDisplayBins.resize(vertexArrayLength);
 
-				// max value; later we try mean value also!
-				localMax = -10000.0F;
-				for (int j = lIdx; j < rIdx; j++) {
-					if (m_wbSpectrumBuffer.at(j) > localMax) {
-
-						localMax = m_wbSpectrumBuffer.at(j);
-						idx = j;
-					}
-				}
-				idx += deltaIdx;
-
-				mutex.lock();
-
-				vertexColorArrayBg[2*i].x = m_rf;
-				vertexColorArrayBg[2*i].y = m_gf;
-				vertexColorArrayBg[2*i].z = m_bf;
-
-				vertexColorArrayBg[2*i+1].x = 0.3 * m_rf;
-				vertexColorArrayBg[2*i+1].y = 0.3 * m_gf;
-				vertexColorArrayBg[2*i+1].z = 0.3 * m_bf;
-
-				qreal yvalue = 0;
-				if (idx < m_wbSpectrumBufferLength)
-					yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMin;
-
-				vertexColorArray[i].x = m_r * (yScaleColor * yvalue);
-				vertexColorArray[i].y = m_g * (yScaleColor * yvalue);
-				vertexColorArray[i].z = m_b * (yScaleColor * yvalue);
-				
-				if (idx < m_wbSpectrumBufferLength)
-					yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMin - m_dBmPanLogGain;
-
-				if (m_mercuryAttenuator)
-					yvalue -= 20.0f;
+	mutex.lock();
+	const int span = qMin(m_scaledBufferSize, m_wbSpectrumBufferLength - deltaIdx);
+	if (span > 0 && m_scaledBufferSize > 0) {
 
-				vertexArrayBg[2*i].x = (GLfloat)(i/scaleMult);
-				vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * yvalue);
-				vertexArrayBg[2*i].z = -2.5;
+		binCount = (span == m_scaledBufferSize)
+			? vertexArrayLength
+			: (int)((qint64) vertexArrayLength * span / m_scaledBufferSize);
+		decimatePeak(m_wbSpectrumBuffer.constData() + deltaIdx, span, m_wbDisplayBins.data(), binCount);
+	}
+	mutex.unlock();
 
-				vertexArrayBg[2*i+1].x = (GLfloat)(i/scaleMult);
-				vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-				vertexArrayBg[2*i+1].z = -2.5;
+	// the renderer takes levels above the display floor
+	float floorLevel = (float)((m_calibrate ? m_dBmPanMinOld : m_dBmPanMin) + m_dBmPanLogGain);
+	if (m_mercuryAttenuator) floorLevel += 20.0f;
 
-				vertexArray[i].x = (GLfloat)(i/scaleMult);
-				vertexArray[i].y = (GLfloat)(yTop - yScale * yvalue);
-				vertexArray[i].z = -1.0;
+	float *bins = m_wbDisplayBins.data();
+	for (int i = 0; i < vertexArrayLength; i++)
+		bins[i] = (i < binCount ? bins[i] : (float) m_dBmPanMin) - floorLevel;
 
-				mutex.unlock();
-			}
-	
-			// Build interleaved [x,y,z,r,g,b] arrays and draw via shader
-		QVector<float> bgData(2 * vertexArrayLength * 6);
-		QVector<float> lineData(vertexArrayLength * 6);
-
-		for (int i = 0; i < vertexArrayLength; i++) {
-			// background fill strip (two vertices per column: top of spectrum → bottom)
-			bgData[12*i+0]  = vertexArrayBg[2*i].x;
-			bgData[12*i+1]  = vertexArrayBg[2*i].y;
-			bgData[12*i+2]  = vertexArrayBg[2*i].z;
-			bgData[12*i+3]  = vertexColorArrayBg[2*i].x;
-			bgData[12*i+4]  = vertexColorArrayBg[2*i].y;
-			bgData[12*i+5]  = vertexColorArrayBg[2*i].z;
-
-			bgData[12*i+6]  = vertexArrayBg[2*i+1].x;
-			bgData[12*i+7]  = vertexArrayBg[2*i+1].y;
-			bgData[12*i+8]  = vertexArrayBg[2*i+1].z;
-			bgData[12*i+9]  = vertexColorArrayBg[2*i+1].x;
-			bgData[12*i+10] = vertexColorArrayBg[2*i+1].y;
-			bgData[12*i+11] = vertexColorArrayBg[2*i+1].z;
-
-			// spectrum line
-			lineData[6*i+0] = vertexArray[i].x;
-			lineData[6*i+1] = vertexArray[i].y;
-			lineData[6*i+2] = vertexArray[i].z;
-			lineData[6*i+3] = vertexColorArray[i].x;
-			lineData[6*i+4] = vertexColorArray[i].y;
-			lineData[6*i+5] = vertexColorArray[i].z;
-		}
+	// the bins go up once; fill, line and bars are drawn from them by the
+	// vertex shader
+	TSpectrumScale scale;
+	scale.x0 = 0.0f;
+	scale.xStep = (float)(1.0 / scaleMult);
+	scale.yBase = yTop;
+	scale.yScale = yScale;
+	scale.colorScale = yScaleColor;
+	m_spectrumRenderer.setSpectrum(bins, vertexArrayLength, scale);
 
-		if (m_program && m_program->isLinked()) {
-			m_program->bind();
-			setMvpOrtho(size().width(), size().height());
-			drawVertexColorArray(GL_QUAD_STRIP, bgData,   2 * vertexArrayLength);
-			drawVertexColorArray(GL_LINE_STRIP,  lineData, vertexArrayLength);
-			m_program->release();
-		}
+	switch (m_panMode) {
 
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
+		case (PanGraphicsMode) FilledLine:
 
+			m_spectrumRenderer.drawSpectrumFill(
+				QColor::fromRgbF(m_rf, m_gf, m_bf),
+				QColor::fromRgbF(0.3f * m_rf, 0.3f * m_gf, 0.3f * m_bf),
+				-2.5f);
+			m_spectrumRenderer.drawSpectrumLine(QColor::fromRgbF(m_r, m_g, m_b), -1.0f);
 			break;
-		} // case FilledLine
-
-		case (PanGraphicsMode) Line: {
 
-			for (int i = 0; i < vertexArrayLength; i++) {
+		case (PanGraphicsMode) Line:
 
-				lIdx = (int)floor((qreal)(i * scale));
-				rIdx = (int)floor((qreal)(i * scale) + scale);
-
-				// max value; later we try mean value also!
-				localMax = -10000.0F;
-				for (int j = lIdx; j < rIdx; j++) {
-					if (m_wbSpectrumBuffer.at(j) > localMax) {
-
-						localMax = m_wbSpectrumBuffer.at(j);
-						idx = j;
-					}
-				}
-				idx += deltaIdx;
-
-				mutex.lock();
-
-				qreal yvalue = 0;
-				if (idx < m_wbSpectrumBufferLength)
-					yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMin;
-
-				vertexColorArray[i].x = m_r	* (yScaleColor * yvalue);
-				vertexColorArray[i].y = m_g * (yScaleColor * yvalue);
-				vertexColorArray[i].z = m_b * (yScaleColor * yvalue);
-
-				if (idx < m_wbSpectrumBufferLength) {
-
-					if (m_calibrate)
-						yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMinOld - m_dBmPanLogGain;
-					else
-						yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMin - m_dBmPanLogGain;
-				}
-
-				if (m_mercuryAttenuator) yvalue -= 20.0f;
-
-				vertexArray[i].x = (GLfloat)(i/scaleMult);
-				vertexArray[i].y = (GLfloat)(yTop - yScale * yvalue);
-				vertexArray[i].z = -1.0;
-
-				mutex.unlock();
-			}
-		
-			// Build interleaved line data and draw via shader
-		QVector<float> lineData(vertexArrayLength * 6);
-		for (int i = 0; i < vertexArrayLength; i++) {
-			lineData[6*i+0] = vertexArray[i].x;
-			lineData[6*i+1] = vertexArray[i].y;
-			lineData[6*i+2] = vertexArray[i].z;
-			lineData[6*i+3] = vertexColorArray[i].x;
-			lineData[6*i+4] = vertexColorArray[i].y;
-			lineData[6*i+5] = vertexColorArray[i].z;
-		}
-		if (m_program && m_program->isLinked()) {
-			m_program->bind();
-			setMvpOrtho(size().width(), size().height());
-			drawVertexColorArray(GL_LINE_STRIP, lineData, vertexArrayLength);
-			m_program->release();
-		}
-
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
-			
+			m_spectrumRenderer.drawSpectrumLine(QColor::fromRgbF(m_r, m_g, m_b), -1.0f);
 			break;
-		} // case Line
-
 
-		case (PanGraphicsMode) Solid: {
+		case (PanGraphicsMode) Solid:
 
 			glDisable(GL_MULTISAMPLE);
 			glDisable(GL_LINE_SMOOTH);
 
-			mutex.lock();
-			for (int i = 0; i < vertexArrayLength; i++) {
-			
-				lIdx = qFloor((qreal)(i * scale));
-				rIdx = qFloor((qreal)(i * scale) + scale);
-
-				// max value
-				localMax = -10000.0F;
-				for (int j = lIdx; j < rIdx; j++) {
-
-					if (m_wbSpectrumBuffer.at(j) > localMax) {
-
-						localMax = m_wbSpectrumBuffer.at(j);
-						idx = j;
-					}
-				}
-				//qreal mean = m_wbSpectrumBuffer.at(lIdx + deltaIdx);
-				//int len = rIdx - lIdx;
-				//WBGRAPHICS_DEBUG << "leftIdx = " << lIdx << " rightIdx = " << rIdx << " length = " << len;
-				//for (int j = lIdx+1; j < len; j++) {
-
-				//	mean += m_wbSpectrumBuffer.at(j);
-				//}
-				//if (len > 0) mean /= len;
-
-				idx += deltaIdx;
-
-				//mutex.lock();
-				vertexColorArrayBg[2*i].x = m_redST;
-				vertexColorArrayBg[2*i].y = m_greenST;
-				vertexColorArrayBg[2*i].z = m_blueST;
-								
-				vertexColorArrayBg[2*i+1].x = m_redSB;
-				vertexColorArrayBg[2*i+1].y = m_greenSB;
-				vertexColorArrayBg[2*i+1].z = m_blueSB;
-
-				qreal yvalue = 0;
-				if (idx < m_wbSpectrumBufferLength)
-					yvalue = m_wbSpectrumBuffer.at(idx) - m_dBmPanMin - m_dBmPanLogGain;
-					//yvalue = mean - m_dBmPanMin - m_dBmPanLogGain;
-
-				if (m_mercuryAttenuator)
-					yvalue -= 20.0;
-
-				vertexArrayBg[2*i].x = (GLfloat)(i/scaleMult);
-				vertexArrayBg[2*i].y = (GLfloat)(yTop - yScale * yvalue);
-				vertexArrayBg[2*i].z = -2.0f;
-
-				vertexArrayBg[2*i+1].x = (GLfloat)(i/scaleMult);
-				vertexArrayBg[2*i+1].y = (GLfloat)yTop;
-				vertexArrayBg[2*i+1].z = -2.0f;
-
-				//mutex.unlock();
-			}
-			mutex.unlock();
-
-			// Build interleaved solid-fill strip data and draw via shader
-		QVector<float> bgData(2 * vertexArrayLength * 6);
-		for (int i = 0; i < vertexArrayLength; i++) {
-			bgData[12*i+0]  = vertexArrayBg[2*i].x;
-			bgData[12*i+1]  = vertexArrayBg[2*i].y;
-			bgData[12*i+2]  = vertexArrayBg[2*i].z;
-			bgData[12*i+3]  = vertexColorArrayBg[2*i].x;
-			bgData[12*i+4]  = vertexColorArrayBg[2*i].y;
-			bgData[12*i+5]  = vertexColorArrayBg[2*i].z;
-
-			bgData[12*i+6]  = vertexArrayBg[2*i+1].x;
-			bgData[12*i+7]  = vertexArrayBg[2*i+1].y;
-			bgData[12*i+8]  = vertexArrayBg[2*i+1].z;
-			bgData[12*i+9]  = vertexColorArrayBg[2*i+1].x;
-			bgData[12*i+10] = vertexColorArrayBg[2*i+1].y;
-			bgData[12*i+11] = vertexColorArrayBg[2*i+1].z;
-		}
-		if (m_program && m_program->isLinked()) {
-			m_program->bind();
-			setMvpOrtho(size().width(), size().height());
-			drawVertexColorArray(GL_LINES, bgData, 2 * vertexArrayLength);
-			m_program->release();
-		}
-
-			delete[] vertexArray;
-			delete[] vertexColorArray;
-			delete[] vertexArrayBg;
-			delete[] vertexColorArrayBg;
-
+			m_spectrumRenderer.drawSpectrumBars(
+				QColor::fromRgbF(m_redST, m_greenST, m_blueST),
+				QColor::fromRgbF(m_redSB, m_greenSB, m_blueSB),
+				-2.0f);
 			break;
-		} // case Solid
 	}
 	glDisable(GL_SCISSOR_TEST);
 
@@ -766,7 +479,7 @@ void QGLWidebandPanel::drawSpectrum() {
 //		}
 	
 		QRect rect = QRect(x1, y1, x2-x1, y2);
-		drawGLRect(rect, QColor(160, 235, 255, 80), 0.0f);
+		m_spectrumRenderer.drawRect(rect, QColor(160, 235, 255, 80), 0.0f);
 
 		// small vertical line
 //		glColor4f(QColor(255, 0, 0, 255));
@@ -778,6 +491,8 @@ void QGLWidebandPanel::drawSpectrum() {
 		glLineWidth(1);
 	}
 
+	m_spectrumRenderer.end();
+
 	//glDisable(GL_SCISSOR_TEST);
 	glDisable(GL_BLEND);
 	glDisable(GL_LINE_SMOOTH);
@@ -1088,12 +803,8 @@ void QGLWidebandPanel::renderHorizontalScale() {
 }
 
 void QGLWidebandPanel::renderGrid() {
-	// Draw grid lines using QPainter (avoids deprecated glLineStipple / glBegin)
-	QPen dotPen(m_gridColor, 1, Qt::DotLine, Qt::FlatCap);
-
-	painter.begin(this);
-	painter.setRenderHint(QPainter::Antialiasing, false);
-	painter.setPen(dotPen);
+	// Both directions in one dotted layer, dotted like the receiver panel grid
+	QVarLengthArray<TGLColorVertex, 128> vertices;
 
 	// Vertical lines (frequency grid)
 	int len = m_frequencyScale.mainPointPositions.length();
@@ -1102,7 +813,8 @@ void QGLWidebandPanel::renderGrid() {
 		int y2 = m_panRect.bottom();
 		for (int i = 0; i < len; i++) {
 			int x = m_frequencyScale.mainPointPositions.at(i);
-			painter.drawLine(x, y1, x, y2);
+			vertices.append(glColorVertex(x, y1, 0.0f, m_gridColor));
+			vertices.append(glColorVertex(x, y2, 0.0f, m_gridColor));
 		}
 	}
 
@@ -1113,11 +825,22 @@ void QGLWidebandPanel::renderGrid() {
 		int x2 = m_panRect.right();
 		for (int i = 0; i < len; i++) {
 			int y = m_dBmScale.mainPointPositions.at(i);
-			painter.drawLine(x1, y, x2, y);
+			vertices.append(glColorVertex(x1, y, 0.0f, m_gridColor));
+			vertices.append(glColorVertex(x2, y, 0.0f, m_gridColor));
 		}
 	}
 
-	painter.end();
+	glDisable(GL_MULTISAMPLE);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_BLEND);
+	glLineWidth(1.0f);
+
+	m_spectrumRenderer.begin(size().width(), size().height());
+	m_spectrumRenderer.drawVertices(GL_LINES, vertices.constData(), vertices.size(), 0x5555);
+	m_spectrumRenderer.end();
+
+	glDisable(GL_BLEND);
+	glEnable(GL_MULTISAMPLE);
 }
  
 //********************************************************************
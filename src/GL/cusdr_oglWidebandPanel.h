@@ -31,6 +31,9 @@
 #include "cusdr_settings.h"
 #include "cusdr_fonts.h"
 #include "cusdr_oglText.h"
+#include "cusdr_oglSpectrumRenderer.h"
+#include "Util/cusdr_spectrumDecimate.h"
+#include "Util/cusdr_displayScheduler.h"
 #include <QEvent>
 //#include <QPixmap>
 //#include <QImage>
@@ -105,13 +108,7 @@ private:
     QOpenGLFramebufferObject*		m_dBmScaleFBO = nullptr;
     QOpenGLFramebufferObject*		m_gridFBO = nullptr;
 
-    // Core-profile shader pipeline
-    QOpenGLShaderProgram*		m_program = nullptr;
-    QOpenGLVertexArrayObject	m_vao;
-    QOpenGLBuffer				m_vbo{QOpenGLBuffer::VertexBuffer};
-    int							m_attrPos   = -1;
-    int							m_attrColor = -1;
-    int							m_uniformMvp = -1;
+    OGLSpectrumRenderer			m_spectrumRenderer;
     CFonts		*fonts;
 	TFonts		m_fonts;
 
@@ -183,6 +180,7 @@ private:
 
 
 	qVectorFloat m_wbSpectrumBuffer;
+	QVector<float> m_wbDisplayBins;
 
 	float		m_scale;
 	float		m_distMax;
@@ -261,10 +259,6 @@ private:
 	void renderHorizontalScale();
 	void renderGrid();
 	void qglColor(QColor color);
-	// Modern GL helper: draw N vertices from interleaved [x,y,z,r,g,b] data
-	void drawVertexColorArray(GLenum mode, const QVector<float> &data, int vertexCount);
-	// Build MVP uniform for current widget size
-	void setMvpOrtho(int w, int h);
 
 private slots:
 	void	systemStateChanged(
@@ -0,0 +1,225 @@
+/**
+* @file  cusdr_spectrumDisplayWorker.cpp
+* @brief per receiver thread turning DSP spectra into panadapter frames
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_spectrumDisplayWorker.h"
+#include "cusdr_settings.h"
+#include "Util/cusdr_spectrumDecimate.h"
+
+#include <cstring>
+
+// The worker of each receiver, registered while its panel exists. post()
+// takes no lock: it counts itself in 'posting' before it loads the worker,
+// and the destructor clears the pointer and then waits for 'posting' to
+// drop to zero, so a worker cannot go away under a post() that found it.
+// Only the receiver's DSP thread posts, so neither atomic is contended.
+typedef struct _workerSlot {
+
+	std::atomic<SpectrumDisplayWorker *>	worker;
+	std::atomic<int>						posting;
+
+} TWorkerSlot;
+
+static TWorkerSlot s_workers[MAX_RECEIVERS];
+
+SpectrumDisplayWorker::SpectrumDisplayWorker(int receiver, QObject *parent)
+	: QThread(parent)
+	, m_receiver(receiver)
+	, m_pending(false)
+	, m_stop(false)
+	, m_viewSerial(0)
+	, m_lutSerial(0)
+	, m_workerViewSerial(0)
+	, m_workerLutSerial(0)
+	, m_sequence(0)
+	, m_notified(false)
+{
+	memset(&m_sharedView, 0, sizeof(m_sharedView));
+	memset(&m_view, 0, sizeof(m_view));
+
+	for (int i = 0; i < 3; i++) {
+
+		m_frames.slot(i).scaleMult = 1.0f;
+		m_frames.slot(i).sequence = 0;
+	}
+
+	if (m_receiver >= 0 && m_receiver < MAX_RECEIVERS)
+		s_workers[m_receiver].worker.store(this);
+}
+
+SpectrumDisplayWorker::~SpectrumDisplayWorker() {
+
+	if (m_receiver >= 0 && m_receiver < MAX_RECEIVERS) {
+
+		TWorkerSlot &slot = s_workers[m_receiver];
+		SpectrumDisplayWorker *self = this;
+		slot.worker.compare_exchange_strong(self, nullptr);
+
+		while (slot.posting.load() > 0)
+			QThread::yieldCurrentThread();
+	}
+
+	stop();
+	wait();
+}
+
+void SpectrumDisplayWorker::post(int receiver, const float *spectrum, int count) {
+
+	if (receiver < 0 || receiver >= MAX_RECEIVERS || count <= 0) return;
+
+	// sequentially consistent, paired with the destructor: either it sees
+	// this post() counted, or this post() sees the cleared pointer
+	TWorkerSlot &slot = s_workers[receiver];
+	slot.posting.fetch_add(1);
+
+	SpectrumDisplayWorker *worker = slot.worker.load();
+	if (worker)
+		worker->postSpectrum(spectrum, count);
+
+	slot.posting.fetch_sub(1, std::memory_order_release);
+}
+
+void SpectrumDisplayWorker::postSpectrum(const float *spectrum, int count) {
+
+	// only reallocates when the spectrum size changes
+	QVector<float> &slot = m_input.back();
+	slot.resize(count);
+	memcpy(slot.data(), spectrum, count * sizeof(float));
+	m_input.publish();
+
+	QMutexLocker locker(&m_wakeMutex);
+	m_pending = true;
+	m_wakeCondition.wakeOne();
+}
+
+void SpectrumDisplayWorker::setView(const TSpectrumDisplayView &view) {
+
+	QMutexLocker locker(&m_viewMutex);
+	if (memcmp(&m_sharedView, &view, sizeof(view)) == 0) return;
+
+	m_sharedView = view;
+	m_viewSerial++;
+}
+
+void SpectrumDisplayWorker::setColorLut(const CColorLut &lut) {
+
+	QMutexLocker locker(&m_viewMutex);
+	m_sharedLut = lut;
+	m_lutSerial++;
+}
+
+bool SpectrumDisplayWorker::takeFrame() {
+
+	// clear first: a frame published after this point notifies again
+	m_notified.store(false, std::memory_order_release);
+	return m_frames.update();
+}
+
+void SpectrumDisplayWorker::stop() {
+
+	QMutexLocker locker(&m_wakeMutex);
+	m_stop = true;
+	m_wakeCondition.wakeOne();
+}
+
+void SpectrumDisplayWorker::run() {
+
+	forever {
+
+		m_wakeMutex.lock();
+		while (!m_pending && !m_stop)
+			m_wakeCondition.wait(&m_wakeMutex);
+
+		const bool stopping = m_stop;
+		m_pending = false;
+		m_wakeMutex.unlock();
+
+		if (stopping) break;
+
+		if (!m_input.update()) continue;
+
+		// the view and table only change on user input; copy them when they do
+		m_viewMutex.lock();
+		if (m_workerViewSerial != m_viewSerial) {
+
+			m_view = m_sharedView;
+			m_workerViewSerial = m_viewSerial;
+		}
+		if (m_workerLutSerial != m_lutSerial) {
+
+			m_lut = m_sharedLut;
+			m_workerLutSerial = m_lutSerial;
+		}
+		m_viewMutex.unlock();
+
+		process(m_input.front());
+	}
+}
+
+void SpectrumDisplayWorker::process(const QVector<float> &spectrum) {
+
+	const TSpectrumDisplayView &view = m_view;
+	const int length = view.binsLength;
+	const int span = qMin(view.sampleSize, (int) spectrum.size() - view.first);
+
+	if (length <= 0 || view.repeat <= 0 || span <= 0 || !m_lut.isValid()) return;
+
+	// peak of the bins under each display bin, shared by panadapter and
+	// waterfall
+	m_peak.resize(length);
+	decimatePeak(spectrum.constData() + view.first, span, m_peak.data(), length);
+
+	TSpectrumDisplayFrame &frame = m_frames.back();
+
+	frame.panBins.resize(length);
+	for (int i = 0; i < length; i++)
+		frame.panBins[i] = m_peak.at(i) - view.panOffset;
+
+	// the bins may not quite fill the panel width; the last pixel is repeated
+	// up to it
+	const int pixels = length * view.repeat;
+	frame.waterfallRow.resize(qMax(pixels, view.rowLength));
+	quint32 *row = frame.waterfallRow.data();
+	if (view.repeat == 1) {
+
+		m_lut.map(m_peak.constData(), length, view.waterfallGain, row);
+	}
+	else {
+
+		m_binColors.resize(length);
+		m_lut.map(m_peak.constData(), length, view.waterfallGain, m_binColors.data());
+
+		for (int i = 0; i < length; i++)
+			for (int j = 0; j < view.repeat; j++)
+				row[i * view.repeat + j] = m_binColors.at(i);
+	}
+
+	for (int i = pixels; i < frame.waterfallRow.size(); i++)
+		row[i] = row[pixels - 1];
+
+	frame.scaleMult = view.scaleMult;
+	frame.sequence = ++m_sequence;
+	m_frames.publish();
+
+	if (!m_notified.exchange(true, std::memory_order_acq_rel))
+		emit frameReady();
+}
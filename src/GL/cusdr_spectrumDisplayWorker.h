@@ -0,0 +1,138 @@
+/**
+* @file  cusdr_spectrumDisplayWorker.h
+* @brief per receiver thread turning DSP spectra into panadapter frames
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _CUSDR_SPECTRUM_DISPLAY_WORKER_H
+#define _CUSDR_SPECTRUM_DISPLAY_WORKER_H
+
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "Util/cusdr_colorLut.h"
+#include "Util/cusdr_spscQueue.h"
+
+// What the panel currently shows: which DSP bins, onto how many display bins,
+// and how they are scaled and colored. Set from the GUI thread whenever it
+// changes.
+typedef struct _spectrumDisplayView {
+
+	int		first;			// first DSP bin shown
+	int		sampleSize;		// DSP bins shown
+	int		binsLength;		// display bins they are reduced to
+	int		repeat;			// waterfall pixels per display bin
+	int		rowLength;		// waterfall pixels, the panel width
+	float	scaleMult;		// display bins per pixel
+	float	panOffset;		// subtracted from the panadapter bins
+	float	waterfallGain;	// added before the waterfall color lookup
+
+} TSpectrumDisplayView;
+
+// One finished panadapter frame.
+typedef struct _spectrumDisplayFrame {
+
+	QVector<float>		panBins;		// dB above the panadapter floor
+	QVector<quint32>	waterfallRow;	// RGBA, at least rowLength pixels
+	float				scaleMult;		// of the view the frame was made with
+	quint64				sequence;
+
+} TSpectrumDisplayFrame;
+
+// Receives the raw spectrum of one receiver from its DSP thread and does the
+// display work on a thread of its own: reducing the bins to the panel width
+// and coloring the waterfall line. Finished frames go to the panel through a
+// triple buffer, so the GUI thread only picks up the latest one in paintGL()
+// and a stalled GUI drops frames instead of holding up the DSP thread.
+//
+// Input works the same way: post() copies the spectrum into the back slot of
+// an input triple buffer and wakes the worker; a worker that falls behind
+// only ever sees the newest spectrum.
+//
+// frameReady() is emitted at most once until the panel has called
+// takeFrame(), so frames never pile up in the GUI event queue.
+
+class SpectrumDisplayWorker : public QThread {
+
+	Q_OBJECT
+
+public:
+	SpectrumDisplayWorker(int receiver, QObject *parent = nullptr);
+	~SpectrumDisplayWorker();
+
+	// DSP thread: hand the spectrum of 'receiver' to its worker, if a panel
+	// has one running; lock-free
+	static void post(int receiver, const float *spectrum, int count);
+
+	// GUI thread
+	void	setView(const TSpectrumDisplayView &view);
+	void	setColorLut(const CColorLut &lut);
+
+	// makes the latest finished frame the front frame; false if there was
+	// none since the last call
+	bool	takeFrame();
+	const TSpectrumDisplayFrame &frame() const	{ return m_frames.front(); }
+
+	void	stop();
+
+signals:
+	void	frameReady();
+
+protected:
+	void	run() override;
+
+private:
+	void	postSpectrum(const float *spectrum, int count);
+	void	process(const QVector<float> &spectrum);
+
+	int		m_receiver;
+
+	QHTripleBuffer<QVector<float> >			m_input;
+	QHTripleBuffer<TSpectrumDisplayFrame>	m_frames;
+
+	QMutex			m_wakeMutex;
+	QWaitCondition	m_wakeCondition;
+	bool			m_pending;
+	bool			m_stop;
+
+	// view and colors, written by the GUI thread
+	QMutex					m_viewMutex;
+	TSpectrumDisplayView	m_sharedView;
+	CColorLut				m_sharedLut;
+	quint32					m_viewSerial;
+	quint32					m_lutSerial;
+
+	// worker thread copies
+	TSpectrumDisplayView	m_view;
+	CColorLut				m_lut;
+	quint32					m_workerViewSerial;
+	quint32					m_workerLutSerial;
+	QVector<float>			m_peak;
+	QVector<quint32>		m_binColors;
+	quint64					m_sequence;
+
+	std::atomic<bool>		m_notified;
+};
+
+#endif // _CUSDR_SPECTRUM_DISPLAY_WORKER_H
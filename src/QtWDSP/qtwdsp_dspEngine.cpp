@@ -224,7 +224,7 @@ void QWDSPEngine::setupConnections() {
 
 
 
-void QWDSPEngine::processDSP(CPX &in, CPX &out) {
+void QWDSPEngine::processDSP(CPX &in, CPX &out, bool spectrum) {
     int error;
     fexchange0(m_rx, reinterpret_cast<double*>(in.data()),
                reinterpret_cast<double*>(out.data()), &error);
@@ -239,7 +239,9 @@ void QWDSPEngine::processDSP(CPX &in, CPX &out) {
         }
     } else {
         m_firstExchangeDone = true;
-        Spectrum0(1, m_rx, 0, 0, reinterpret_cast<double*>(in.data()));
+        // the analyzer is only fed while the receiver's spectrum is shown
+        if (spectrum)
+            Spectrum0(1, m_rx, 0, 0, reinterpret_cast<double*>(in.data()));
     }
 
 }
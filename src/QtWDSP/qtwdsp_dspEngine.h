@@ -63,7 +63,7 @@ public:
     explicit QWDSPEngine(QObject *parent = nullptr, int rx = 0, int size = 0);
     ~QWDSPEngine() override;
 
-    void processDSP(CPX &in, CPX &out);
+    void processDSP(CPX &in, CPX &out, bool spectrum = true);
 
     double getSMeterInstValue();
     void init_analyzer(int refreshrate);
@@ -0,0 +1,179 @@
+/**
+* @file  cusdr_audioMix.cpp
+* @brief stereo audio mixing and sample format conversion kernels for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_audioMix.h"
+
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AUDIO_MIX_X86
+#include <immintrin.h>
+#endif
+
+typedef struct _audioMixKernels {
+
+	void	(*mix)(const float *, float *, int, float, float);
+	void	(*clip)(float *, int);
+	void	(*toInt16)(const float *, qint16 *, int);
+
+} TAudioMixKernels;
+
+static void mixScalar(const float *in, float *acc, int frames, float gainL, float gainR) {
+
+	for (int i = 0; i < frames; i++) {
+
+		acc[2 * i]     += in[2 * i]     * gainL;
+		acc[2 * i + 1] += in[2 * i + 1] * gainR;
+	}
+}
+
+static inline float clipSample(float v) {
+
+	return v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : v);
+}
+
+static void clipScalar(float *buf, int samples) {
+
+	for (int i = 0; i < samples; i++)
+		buf[i] = clipSample(buf[i]);
+}
+
+static void toInt16Scalar(const float *in, qint16 *out, int samples) {
+
+	// front to back: out[i] never overwrites an input that is still unread
+	for (int i = 0; i < samples; i++)
+		out[i] = (qint16) lrintf(clipSample(in[i]) * 32767.0f);
+}
+
+#ifdef AUDIO_MIX_X86
+
+__attribute__((target("avx2")))
+static void mixAvx2(const float *in, float *acc, int frames, float gainL, float gainR) {
+
+	const __m256 gain = _mm256_setr_ps(gainL, gainR, gainL, gainR, gainL, gainR, gainL, gainR);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4) {
+
+		__m256 v = _mm256_loadu_ps(acc + 2 * i);
+		v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_loadu_ps(in + 2 * i), gain));
+		_mm256_storeu_ps(acc + 2 * i, v);
+	}
+
+	mixScalar(in + 2 * i, acc + 2 * i, frames - i, gainL, gainR);
+}
+
+__attribute__((target("avx2")))
+static void clipAvx2(float *buf, int samples) {
+
+	const __m256 hi = _mm256_set1_ps(1.0f);
+	const __m256 lo = _mm256_set1_ps(-1.0f);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8)
+		_mm256_storeu_ps(buf + i, _mm256_max_ps(lo, _mm256_min_ps(hi, _mm256_loadu_ps(buf + i))));
+
+	clipScalar(buf + i, samples - i);
+}
+
+// Sixteen floats (64 bytes) are loaded before their sixteen results (32
+// bytes) are stored at the same or a lower address, so converting in place
+// never clobbers input that is still to be read.
+__attribute__((target("avx2")))
+static void toInt16Avx2(const float *in, qint16 *out, int samples) {
+
+	const __m256 hi = _mm256_set1_ps(1.0f);
+	const __m256 lo = _mm256_set1_ps(-1.0f);
+	const __m256 scale = _mm256_set1_ps(32767.0f);
+
+	int i = 0;
+	for (; i + 16 <= samples; i += 16) {
+
+		__m256 a = _mm256_loadu_ps(in + i);
+		__m256 b = _mm256_loadu_ps(in + i + 8);
+
+		a = _mm256_mul_ps(_mm256_max_ps(lo, _mm256_min_ps(hi, a)), scale);
+		b = _mm256_mul_ps(_mm256_max_ps(lo, _mm256_min_ps(hi, b)), scale);
+
+		// packs works per 128-bit lane; put the quadwords back in order
+		__m256i v = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+		v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm256_storeu_si256((__m256i *)(out + i), v);
+	}
+
+	toInt16Scalar(in + i, out + i, samples - i);
+}
+
+#endif // AUDIO_MIX_X86
+
+static TAudioMixKernels selectKernels(const char **name) {
+
+	TAudioMixKernels k;
+
+#ifdef AUDIO_MIX_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+
+		k.mix		= mixAvx2;
+		k.clip		= clipAvx2;
+		k.toInt16	= toInt16Avx2;
+		*name = "avx2";
+		return k;
+	}
+#endif
+	k.mix		= mixScalar;
+	k.clip		= clipScalar;
+	k.toInt16	= toInt16Scalar;
+	*name = "scalar";
+	return k;
+}
+
+static const char *s_kernelName = nullptr;
+
+static const TAudioMixKernels &kernels() {
+
+	static const TAudioMixKernels k = selectKernels(&s_kernelName);
+	return k;
+}
+
+void mixStereo(const float *in, float *acc, int frames, float gainL, float gainR) {
+
+	if (frames > 0) kernels().mix(in, acc, frames, gainL, gainR);
+}
+
+void clipAudio(float *buf, int samples) {
+
+	if (samples > 0) kernels().clip(buf, samples);
+}
+
+void audioToInt16(const float *in, qint16 *out, int samples) {
+
+	if (samples > 0) kernels().toInt16(in, out, samples);
+}
+
+const char *audioMixKernel() {
+
+	kernels();
+	return s_kernelName;
+}
@@ -0,0 +1,48 @@
+/**
+* @file  cusdr_audioMix.h
+* @brief stereo audio mixing and sample format conversion kernels for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_AUDIO_MIX_H
+#define CUSDR_AUDIO_MIX_H
+
+#include <QtGlobal>
+
+// All buffers are interleaved L/R floats; 'frames' counts stereo pairs,
+// 'samples' single values. Nothing is allocated.
+//
+// The AVX2 kernels are chosen on the first call if the CPU has them; other
+// targets use the scalar loops.
+
+// acc[L] += in[L] * gainL, acc[R] += in[R] * gainR
+void mixStereo(const float *in, float *acc, int frames, float gainL, float gainR);
+
+// clip to [-1, 1] in place, for float sinks
+void clipAudio(float *buf, int samples);
+
+// clip and convert to signed 16 bit; 'out' may be the same memory as 'in',
+// so a float buffer can be converted in place
+void audioToInt16(const float *in, qint16 *out, int samples);
+
+// name of the kernel the functions dispatch to ("avx2", "scalar")
+const char *audioMixKernel();
+
+#endif // CUSDR_AUDIO_MIX_H
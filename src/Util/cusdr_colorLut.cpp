@@ -0,0 +1,126 @@
+/**
+* @file  cusdr_colorLut.cpp
+* @brief dB to RGBA color lookup table for the waterfall displays
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_colorLut.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLOR_LUT_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*MapKernel)(const quint32 *, const float *, int, float, float, quint32 *);
+
+// index = (dB + bias) * scale, rounded and clamped to the table; a NaN maps
+// to entry 0
+static void mapScalar(const quint32 *table, const float *dB, int count, float bias, float scale, quint32 *out) {
+
+	const float last = (float)(CColorLut::LUT_SIZE - 1);
+	for (int i = 0; i < count; i++) {
+
+		float x = (dB[i] + bias) * scale + 0.5f;
+		x = x > 0.0f ? x : 0.0f;
+		x = x < last ? x : last;
+		out[i] = table[(int) x];
+	}
+}
+
+#ifdef COLOR_LUT_X86
+
+// Eight bins per iteration: the index arithmetic in ps, then one gather from
+// the table. max_ps returns its second operand for a NaN, as in mapScalar().
+__attribute__((target("avx2")))
+static void mapAvx2(const quint32 *table, const float *dB, int count, float bias, float scale, quint32 *out) {
+
+	const __m256 vBias  = _mm256_set1_ps(bias);
+	const __m256 vScale = _mm256_set1_ps(scale);
+	const __m256 vHalf  = _mm256_set1_ps(0.5f);
+	const __m256 vZero  = _mm256_setzero_ps();
+	const __m256 vLast  = _mm256_set1_ps((float)(CColorLut::LUT_SIZE - 1));
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+
+		__m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(dB + i), vBias), vScale), vHalf);
+		x = _mm256_min_ps(_mm256_max_ps(x, vZero), vLast);
+
+		const __m256i idx = _mm256_cvttps_epi32(x);
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_i32gather_epi32((const int *) table, idx, 4));
+	}
+
+	mapScalar(table, dB + i, count - i, bias, scale, out + i);
+}
+
+#endif // COLOR_LUT_X86
+
+static MapKernel selectKernel(const char **name) {
+
+#ifdef COLOR_LUT_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return mapAvx2;
+	}
+#endif
+	*name = "scalar";
+	return mapScalar;
+}
+
+static const char *s_kernelName = nullptr;
+
+static MapKernel kernel() {
+
+	static const MapKernel k = selectKernel(&s_kernelName);
+	return k;
+}
+
+CColorLut::CColorLut()
+	: m_lower(0.0f)
+	, m_upper(1.0f)
+	, m_scale(1.0f)
+	, m_valid(false)
+{
+	memset(m_table, 0, sizeof(m_table));
+}
+
+void CColorLut::setEntry(int i, const QColor &color) {
+
+	const QColor rgb = color.toRgb();
+	const uchar bytes[4] = {
+		(uchar) rgb.red(), (uchar) rgb.green(), (uchar) rgb.blue(), (uchar) rgb.alpha()
+	};
+	memcpy(&m_table[i], bytes, 4);
+}
+
+void CColorLut::map(const float *dB, int count, float offset, void *out) const {
+
+	if (count > 0)
+		kernel()(m_table, dB, count, offset - m_lower, m_scale, static_cast<quint32 *>(out));
+}
+
+const char *CColorLut::kernelName() {
+
+	kernel();
+	return s_kernelName;
+}
@@ -0,0 +1,91 @@
+/**
+* @file  cusdr_colorLut.h
+* @brief dB to RGBA color lookup table for the waterfall displays
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_COLOR_LUT_H
+#define CUSDR_COLOR_LUT_H
+
+#include <QtGlobal>
+#include <QColor>
+
+// Color of a dB value, sampled at LUT_SIZE points between a lower and an
+// upper threshold. Values at or below the lower threshold get entry 0, at or
+// above the upper one the last entry; in between the nearest entry, which is
+// within (upper - lower) / 8190 dB of the value (about 0.02 dB for a 150 dB
+// span).
+//
+// Entries are 4 bytes R, G, B, A in memory, the layout of TGL_ubyteRGBA and
+// of a GL_RGBA / GL_UNSIGNED_BYTE texture row, so map() can write straight
+// into a waterfall line.
+
+class CColorLut {
+
+public:
+	static const int LUT_SIZE = 4096;
+
+	CColorLut();
+
+	// colorAt(qreal dB) -> QColor is called once per entry
+	template<typename ColorFunction>
+	void	build(float lower, float upper, ColorFunction colorAt);
+
+	bool	isValid() const		{ return m_valid; }
+	void	invalidate()		{ m_valid = false; }
+
+	float	lower() const		{ return m_lower; }
+	float	upper() const		{ return m_upper; }
+
+	// out[i] = color of (dB[i] + offset), count entries of 4 bytes each
+	void	map(const float *dB, int count, float offset, void *out) const;
+
+	// name of the kernel map() dispatches to ("avx2", "scalar")
+	static const char *kernelName();
+
+private:
+	void	setEntry(int i, const QColor &color);
+
+	quint32	m_table[LUT_SIZE];
+	float	m_lower;
+	float	m_upper;
+	float	m_scale;	// entries per dB
+	bool	m_valid;
+};
+
+template<typename ColorFunction>
+void CColorLut::build(float lower, float upper, ColorFunction colorAt) {
+
+	if (upper <= lower) upper = lower + 1.0f;
+
+	m_lower = lower;
+	m_upper = upper;
+	m_scale = (LUT_SIZE - 1) / (upper - lower);
+
+	// the end points exactly, so they get the colors beyond the thresholds
+	setEntry(0, colorAt((qreal) lower));
+	for (int i = 1; i < LUT_SIZE - 1; i++)
+		setEntry(i, colorAt((qreal) lower + (qreal) i * (upper - lower) / (LUT_SIZE - 1)));
+	setEntry(LUT_SIZE - 1, colorAt((qreal) upper));
+
+	m_valid = true;
+}
+
+#endif // CUSDR_COLOR_LUT_H
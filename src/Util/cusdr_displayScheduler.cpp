@@ -0,0 +1,226 @@
+/**
+* @file  cusdr_displayScheduler.cpp
+* @brief tracks which spectrum displays are on screen and how fast they refresh
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#define LOG_DISPLAY_SCHEDULER
+
+// use: DISPLAY_SCHEDULER_DEBUG
+
+#include "cusdr_displayScheduler.h"
+#include "cusdr_settings.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QScreen>
+#include <QWindow>
+
+// Exposure changes (another window on top, a virtual desktop switch) reach
+// the QWindow but not the panels, so they are picked up by polling.
+#define DISPLAY_SCHEDULER_POLL_MS	250
+
+CDisplayScheduler *CDisplayScheduler::instance() {
+
+	static CDisplayScheduler scheduler;
+	return &scheduler;
+}
+
+CDisplayScheduler::CDisplayScheduler()
+	: QObject()
+	, m_pollTimer(this)
+	, m_evaluatePending(false)
+	, m_tracking(false)
+{
+	for (int i = 0; i < StreamCount; i++)
+		m_interval[i].store(0, std::memory_order_relaxed);
+
+	// the first call may come from a DSP thread; the widgets live on the
+	// GUI thread, and so does the scheduler
+	if (QCoreApplication::instance())
+		moveToThread(QCoreApplication::instance()->thread());
+
+	m_pollTimer.setInterval(DISPLAY_SCHEDULER_POLL_MS);
+	CHECKED_CONNECT(&m_pollTimer, SIGNAL(timeout()), this, SLOT(evaluate()));
+}
+
+void CDisplayScheduler::addDisplay(QWidget *display, int stream) {
+
+	if (!display || stream < 0 || stream >= StreamCount) return;
+
+	TDisplay entry;
+	entry.widget = display;
+	entry.stream = stream;
+	m_displays.append(entry);
+
+	display->installEventFilter(this);
+	trackWindow(display);
+
+	m_tracking.store(true, std::memory_order_release);
+	if (!m_pollTimer.isActive())
+		m_pollTimer.start();
+
+	evaluate();
+}
+
+void CDisplayScheduler::removeDisplay(QWidget *display) {
+
+	for (int i = m_displays.size() - 1; i >= 0; i--) {
+
+		QWidget *widget = m_displays.at(i).widget.data();
+		if (!widget || widget == display)
+			m_displays.removeAt(i);
+	}
+
+	if (display)
+		display->removeEventFilter(this);
+
+	// no display left: back to the headless behaviour until one registers
+	if (m_displays.isEmpty())
+		m_tracking.store(false, std::memory_order_release);
+
+	evaluate();
+}
+
+bool CDisplayScheduler::isShown(int stream) const {
+
+	return frameInterval(stream) >= 0;
+}
+
+int CDisplayScheduler::frameInterval(int stream) const {
+
+	if (!m_tracking.load(std::memory_order_acquire)) return 0;
+	if (stream < 0 || stream >= StreamCount) return -1;
+
+	return m_interval[stream].load(std::memory_order_relaxed);
+}
+
+bool CDisplayScheduler::frameDue(int stream, qint64 elapsedUs, int requestedUs) const {
+
+	const int interval = frameInterval(stream);
+	if (interval < 0) return false;
+
+	return elapsedUs >= qMax(interval, requestedUs);
+}
+
+bool CDisplayScheduler::eventFilter(QObject *watched, QEvent *event) {
+
+	switch (event->type()) {
+
+		case QEvent::Show:
+		case QEvent::ParentChange:
+			// the native window may be new, or a different one
+			trackWindow(qobject_cast<QWidget *>(watched));
+			scheduleEvaluate();
+			break;
+
+		case QEvent::Hide:
+			scheduleEvaluate();
+			break;
+
+		default:
+			break;
+	}
+
+	return QObject::eventFilter(watched, event);
+}
+
+void CDisplayScheduler::scheduleEvaluate() {
+
+	// a tab switch hides one panel and shows another; look once both are done
+	if (m_evaluatePending) return;
+
+	m_evaluatePending = true;
+	QTimer::singleShot(0, this, SLOT(evaluate()));
+}
+
+// A move to another screen is only announced by the top level QWindow,
+// which exists once the window has been shown.
+void CDisplayScheduler::trackWindow(QWidget *widget) {
+
+	if (!widget) return;
+
+	QWindow *handle = widget->window()->windowHandle();
+	if (!handle) return;
+
+	connect(handle, SIGNAL(screenChanged(QScreen*)), this, SLOT(scheduleEvaluate()), Qt::UniqueConnection);
+}
+
+bool CDisplayScheduler::isOnScreen(QWidget *widget) const {
+
+	if (!widget->isVisible() || widget->visibleRegion().isEmpty()) return false;
+
+	QWidget *window = widget->window();
+	if (window->isMinimized()) return false;
+
+	const QWindow *handle = window->windowHandle();
+	return handle && handle->isExposed();
+}
+
+void CDisplayScheduler::evaluate() {
+
+	m_evaluatePending = false;
+
+	int interval[StreamCount];
+	for (int i = 0; i < StreamCount; i++)
+		interval[i] = -1;
+
+	for (int i = m_displays.size() - 1; i >= 0; i--) {
+
+		QWidget *widget = m_displays.at(i).widget.data();
+		if (!widget) {
+
+			m_displays.removeAt(i);
+			continue;
+		}
+
+		if (!isOnScreen(widget)) continue;
+
+		// one frame per refresh of the fastest screen the stream is on
+		int us = 0;
+		const QScreen *screen = widget->screen();
+		if (screen && screen->refreshRate() > 1.0)
+			us = (int)(1000000.0 / screen->refreshRate());
+
+		int &current = interval[m_displays.at(i).stream];
+		current = (current < 0) ? us : qMin(current, us);
+	}
+
+	for (int i = 0; i < StreamCount; i++) {
+
+		const int previous = m_interval[i].exchange(interval[i], std::memory_order_relaxed);
+		if (previous != interval[i]) {
+
+			if (i == Wideband)
+				DISPLAY_SCHEDULER_DEBUG << "wide band: " << (interval[i] < 0 ? "hidden" : "shown") << ", " << interval[i] << " us";
+			else if (i >= ReceiverSignal0)
+				DISPLAY_SCHEDULER_DEBUG << "receiver " << i - ReceiverSignal0 << " signal: " << (interval[i] < 0 ? "hidden" : "shown") << ", " << interval[i] << " us";
+			else
+				DISPLAY_SCHEDULER_DEBUG << "receiver " << i - Receiver0 << ": " << (interval[i] < 0 ? "hidden" : "shown") << ", " << interval[i] << " us";
+		}
+	}
+
+	// the last panel may have been deleted without removeDisplay()
+	if (m_displays.isEmpty()) {
+
+		m_tracking.store(false, std::memory_order_release);
+		m_pollTimer.stop();
+	}
+}
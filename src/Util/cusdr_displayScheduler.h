@@ -0,0 +1,116 @@
+/**
+* @file  cusdr_displayScheduler.h
+* @brief tracks which spectrum displays are on screen and how fast they refresh
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_DISPLAY_SCHEDULER_H
+#define CUSDR_DISPLAY_SCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+
+#include <atomic>
+
+#include "cusdr_settings.h"
+
+#ifdef LOG_DISPLAY_SCHEDULER
+#   define DISPLAY_SCHEDULER_DEBUG qDebug().nospace() << "DisplayScheduler::\t"
+#else
+#   define DISPLAY_SCHEDULER_DEBUG nullDebug()
+#endif
+
+// Decides which spectrum streams are worth computing. The panels showing a
+// stream register here; the GUI thread keeps track of whether any of them is
+// actually on screen (visible, not on a hidden tab, not minimized, window
+// exposed) and of the refresh rate of the screens they are on. The DSP
+// threads read the result lock-free:
+//
+//  - a stream nobody sees skips its analyzer work (Spectrum0 / GetPixels)
+//    altogether, so receivers without a visible panel cost no display time;
+//  - a shown stream is pulled at most once per refresh of the fastest
+//    screen it is shown on, as more frames than that are never displayed.
+//
+// Until the first display registers (headless runs) every stream counts as
+// shown at an unlimited rate, so nothing changes without a GUI.
+
+class CDisplayScheduler : public QObject {
+
+	Q_OBJECT
+
+public:
+	enum Stream {
+
+		Receiver0,								// Receiver0 + rx: a receiver's spectrum
+		Wideband = Receiver0 + MAX_RECEIVERS,	// the wide band spectrum
+		ReceiverSignal0,						// ReceiverSignal0 + rx: a receiver's spectrum
+												// as Receiver::spectrumBufferChanged (3D panel)
+		StreamCount = ReceiverSignal0 + MAX_RECEIVERS
+	};
+
+	static CDisplayScheduler *instance();
+
+	// GUI thread
+	void	addDisplay(QWidget *display, int stream);
+	void	removeDisplay(QWidget *display);
+
+	// any thread
+	bool	isShown(int stream) const;
+
+	// shortest useful time between two frames of the stream in us: 0 for
+	// no limit, -1 if the stream is not shown at all
+	int		frameInterval(int stream) const;
+
+	// true if a shown stream is due for a frame 'elapsedUs' after its last
+	// one, given the interval the user asked for
+	bool	frameDue(int stream, qint64 elapsedUs, int requestedUs) const;
+
+protected:
+	bool	eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+	void	evaluate();
+	void	scheduleEvaluate();
+
+private:
+	CDisplayScheduler();
+
+	typedef struct _display {
+
+		QPointer<QWidget>	widget;
+		int					stream;
+
+	} TDisplay;
+
+	void	trackWindow(QWidget *widget);
+	bool	isOnScreen(QWidget *widget) const;
+
+	QList<TDisplay>		m_displays;
+	QTimer				m_pollTimer;
+	bool				m_evaluatePending;
+
+	std::atomic<bool>	m_tracking;
+	std::atomic<int>	m_interval[StreamCount];
+};
+
+#endif // CUSDR_DISPLAY_SCHEDULER_H
@@ -0,0 +1,140 @@
+/**
+* @file  cusdr_frameBuffer.h
+* @brief preallocated double-buffered frame handoff for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_FRAME_BUFFER_H
+#define CUSDR_FRAME_BUFFER_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// 32 wideband packets of 1024 bytes, the largest EP4 frame we assemble
+#define FRAME_BUFFER_SIZE	32768
+
+// Two preallocated frames handed from one producer thread to one consumer
+// thread (DataIO -> WideBandDataProcessor).
+//
+// The producer always owns one frame and writes into it in place; publish()
+// swaps it with the other one, if the consumer is not reading that. Frames
+// are for display, so nothing ever waits on the consumer: a frame that finds
+// the consumer busy is dropped, and a published frame nobody has taken yet
+// is replaced by the newer one.
+//
+// tryAcquire() returns nullptr when no frame is ready; release() gives the
+// frame back once the consumer is done with it.
+
+class CFrameDoubleBuffer {
+
+public:
+	CFrameDoubleBuffer()
+		: m_fill(0)
+		, m_other(1)
+		, m_state(Free)
+		, m_dropped(0)
+	{
+		for (int i = 0; i < 2; i++) {
+
+			m_frames[i].reset(new uchar[FRAME_BUFFER_SIZE]);
+			m_size[i] = 0;
+		}
+	}
+
+	CFrameDoubleBuffer(const CFrameDoubleBuffer &) = delete;
+	CFrameDoubleBuffer &operator=(const CFrameDoubleBuffer &) = delete;
+
+	// producer side
+
+	uchar	*fillBuffer()		{ return m_frames[m_fill].get(); }
+	int		capacity() const	{ return FRAME_BUFFER_SIZE; }
+
+	bool publish(int size) {
+
+		int state = m_state.load(std::memory_order_acquire);
+
+		// still not taken: the newer frame wins
+		if (state == Ready &&
+			m_state.compare_exchange_strong(state, Free, std::memory_order_acquire)) {
+
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			state = Free;
+		}
+
+		// the consumer is on the other frame: this one goes
+		if (state != Free) {
+
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_size[m_fill] = size;
+		std::swap(m_fill, m_other);
+		m_state.store(Ready, std::memory_order_release);
+		return true;
+	}
+
+	// consumer side
+
+	const uchar *tryAcquire(int &size) {
+
+		int state = Ready;
+		if (!m_state.compare_exchange_strong(state, Reading, std::memory_order_acquire))
+			return nullptr;
+
+		size = m_size[m_other];
+		return m_frames[m_other].get();
+	}
+
+	void release() {
+
+		m_state.store(Free, std::memory_order_release);
+	}
+
+	// either side
+
+	// drops a frame that was published but not taken yet
+	void clear() {
+
+		int state = Ready;
+		m_state.compare_exchange_strong(state, Free, std::memory_order_acquire);
+	}
+
+	quint64 dropped() const {
+
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+
+private:
+	enum { Free, Ready, Reading };
+
+	std::unique_ptr<uchar[]>	m_frames[2];
+	int							m_size[2];
+	int							m_fill;		// producer's frame
+	int							m_other;	// published, read or free
+
+	std::atomic<int>		m_state;		// of m_other
+	std::atomic<quint64>	m_dropped;
+};
+
+#endif // CUSDR_FRAME_BUFFER_H
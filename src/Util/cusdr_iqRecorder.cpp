@@ -0,0 +1,477 @@
+/**
+* @file  cusdr_iqRecorder.cpp
+* @brief raw IQ datagram recorder and memory-mapped recording reader
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_iqRecorder.h"
+#include "cusdr_settings.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline int paddedRecordSize(int size) {
+	return (int) sizeof(TIQRecRecord) + ((size + 7) & ~7);
+}
+
+}
+
+IQRecorder::IQRecorder()
+	: m_freeChunks(IQREC_CHUNKS)
+	, m_fullChunks(IQREC_CHUNKS)
+	, m_current(-1)
+	, m_writer(this)
+	, m_startMono(0)
+	, m_portBase(0)
+	, m_recording(false)
+	, m_stopping(false)
+	, m_producers(0)
+	, m_records(0)
+	, m_dropped(0)
+	, m_bytesWritten(0)
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+IQRecorder::~IQRecorder() {
+
+	stop();
+}
+
+bool IQRecorder::start(const QString &fileName, int protocol, int sampleRate, int receivers, QString *error) {
+
+	stop();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+
+		*error = QString("cannot create %1: %2").arg(fileName, m_file.errorString());
+		return false;
+	}
+
+	// page aligned, so every write to the file is a whole number of pages
+	m_chunks.resize(IQREC_CHUNKS);
+	for (int i = 0; i < IQREC_CHUNKS; i++) {
+
+		m_chunks[i].data = static_cast<char *>(qMallocAligned(IQREC_CHUNK_SIZE, 4096));
+		if (!m_chunks[i].data) {
+
+			*error = QString("out of memory for %1 recording buffers").arg(IQREC_CHUNKS);
+			freeChunks();
+			m_file.close();
+			return false;
+		}
+	}
+
+	m_freeChunks.clear();
+	m_fullChunks.clear();
+	for (int i = 0; i < IQREC_CHUNKS; i++)
+		m_freeChunks.tryEnqueue(i);
+	m_current = -1;
+
+	m_index.clear();
+	m_error.clear();
+	m_records.store(0);
+	m_dropped.store(0);
+	m_bytesWritten.store(0);
+
+	memset(&m_header, 0, sizeof(m_header));
+	memcpy(m_header.magic, IQREC_MAGIC, sizeof(m_header.magic));
+	m_header.version = IQREC_VERSION;
+	m_header.headerSize = IQREC_HEADER_SIZE;
+	m_header.chunkSize = IQREC_CHUNK_SIZE;
+	m_header.protocol = (quint32) protocol;
+	m_header.sampleRate = (quint32) sampleRate;
+	m_header.receivers = (quint32) receivers;
+	m_header.startTime = QDateTime::currentMSecsSinceEpoch() * 1000;
+	m_startMono = cusdrMonotonicUs();
+	m_portBase = (protocol == 2) ? 1035 : 1024;
+
+	if (!writeHeader()) {
+
+		*error = QString("cannot write %1: %2").arg(fileName, m_error);
+		freeChunks();
+		m_file.close();
+		return false;
+	}
+
+	m_fileName = fileName;
+	m_stopping.store(false);
+	m_writer.start(QThread::LowPriority);
+	m_recording.store(true);
+
+	IQ_RECORDER_DEBUG << "recording Protocol " << protocol << " to " << qPrintable(fileName);
+	return true;
+}
+
+void IQRecorder::stop() {
+
+	if (!m_file.isOpen()) return;
+
+	m_recording.store(false);
+	while (m_producers.load() != 0)
+		QThread::yieldCurrentThread();
+
+	// DataIO is out of record(), so this thread may finish the open chunk
+	if (m_current >= 0 && m_chunks[m_current].entry.records > 0)
+		closeChunk();
+
+	m_stopping.store(true);
+	m_writer.wait();
+
+	m_header.chunks = (quint64) m_index.count();
+	m_header.records = 0;
+	for (const TIQRecIndexEntry &entry : m_index)
+		m_header.records += entry.records;
+	m_header.droppedRecords = m_dropped.load();
+
+	// Write the index even after a write error: what made it to disk is
+	// still worth finding. If that fails too the reader rebuilds it.
+	const qint64 indexOffset = (qint64) IQREC_HEADER_SIZE + (qint64) m_index.count() * IQREC_CHUNK_SIZE;
+	const qint64 indexBytes = (qint64) m_index.count() * (qint64) sizeof(TIQRecIndexEntry);
+	if (m_file.seek(indexOffset) && m_file.write((const char *) m_index.constData(), indexBytes) == indexBytes)
+		m_header.indexOffset = (quint64) indexOffset;
+
+	writeHeader();
+	m_file.close();
+	freeChunks();
+
+	IQ_RECORDER_DEBUG << "recorded " << m_header.records << " datagrams, "
+					  << m_header.droppedRecords << " dropped, to " << qPrintable(m_fileName);
+}
+
+QString IQRecorder::errorString() const {
+
+	// written by the writer thread; only read it once stop() has returned
+	return m_file.isOpen() ? QString() : m_error;
+}
+
+void IQRecorder::append(const char *data, int size, quint16 port, qint64 time) {
+
+	if (size <= 0 || size > 0xFFFF) return;
+
+	// keep room for the end marker behind the record
+	const int need = paddedRecordSize(size);
+	if (m_current >= 0 && m_chunks[m_current].fill + need + (int) sizeof(TIQRecRecord) > IQREC_CHUNK_SIZE)
+		closeChunk();
+
+	if (m_current < 0 && !takeChunk()) {
+
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	TChunk &chunk = m_chunks[m_current];
+	TIQRecRecord *record = reinterpret_cast<TIQRecRecord *>(chunk.data + chunk.fill);
+	record->time = time - m_startMono;
+	record->port = port;
+	record->size = (quint16) size;
+	record->reserved = 0;
+	memcpy(record + 1, data, size);
+	chunk.fill += need;
+
+	if (chunk.entry.records == 0)
+		chunk.entry.firstTime = record->time;
+	chunk.entry.lastTime = record->time;
+	chunk.entry.records++;
+
+	const quint32 bit = (quint32) port - m_portBase;
+	if (bit < 32)
+		chunk.entry.ports |= 1u << bit;
+
+	m_records.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool IQRecorder::takeChunk() {
+
+	int chunk;
+	if (!m_freeChunks.tryDequeue(chunk)) return false;
+
+	m_chunks[chunk].fill = 0;
+	memset(&m_chunks[chunk].entry, 0, sizeof(TIQRecIndexEntry));
+	m_current = chunk;
+	return true;
+}
+
+void IQRecorder::closeChunk() {
+
+	TChunk &chunk = m_chunks[m_current];
+	if (chunk.fill + (int) sizeof(TIQRecRecord) <= IQREC_CHUNK_SIZE)
+		memset(chunk.data + chunk.fill, 0, sizeof(TIQRecRecord));
+
+	// every chunk is either free, being filled or queued here, so this
+	// queue always has room
+	m_fullChunks.tryEnqueue(m_current);
+	m_current = -1;
+}
+
+void IQRecorder::writerLoop() {
+
+	bool ok = true;
+	for (;;) {
+
+		int index;
+		if (m_fullChunks.tryDequeue(index)) {
+
+			TChunk &chunk = m_chunks[index];
+			if (ok)
+				ok = writeChunk(chunk);
+			if (!ok)
+				m_dropped.fetch_add(chunk.entry.records, std::memory_order_relaxed);
+
+			m_freeChunks.tryEnqueue(index);
+			continue;
+		}
+
+		// stop() queues the last chunk before it sets m_stopping
+		if (m_stopping.load()) {
+
+			if (m_fullChunks.isEmpty()) break;
+			continue;
+		}
+		QThread::msleep(IQREC_WRITER_POLL_MS);
+	}
+}
+
+bool IQRecorder::writeChunk(TChunk &chunk) {
+
+	if (m_file.write(chunk.data, IQREC_CHUNK_SIZE) != IQREC_CHUNK_SIZE) {
+
+		m_error = m_file.errorString();
+		IQ_RECORDER_DEBUG << "write failed: " << qPrintable(m_error);
+		return false;
+	}
+
+	m_index.append(chunk.entry);
+	m_bytesWritten.fetch_add(IQREC_CHUNK_SIZE, std::memory_order_relaxed);
+	return true;
+}
+
+bool IQRecorder::writeHeader() {
+
+	QByteArray block(IQREC_HEADER_SIZE, 0);
+	memcpy(block.data(), &m_header, sizeof(m_header));
+
+	if (!m_file.seek(0) || m_file.write(block) != block.size()) {
+
+		m_error = m_file.errorString();
+		return false;
+	}
+	return true;
+}
+
+void IQRecorder::freeChunks() {
+
+	for (TChunk &chunk : m_chunks)
+		qFreeAligned(chunk.data);
+	m_chunks.clear();
+	m_current = -1;
+}
+
+void IQRecorder::Writer::run() {
+
+	m_recorder->writerLoop();
+}
+
+// ************************************************************************
+
+IQRecording::IQRecording()
+	: m_map(nullptr)
+	, m_size(0)
+{
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+IQRecording::~IQRecording() {
+
+	close();
+}
+
+bool IQRecording::open(const QString &fileName, QString *error) {
+
+	close();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadOnly)) {
+
+		*error = QString("cannot open %1: %2").arg(fileName, m_file.errorString());
+		return false;
+	}
+
+	m_size = m_file.size();
+	if (m_size >= (qint64) sizeof(TIQRecHeader))
+		m_map = m_file.map(0, m_size);
+
+	if (!m_map) {
+
+		*error = QString("cannot map %1").arg(fileName);
+		close();
+		return false;
+	}
+
+	memcpy(&m_header, m_map, sizeof(m_header));
+	if (memcmp(m_header.magic, IQREC_MAGIC, sizeof(m_header.magic)) != 0 ||
+		m_header.version != IQREC_VERSION ||
+		m_header.headerSize < sizeof(TIQRecHeader) ||
+		m_header.chunkSize < 2 * sizeof(TIQRecRecord) || (m_header.chunkSize & 7) != 0)
+	{
+		*error = QString("%1 is not a cudaSDR IQ recording").arg(fileName);
+		close();
+		return false;
+	}
+
+	const qint64 indexBytes = (qint64) m_header.chunks * (qint64) sizeof(TIQRecIndexEntry);
+	const qint64 dataEnd = (qint64) m_header.headerSize + (qint64) m_header.chunks * m_header.chunkSize;
+	if (m_header.indexOffset != 0 && dataEnd <= (qint64) m_header.indexOffset &&
+		(qint64) m_header.indexOffset + indexBytes <= m_size)
+	{
+		m_index.resize((int) m_header.chunks);
+		memcpy(m_index.data(), m_map + m_header.indexOffset, indexBytes);
+	}
+	else if (!rebuildIndex()) {
+
+		*error = QString("%1 holds no complete chunk").arg(fileName);
+		close();
+		return false;
+	}
+	return true;
+}
+
+void IQRecording::close() {
+
+	if (m_map)
+		m_file.unmap(const_cast<uchar *>(m_map));
+	m_map = nullptr;
+	m_size = 0;
+	m_index.clear();
+	m_file.close();
+}
+
+// The recorder did not get to write its index: walk every complete chunk.
+bool IQRecording::rebuildIndex() {
+
+	m_index.clear();
+	m_header.records = 0;
+
+	const qint64 chunks = (m_size - (qint64) m_header.headerSize) / m_header.chunkSize;
+	const quint32 portBase = (m_header.protocol == 2) ? 1035 : 1024;
+
+	for (qint64 n = 0; n < chunks; n++) {
+
+		const uchar *chunk = chunkData((int) n);
+		TIQRecIndexEntry entry;
+		memset(&entry, 0, sizeof(entry));
+
+		qint64 offset = 0;
+		while (offset + (qint64) sizeof(TIQRecRecord) <= m_header.chunkSize) {
+
+			const TIQRecRecord *record = reinterpret_cast<const TIQRecRecord *>(chunk + offset);
+			if (record->size == 0 || offset + paddedRecordSize(record->size) > m_header.chunkSize) break;
+
+			if (entry.records == 0)
+				entry.firstTime = record->time;
+			entry.lastTime = record->time;
+			entry.records++;
+
+			const quint32 bit = (quint32) record->port - portBase;
+			if (bit < 32)
+				entry.ports |= 1u << bit;
+
+			offset += paddedRecordSize(record->size);
+		}
+
+		// an empty chunk is one the recorder never wrote
+		if (entry.records == 0) break;
+
+		m_index.append(entry);
+		m_header.records += entry.records;
+	}
+
+	m_header.chunks = (quint64) m_index.count();
+	return !m_index.isEmpty();
+}
+
+const uchar *IQRecording::chunkData(int chunk) const {
+
+	return m_map + m_header.headerSize + (qint64) chunk * m_header.chunkSize;
+}
+
+qint64 IQRecording::duration() const {
+
+	return m_index.isEmpty() ? 0 : m_index.last().lastTime;
+}
+
+IQRecording::Cursor IQRecording::begin() const {
+
+	Cursor cursor;
+	cursor.m_recording = this;
+	cursor.settle();
+	return cursor;
+}
+
+IQRecording::Cursor IQRecording::seek(qint64 time) const {
+
+	// records are in arrival order, so the chunks' last times are sorted
+	const auto it = std::lower_bound(m_index.constBegin(), m_index.constEnd(), time,
+		[](const TIQRecIndexEntry &entry, qint64 t) { return entry.lastTime < t; });
+
+	Cursor cursor;
+	cursor.m_recording = this;
+	cursor.m_chunk = (int)(it - m_index.constBegin());
+	cursor.settle();
+
+	while (!cursor.atEnd() && cursor.record().time < time)
+		cursor.next();
+	return cursor;
+}
+
+const TIQRecRecord &IQRecording::Cursor::record() const {
+
+	return *reinterpret_cast<const TIQRecRecord *>(m_recording->chunkData(m_chunk) + m_offset);
+}
+
+void IQRecording::Cursor::next() {
+
+	if (atEnd()) return;
+
+	m_offset += paddedRecordSize(record().size);
+	settle();
+}
+
+// move on to the next chunk when this one has no record at m_offset
+void IQRecording::Cursor::settle() {
+
+	const qint64 chunkSize = m_recording->m_header.chunkSize;
+	while (!atEnd()) {
+
+		if (m_offset + (qint64) sizeof(TIQRecRecord) <= chunkSize) {
+
+			const TIQRecRecord &r = record();
+			if (r.size != 0 && m_offset + paddedRecordSize(r.size) <= chunkSize)
+				return;
+		}
+		m_chunk++;
+		m_offset = 0;
+	}
+}
@@ -0,0 +1,254 @@
+/**
+* @file  cusdr_iqRecorder.h
+* @brief raw IQ datagram recorder and memory-mapped recording reader
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_IQ_RECORDER_H
+#define CUSDR_IQ_RECORDER_H
+
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include <atomic>
+#include <vector>
+
+#include "cusdr_spscQueue.h"
+
+#ifdef LOG_IQ_RECORDER
+#   define IQ_RECORDER_DEBUG qDebug().nospace() << "IQRecorder::\t"
+#else
+#   define IQ_RECORDER_DEBUG nullDebug()
+#endif
+
+// Recording file layout (host byte order, i.e. little endian on every
+// platform we build for):
+//
+//   header     TIQRecHeader, padded to IQREC_HEADER_SIZE
+//   chunk 0    IQREC_CHUNK_SIZE bytes at IQREC_HEADER_SIZE
+//   chunk 1    ...
+//   index      one TIQRecIndexEntry per chunk, at header.indexOffset
+//
+// A chunk is a run of records, each a TIQRecRecord followed by the datagram
+// as received (protocol header included), padded to 8 bytes. A record with
+// size 0, or the end of the chunk, ends it. Chunk n always starts at
+// IQREC_HEADER_SIZE + n * chunkSize, so a mapped file can be entered at any
+// chunk; the index gives each chunk's first and last time stamp for a seek.
+//
+// The index and final header are written when the recording stops. A file
+// left behind by a crash has indexOffset 0; IQRecording rebuilds the index
+// from the chunks in that case.
+
+#define IQREC_MAGIC				"CUSDRIQ1"
+#define IQREC_VERSION			1
+#define IQREC_HEADER_SIZE		4096
+#define IQREC_CHUNK_SIZE		(4 * 1024 * 1024)
+#define IQREC_CHUNKS			16		// 64 MB: > 3 s of eight 384 kHz DDCs
+#define IQREC_WRITER_POLL_MS	10
+
+typedef struct _iqRecHeader {
+
+	char	magic[8];
+	quint32	version;
+	quint32	headerSize;
+	quint32	chunkSize;
+	quint32	protocol;		// 1 or 2
+	quint32	sampleRate;
+	quint32	receivers;
+	qint64	startTime;		// wall clock at record time 0, us since the epoch
+	quint64	chunks;
+	quint64	records;
+	quint64	droppedRecords;	// no free chunk, or lost to a write error
+	quint64	indexOffset;	// 0: recording did not stop cleanly
+
+} TIQRecHeader;
+
+typedef struct _iqRecRecord {
+
+	qint64	time;			// arrival at DataIO, us since the recording started
+	quint16	port;			// radio source port: 1024 (P1), 1035 + DDC (P2)
+	quint16	size;			// datagram bytes that follow
+	quint32	reserved;
+
+} TIQRecRecord;
+
+typedef struct _iqRecIndexEntry {
+
+	qint64	firstTime;
+	qint64	lastTime;
+	quint32	records;
+	quint32	ports;			// bit n: port - 1024 (P1) or DDC n (P2) present
+
+} TIQRecIndexEntry;
+
+static_assert(sizeof(TIQRecHeader) <= IQREC_HEADER_SIZE, "recording header too large");
+static_assert(sizeof(TIQRecRecord) == 16, "record header must stay 16 bytes");
+static_assert(sizeof(TIQRecIndexEntry) == 24, "index entry must stay 24 bytes");
+
+// Records the radio's IQ datagrams as DataIO receives them. record() runs on
+// the DataIO thread and only copies into a preallocated chunk; full chunks go
+// to a writer thread through a queue. When the writer falls so far behind
+// that no free chunk is left, records are dropped and counted, never waited
+// for.
+
+class IQRecorder {
+
+public:
+	IQRecorder();
+	~IQRecorder();
+
+	IQRecorder(const IQRecorder &) = delete;
+	IQRecorder &operator=(const IQRecorder &) = delete;
+
+	bool	start(const QString &fileName, int protocol, int sampleRate, int receivers, QString *error);
+	void	stop();
+
+	bool	isRecording() const		{ return m_recording.load(std::memory_order_relaxed); }
+	QString	fileName() const		{ return m_fileName; }
+
+	quint64	records() const			{ return m_records.load(std::memory_order_relaxed); }
+	quint64	droppedRecords() const	{ return m_dropped.load(std::memory_order_relaxed); }
+	quint64	bytesWritten() const	{ return m_bytesWritten.load(std::memory_order_relaxed); }
+	QString	errorString() const;
+
+	// DataIO thread only. time is cusdrMonotonicUs() at arrival.
+	void	record(const char *data, int size, quint16 port, qint64 time) {
+
+		if (!m_recording.load(std::memory_order_relaxed)) return;
+
+		// stop() waits for m_producers to drain after clearing m_recording
+		m_producers.fetch_add(1);
+		if (m_recording.load())
+			append(data, size, port, time);
+		m_producers.fetch_sub(1);
+	}
+
+private:
+	typedef struct _chunk {
+
+		char*		data;
+		int			fill;
+		TIQRecIndexEntry	entry;
+
+	} TChunk;
+
+	class Writer : public QThread {
+
+	public:
+		explicit Writer(IQRecorder *recorder) : m_recorder(recorder) {}
+
+	protected:
+		void run() override;
+
+	private:
+		IQRecorder*	m_recorder;
+	};
+
+	void	append(const char *data, int size, quint16 port, qint64 time);
+	bool	takeChunk();
+	void	closeChunk();
+	void	writerLoop();
+	bool	writeChunk(TChunk &chunk);
+	bool	writeHeader();
+	void	freeChunks();
+
+	std::vector<TChunk>		m_chunks;
+	QHSpscQueue<int>		m_freeChunks;	// writer -> DataIO
+	QHSpscQueue<int>		m_fullChunks;	// DataIO -> writer
+	int						m_current;		// chunk being filled, -1: none
+
+	Writer					m_writer;
+	QFile					m_file;
+	QString					m_fileName;
+	QString					m_error;
+	QVector<TIQRecIndexEntry>	m_index;	// writer thread
+
+	TIQRecHeader			m_header;
+	qint64					m_startMono;
+	quint32					m_portBase;
+
+	std::atomic<bool>		m_recording;
+	std::atomic<bool>		m_stopping;
+	std::atomic<int>		m_producers;
+	std::atomic<quint64>	m_records;
+	std::atomic<quint64>	m_dropped;
+	std::atomic<quint64>	m_bytesWritten;
+};
+
+// Read access to a recording through a memory mapping. Records are visited
+// in file order, which is arrival order.
+
+class IQRecording {
+
+public:
+	IQRecording();
+	~IQRecording();
+
+	bool	open(const QString &fileName, QString *error);
+	void	close();
+
+	const TIQRecHeader &header() const	{ return m_header; }
+	int		chunks() const				{ return m_index.count(); }
+	const TIQRecIndexEntry &indexEntry(int chunk) const	{ return m_index.at(chunk); }
+
+	// last record time, us since the recording started
+	qint64	duration() const;
+
+	class Cursor {
+
+	public:
+		Cursor() : m_recording(nullptr), m_chunk(0), m_offset(0) {}
+
+		bool	atEnd() const	{ return m_recording == nullptr || m_chunk >= m_recording->chunks(); }
+
+		const TIQRecRecord	&record() const;
+		const char			*data() const	{ return (const char *) &record() + sizeof(TIQRecRecord); }
+
+		void	next();
+
+	private:
+		friend class IQRecording;
+
+		void	settle();
+
+		const IQRecording*	m_recording;
+		int					m_chunk;
+		qint64				m_offset;	// within the chunk
+	};
+
+	Cursor	begin() const;
+
+	// first record at or after time (us since the recording started)
+	Cursor	seek(qint64 time) const;
+
+private:
+	const uchar	*chunkData(int chunk) const;
+	bool		rebuildIndex();
+
+	QFile						m_file;
+	const uchar*				m_map;
+	qint64						m_size;
+	TIQRecHeader				m_header;
+	QVector<TIQRecIndexEntry>	m_index;
+};
+
+#endif // CUSDR_IQ_RECORDER_H
@@ -0,0 +1,298 @@
+/**
+* @file  cusdr_iqUnpack.cpp
+* @brief IQ and wideband sample unpackers for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_iqUnpack.h"
+
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IQ_UNPACK_X86
+#include <immintrin.h>
+#endif
+
+typedef UnpackIQ24Fn UnpackKernel;
+
+static void unpackScalar(const unsigned char *src, int stride, int count, cpx *dst) {
+
+	for (int i = 0; i < count; i++, src += stride) {
+
+		int iSample = (int)((signed char) src[0]) << 16;
+		iSample    |= (int)src[1] << 8;
+		iSample    |= (int)src[2];
+		int qSample = (int)((signed char) src[3]) << 16;
+		qSample    |= (int)src[4] << 8;
+		qSample    |= (int)src[5];
+
+		dst[i].re = (double)iSample * IQ24_SCALE;
+		dst[i].im = (double)qSample * IQ24_SCALE;
+	}
+}
+
+#ifdef IQ_UNPACK_X86
+
+// Each pair is fetched with one 8-byte load (6 sample bytes plus 2 bytes of
+// whatever follows), two pairs make up a 128-bit lane. The shuffle moves the
+// three big-endian bytes of I and Q into the top of an int32 each, and the
+// arithmetic shift right by 8 sign-extends them:
+//   lane bytes  I_a Q_a I_b Q_b  <-  0..2  3..5  8..10  11..13
+//
+// The 8-byte load of a pair may run 2 bytes into the next pair, so the vector
+// loops always leave the last pair to the scalar tail.
+
+#define IQ_SHUFFLE_MASK	-128, 2, 1, 0, -128, 5, 4, 3, -128, 10, 9, 8, -128, 13, 12, 11
+
+__attribute__((target("ssse3")))
+static void unpackSsse3(const unsigned char *src, int stride, int count, cpx *dst) {
+
+	const __m128i mask = _mm_setr_epi8(IQ_SHUFFLE_MASK);
+	const __m128d scale = _mm_set1_pd(IQ24_SCALE);
+
+	int i = 0;
+	for (; i + 2 < count; i += 2, src += 2 * stride) {
+
+		__m128i v = _mm_unpacklo_epi64(
+						_mm_loadl_epi64((const __m128i *) src),
+						_mm_loadl_epi64((const __m128i *)(src + stride)));
+
+		v = _mm_srai_epi32(_mm_shuffle_epi8(v, mask), 8);
+
+		_mm_storeu_pd(&dst[i].re,     _mm_mul_pd(_mm_cvtepi32_pd(v), scale));
+		_mm_storeu_pd(&dst[i + 1].re, _mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(v, v)), scale));
+	}
+
+	unpackScalar(src, stride, count - i, dst + i);
+}
+
+__attribute__((target("avx2")))
+static void unpackAvx2(const unsigned char *src, int stride, int count, cpx *dst) {
+
+	const __m256i mask = _mm256_setr_epi8(IQ_SHUFFLE_MASK, IQ_SHUFFLE_MASK);
+	const __m256d scale = _mm256_set1_pd(IQ24_SCALE);
+
+	int i = 0;
+	for (; i + 4 < count; i += 4, src += 4 * stride) {
+
+		__m128i lo = _mm_unpacklo_epi64(
+						_mm_loadl_epi64((const __m128i *) src),
+						_mm_loadl_epi64((const __m128i *)(src + stride)));
+		__m128i hi = _mm_unpacklo_epi64(
+						_mm_loadl_epi64((const __m128i *)(src + 2 * stride)),
+						_mm_loadl_epi64((const __m128i *)(src + 3 * stride)));
+
+		__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		v = _mm256_srai_epi32(_mm256_shuffle_epi8(v, mask), 8);
+
+		_mm256_storeu_pd(&dst[i].re,
+			_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), scale));
+		_mm256_storeu_pd(&dst[i + 2].re,
+			_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), scale));
+	}
+
+	unpackScalar(src, stride, count - i, dst + i);
+}
+
+#endif // IQ_UNPACK_X86
+
+static UnpackKernel selectKernel(const char **name) {
+
+#ifdef IQ_UNPACK_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return unpackAvx2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		*name = "ssse3";
+		return unpackSsse3;
+	}
+#endif
+	*name = "scalar";
+	return unpackScalar;
+}
+
+static const char *s_kernelName = nullptr;
+
+static UnpackKernel kernel() {
+
+	static const UnpackKernel k = selectKernel(&s_kernelName);
+	return k;
+}
+
+void unpackIQ24(const unsigned char *src, int stride, int count, cpx *dst) {
+
+	if (count > 0) kernel()(src, stride, count, dst);
+}
+
+const char *unpackIQ24Kernel() {
+
+	kernel();
+	return s_kernelName;
+}
+
+UnpackIQ24Fn unpackIQ24Function() {
+
+	return kernel();
+}
+
+static inline int toIQ24(double value) {
+
+	double scaled = value * 8388607.0;
+	if (scaled > 8388607.0) scaled = 8388607.0;
+	else if (scaled < -8388608.0) scaled = -8388608.0;
+
+	return (int) lrint(scaled);
+}
+
+void packIQ24(const cpx *src, int count, unsigned char *dst) {
+
+	for (int i = 0; i < count; i++, dst += 6) {
+
+		const int iSample = toIQ24(src[i].re);
+		const int qSample = toIQ24(src[i].im);
+
+		dst[0] = (unsigned char)(iSample >> 16);
+		dst[1] = (unsigned char)(iSample >> 8);
+		dst[2] = (unsigned char) iSample;
+		dst[3] = (unsigned char)(qSample >> 16);
+		dst[4] = (unsigned char)(qSample >> 8);
+		dst[5] = (unsigned char) qSample;
+	}
+}
+
+// wideband: 16-bit little-endian real samples
+
+typedef void (*Real16Kernel)(const unsigned char *, int, cpx *);
+
+static void unpackReal16Scalar(const unsigned char *src, int count, cpx *dst) {
+
+	for (int i = 0; i < count; i++, src += 2) {
+
+		const qint16 sample = (qint16)(src[0] | (src[1] << 8));
+
+		dst[i].re = (double)sample * REAL16_SCALE;
+		dst[i].im = 0.0;
+	}
+}
+
+#ifdef IQ_UNPACK_X86
+
+// Eight samples per iteration. The int16s are widened to int32 (unpacked
+// against themselves and shifted back down, which sign-extends them),
+// converted to double and interleaved with zeros for the imaginary parts.
+
+__attribute__((target("sse2")))
+static void unpackReal16Sse2(const unsigned char *src, int count, cpx *dst) {
+
+	const __m128d scale = _mm_set1_pd(REAL16_SCALE);
+	const __m128d zero = _mm_setzero_pd();
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8, src += 16) {
+
+		const __m128i v = _mm_loadu_si128((const __m128i *) src);
+		const __m128i w[2] = {
+			_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16),
+			_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)
+		};
+
+		for (int k = 0; k < 2; k++) {
+
+			const __m128d lo = _mm_mul_pd(_mm_cvtepi32_pd(w[k]), scale);
+			const __m128d hi = _mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(w[k], w[k])), scale);
+
+			cpx *d = dst + i + 4 * k;
+			_mm_storeu_pd(&d[0].re, _mm_unpacklo_pd(lo, zero));
+			_mm_storeu_pd(&d[1].re, _mm_unpackhi_pd(lo, zero));
+			_mm_storeu_pd(&d[2].re, _mm_unpacklo_pd(hi, zero));
+			_mm_storeu_pd(&d[3].re, _mm_unpackhi_pd(hi, zero));
+		}
+	}
+
+	unpackReal16Scalar(src, count - i, dst + i);
+}
+
+__attribute__((target("avx2")))
+static void unpackReal16Avx2(const unsigned char *src, int count, cpx *dst) {
+
+	const __m256d scale = _mm256_set1_pd(REAL16_SCALE);
+	const __m256d zero = _mm256_setzero_pd();
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8, src += 16) {
+
+		const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) src));
+
+		for (int k = 0; k < 2; k++) {
+
+			// s0 s1 s2 s3 -> (s0 0 s2 0) (s1 0 s3 0) -> (s0 0 s1 0) (s2 0 s3 0)
+			const __m256d s = _mm256_mul_pd(_mm256_cvtepi32_pd(
+								k ? _mm256_extracti128_si256(v, 1) : _mm256_castsi256_si128(v)), scale);
+			const __m256d even = _mm256_unpacklo_pd(s, zero);
+			const __m256d odd = _mm256_unpackhi_pd(s, zero);
+
+			cpx *d = dst + i + 4 * k;
+			_mm256_storeu_pd(&d[0].re, _mm256_permute2f128_pd(even, odd, 0x20));
+			_mm256_storeu_pd(&d[2].re, _mm256_permute2f128_pd(even, odd, 0x31));
+		}
+	}
+
+	unpackReal16Scalar(src, count - i, dst + i);
+}
+
+#endif // IQ_UNPACK_X86
+
+static Real16Kernel selectReal16Kernel(const char **name) {
+
+#ifdef IQ_UNPACK_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return unpackReal16Avx2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		*name = "sse2";
+		return unpackReal16Sse2;
+	}
+#endif
+	*name = "scalar";
+	return unpackReal16Scalar;
+}
+
+static const char *s_real16KernelName = nullptr;
+
+static Real16Kernel real16Kernel() {
+
+	static const Real16Kernel k = selectReal16Kernel(&s_real16KernelName);
+	return k;
+}
+
+void unpackReal16(const unsigned char *src, int count, cpx *dst) {
+
+	if (count > 0) real16Kernel()(src, count, dst);
+}
+
+const char *unpackReal16Kernel() {
+
+	real16Kernel();
+	return s_real16KernelName;
+}
@@ -0,0 +1,74 @@
+/**
+* @file  cusdr_iqUnpack.h
+* @brief IQ and wideband sample unpackers for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_IQ_UNPACK_H
+#define CUSDR_IQ_UNPACK_H
+
+#include "QtDSP/qtdsp_qComplex.h"
+
+// full scale of a signed 24-bit sample
+#define IQ24_SCALE	(1.0 / 8388607.0)
+
+// Converts 'count' I/Q pairs of 24-bit big-endian two's complement samples
+// (I2 I1 I0 Q2 Q1 Q0) into normalized cpx values.
+//
+// 'stride' is the distance in bytes between the start of consecutive pairs:
+// 6 for a Protocol 2 DDC payload, 6 * receivers + 2 for the interleaved
+// Protocol 1 frame (pass the address of receiver r's first pair to pick out
+// that receiver). The source is never read beyond the last pair.
+//
+// The SSSE3 / AVX2 kernel is chosen on the first call from what the CPU
+// supports; other targets use the scalar loop.
+
+void unpackIQ24(const unsigned char *src, int stride, int count, cpx *dst);
+
+// name of the kernel unpackIQ24() dispatches to ("avx2", "ssse3", "scalar")
+const char *unpackIQ24Kernel();
+
+// The kernel unpackIQ24() dispatches to, for decoders that unpack several
+// runs per frame: fetch it once and call it directly. Like unpackIQ24(), it
+// writes nothing for count <= 0.
+
+typedef void (*UnpackIQ24Fn)(const unsigned char *src, int stride, int count, cpx *dst);
+
+UnpackIQ24Fn unpackIQ24Function();
+
+// The reverse, for the TX path: 'count' normalized cpx values to contiguous
+// 24-bit big-endian I/Q pairs (6 bytes each), rounded and clipped to full
+// scale.
+
+void packIQ24(const cpx *src, int count, unsigned char *dst);
+
+// full scale of a signed 16-bit wideband ADC sample
+#define REAL16_SCALE	(1.0 / 32767.0)
+
+// Converts 'count' 16-bit little-endian real ADC samples (the wideband EP4
+// stream) into normalized cpx values with a zero imaginary part, for an
+// analyzer fed real input. Same kernel choice as unpackIQ24().
+
+void unpackReal16(const unsigned char *src, int count, cpx *dst);
+
+// name of the kernel unpackReal16() dispatches to ("avx2", "sse2", "scalar")
+const char *unpackReal16Kernel();
+
+#endif // CUSDR_IQ_UNPACK_H
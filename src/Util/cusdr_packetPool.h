@@ -0,0 +1,220 @@
+/**
+* @file  cusdr_packetPool.h
+* @brief preallocated, reference counted datagram buffers for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_PACKET_POOL_H
+#define CUSDR_PACKET_POOL_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+// 1444-byte P2 DDC packets are the largest datagrams we receive; round the
+// slot up to a whole number of cache lines.
+#define PACKET_POOL_SLOT_SIZE	1536
+#define PACKET_POOL_SLOTS		4096
+
+class CPacketPool;
+
+// Handle to one slot of a CPacketPool. Copying the handle adds a reference,
+// destroying it drops one; the slot returns to the pool when the last handle
+// is gone. Handles may be released from any thread.
+
+class CPacketBuffer {
+
+public:
+	CPacketBuffer() : m_pool(nullptr), m_slot(-1), m_size(0) {}
+	inline CPacketBuffer(const CPacketBuffer &other);
+	CPacketBuffer(CPacketBuffer &&other) noexcept
+		: m_pool(other.m_pool)
+		, m_slot(other.m_slot)
+		, m_size(other.m_size)
+	{
+		other.m_pool = nullptr;
+		other.m_slot = -1;
+		other.m_size = 0;
+	}
+	~CPacketBuffer() { reset(); }
+
+	inline CPacketBuffer &operator=(const CPacketBuffer &other);
+	CPacketBuffer &operator=(CPacketBuffer &&other) noexcept {
+
+		if (this != &other) {
+			reset();
+			m_pool = other.m_pool;
+			m_slot = other.m_slot;
+			m_size = other.m_size;
+			other.m_pool = nullptr;
+			other.m_slot = -1;
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+	bool	isNull() const		{ return m_pool == nullptr; }
+	int		size() const		{ return m_size; }
+	void	setSize(int size)	{ m_size = size; }
+	inline int		capacity() const;
+	inline char*	data();
+	inline const char*	constData() const;
+
+	// non-owning view of [offset, offset + length); valid while this
+	// handle (or a copy of it) is alive.
+	QByteArray view(int offset, int length) const {
+
+		return QByteArray::fromRawData(constData() + offset, length);
+	}
+
+	inline void reset();
+
+private:
+	friend class CPacketPool;
+	CPacketBuffer(CPacketPool *pool, int slot)
+		: m_pool(pool)
+		, m_slot(slot)
+		, m_size(0)
+	{}
+
+	CPacketPool*	m_pool;
+	int				m_slot;
+	int				m_size;
+};
+
+
+// Fixed slab of equally sized datagram buffers. acquire() must only be called
+// from one thread (the DataIO thread); references are dropped lock-free from
+// whichever thread last holds the buffer. The whole slab is allocated and
+// touched up front so steady-state receive neither allocates nor page-faults.
+
+class CPacketPool {
+
+public:
+	CPacketPool(int slots = PACKET_POOL_SLOTS, int slotSize = PACKET_POOL_SLOT_SIZE)
+		: m_slots(slots)
+		, m_slotSize(slotSize)
+		, m_refs(new std::atomic<int>[slots])
+		, m_cursor(0)
+		, m_exhausted(0)
+	{
+		m_memory = static_cast<char *>(qMallocAligned((size_t) m_slots * m_slotSize, 64));
+		memset(m_memory, 0, (size_t) m_slots * m_slotSize);
+		for (int i = 0; i < m_slots; i++)
+			m_refs[i].store(0, std::memory_order_relaxed);
+	}
+
+	~CPacketPool() {
+
+		qFreeAligned(m_memory);
+	}
+
+	CPacketPool(const CPacketPool &) = delete;
+	CPacketPool &operator=(const CPacketPool &) = delete;
+
+	// Returns a null buffer if every slot is still referenced downstream.
+	CPacketBuffer acquire() {
+
+		for (int n = 0; n < m_slots; n++) {
+
+			int slot = m_cursor;
+			if (++m_cursor == m_slots) m_cursor = 0;
+
+			// pairs with the release decrement in unref(), so the previous
+			// owner's reads of the slot happen before we overwrite it.
+			if (m_refs[slot].load(std::memory_order_acquire) == 0) {
+
+				m_refs[slot].store(1, std::memory_order_relaxed);
+				return CPacketBuffer(this, slot);
+			}
+		}
+
+		m_exhausted.fetch_add(1, std::memory_order_relaxed);
+		return CPacketBuffer();
+	}
+
+	int		slotSize() const		{ return m_slotSize; }
+	int		slotCount() const		{ return m_slots; }
+	quint64	exhaustedCount() const	{ return m_exhausted.load(std::memory_order_relaxed); }
+
+private:
+	friend class CPacketBuffer;
+
+	char *slotData(int slot) const	{ return m_memory + (size_t) slot * m_slotSize; }
+	void ref(int slot)		{ m_refs[slot].fetch_add(1, std::memory_order_relaxed); }
+	void unref(int slot)	{ m_refs[slot].fetch_sub(1, std::memory_order_acq_rel); }
+
+	const int	m_slots;
+	const int	m_slotSize;
+	char*		m_memory;
+
+	std::unique_ptr<std::atomic<int>[]>	m_refs;
+	int						m_cursor;
+	std::atomic<quint64>	m_exhausted;
+};
+
+
+inline CPacketBuffer::CPacketBuffer(const CPacketBuffer &other)
+	: m_pool(other.m_pool)
+	, m_slot(other.m_slot)
+	, m_size(other.m_size)
+{
+	if (m_pool) m_pool->ref(m_slot);
+}
+
+inline CPacketBuffer &CPacketBuffer::operator=(const CPacketBuffer &other) {
+
+	if (this != &other) {
+		if (other.m_pool) other.m_pool->ref(other.m_slot);
+		reset();
+		m_pool = other.m_pool;
+		m_slot = other.m_slot;
+		m_size = other.m_size;
+	}
+	return *this;
+}
+
+inline int CPacketBuffer::capacity() const {
+
+	return m_pool ? m_pool->slotSize() : 0;
+}
+
+inline char *CPacketBuffer::data() {
+
+	return m_pool ? m_pool->slotData(m_slot) : nullptr;
+}
+
+inline const char *CPacketBuffer::constData() const {
+
+	return m_pool ? m_pool->slotData(m_slot) : nullptr;
+}
+
+inline void CPacketBuffer::reset() {
+
+	if (m_pool) m_pool->unref(m_slot);
+	m_pool = nullptr;
+	m_slot = -1;
+	m_size = 0;
+}
+
+#endif // CUSDR_PACKET_POOL_H
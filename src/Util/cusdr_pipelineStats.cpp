@@ -0,0 +1,246 @@
+/**
+* @file  cusdr_pipelineStats.cpp
+* @brief receive pipeline latency instrumentation for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_pipelineStats.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <QtAlgorithms>
+
+void CThreadCpuClock::attach() {
+
+#if defined(Q_OS_LINUX)
+	if (pthread_getcpuclockid(pthread_self(), &m_clock) == 0)
+		m_attached.store(true, std::memory_order_release);
+#endif
+}
+
+qint64 CThreadCpuClock::cpuUs() const {
+
+#if defined(Q_OS_LINUX)
+	timespec ts;
+	if (m_attached.load(std::memory_order_acquire) && clock_gettime(m_clock, &ts) == 0)
+		return (qint64) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+	return 0;
+}
+
+// ************************************************************************
+
+CLatencyHistogram::CLatencyHistogram()
+	: m_max(0)
+{
+	for (int i = 0; i < BINS; i++)
+		m_bins[i].store(0, std::memory_order_relaxed);
+}
+
+// values below 4 us get a bin each; above that the bin is the exponent plus
+// the two bits below the leading one.
+int CLatencyHistogram::binOf(qint64 us) {
+
+	if (us < 4) return us < 0 ? 0 : (int) us;
+
+	const int exponent = 63 - qCountLeadingZeroBits((quint64) us);
+	const int mantissa = (int)((us >> (exponent - 2)) & 3);
+	return qMin(4 + (exponent - 2) * 4 + mantissa, BINS - 1);
+}
+
+qint64 CLatencyHistogram::binUpperBound(int bin) {
+
+	if (bin < 4) return bin;
+
+	const int exponent = (bin - 4) / 4 + 2;
+	const qint64 lower = (qint64)(4 + (bin - 4) % 4) << (exponent - 2);
+	return lower + ((qint64) 1 << (exponent - 2)) - 1;
+}
+
+void CLatencyHistogram::record(qint64 us) {
+
+	m_bins[binOf(us)].fetch_add(1, std::memory_order_relaxed);
+
+	qint64 max = m_max.load(std::memory_order_relaxed);
+	while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+}
+
+void CLatencyHistogram::reset() {
+
+	for (int i = 0; i < BINS; i++)
+		m_bins[i].store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+quint64 CLatencyHistogram::count() const {
+
+	quint64 total = 0;
+	for (int i = 0; i < BINS; i++)
+		total += m_bins[i].load(std::memory_order_relaxed);
+	return total;
+}
+
+qint64 CLatencyHistogram::percentile(double p) const {
+
+	quint64 bins[BINS];
+	quint64 total = 0;
+	for (int i = 0; i < BINS; i++) {
+
+		bins[i] = m_bins[i].load(std::memory_order_relaxed);
+		total += bins[i];
+	}
+	if (total == 0) return 0;
+
+	const quint64 rank = qMax((quint64) 1, (quint64)(p * (double) total + 0.5));
+	quint64 seen = 0;
+	for (int i = 0; i < BINS; i++) {
+
+		seen += bins[i];
+		if (seen >= rank)
+			return qMin(binUpperBound(i), max());
+	}
+	return max();
+}
+
+// ************************************************************************
+
+CPipelineStats *CPipelineStats::instance() {
+
+	static CPipelineStats stats;
+	return &stats;
+}
+
+CPipelineStats::CPipelineStats() {
+
+	for (int i = 0; i < GaugeCount; i++) {
+
+		m_depth[i].store(0, std::memory_order_relaxed);
+		m_maxDepth[i].store(0, std::memory_order_relaxed);
+	}
+
+	for (int i = 0; i < CounterCount; i++)
+		m_counters[i].store(0, std::memory_order_relaxed);
+}
+
+void CPipelineStats::setQueueDepth(int gauge, int depth) {
+
+	if (gauge < 0 || gauge >= GaugeCount) return;
+
+	m_depth[gauge].store(depth, std::memory_order_relaxed);
+
+	int max = m_maxDepth[gauge].load(std::memory_order_relaxed);
+	while (depth > max && !m_maxDepth[gauge].compare_exchange_weak(max, depth, std::memory_order_relaxed)) {}
+}
+
+void CPipelineStats::reset() {
+
+	for (int i = 0; i < StageCount; i++)
+		m_stages[i].reset();
+
+	for (int i = 0; i < GaugeCount; i++)
+		m_maxDepth[i].store(m_depth[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+	for (int i = 0; i < CounterCount; i++)
+		m_counters[i].store(0, std::memory_order_relaxed);
+}
+
+const char *CPipelineStats::stageName(Stage stage) {
+
+	switch (stage) {
+
+		case NetworkToDecoded:	return "network -> decoded";
+		case DecodedToDspStart:	return "decoded -> DSP start";
+		case ProcessDSP:		return "processDSP";
+		case DspEndToAudio:		return "DSP end -> audio";
+		case NetworkToAudio:	return "network -> audio";
+		case TxTimer:			return "tx timer jitter";
+		default:				return "";
+	}
+}
+
+QString CPipelineStats::report() const {
+
+	QStringList lines;
+	for (int i = 0; i < StageCount; i++) {
+
+		const CLatencyHistogram &h = m_stages[i];
+		if (i == TxTimer && h.count() == 0) continue;
+
+		lines << QString("%1: p50 %2 us  p99 %3 us  max %4 us  (n=%5)")
+					.arg(QString(stageName((Stage) i)), -22)
+					.arg(h.percentile(0.50))
+					.arg(h.percentile(0.99))
+					.arg(h.max())
+					.arg(h.count());
+	}
+
+	lines << QString("%1: %2 (max %3)")
+				.arg(QString("IQ packet queue"), -22)
+				.arg(m_depth[IQPacketQueue].load(std::memory_order_relaxed))
+				.arg(m_maxDepth[IQPacketQueue].load(std::memory_order_relaxed));
+
+	for (int rx = 0; rx < GaugeCount - ReceiverRing0; rx++) {
+
+		const int max = m_maxDepth[ReceiverRing0 + rx].load(std::memory_order_relaxed);
+		if (max == 0) continue;
+
+		lines << QString("%1: %2 (max %3)")
+					.arg(QString("rx %1 IQ ring").arg(rx), -22)
+					.arg(m_depth[ReceiverRing0 + rx].load(std::memory_order_relaxed))
+					.arg(max);
+	}
+
+	// only once something was transmitted
+	if (counter(TxFramesSent) || counter(TxOverruns)) {
+
+		lines << QString("%1: %2 frames in %3 syscalls, %4 late")
+					.arg(QString("tx frames"), -22)
+					.arg(counter(TxFramesSent))
+					.arg(counter(TxSyscalls))
+					.arg(counter(TxLate));
+
+		lines << QString("%1: %2 underruns, %3 overruns")
+					.arg(QString("tx queue"), -22)
+					.arg(counter(TxUnderruns))
+					.arg(counter(TxOverruns));
+	}
+
+	if (counter(DucPackets)) {
+
+		lines << QString("%1: %2 packets, %3 underruns, %4 overruns")
+					.arg(QString("duc packets"), -22)
+					.arg(counter(DucPackets))
+					.arg(counter(DucUnderruns))
+					.arg(counter(DucOverruns));
+
+		lines << QString("%1: %2 (max %3)")
+					.arg(QString("duc ring"), -22)
+					.arg(m_depth[DucRing].load(std::memory_order_relaxed))
+					.arg(m_maxDepth[DucRing].load(std::memory_order_relaxed));
+	}
+	return lines.join('\n');
+}
+
+void CPipelineStats::dump() const {
+
+	const QStringList lines = report().split('\n');
+	for (const QString &line : lines)
+		qDebug().noquote() << "PipelineStats::\t" << line;
+}
@@ -0,0 +1,158 @@
+/**
+* @file  cusdr_pipelineStats.h
+* @brief receive pipeline latency instrumentation for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_PIPELINE_STATS_H
+#define CUSDR_PIPELINE_STATS_H
+
+#include <QtGlobal>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#include "cusdr_settings.h"
+
+// monotonic clock shared by all pipeline timestamps, in microseconds
+inline qint64 cusdrMonotonicUs() {
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// CPU time used by one thread. attach() is called on the thread to be
+// measured, cpuUs() can then be read from any thread while it is alive.
+// Linux only; elsewhere cpuUs() reads 0.
+
+class CThreadCpuClock {
+
+public:
+	CThreadCpuClock() : m_attached(false) {}
+
+	void	attach();
+	qint64	cpuUs() const;
+
+private:
+#if defined(Q_OS_LINUX)
+	clockid_t			m_clock;
+#endif
+	std::atomic<bool>	m_attached;
+};
+
+// Lock-free latency histogram. Values are binned log-linear, four bins per
+// power of two, so a percentile is reported to within 25 % of its value.
+// record() may be called from any number of threads.
+
+class CLatencyHistogram {
+
+public:
+	CLatencyHistogram();
+
+	void	record(qint64 us);
+	void	reset();
+
+	quint64	count() const;
+	qint64	max() const		{ return m_max.load(std::memory_order_relaxed); }
+	qint64	percentile(double p) const;
+
+private:
+	static const int BINS = 160;
+
+	static int		binOf(qint64 us);
+	static qint64	binUpperBound(int bin);
+
+	std::atomic<quint64>	m_bins[BINS];
+	std::atomic<qint64>		m_max;
+};
+
+// Always-on timing of the receive path. Each IQ block carries the time its
+// last datagram arrived at DataIO, the time the decoder handed it over, and
+// the receiver adds the DSP and audio timestamps, so every stage below is
+// measured for every block. The TX sender adds its timer error and
+// counters, so both directions show up in one report.
+
+class CPipelineStats {
+
+public:
+	enum Stage {
+
+		NetworkToDecoded,	// datagram received -> block handed to the DSP
+		DecodedToDspStart,	// waiting in the receiver's IQ ring
+		ProcessDSP,			// WDSP fexchange + spectrum
+		DspEndToAudio,		// display, meter and audio write
+		NetworkToAudio,		// end to end
+		TxTimer,			// TX sender timer wake-up error
+		StageCount
+	};
+
+	enum Counter {
+
+		TxFramesSent,		// TX datagrams sent
+		TxSyscalls,			// sendmmsg() / sendmsg() calls
+		TxLate,				// frames sent more than half a period late
+		TxUnderruns,		// the TX timer found nothing to send
+		TxOverruns,			// the TX pool was full, frame dropped
+		DucPackets,			// P2 DUC packets made, silence included
+		DucUnderruns,		// DUC packets padded with silence mid transmission
+		DucOverruns,		// TX IQ dropped from a full DUC ring
+		CounterCount
+	};
+
+	enum Gauge {
+
+		IQPacketQueue,		// DataIO -> DataProcessor datagram queue
+		DucRing,			// TX IQ samples waiting for a DUC packet
+		ReceiverRing0,		// ReceiverRing0 + rx: decoder -> DSP block ring
+		GaugeCount = ReceiverRing0 + MAX_RECEIVERS
+	};
+
+	static CPipelineStats *instance();
+
+	void	record(Stage stage, qint64 us)	{ m_stages[stage].record(us); }
+	void	setQueueDepth(int gauge, int depth);
+	void	add(Counter counter, quint64 n = 1)	{ m_counters[counter].fetch_add(n, std::memory_order_relaxed); }
+	void	reset();
+
+	const CLatencyHistogram &stage(Stage stage) const	{ return m_stages[stage]; }
+	quint64	counter(Counter counter) const	{ return m_counters[counter].load(std::memory_order_relaxed); }
+
+	// one line per stage and gauge, for the log or the network widget
+	QString	report() const;
+	void	dump() const;
+
+private:
+	CPipelineStats();
+
+	static const char *stageName(Stage stage);
+
+	CLatencyHistogram	m_stages[StageCount];
+	std::atomic<int>	m_depth[GaugeCount];
+	std::atomic<int>	m_maxDepth[GaugeCount];
+	std::atomic<quint64>	m_counters[CounterCount];
+};
+
+#endif // CUSDR_PIPELINE_STATS_H
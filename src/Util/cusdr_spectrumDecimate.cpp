@@ -0,0 +1,262 @@
+/**
+* @file  cusdr_spectrumDecimate.cpp
+* @brief spectrum bin to display pixel reduction for the panadapters
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "cusdr_spectrumDecimate.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DECIMATE_X86
+#include <immintrin.h>
+#endif
+
+// what a kernel instance computes
+#define DECIMATE_MIN	1
+#define DECIMATE_MAX	2
+#define DECIMATE_MEAN	4
+
+// widest pixel the AVX2 kernel reduces eight at a time with gathers; wider
+// pixels are reduced one by one across their bins
+#define DECIMATE_GATHER_SPAN	8
+
+typedef void (*DecimateKernel)(const float *, int, int, float *, float *, float *);
+
+typedef struct _decimateKernels {
+
+	DecimateKernel	peak;
+	DecimateKernel	average;
+	DecimateKernel	minMax;
+
+} TDecimateKernels;
+
+// first bin and bin count of pixel i
+static inline void pixelSpan(int i, int span, int count, int *first, int *n) {
+
+	const int lo = (int)((long long) i * span / count);
+	const int hi = (int)((long long)(i + 1) * span / count);
+
+	*first = lo;
+	*n = hi > lo ? hi - lo : 1;
+}
+
+template<int Outputs>
+static inline void reduceScalar(const float *p, int n, float *mn, float *mx, float *mean, int i) {
+
+	float a = p[0];
+	float b = p[0];
+	float s = p[0];
+	for (int j = 1; j < n; j++) {
+
+		if (Outputs & DECIMATE_MIN)		a = p[j] < a ? p[j] : a;
+		if (Outputs & DECIMATE_MAX)		b = p[j] > b ? p[j] : b;
+		if (Outputs & DECIMATE_MEAN)	s += p[j];
+	}
+
+	if (Outputs & DECIMATE_MIN)		mn[i] = a;
+	if (Outputs & DECIMATE_MAX)		mx[i] = b;
+	if (Outputs & DECIMATE_MEAN)	mean[i] = s / n;
+}
+
+template<int Outputs>
+static void decimatePixels(const float *src, int span, int count, int from, float *mn, float *mx, float *mean) {
+
+	for (int i = from; i < count; i++) {
+
+		int first, n;
+		pixelSpan(i, span, count, &first, &n);
+		reduceScalar<Outputs>(src + first, n, mn, mx, mean, i);
+	}
+}
+
+template<int Outputs>
+static void decimateScalar(const float *src, int span, int count, float *mn, float *mx, float *mean) {
+
+	decimatePixels<Outputs>(src, span, count, 0, mn, mx, mean);
+}
+
+#ifdef DECIMATE_X86
+
+__attribute__((target("avx2")))
+static inline float horizontalMin(__m256 v) {
+
+	__m128 x = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	x = _mm_min_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_min_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+__attribute__((target("avx2")))
+static inline float horizontalMax(__m256 v) {
+
+	__m128 x = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	x = _mm_max_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_max_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+__attribute__((target("avx2")))
+static inline float horizontalSum(__m256 v) {
+
+	__m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+// a pixel wider than DECIMATE_GATHER_SPAN, eight bins per step
+template<int Outputs>
+__attribute__((target("avx2")))
+static inline void reduceWide(const float *p, int n, float *mn, float *mx, float *mean, int i) {
+
+	__m256 vMin = _mm256_loadu_ps(p);
+	__m256 vMax = vMin;
+	__m256 vSum = vMin;
+
+	int j = 8;
+	for (; j + 8 <= n; j += 8) {
+
+		const __m256 v = _mm256_loadu_ps(p + j);
+		if (Outputs & DECIMATE_MIN)		vMin = _mm256_min_ps(vMin, v);
+		if (Outputs & DECIMATE_MAX)		vMax = _mm256_max_ps(vMax, v);
+		if (Outputs & DECIMATE_MEAN)	vSum = _mm256_add_ps(vSum, v);
+	}
+
+	float a = horizontalMin(vMin);
+	float b = horizontalMax(vMax);
+	float s = horizontalSum(vSum);
+	for (; j < n; j++) {
+
+		if (Outputs & DECIMATE_MIN)		a = p[j] < a ? p[j] : a;
+		if (Outputs & DECIMATE_MAX)		b = p[j] > b ? p[j] : b;
+		if (Outputs & DECIMATE_MEAN)	s += p[j];
+	}
+
+	if (Outputs & DECIMATE_MIN)		mn[i] = a;
+	if (Outputs & DECIMATE_MAX)		mx[i] = b;
+	if (Outputs & DECIMATE_MEAN)	mean[i] = s / n;
+}
+
+// Eight pixels per step. While they are all narrow, bin j of each pixel is
+// fetched with one gather; a pixel with fewer bins re-reads its last bin,
+// which leaves min and max alone and is masked out of the sum.
+template<int Outputs>
+__attribute__((target("avx2")))
+static void decimateAvx2(const float *src, int span, int count, float *mn, float *mx, float *mean) {
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+
+		alignas(32) int first[8];
+		alignas(32) int n[8];
+		int widest = 0;
+		for (int k = 0; k < 8; k++) {
+
+			pixelSpan(i + k, span, count, &first[k], &n[k]);
+			widest = n[k] > widest ? n[k] : widest;
+		}
+
+		if (widest > DECIMATE_GATHER_SPAN) {
+
+			for (int k = 0; k < 8; k++)
+				reduceWide<Outputs>(src + first[k], n[k], mn, mx, mean, i + k);
+			continue;
+		}
+
+		const __m256i vFirst = _mm256_load_si256((const __m256i *) first);
+		const __m256i vN = _mm256_load_si256((const __m256i *) n);
+		const __m256i vLast = _mm256_add_epi32(vFirst, _mm256_sub_epi32(vN, _mm256_set1_epi32(1)));
+
+		__m256 v = _mm256_i32gather_ps(src, vFirst, 4);
+		__m256 vMin = v;
+		__m256 vMax = v;
+		__m256 vSum = v;
+
+		for (int j = 1; j < widest; j++) {
+
+			const __m256i vJ = _mm256_set1_epi32(j);
+			v = _mm256_i32gather_ps(src, _mm256_min_epi32(_mm256_add_epi32(vFirst, vJ), vLast), 4);
+
+			if (Outputs & DECIMATE_MIN)		vMin = _mm256_min_ps(vMin, v);
+			if (Outputs & DECIMATE_MAX)		vMax = _mm256_max_ps(vMax, v);
+			if (Outputs & DECIMATE_MEAN)
+				vSum = _mm256_add_ps(vSum, _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_cmpgt_epi32(vN, vJ))));
+		}
+
+		if (Outputs & DECIMATE_MIN)		_mm256_storeu_ps(mn + i, vMin);
+		if (Outputs & DECIMATE_MAX)		_mm256_storeu_ps(mx + i, vMax);
+		if (Outputs & DECIMATE_MEAN)	_mm256_storeu_ps(mean + i, _mm256_div_ps(vSum, _mm256_cvtepi32_ps(vN)));
+	}
+
+	decimatePixels<Outputs>(src, span, count, i, mn, mx, mean);
+}
+
+#endif // DECIMATE_X86
+
+static TDecimateKernels selectKernels(const char **name) {
+
+	TDecimateKernels k;
+
+#ifdef DECIMATE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+
+		k.peak		= decimateAvx2<DECIMATE_MAX>;
+		k.average	= decimateAvx2<DECIMATE_MEAN>;
+		k.minMax	= decimateAvx2<DECIMATE_MIN | DECIMATE_MAX>;
+		*name = "avx2";
+		return k;
+	}
+#endif
+	k.peak		= decimateScalar<DECIMATE_MAX>;
+	k.average	= decimateScalar<DECIMATE_MEAN>;
+	k.minMax	= decimateScalar<DECIMATE_MIN | DECIMATE_MAX>;
+	*name = "scalar";
+	return k;
+}
+
+static const char *s_kernelName = nullptr;
+
+static const TDecimateKernels &kernels() {
+
+	static const TDecimateKernels k = selectKernels(&s_kernelName);
+	return k;
+}
+
+void decimatePeak(const float *src, int span, float *dst, int count) {
+
+	if (span > 0 && count > 0) kernels().peak(src, span, count, nullptr, dst, nullptr);
+}
+
+void decimateAverage(const float *src, int span, float *dst, int count) {
+
+	if (span > 0 && count > 0) kernels().average(src, span, count, nullptr, nullptr, dst);
+}
+
+void decimateMinMax(const float *src, int span, float *dstMin, float *dstMax, int count) {
+
+	if (span > 0 && count > 0) kernels().minMax(src, span, count, dstMin, dstMax, nullptr);
+}
+
+const char *decimateKernel() {
+
+	kernels();
+	return s_kernelName;
+}
@@ -0,0 +1,49 @@
+/**
+* @file  cusdr_spectrumDecimate.h
+* @brief spectrum bin to display pixel reduction for the panadapters
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_SPECTRUM_DECIMATE_H
+#define CUSDR_SPECTRUM_DECIMATE_H
+
+// Reduce 'span' spectrum bins starting at 'src' onto 'count' display pixels.
+// Pixel i covers the bins [i * span / count, (i + 1) * span / count), both
+// rounded down and at least one bin wide, so every bin belongs to exactly one
+// pixel when span >= count, and bins repeat over neighbouring pixels when
+// span < count. Only src[0 .. span - 1] is read; the results go to
+// caller-owned arrays of 'count' floats, nothing is allocated.
+//
+// The AVX2 kernel is chosen on the first call if the CPU has it; other
+// targets use the scalar loop.
+
+// highest bin of each pixel, the usual panadapter trace
+void decimatePeak(const float *src, int span, float *dst, int count);
+
+// mean of each pixel's bins
+void decimateAverage(const float *src, int span, float *dst, int count);
+
+// lowest and highest bin of each pixel, for an envelope display
+void decimateMinMax(const float *src, int span, float *dstMin, float *dstMax, int count);
+
+// name of the kernel the decimators dispatch to ("avx2", "scalar")
+const char *decimateKernel();
+
+#endif // CUSDR_SPECTRUM_DECIMATE_H
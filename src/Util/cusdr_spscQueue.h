@@ -0,0 +1,536 @@
+/**
+* @file  cusdr_spscQueue.h
+* @brief lock-free single producer / single consumer queue for cuSDR
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CUSDR_SPSC_QUEUE_H
+#define CUSDR_SPSC_QUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define CUSDR_CPU_RELAX()	_mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CUSDR_CPU_RELAX()	__asm__ __volatile__("yield")
+#else
+#define CUSDR_CPU_RELAX()	do {} while (0)
+#endif
+
+#define CUSDR_CACHE_LINE_SIZE	64
+
+inline uint32_t cusdrRoundUpPow2(uint32_t v) {
+
+	uint32_t p = 1;
+	while (p < v) p <<= 1;
+	return p;
+}
+
+// Bounded ring buffer with the same interface as QHQueue, for queues that
+// have exactly one producer thread and one consumer thread (DataIO ->
+// DataProcessor, DataProcessor -> Receiver DSP thread).
+//
+// The fast path is two relaxed/acquire loads and one release store; no mutex
+// is taken. Each side caches the other side's index on its own cache line, so
+// the shared line is only pulled over when the cached value says the ring
+// looks full (producer) or empty (consumer).
+//
+// enqueue()/dequeue()/head() block: they spin briefly, then sleep on a wait
+// condition. The other side only touches the mutex when a waiter is present.
+//
+// Flushing the queue from a third thread (e.g. DataEngine::stop()) is only
+// valid once the producer and consumer threads are quiescent.
+
+template<class T> class QHSpscQueue {
+
+public:
+	QHSpscQueue(int maxSize = 8192)
+		: m_maxSize(maxSize > 0 ? (uint32_t) maxSize : 1)
+		, m_mask(cusdrRoundUpPow2(m_maxSize) - 1)
+		, m_slots(m_mask + 1)
+		, m_head(0)
+		, m_tailCache(0)
+		, m_tail(0)
+		, m_headCache(0)
+		, m_waiters(0)
+	{
+	}
+
+	QHSpscQueue(const QHSpscQueue &) = delete;
+	QHSpscQueue &operator=(const QHSpscQueue &) = delete;
+
+	// producer side
+
+	bool tryEnqueue(const T &value) {
+
+		const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		if (!producerHasRoom(tail))
+			return false;
+
+		m_slots[tail & m_mask] = value;
+		publishTail(tail + 1);
+		return true;
+	}
+
+	bool tryEnqueue(T &&value) {
+
+		const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		if (!producerHasRoom(tail))
+			return false;
+
+		m_slots[tail & m_mask] = std::move(value);
+		publishTail(tail + 1);
+		return true;
+	}
+
+	void enqueue(const T &value) {
+
+		if (tryEnqueue(value)) return;
+
+		waitUntil([this] { return !isFull(); });
+		tryEnqueue(value);
+	}
+
+	void enqueue(T &&value) {
+
+		if (tryEnqueue(std::move(value))) return;
+
+		waitUntil([this] { return !isFull(); });
+		tryEnqueue(std::move(value));
+	}
+
+	// consumer side
+
+	bool tryDequeue(T &value) {
+
+		const uint32_t head = m_head.load(std::memory_order_relaxed);
+		if (!consumerHasData(head))
+			return false;
+
+		T &slot = m_slots[head & m_mask];
+		value = std::move(slot);
+		// drop the slot's reference now, so implicitly shared payloads are
+		// released on the consumer thread and not when the slot is reused.
+		slot = T();
+		publishHead(head + 1);
+		return true;
+	}
+
+	T tryDequeue() {
+
+		T val = T();
+		tryDequeue(val);
+		return val;
+	}
+
+	T dequeue() {
+
+		T val = T();
+		if (tryDequeue(val)) return val;
+
+		waitUntil([this] { return !isEmpty(); });
+		tryDequeue(val);
+		return val;
+	}
+
+	T tryHead() {
+
+		const uint32_t head = m_head.load(std::memory_order_relaxed);
+		if (!consumerHasData(head))
+			return T();
+
+		return m_slots[head & m_mask];
+	}
+
+	T head() {
+
+		waitUntil([this] { return !isEmpty(); });
+		return tryHead();
+	}
+
+	void clear() {
+
+		T val;
+		while (tryDequeue(val)) {}
+	}
+
+	// either side
+
+	bool isEmpty() const {
+
+		return count() == 0;
+	}
+
+	bool isFull() const {
+
+		return count() >= (int) m_maxSize;
+	}
+
+	int count() const {
+
+		const uint32_t tail = m_tail.load(std::memory_order_acquire);
+		const uint32_t head = m_head.load(std::memory_order_acquire);
+		return (int)(tail - head);
+	}
+
+	int capacity() const {
+
+		return (int) m_maxSize;
+	}
+
+private:
+	bool producerHasRoom(uint32_t tail) {
+
+		if (tail - m_headCache < m_maxSize) return true;
+
+		m_headCache = m_head.load(std::memory_order_acquire);
+		return tail - m_headCache < m_maxSize;
+	}
+
+	bool consumerHasData(uint32_t head) {
+
+		if (head != m_tailCache) return true;
+
+		m_tailCache = m_tail.load(std::memory_order_acquire);
+		return head != m_tailCache;
+	}
+
+	void publishTail(uint32_t tail) {
+
+		m_tail.store(tail, std::memory_order_release);
+		wakeWaiters();
+	}
+
+	void publishHead(uint32_t head) {
+
+		m_head.store(head, std::memory_order_release);
+		wakeWaiters();
+	}
+
+	void wakeWaiters() {
+
+		// pairs with the seq_cst increment in waitUntil(): either we see the
+		// waiter, or the waiter sees the index we have just published.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_waiters.load(std::memory_order_relaxed) == 0) return;
+
+		QMutexLocker locker(&m_waitMutex);
+		m_waitCondition.wakeAll();
+	}
+
+	template<class Predicate> void waitUntil(Predicate ready) {
+
+		for (int i = 0; i < SPIN_COUNT; i++) {
+
+			if (ready()) return;
+			CUSDR_CPU_RELAX();
+		}
+
+		QMutexLocker locker(&m_waitMutex);
+		m_waiters.fetch_add(1, std::memory_order_seq_cst);
+		while (!ready())
+			m_waitCondition.wait(&m_waitMutex);
+		m_waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	static const int SPIN_COUNT = 256;
+
+	const uint32_t	m_maxSize;
+	const uint32_t	m_mask;
+	std::vector<T>	m_slots;
+
+	// consumer owned
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_head;
+	uint32_t	m_tailCache;
+
+	// producer owned
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_tail;
+	uint32_t	m_headCache;
+
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<int>	m_waiters;
+	QMutex			m_waitMutex;
+	QWaitCondition	m_waitCondition;
+};
+
+// Ring of preallocated slots for one producer and one consumer that work on
+// the slot contents in place, so large blocks are neither allocated nor
+// copied per hand-over.
+//
+// The producer fills the slot returned by claim() and hands it over with
+// publish(); the consumer reads front() and gives it back with pop(). Both
+// sides only ever see slots the other side is not using. Neither side blocks:
+// claim() and front() return nullptr when the ring is full or empty.
+//
+// The size is rounded up to a power of two. slot() gives direct access to
+// the storage, e.g. to preallocate it, and is only valid while neither side
+// is running.
+
+template<class T> class QHSpscRing {
+
+public:
+	QHSpscRing(int size)
+		: m_mask(cusdrRoundUpPow2(size > 0 ? (uint32_t) size : 1) - 1)
+		, m_slots(m_mask + 1)
+		, m_head(0)
+		, m_tail(0)
+	{
+	}
+
+	QHSpscRing(const QHSpscRing &) = delete;
+	QHSpscRing &operator=(const QHSpscRing &) = delete;
+
+	// producer side
+
+	T *claim() {
+
+		const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+			return nullptr;
+
+		return &m_slots[tail & m_mask];
+	}
+
+	void publish() {
+
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// consumer side
+
+	T *front() {
+
+		const uint32_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &m_slots[head & m_mask];
+	}
+
+	void pop() {
+
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	void clear() {
+
+		while (front()) pop();
+	}
+
+	// either side
+
+	bool isEmpty() const {
+
+		return count() == 0;
+	}
+
+	int count() const {
+
+		const uint32_t tail = m_tail.load(std::memory_order_acquire);
+		const uint32_t head = m_head.load(std::memory_order_acquire);
+		return (int)(tail - head);
+	}
+
+	int capacity() const {
+
+		return (int)(m_mask + 1);
+	}
+
+	T &slot(int index) {
+
+		return m_slots[index];
+	}
+
+private:
+	const uint32_t	m_mask;
+	std::vector<T>	m_slots;
+
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_head;
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_tail;
+};
+
+// Three slots handed from one writer to one reader that only wants the most
+// recent value, e.g. a display frame: a slow reader skips frames instead of
+// holding the writer up, and neither side ever waits.
+//
+// The writer fills back() and hands it over with publish(), which swaps it
+// with the middle slot. The reader calls update() to swap the middle slot
+// with front() if something was published since; front() then stays valid
+// and untouched by the writer until the next update(). slot() gives direct
+// access to the storage, e.g. to preallocate it, and is only valid while
+// neither side is running.
+
+template<class T> class QHTripleBuffer {
+
+public:
+	QHTripleBuffer()
+		: m_back(0)
+		, m_middle(1)
+		, m_front(2)
+	{
+	}
+
+	QHTripleBuffer(const QHTripleBuffer &) = delete;
+	QHTripleBuffer &operator=(const QHTripleBuffer &) = delete;
+
+	// writer side
+
+	T &back() {
+
+		return m_slots[m_back];
+	}
+
+	void publish() {
+
+		const uint32_t previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+		m_back = previous & INDEX_MASK;
+	}
+
+	// reader side
+
+	bool update() {
+
+		if (!(m_middle.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		const uint32_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+		m_front = previous & INDEX_MASK;
+		return true;
+	}
+
+	T &front() {
+
+		return m_slots[m_front];
+	}
+
+	const T &front() const {
+
+		return m_slots[m_front];
+	}
+
+	T &slot(int index) {
+
+		return m_slots[index];
+	}
+
+private:
+	static const uint32_t INDEX_MASK = 3;
+	static const uint32_t FRESH = 4;
+
+	T	m_slots[3];
+
+	alignas(CUSDR_CACHE_LINE_SIZE) uint32_t	m_back;					// writer owned
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_middle;	// slot index | FRESH
+	alignas(CUSDR_CACHE_LINE_SIZE) uint32_t	m_front;				// reader owned
+};
+
+// Fixed-size FIFO of plain values (audio samples) for one producer and one
+// consumer that move blocks at a time. write() stores what fits and read()
+// returns what is there; neither blocks or allocates. The size is rounded up
+// to a power of two.
+
+template<class T> class QHSpscBuffer {
+
+public:
+	QHSpscBuffer(int size)
+		: m_mask(cusdrRoundUpPow2(size > 0 ? (uint32_t) size : 1) - 1)
+		, m_data(m_mask + 1)
+		, m_head(0)
+		, m_tail(0)
+	{
+	}
+
+	QHSpscBuffer(const QHSpscBuffer &) = delete;
+	QHSpscBuffer &operator=(const QHSpscBuffer &) = delete;
+
+	// producer side: returns the number of values stored
+
+	int write(const T *src, int count) {
+
+		const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		const uint32_t room = (m_mask + 1) - (tail - m_head.load(std::memory_order_acquire));
+		const uint32_t n = qMin((uint32_t) qMax(count, 0), room);
+
+		copyIn(tail, src, n);
+		m_tail.store(tail + n, std::memory_order_release);
+		return (int) n;
+	}
+
+	// consumer side: returns the number of values read; 'dst' may be null
+	// to drop them
+
+	int read(T *dst, int count) {
+
+		const uint32_t head = m_head.load(std::memory_order_relaxed);
+		const uint32_t n = qMin((uint32_t) qMax(count, 0), m_tail.load(std::memory_order_acquire) - head);
+
+		if (dst) copyOut(head, dst, n);
+		m_head.store(head + n, std::memory_order_release);
+		return (int) n;
+	}
+
+	// either side
+
+	int count() const {
+
+		const uint32_t tail = m_tail.load(std::memory_order_acquire);
+		const uint32_t head = m_head.load(std::memory_order_acquire);
+		return (int)(tail - head);
+	}
+
+	int capacity() const {
+
+		return (int)(m_mask + 1);
+	}
+
+private:
+	void copyIn(uint32_t pos, const T *src, uint32_t n) {
+
+		const uint32_t index = pos & m_mask;
+		const uint32_t first = qMin(n, m_mask + 1 - index);
+
+		std::copy(src, src + first, m_data.begin() + index);
+		std::copy(src + first, src + n, m_data.begin());
+	}
+
+	void copyOut(uint32_t pos, T *dst, uint32_t n) const {
+
+		const uint32_t index = pos & m_mask;
+		const uint32_t first = qMin(n, m_mask + 1 - index);
+
+		std::copy(m_data.begin() + index, m_data.begin() + index + first, dst);
+		std::copy(m_data.begin(), m_data.begin() + (n - first), dst + first);
+	}
+
+	const uint32_t	m_mask;
+	std::vector<T>	m_data;
+
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_head;
+	alignas(CUSDR_CACHE_LINE_SIZE) std::atomic<uint32_t>	m_tail;
+};
+
+#endif // CUSDR_SPSC_QUEUE_H
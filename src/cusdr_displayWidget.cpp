@@ -603,6 +603,34 @@ void DisplayOptionsWidget::createWidebandPanOptions() {
 	m_wbAvgLabel->setFrameStyle(QFrame::Box | QFrame::Raised);
 	m_wbAvgLabel->setStyleSheet(set->getLabelStyle());
 
+	m_wbAnalyzerLabel = new QLabel("FFT/Ovl/Rate:", this);
+	m_wbAnalyzerLabel->setFrameStyle(QFrame::Box | QFrame::Raised);
+	m_wbAnalyzerLabel->setStyleSheet(set->getLabelStyle());
+
+	m_wbFftSizeCombo = new QComboBox(this);
+	for (int size = 1024; size <= BIGWIDEBANDSIZE; size *= 2)
+		m_wbFftSizeCombo->addItem(QString("%1k").arg(size / 1024), size);
+	m_wbFftSizeCombo->setFont(m_fonts.normalFont);
+	m_wbFftSizeCombo->setCurrentIndex(m_wbFftSizeCombo->findData(m_widebandOptions.fftSize));
+	m_wbFftSizeCombo->setStyleSheet(set->getComboBoxStyle());
+	CHECKED_CONNECT(m_wbFftSizeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(widebandAnalyzerChanged()));
+
+	m_wbOverlapCombo = new QComboBox(this);
+	for (int overlap = 0; overlap <= 75; overlap += 25)
+		m_wbOverlapCombo->addItem(QString("%1 %").arg(overlap), overlap);
+	m_wbOverlapCombo->setFont(m_fonts.normalFont);
+	m_wbOverlapCombo->setCurrentIndex(qMax(0, m_wbOverlapCombo->findData(m_widebandOptions.overlap)));
+	m_wbOverlapCombo->setStyleSheet(set->getComboBoxStyle());
+	CHECKED_CONNECT(m_wbOverlapCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(widebandAnalyzerChanged()));
+
+	m_wbFrameRateCombo = new QComboBox(this);
+	foreach (int rate, QList<int>() << 5 << 10 << 15 << 20 << 25 << 30 << 60)
+		m_wbFrameRateCombo->addItem(QString("%1/s").arg(rate), rate);
+	m_wbFrameRateCombo->setFont(m_fonts.normalFont);
+	m_wbFrameRateCombo->setCurrentIndex(qMax(0, m_wbFrameRateCombo->findData(m_widebandOptions.frameRate)));
+	m_wbFrameRateCombo->setStyleSheet(set->getComboBoxStyle());
+	CHECKED_CONNECT(m_wbFrameRateCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(widebandAnalyzerChanged()));
+
 
     QHBoxLayout* hbox1 = new QHBoxLayout;
 	hbox1->setSpacing(4);
@@ -619,11 +647,21 @@ void DisplayOptionsWidget::createWidebandPanOptions() {
 	hbox2->addWidget(m_wbAvgSlider);
 	hbox2->addWidget(m_wbAvgLevelLabel);
 
+	QHBoxLayout* hbox3 = new QHBoxLayout;
+	hbox3->setSpacing(4);
+	hbox3->setContentsMargins(0,0,0,0);
+	hbox3->addWidget(m_wbAnalyzerLabel);
+	hbox3->addStretch();
+	hbox3->addWidget(m_wbFftSizeCombo);
+	hbox3->addWidget(m_wbOverlapCombo);
+	hbox3->addWidget(m_wbFrameRateCombo);
+
     QVBoxLayout* vbox = new QVBoxLayout;
 	vbox->setSpacing(6);
 	vbox->addSpacing(6);
 	vbox->addLayout(hbox1);
 	vbox->addLayout(hbox2);
+	vbox->addLayout(hbox3);
 
 	m_widebandPanOptions = new QGroupBox(tr("Wideband Panadapter Spectrum"), this);
 	m_widebandPanOptions->setMinimumWidth(m_minimumGroupBoxWidth);
@@ -1040,6 +1078,15 @@ void DisplayOptionsWidget::setWidebandAveragingCnt(int value) {
 	set->setSpectrumAveragingCnt(this, -1, value);
 }
 
+void DisplayOptionsWidget::widebandAnalyzerChanged() {
+
+	set->setWidebandAnalyzer(
+			this,
+			m_wbFftSizeCombo->currentData().toInt(),
+			m_wbOverlapCombo->currentData().toInt(),
+			m_wbFrameRateCombo->currentData().toInt());
+}
+
 void DisplayOptionsWidget::sampleRateChanged(QObject *sender, int value) {
 
 	Q_UNUSED(sender)
@@ -101,6 +101,9 @@ private:
 	QComboBox*              m_panAverageCombo;
     QComboBox*              m_panDetectorCombo;
 	QComboBox*              m_fftSizeCombo;
+	QComboBox*				m_wbFftSizeCombo;
+	QComboBox*				m_wbOverlapCombo;
+	QComboBox*				m_wbFrameRateCombo;
 
     QSpinBox*				m_waterfallLoOffsetSpinBox;
 	QSpinBox*				m_waterfallHiOffsetSpinBox;
@@ -112,6 +115,7 @@ private:
 	QLabel*					m_wbAvgLabel;
 	QLabel*					m_avgLevelLabel;
 	QLabel*					m_wbAvgLevelLabel;
+	QLabel*					m_wbAnalyzerLabel;
 	QLabel*					m_resolutionLabel;
 	QLabel*					m_waterfallTimeLabel;
 	QLabel*					m_waterfallLoOffsetLabel;
@@ -199,6 +203,7 @@ private slots:
 	void 	fpsValueChanged(int value);
 	void	averagingFilterCntChanged(int value);
 	void	setWidebandAveragingCnt(int value);
+	void	widebandAnalyzerChanged();
 	void	sampleRateChanged(QObject *sender, int value);
 	void	callSignTextChanged(const QString &text);
 	void	callSignChanged();
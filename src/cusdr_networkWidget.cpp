@@ -65,6 +65,7 @@ NetworkWidget::NetworkWidget(QWidget *parent)
 
 	createDeviceNetworkInterfaceGroup();
 	createDeviceSearchGroup();
+	createPipelineStatsGroup();
 
 	QBoxLayout *mainLayout = new QBoxLayout(QBoxLayout::TopToBottom, this);
 	mainLayout->setSpacing(5);
@@ -86,6 +87,11 @@ NetworkWidget::NetworkWidget(QWidget *parent)
 	hbox3->setContentsMargins(4, 0, 4, 0);
 	hbox3->addWidget(searchNetworkDeviceGroupBox);
 
+	QHBoxLayout *hbox4 = new QHBoxLayout();
+	hbox4->setSpacing(0);
+	hbox4->setContentsMargins(4, 0, 4, 0);
+	hbox4->addWidget(pipelineStatsGroupBox);
+
 	if (m_hwInterface == QSDR::NoInterfaceMode) {
 		
 		deviceNIGroupBox->hide();
@@ -95,6 +101,7 @@ NetworkWidget::NetworkWidget(QWidget *parent)
 	mainLayout->addLayout(hbox1);
 	mainLayout->addLayout(hbox2);
 	mainLayout->addLayout(hbox3);
+	mainLayout->addLayout(hbox4);
 	mainLayout->addStretch();
 	setLayout(mainLayout);
 
@@ -133,6 +140,12 @@ void NetworkWidget::setupConnections() {
 		this, 
 		SLOT(addDeviceNICEntry(QString, QString)));
 
+	CHECKED_CONNECT(
+		set, 
+		SIGNAL(iqRecordingChanged(QObject *, bool)), 
+		this, 
+		SLOT(iqRecordingChanged(QObject *, bool)));
+
 	CHECKED_CONNECT(
 		set, 
 		SIGNAL(hpsdrDeviceNICChanged(int)), 
@@ -318,6 +331,78 @@ void NetworkWidget::createDeviceSearchGroup() {
 	searchNetworkDeviceGroupBox->setFont(QFont("Arial", 8));
 }
 
+void NetworkWidget::createPipelineStatsGroup() {
+
+	pipelineStatsDumpBtn = new AeroButton("dump", this);
+	pipelineStatsDumpBtn->setRoundness(10);
+	pipelineStatsDumpBtn->setFixedSize(btn_width2, btn_height);
+
+	CHECKED_CONNECT(
+		pipelineStatsDumpBtn, 
+		SIGNAL(clicked()), 
+		this, 
+		SLOT(pipelineStatsDumpBtnClicked()));
+
+	pipelineStatsResetBtn = new AeroButton("reset", this);
+	pipelineStatsResetBtn->setRoundness(10);
+	pipelineStatsResetBtn->setFixedSize(btn_width2, btn_height);
+
+	CHECKED_CONNECT(
+		pipelineStatsResetBtn, 
+		SIGNAL(clicked()), 
+		this, 
+		SLOT(pipelineStatsResetBtnClicked()));
+
+	iqRecordBtn = new AeroButton("record", this);
+	iqRecordBtn->setRoundness(10);
+	iqRecordBtn->setFixedSize(btn_width2, btn_height);
+	iqRecordBtn->setToolTip(tr("record the raw IQ datagrams to ~/.cudaSDR/recordings"));
+	iqRecordBtn->setBtnState(set->getIQRecording() ? AeroButton::ON : AeroButton::OFF);
+
+	CHECKED_CONNECT(
+		iqRecordBtn, 
+		SIGNAL(clicked()), 
+		this, 
+		SLOT(iqRecordBtnClicked()));
+
+	pipelineStatsLabel = new QLabel(this);
+	pipelineStatsLabel->setFont(QFont("Courier New", 7));
+	pipelineStatsLabel->setStyleSheet(set->getLabelStyle());
+	pipelineStatsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+	QHBoxLayout *hbox1 = new QHBoxLayout();
+	hbox1->setSpacing(1);
+	hbox1->addWidget(iqRecordBtn);
+	hbox1->addStretch();
+	hbox1->addWidget(pipelineStatsDumpBtn);
+	hbox1->addSpacing(3);
+	hbox1->addWidget(pipelineStatsResetBtn);
+
+	QVBoxLayout *vbox = new QVBoxLayout();
+	vbox->setSpacing(3);
+	vbox->addSpacing(5);
+	vbox->addWidget(pipelineStatsLabel);
+	vbox->addLayout(hbox1);
+	vbox->addSpacing(5);
+
+	pipelineStatsGroupBox = new QGroupBox(tr("Receive pipeline latency"), this);
+	pipelineStatsGroupBox->setMinimumWidth(m_minimumGroupBoxWidth);
+	pipelineStatsGroupBox->setLayout(vbox);
+	pipelineStatsGroupBox->setFont(QFont("Arial", 8));
+
+	pipelineStatsTimer = new QTimer(this);
+	pipelineStatsTimer->setInterval(1000);
+
+	CHECKED_CONNECT(
+		pipelineStatsTimer, 
+		SIGNAL(timeout()), 
+		this, 
+		SLOT(updatePipelineStats()));
+
+	pipelineStatsTimer->start();
+	updatePipelineStats();
+}
+
 // ************************************************************************
 
 void NetworkWidget::addDeviceNICEntry(QString niName, QString ipAddress) {
@@ -593,3 +678,35 @@ void NetworkWidget::setSocketBufferSize(int value) {
 			break;
 	}
 }
+
+void NetworkWidget::updatePipelineStats() {
+
+	// the histograms are always filled; only render them while we are shown
+	if (!isVisible()) return;
+
+	pipelineStatsLabel->setText(CPipelineStats::instance()->report());
+}
+
+void NetworkWidget::pipelineStatsDumpBtnClicked() {
+
+	CPipelineStats::instance()->dump();
+}
+
+void NetworkWidget::pipelineStatsResetBtnClicked() {
+
+	CPipelineStats::instance()->reset();
+	updatePipelineStats();
+}
+
+void NetworkWidget::iqRecordBtnClicked() {
+
+	set->setIQRecording(this, !set->getIQRecording());
+}
+
+void NetworkWidget::iqRecordingChanged(QObject *sender, bool value) {
+
+	Q_UNUSED(sender)
+
+	iqRecordBtn->setBtnState(value ? AeroButton::ON : AeroButton::OFF);
+	iqRecordBtn->update();
+}
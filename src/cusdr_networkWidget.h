@@ -34,6 +34,7 @@
 #include <QSpinBox>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QTimer>
 #include <QLabel>
 
 #include "Util/cusdr_buttons.h"
@@ -75,6 +76,7 @@ private:
 	QGroupBox	*deviceNIGroupBox;
 	QGroupBox	*searchNetworkDeviceGroupBox;
 	QGroupBox	*socketBufferSizeGroupBox;
+	QGroupBox	*pipelineStatsGroupBox;
 	
 	QComboBox	*networkDeviceInterfaces;
 	QComboBox	*networkDeviceIPAdresses;
@@ -82,12 +84,18 @@ private:
 	QComboBox	*m_receiverComboBox;
 
 	QLabel		*socketBufferSizeLabel;
+	QLabel		*pipelineStatsLabel;
+
+	QTimer		*pipelineStatsTimer;
 	
 	AeroButton	*networkPresenceBtn;
 	AeroButton	*noHWBtn;
 
 	AeroButton	*searchNetworkDeviceBtn;
 	AeroButton	*socketBufSizeBtn;
+	AeroButton	*pipelineStatsDumpBtn;
+	AeroButton	*pipelineStatsResetBtn;
+	AeroButton	*iqRecordBtn;
 
 	QSDR::_ServerMode		m_serverMode;
 	QSDR::_HWInterfaceMode	m_hwInterface;
@@ -103,6 +111,7 @@ private:
 	void	setupConnections();
 	void	createDeviceNetworkInterfaceGroup();
 	void	createDeviceSearchGroup();
+	void	createPipelineStatsGroup();
 
 private slots:
 	void	systemStateChanged(
@@ -121,6 +130,11 @@ private slots:
 	void	setCurrentNetworkDevice(TNetworkDevicecard card);
 	void	disableButtons();
 	void	enableButtons();
+	void	updatePipelineStats();
+	void	pipelineStatsDumpBtnClicked();
+	void	pipelineStatsResetBtnClicked();
+	void	iqRecordBtnClicked();
+	void	iqRecordingChanged(QObject *sender, bool value);
 	
 signals:
 	void	messageEvent(QString message);
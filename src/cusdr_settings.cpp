@@ -73,7 +73,7 @@ Settings *Settings::m_instance = nullptr;        /*!< set m_instance to NULL. */
 
 Settings::Settings(QObject *parent)
         : QObject(parent), m_dataEngineState(QSDR::DataEngineDown), setLoaded(false), m_mainPower(false),
-          m_manualSocketBufferSize(false), m_peakHold(false), m_packetsToggle(true), m_radioPopupVisible(false),
+          m_manualSocketBufferSize(false), m_peakHold(false), m_packetsToggle(true), m_iqRecording(false), m_radioPopupVisible(false),
           m_hpsdrNetworkDevices(0), m_mercuryReceivers(1), m_currentReceiver(0) {
     m_devices.mercuryFWVersion = 0;
 
@@ -735,6 +735,18 @@ int Settings::loadSettings() {
     if ((value < 1) || (value > 100)) value = 5;
     m_widebandOptions.averagingCnt = value;
 
+    value = settings->value("wideband/fftSize", 8192).toInt();
+    if ((value < 1024) || (value > BIGWIDEBANDSIZE) || (value & (value - 1))) value = 8192;
+    m_widebandOptions.fftSize = value;
+
+    value = settings->value("wideband/overlap", 0).toInt();
+    if ((value < 0) || (value > 75)) value = 0;
+    m_widebandOptions.overlap = value;
+
+    value = settings->value("wideband/frameRate", 20).toInt();
+    if ((value < 1) || (value > 60)) value = 20;
+    m_widebandOptions.frameRate = value;
+
     value = settings->value("wideband/dBmWideBandScaleMin", -140).toInt();
     if ((value < -200) || (value > 0)) value = -140;
     m_widebandOptions.dBmWBScaleMin = (qreal) (1.0 * value);
@@ -1894,6 +1906,9 @@ int Settings::saveSettings() {
         settings->setValue("wideband/averaging", "off");
 
     settings->setValue("wideband/averagingCnt", m_widebandOptions.averagingCnt);
+    settings->setValue("wideband/fftSize", m_widebandOptions.fftSize);
+    settings->setValue("wideband/overlap", m_widebandOptions.overlap);
+    settings->setValue("wideband/frameRate", m_widebandOptions.frameRate);
     settings->setValue("wideband/dBmWideBandScaleMin", (int) m_widebandOptions.dBmWBScaleMin);
     settings->setValue("wideband/dBmWideBandScaleMax", (int) m_widebandOptions.dBmWBScaleMax);
 
@@ -4515,6 +4530,32 @@ void Settings::setWidebandData(QObject *sender, bool value) {
     emit widebandDataChanged(sender, m_widebandOptions.wideBandData);
 }
 
+void Settings::setIQRecording(QObject *sender, bool value) {
+
+    QMutexLocker locker(&settingsMutex);
+
+    if (m_iqRecording == value) return;
+    m_iqRecording = value;
+    locker.unlock();
+    emit iqRecordingChanged(sender, m_iqRecording);
+}
+
+void Settings::setWidebandAnalyzer(QObject *sender, int fftSize, int overlap, int frameRate) {
+
+    QMutexLocker locker(&settingsMutex);
+
+    if (m_widebandOptions.fftSize == fftSize &&
+        m_widebandOptions.overlap == overlap &&
+        m_widebandOptions.frameRate == frameRate) return;
+
+    m_widebandOptions.fftSize = fftSize;
+    m_widebandOptions.overlap = overlap;
+    m_widebandOptions.frameRate = frameRate;
+
+    locker.unlock();
+    emit widebandAnalyzerChanged(sender, fftSize, overlap, frameRate);
+}
+
 void Settings::setWidebandBuffers(QObject *sender, int value) {
 
     Q_UNUSED(sender)
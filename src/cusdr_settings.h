@@ -179,6 +179,11 @@
 //#include "cusdr_about.h"
 #include "AudioEngine/cusdr_fspectrum.h"
 #include "Util/cusdr_queue.h"
+#include "Util/cusdr_spscQueue.h"
+#include "Util/cusdr_packetPool.h"
+#include "Util/cusdr_frameBuffer.h"
+#include "Util/cusdr_pipelineStats.h"
+#include "Util/cusdr_iqRecorder.h"
 
 
 
@@ -384,17 +389,32 @@ typedef struct _ccParameterTx {
 
 class IHPSDRProtocol;
 
+// payload is either an owned byte array or, for datagrams received into
+// io.iq_pool, a non-owning view into buffer that stays valid while the
+// packet (or a copy of it) is alive. received is the cusdrMonotonicUs()
+// time DataIO read the datagram, 0 for packets that did not come off the wire.
 typedef struct _iqPacket {
-	QByteArray	payload;
-	quint16		sourcePort;
+	CPacketBuffer	buffer;
+	QByteArray		payload;
+	quint16			sourcePort;
+	qint64			received;
 
 	_iqPacket()
 		: sourcePort(0)
+		, received(0)
 	{}
 
 	_iqPacket(const QByteArray &data, quint16 port)
 		: payload(data)
 		, sourcePort(port)
+		, received(0)
+	{}
+
+	_iqPacket(CPacketBuffer &&buf, int offset, int length, quint16 port, qint64 time = 0)
+		: buffer(std::move(buf))
+		, payload(buffer.view(offset, length))
+		, sourcePort(port)
+		, received(time)
 	{}
 
 } TIQPacket;
@@ -416,9 +436,11 @@ typedef struct _hpsdrParameter {
 
 	QByteArray				audioDatagram;
 	
-	QHQueue<TIQPacket>		iq_queue;
+	CPacketPool				iq_pool;
+	QHSpscQueue<TIQPacket>	iq_queue;
+	IQRecorder				iq_recorder;
 	QHQueue<QByteArray>		au_queue;
-	QHQueue<QByteArray>		wb_queue;
+	CFrameDoubleBuffer		wb_frames;
 	QHQueue<QList<qreal> >	data_queue;
 
 	QList<qreal> inputBuffer;
@@ -452,6 +474,9 @@ typedef struct _hpsdrParameter {
 	int		currentReceiver;
 	int		audio_rx;
 	int		timing;
+
+	// receive time of the IQ packet the decoder is working on (DataProcessor thread)
+	qint64	iqPacketReceived;
 	
 	int		currentMetisCard;
 
@@ -664,6 +689,10 @@ typedef struct _wideband {
 	int	numberOfBuffers;
 	int	averagingCnt;
 
+	int	fftSize;		// analyzer FFT length, a power of two
+	int	overlap;		// percent of each FFT shared with the one before
+	int	frameRate;		// spectra per second
+
 	float	scalePosition;
 
 	qreal	dBmWBScaleMin;
@@ -945,6 +974,8 @@ signals:
 	void widebandSpectrumBufferReset();
 	void widebandStatusChanged(QObject* sender, bool value);
 	void widebandDataChanged(QObject* sender, bool value);
+	void widebandAnalyzerChanged(QObject* sender, int fftSize, int overlap, int frameRate);
+	void iqRecordingChanged(QObject* sender, bool value);
 	void widebanddBmScaleMinChanged(QObject *sender, qreal value);
 	void widebanddBmScaleMaxChanged(QObject *sender, qreal value);
 	void wideBandScalePositionChanged(QObject *sender, float position);
@@ -1181,9 +1212,13 @@ public:
 
 	bool		getWidebandStatus()			{ return m_widebandOptions.wideBandDisplayStatus; }
 	bool		getWidebandData()			{ return m_widebandOptions.wideBandData; }
+	bool		getIQRecording()			{ return m_iqRecording; }
 	qreal		getWidebanddBmScaleMin()	{ return m_widebandOptions.dBmWBScaleMin; }
 	qreal		getWidebanddBmScaleMax()	{ return m_widebandOptions.dBmWBScaleMax; }
 	int			getWidebandBuffers()		{ return m_widebandOptions.numberOfBuffers; }
+	int			getWidebandFftSize()		{ return m_widebandOptions.fftSize; }
+	int			getWidebandOverlap()		{ return m_widebandOptions.overlap; }
+	int			getWidebandFrameRate()		{ return m_widebandOptions.frameRate; }
 
 
 
@@ -1458,6 +1493,8 @@ public slots:
 	void setWidebandOptions(QObject* sender, TWideband options);
 	void setWidebandStatus(QObject* sender, bool value);
 	void setWidebandData(QObject* sender, bool value);
+	void setWidebandAnalyzer(QObject* sender, int fftSize, int overlap, int frameRate);
+	void setIQRecording(QObject* sender, bool value);
 	void setWidebanddBmScaleMin(QObject* sender, qreal value);
 	void setWidebanddBmScaleMax(QObject* sender, qreal value);
 	//void setWidebandAveraging(QObject *sender, bool value);
@@ -1633,6 +1670,7 @@ private:
 	bool	m_panGrid;
 	bool	m_peakHold;
 	bool	m_packetsToggle;
+	bool	m_iqRecording;
 
 	bool	m_frequencyRx1onRx2;
 	bool	m_radioPopupVisible;
@@ -27,6 +27,7 @@
 #include "cusdr_settings.h"
 #include "fftw3.h"
 #include "cusdr_mainWidget.h"
+#include "DataEngine/cusdr_iqReplay.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -41,6 +42,7 @@
 #include <QSurfaceFormat>
 #include <QOpenGLContext>
 #include <QElapsedTimer>
+#include <QCommandLineParser>
 #include <QLoggingCategory> // NOTE: Added for the updated message handler
 
 #if defined(Q_OS_WIN32)
@@ -93,8 +95,59 @@ void load_WDSPWisdom() {
     WDSPwisdom(Settings::instance()->cfg_dir.toLocal8Bit().data());
 }
 
+// Headless IQ replay (DataEngine/cusdr_iqReplay.h): no splash, no GL, no
+// main window. The result goes to stdout; the exit code is 1 on error and,
+// with --realtime, 2 if anything was dropped.
+int runIQReplay(int argc, char *argv[]) {
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a captured radio IQ stream through the receive pipeline.");
+    parser.addHelpOption();
+    parser.addOption({"replay", "Capture (pcap, pcapng) or IQ recording (.cuiq) to replay.", "file"});
+    parser.addOption({"realtime", "Pace the datagrams by their capture time stamps."});
+    parser.addOption({"receivers", "Number of receivers (default: from the capture or the settings).", "n", "0"});
+    parser.addOption({"rate", "Sample rate in Hz (default: from the settings).", "hz", "0"});
+    parser.addOption({"loops", "Number of passes over the capture.", "n", "1"});
+    parser.process(app);
+
+    Settings::instance(&app);
+    Settings::instance()->setSettingsFilename(QCoreApplication::applicationDirPath() +
+                                              "/" + Settings::instance()->getSettingsFilename());
+    Settings::instance()->setSettingsLoaded(Settings::instance()->loadSettings() >= 0);
+    load_WDSPWisdom();
+
+    TIQReplayConfig config;
+    config.fileName = parser.value("replay");
+    config.realtime = parser.isSet("realtime");
+    config.receivers = parser.value("receivers").toInt();
+    config.sampleRate = parser.value("rate").toInt();
+    config.loops = parser.value("loops").toInt();
+
+    QTextStream out(stdout);
+    QString error;
+    IQReplay replay(config);
+    if (!replay.load(&error) || !replay.run(&error)) {
+
+        out << "replay failed: " << error << Qt::endl;
+        return 1;
+    }
+
+    out << replay.report() << Qt::endl;
+    return (config.realtime && replay.hasDrops()) ? 2 : 0;
+}
+
 int main(int argc, char *argv[]) {
 
+    // "--replay <file>" or "--replay=<file>"; QCommandLineParser takes both
+    for (int i = 1; i < argc; i++)
+        if (qstrcmp(argv[i], "--replay") == 0 || qstrncmp(argv[i], "--replay=", 9) == 0)
+            return runIQReplay(argc, argv);
+
 #ifndef DEBUG
     // NOTE: The function name is the same, but it now works with the updated handler signature.
     qInstallMessageHandler(cuSDRMessageHandler);
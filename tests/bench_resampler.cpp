@@ -0,0 +1,254 @@
+/**
+* @file  bench_resampler.cpp
+* @brief quality and throughput of CPolyphaseResampler against CFractResampler
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Both resamplers convert complex test tones at the rate pairs the audio
+// path uses, at the nominal ratio and with a 50 ppm clock correction (the
+// polyphase fractional path). For each case:
+//
+//  - passband: worst gain error in dB of tones up to 80% of the lower
+//    Nyquist frequency;
+//  - spurious: worst power beside the tone, images and interpolation noise,
+//    relative to the tone, for the same tones;
+//  - stopband: worst output power of tones whose alias would land in that
+//    passband, from 60% of the output rate up to 95% of the input Nyquist
+//    frequency (down-conversion only), i.e. how well aliases are rejected;
+//  - throughput in input Msamples/s.
+//
+// The run fails if CPolyphaseResampler misses the limits below.
+//
+//   bench_resampler [seconds of signal per measurement]
+
+#include "polyphaseresampler.h"
+#include "fractresampler.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define BENCH_BLOCK			1024
+#define BENCH_SETTLE		4096	// output samples skipped before measuring
+
+#define LIMIT_PASSBAND_DB	0.01
+#define LIMIT_SPURIOUS_DB	-95.0
+#define LIMIT_STOPBAND_DB	-95.0
+
+typedef struct _ratePair {
+
+	int		inRate;
+	int		outRate;
+
+} TRatePair;
+
+typedef struct _quality {
+
+	double	passband;	// worst |gain| error, dB
+	double	spurious;	// worst spurious level, dB below the tone
+	double	stopband;	// worst stopband output, dB; 0 if not measured
+	double	msps;		// input Msamples/s
+
+} TQuality;
+
+// the two resamplers behind one interface
+class Resampler {
+
+public:
+	virtual ~Resampler() {}
+	virtual int run(int length, double rate, TYPECPX *in, TYPECPX *out) = 0;
+};
+
+class Polyphase : public Resampler {
+
+public:
+	Polyphase(const TRatePair &pair) { m_r.Init(BENCH_BLOCK, pair.inRate, pair.outRate); }
+	int run(int length, double rate, TYPECPX *in, TYPECPX *out) override { return m_r.Resample(length, rate, in, out); }
+
+private:
+	CPolyphaseResampler	m_r;
+};
+
+class Fract : public Resampler {
+
+public:
+	Fract(const TRatePair &) { m_r.Init(BENCH_BLOCK); }
+	int run(int length, double rate, TYPECPX *in, TYPECPX *out) override { return m_r.Resample(length, rate, in, out); }
+
+private:
+	CFractResampler	m_r;
+};
+
+template<class R>
+static std::vector<std::complex<double> > convert(const TRatePair &pair, double rate, double freq, int inSamples) {
+
+	R resampler(pair);
+	std::vector<TYPECPX> in(BENCH_BLOCK);
+	std::vector<TYPECPX> out((int)(BENCH_BLOCK / rate) + 2);
+	std::vector<std::complex<double> > result;
+
+	const double w = K_2PI * freq / pair.inRate;
+	long n = 0;
+	for (int done = 0; done < inSamples; done += BENCH_BLOCK) {
+
+		for (int i = 0; i < BENCH_BLOCK; i++, n++) {
+
+			in[i].re = 0.5 * cos(w * n);
+			in[i].im = 0.5 * sin(w * n);
+		}
+
+		const int produced = resampler.run(BENCH_BLOCK, rate, in.data(), out.data());
+		for (int i = 0; i < produced; i++)
+			result.push_back(std::complex<double>(out[i].re, out[i].im));
+	}
+
+	result.erase(result.begin(), result.begin() + qMin((int) result.size(), BENCH_SETTLE));
+	return result;
+}
+
+// tone power at 'freq' (by projection) and the power of everything else,
+// both relative to the 0.5 amplitude input
+static void measure(const std::vector<std::complex<double> > &y, double freq, double rate, double *tone, double *rest) {
+
+	const double w = K_2PI * freq / rate;
+	std::complex<double> c(0.0, 0.0);
+	double total = 0.0;
+	for (size_t n = 0; n < y.size(); n++) {
+
+		c += y[n] * std::polar(1.0, -w * (double) n);
+		total += std::norm(y[n]);
+	}
+	c /= (double) y.size();
+	total /= (double) y.size();
+
+	*tone = std::norm(c) / 0.25;
+	*rest = qMax(total - std::norm(c), 1e-30) / 0.25;
+}
+
+static double dB(double power) {
+
+	return 10.0 * log10(qMax(power, 1e-30));
+}
+
+template<class R>
+static TQuality evaluate(const TRatePair &pair, double rate, int inSamples) {
+
+	TQuality q = { 0.0, -300.0, 0.0, 0.0 };
+
+	// output rate the stream really runs at with a clock correction
+	const double outRate = pair.inRate / rate;
+	const double nyquist = 0.5 * qMin(pair.inRate, pair.outRate);
+
+	for (int k = -8; k <= 8; k++) {
+
+		const double freq = 0.1 * k * nyquist;
+		double tone, rest;
+		measure(convert<R>(pair, rate, freq, inSamples), freq, outRate, &tone, &rest);
+
+		q.passband = qMax(q.passband, fabs(dB(tone)));
+		q.spurious = qMax(q.spurious, dB(rest) - dB(tone));
+	}
+
+	if (pair.inRate > pair.outRate) {
+
+		q.stopband = -300.0;
+		const double lo = 0.6 * pair.outRate;
+		const double hi = 0.95 * 0.5 * pair.inRate;
+		for (int k = 0; k <= 8; k++) {
+
+			const double freq = lo + (hi - lo) * k / 8.0;
+			double tone, rest;
+			measure(convert<R>(pair, rate, freq, inSamples), freq, outRate, &tone, &rest);
+			q.stopband = qMax(q.stopband, dB(tone + rest));
+		}
+	}
+
+	// throughput on a continuous stream
+	R resampler(pair);
+	std::vector<TYPECPX> in(BENCH_BLOCK);
+	std::vector<TYPECPX> out((int)(BENCH_BLOCK / rate) + 2);
+	for (int i = 0; i < BENCH_BLOCK; i++) {
+
+		in[i].re = sin(0.01 * i);
+		in[i].im = cos(0.013 * i);
+	}
+
+	const int blocks = qMax(inSamples * 4 / BENCH_BLOCK, 1);
+	volatile double sink = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for (int b = 0; b < blocks; b++)
+		sink = sink + resampler.run(BENCH_BLOCK, rate, in.data(), out.data());
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	q.msps = (double) blocks * BENCH_BLOCK / s * 1e-6;
+
+	return q;
+}
+
+static void print(const char *name, const TRatePair &pair, const char *path, const TQuality &q) {
+
+	printf("%-10s %6d -> %6d %-9s passband %6.3f dB  spurious %7.1f dB", name, pair.inRate, pair.outRate, path, q.passband, q.spurious);
+	if (q.stopband != 0.0)
+		printf("  stopband %7.1f dB", q.stopband);
+	else
+		printf("  stopband     n/a   ");
+	printf("  %7.2f Msps\n", q.msps);
+}
+
+int main(int argc, char *argv[]) {
+
+	double seconds = argc > 1 ? atof(argv[1]) : 0.3;
+	if (seconds <= 0.0) seconds = 0.3;
+
+	static const TRatePair pairs[] = {
+		{ 48000, 48000 }, { 96000, 48000 }, { 192000, 48000 }, { 384000, 48000 },
+		{ 44100, 48000 }, { 48000, 192000 } };
+
+	printf("polyphase kernel: %s\n", CPolyphaseResampler::Kernel());
+
+	int failures = 0;
+	for (const TRatePair &pair : pairs) {
+
+		const int inSamples = (int)(seconds * pair.inRate);
+		const double nominal = (double) pair.inRate / pair.outRate;
+
+		for (int corrected = 0; corrected <= 1; corrected++) {
+
+			const double rate = corrected ? nominal * (1.0 + 50e-6) : nominal;
+			const char *path = corrected ? "+50ppm" : "nominal";
+
+			const TQuality poly = evaluate<Polyphase>(pair, rate, inSamples);
+			const TQuality fract = evaluate<Fract>(pair, rate, inSamples);
+			print("polyphase", pair, path, poly);
+			print("fract", pair, path, fract);
+
+			if (poly.passband > LIMIT_PASSBAND_DB || poly.spurious > LIMIT_SPURIOUS_DB ||
+				(poly.stopband != 0.0 && poly.stopband > LIMIT_STOPBAND_DB)) {
+
+				printf("FAIL polyphase %d -> %d %s\n", pair.inRate, pair.outRate, path);
+				failures++;
+			}
+		}
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/**
+* @file  bench_spscQueue.cpp
+* @brief micro-benchmark of QHSpscQueue against the mutex based QHQueue
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// One producer thread and one consumer thread pass <items> sequence numbers
+// through each queue; the consumer checks ordering and the run reports items
+// per second. Queue depth matches the DataIO -> DataProcessor queues.
+//
+//   bench_spscQueue [items]
+
+#include "cusdr_queue.h"
+#include "cusdr_spscQueue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#define BENCH_QUEUE_DEPTH	8192
+
+template<class Queue>
+static bool runQueue(const char *name, long items) {
+
+	Queue queue(BENCH_QUEUE_DEPTH);
+	bool inOrder = true;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread consumer([&]() {
+
+		for (long i = 0; i < items; i++) {
+
+			long v = queue.dequeue();
+			if (v != i) inOrder = false;
+		}
+	});
+
+	for (long i = 0; i < items; i++)
+		queue.enqueue(i);
+
+	consumer.join();
+
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%-12s %10ld items  %8.3f ms  %8.2f Mitems/s%s\n",
+		name, items, s * 1e3, items / s * 1e-6, inOrder ? "" : "  OUT OF ORDER");
+
+	return inOrder;
+}
+
+int main(int argc, char *argv[]) {
+
+	long items = argc > 1 ? atol(argv[1]) : 2000000;
+	if (items <= 0) items = 2000000;
+
+	bool ok = true;
+	ok &= runQueue<QHQueue<long> >("QHQueue", items);
+	ok &= runQueue<QHSpscQueue<long> >("QHSpscQueue", items);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
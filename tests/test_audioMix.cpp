@@ -0,0 +1,272 @@
+/**
+* @file  test_audioMix.cpp
+* @brief scalar equivalence, clipping and throughput of the audio mix kernels
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// The scalar kernels are checked against the plain definitions: the mix adds
+// in * gain per channel, the clip saturates at +-1 and the 16 bit conversion
+// saturates at +-32767 and rounds to nearest. The AVX2 kernels, if the CPU
+// has them, must then match the scalar ones bit for bit on every length up
+// to 70 and on a full mixer period, including values beyond full scale and
+// the in place conversion; nothing may be written past the end. Then each
+// kernel's samples/s is measured on a 1024 frame period.
+//
+//   test_audioMix [iterations]
+
+// the kernels are file static; pull them in directly
+#include "cusdr_audioMix.cpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// a value no kernel produces from the test buffers
+#define TEST_GUARD		1234.5f
+#define TEST_GUARD16	((qint16) 0x5A5A)
+
+struct MixKernelSet {
+	const char			*name;
+	TAudioMixKernels	k;
+};
+
+static std::vector<MixKernelSet> kernelSets() {
+
+	std::vector<MixKernelSet> sets;
+
+	TAudioMixKernels scalar;
+	scalar.mix		= mixScalar;
+	scalar.clip		= clipScalar;
+	scalar.toInt16	= toInt16Scalar;
+	sets.push_back({ "scalar", scalar });
+
+#ifdef AUDIO_MIX_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+
+		TAudioMixKernels avx2;
+		avx2.mix		= mixAvx2;
+		avx2.clip		= clipAvx2;
+		avx2.toInt16	= toInt16Avx2;
+		sets.push_back({ "avx2", avx2 });
+	}
+#endif
+	return sets;
+}
+
+// mostly within full scale, some well beyond it, and the edges exactly
+static std::vector<float> testSignal(std::mt19937 &rng, int samples) {
+
+	std::uniform_real_distribution<float> level(-1.6f, 1.6f);
+	static const float edges[] = { 1.0f, -1.0f, 1.0000001f, -1.0000001f, 0.0f, -0.0f, 1e9f, -1e9f,
+								   0.5f / 32767.0f, 1.5f / 32767.0f, -0.5f / 32767.0f };
+
+	std::vector<float> v(samples);
+	for (int i = 0; i < samples; i++)
+		v[i] = (i % 5 == 3) ? edges[(i / 5) % (sizeof(edges) / sizeof(edges[0]))] : level(rng);
+	return v;
+}
+
+static int checkScalar() {
+
+	int failures = 0;
+
+	const float in[8] = { 0.25f, -0.5f, 2.0f, -3.0f, 1.0f, -1.0f, 0.999f, -0.999f };
+	float acc[8] = { 0.5f, 0.5f, 0.5f, 0.5f, 0.0f, 0.0f, -1.0f, 1.0f };
+	mixScalar(in, acc, 4, 2.0f, 0.5f);
+
+	const float mixed[8] = { 1.0f, 0.25f, 4.5f, -1.0f, 2.0f, -0.5f, 0.998f, 0.5005f };
+	for (int i = 0; i < 8; i++) {
+
+		if (fabsf(acc[i] - mixed[i]) > 1e-6f) {
+
+			printf("FAIL mix sample %d: %g, expected %g\n", i, acc[i], mixed[i]);
+			failures++;
+		}
+	}
+
+	float clip[6] = { 1.5f, -1.5f, 0.25f, 1.0f, -1.0f, 1e30f };
+	clipScalar(clip, 6);
+	const float clipped[6] = { 1.0f, -1.0f, 0.25f, 1.0f, -1.0f, 1.0f };
+	if (memcmp(clip, clipped, sizeof(clip))) {
+
+		printf("FAIL clip does not saturate at +-1\n");
+		failures++;
+	}
+
+	// saturation, symmetric full scale and round to nearest
+	const float conv[8] = { 2.0f, -2.0f, 1.0f, -1.0f, 0.4f / 32767.0f, 1.6f / 32767.0f, 0.6f / 32767.0f, -0.6f / 32767.0f };
+	const qint16 converted[8] = { 32767, -32767, 32767, -32767, 0, 2, 1, -1 };
+	qint16 out[8];
+	toInt16Scalar(conv, out, 8);
+	for (int i = 0; i < 8; i++) {
+
+		if (out[i] != converted[i]) {
+
+			printf("FAIL int16 sample %d: %d, expected %d\n", i, out[i], converted[i]);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+static int checkKernels(std::mt19937 &rng) {
+
+	const std::vector<MixKernelSet> sets = kernelSets();
+	int failures = 0;
+
+	std::vector<int> lengths;
+	for (int n = 1; n <= 70; n++) lengths.push_back(n);
+	lengths.push_back(2 * 1024);
+
+	for (int samples : lengths) {
+
+		const int frames = samples / 2;
+		const std::vector<float> in = testSignal(rng, samples);
+		const std::vector<float> base = testSignal(rng, samples);
+		std::uniform_real_distribution<float> gain(0.0f, 2.0f);
+		const float gainL = gain(rng), gainR = gain(rng);
+
+		std::vector<float> refMix, refClip;
+		std::vector<qint16> refInt16;
+
+		for (const MixKernelSet &set : sets) {
+
+			// exactly 'samples' values plus a guard, so overruns show
+			std::vector<float> mix(base);
+			mix.push_back(TEST_GUARD);
+			set.k.mix(in.data(), mix.data(), frames, gainL, gainR);
+
+			std::vector<float> clip(in);
+			clip.push_back(TEST_GUARD);
+			set.k.clip(clip.data(), samples);
+
+			std::vector<qint16> int16(samples + 1, TEST_GUARD16);
+			set.k.toInt16(in.data(), int16.data(), samples);
+
+			// in place: the qint16 results overwrite the front of the floats
+			std::vector<float> inPlace(in);
+			inPlace.push_back(TEST_GUARD);
+			set.k.toInt16(inPlace.data(), reinterpret_cast<qint16 *>(inPlace.data()), samples);
+
+			bool ok = mix[samples] == TEST_GUARD && clip[samples] == TEST_GUARD
+					  && int16[samples] == TEST_GUARD16 && inPlace[samples] == TEST_GUARD;
+
+			// an odd sample at the end belongs to no frame and stays as it was
+			if (samples & 1)
+				ok &= mix[samples - 1] == base[samples - 1];
+
+			for (int i = 0; i < samples; i++)
+				ok &= clip[i] >= -1.0f && clip[i] <= 1.0f && (fabsf(in[i]) > 1.0f || clip[i] == in[i]);
+
+			if (memcmp(inPlace.data(), int16.data(), samples * sizeof(qint16)))
+				ok = false;
+
+			if (refMix.empty()) {
+
+				refMix = mix;
+				refClip = clip;
+				refInt16 = int16;
+			}
+			else if (memcmp(refMix.data(), mix.data(), samples * sizeof(float))
+					 || memcmp(refClip.data(), clip.data(), samples * sizeof(float))
+					 || memcmp(refInt16.data(), int16.data(), samples * sizeof(qint16))) {
+
+				printf("FAIL %s differs from %s on %d samples\n", set.name, sets[0].name, samples);
+				ok = false;
+			}
+
+			if (!ok) {
+
+				printf("FAIL %s on %d samples\n", set.name, samples);
+				failures++;
+			}
+		}
+	}
+
+	// the public entry points ignore empty requests
+	float f = TEST_GUARD;
+	qint16 s = TEST_GUARD16;
+	mixStereo(&f, &f, 0, 1.0f, 1.0f);
+	clipAudio(&f, 0);
+	audioToInt16(&f, &s, 0);
+	if (f != TEST_GUARD || s != TEST_GUARD16) {
+
+		printf("FAIL an empty request was written\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+static void bench(int frames, long iterations) {
+
+	std::mt19937 rng(1);
+	const std::vector<float> in = testSignal(rng, 2 * frames);
+	std::vector<float> acc(2 * frames), buf(2 * frames);
+	std::vector<qint16> out(2 * frames);
+
+	for (const MixKernelSet &set : kernelSets()) {
+
+		const struct { const char *name; int op; } ops[] = { { "mix", 0 }, { "clip", 1 }, { "int16", 2 } };
+
+		for (const auto &op : ops) {
+
+			auto start = std::chrono::steady_clock::now();
+			for (long it = 0; it < iterations; it++) {
+
+				switch (op.op) {
+				case 0: set.k.mix(in.data(), acc.data(), frames, 0.5f, 0.5f); break;
+				case 1: memcpy(buf.data(), in.data(), in.size() * sizeof(float)); set.k.clip(buf.data(), 2 * frames); break;
+				default: set.k.toInt16(in.data(), out.data(), 2 * frames); break;
+				}
+			}
+			double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			volatile float sink = acc[0] + buf[1] + out[2];
+			(void) sink;
+
+			printf("%5d frames  %-7s %-6s %8.3f us/period  %8.2f Msamples/s\n", frames, set.name, op.name,
+				secs / iterations * 1e6, 2.0 * frames * iterations / secs * 1e-6);
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+
+	long iterations = argc > 1 ? atol(argv[1]) : 20000;
+	if (iterations <= 0) iterations = 20000;
+
+	std::mt19937 rng(20261017);
+	int failures = checkScalar();
+	failures += checkKernels(rng);
+
+	printf("audio mix dispatches to %s\n", audioMixKernel());
+	printf("golden: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	bench(1024, iterations);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+/**
+* @file  test_colorLut.cpp
+* @brief table, clamping and kernel equivalence checks of the waterfall color LUT
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// The table is built from a color function that encodes the entry index in
+// red and green, so every mapped pixel tells which entry it came from. Each
+// entry must be the nearest one to the value (within half an entry of the
+// double precision position), values at or beyond the thresholds and NaN
+// must take the end entries, and the bytes must be R, G, B, A in memory.
+// The scalar and (if the CPU has it) AVX2 kernels must agree bit for bit on
+// every count up to 40 and on a full display line; nothing may be written
+// past 'count'. Then each kernel's bins/s is measured on a 4096 bin line.
+//
+//   test_colorLut [iterations]
+
+// the kernels are file static; pull them in directly
+#include "cusdr_colorLut.cpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define TEST_LOWER	-140.0f
+#define TEST_UPPER	10.0f
+#define TEST_BLUE	0x5A
+#define TEST_ALPHA	0xC3
+#define TEST_GUARD	0xDEADBEEFu
+
+struct MapKernelEntry {
+	const char	*name;
+	MapKernel	fn;
+};
+
+static std::vector<MapKernelEntry> mapKernels() {
+
+	std::vector<MapKernelEntry> kernels;
+	kernels.push_back({ "scalar", mapScalar });
+
+#ifdef COLOR_LUT_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		kernels.push_back({ "avx2", mapAvx2 });
+#endif
+	return kernels;
+}
+
+// entry i of a table over [lower, upper] gets red = i & 0xff, green = i >> 8
+static void buildIndexLut(CColorLut &lut, float lower, float upper) {
+
+	lut.build(lower, upper, [lower, upper](qreal dB) {
+
+		const int i = (int) lround((dB - lower) / (upper - lower) * (CColorLut::LUT_SIZE - 1));
+		return QColor(i & 0xff, i >> 8, TEST_BLUE, TEST_ALPHA);
+	});
+}
+
+// the entry a pixel came from, or -1 if blue or alpha are not ours
+static int entryOf(quint32 pixel) {
+
+	uchar bytes[4];
+	memcpy(bytes, &pixel, 4);
+	if (bytes[2] != TEST_BLUE || bytes[3] != TEST_ALPHA) return -1;
+	return bytes[0] | (bytes[1] << 8);
+}
+
+// position of a value in entries, unrounded and unclamped
+static double position(float dB, float offset, float lower, float upper) {
+
+	return ((double) dB + offset - lower) * (CColorLut::LUT_SIZE - 1) / ((double) upper - lower);
+}
+
+static int checkTable() {
+
+	int failures = 0;
+
+	CColorLut lut;
+	if (lut.isValid()) {
+
+		printf("FAIL a new table is valid\n");
+		failures++;
+	}
+
+	buildIndexLut(lut, TEST_LOWER, TEST_UPPER);
+	if (!lut.isValid() || lut.lower() != TEST_LOWER || lut.upper() != TEST_UPPER) {
+
+		printf("FAIL build() did not set the thresholds\n");
+		failures++;
+	}
+
+	// every entry once, straight through the public API
+	std::vector<float> dB(CColorLut::LUT_SIZE);
+	std::vector<quint32> out(CColorLut::LUT_SIZE);
+	for (int i = 0; i < CColorLut::LUT_SIZE; i++)
+		dB[i] = TEST_LOWER + (float)((double) i * (TEST_UPPER - TEST_LOWER) / (CColorLut::LUT_SIZE - 1));
+
+	lut.map(dB.data(), CColorLut::LUT_SIZE, 0.0f, out.data());
+
+	int wrong = 0;
+	for (int i = 0; i < CColorLut::LUT_SIZE; i++)
+		if (entryOf(out[i]) != i) wrong++;
+
+	if (wrong) {
+
+		printf("FAIL %d of %d entries do not map to themselves\n", wrong, CColorLut::LUT_SIZE);
+		failures++;
+	}
+
+	// R, G, B, A in memory, as a GL_RGBA / GL_UNSIGNED_BYTE row wants them
+	const float top = TEST_UPPER;
+	quint32 pixel = 0;
+	lut.map(&top, 1, 0.0f, &pixel);
+
+	const uchar *bytes = reinterpret_cast<const uchar *>(&pixel);
+	const int last = CColorLut::LUT_SIZE - 1;
+	if (bytes[0] != (last & 0xff) || bytes[1] != (last >> 8) || bytes[2] != TEST_BLUE || bytes[3] != TEST_ALPHA) {
+
+		printf("FAIL byte order %02x %02x %02x %02x\n", bytes[0], bytes[1], bytes[2], bytes[3]);
+		failures++;
+	}
+
+	// an empty span is widened rather than divided by
+	CColorLut flat;
+	flat.build(-50.0f, -50.0f, [](qreal) { return QColor(1, 2, 3, 4); });
+	if (!flat.isValid() || flat.upper() <= flat.lower()) {
+
+		printf("FAIL an empty span gives thresholds %g, %g\n", flat.lower(), flat.upper());
+		failures++;
+	}
+
+	// nothing is written for an empty request
+	pixel = TEST_GUARD;
+	lut.map(&top, 0, 0.0f, &pixel);
+	if (pixel != TEST_GUARD) {
+
+		printf("FAIL map() wrote for an empty request\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+// every kernel against the nearest entry of the unrounded position
+static int checkKernels(std::mt19937 &rng) {
+
+	static const float offsets[] = { 0.0f, -12.5f, 37.0f };
+
+	CColorLut lut;
+	buildIndexLut(lut, TEST_LOWER, TEST_UPPER);
+
+	// raw table and parameters the way map() passes them
+	std::vector<quint32> table(CColorLut::LUT_SIZE);
+	for (int i = 0; i < CColorLut::LUT_SIZE; i++) {
+
+		const float dB = TEST_LOWER + (float)((double) i * (TEST_UPPER - TEST_LOWER) / (CColorLut::LUT_SIZE - 1));
+		lut.map(&dB, 1, 0.0f, &table[i]);
+	}
+	const float scale = (CColorLut::LUT_SIZE - 1) / (TEST_UPPER - TEST_LOWER);
+
+	const std::vector<MapKernelEntry> kernels = mapKernels();
+	std::uniform_real_distribution<float> dBm(TEST_LOWER - 40.0f, TEST_UPPER + 40.0f);
+	int failures = 0;
+
+	std::vector<int> counts;
+	for (int count = 1; count <= 40; count++) counts.push_back(count);
+	counts.push_back(1920);
+
+	for (float offset : offsets) {
+
+		for (int count : counts) {
+
+			// exactly 'count' values, so reads past the end show under ASan
+			std::vector<float> dB(count);
+			for (int i = 0; i < count; i++) dB[i] = dBm(rng);
+
+			// the thresholds themselves, beyond them and NaN
+			dB[0] = TEST_LOWER - offset;
+			if (count > 1) dB[count - 1] = TEST_UPPER - offset;
+			if (count > 2) dB[1] = std::numeric_limits<float>::quiet_NaN();
+			if (count > 3) dB[2] = -std::numeric_limits<float>::infinity();
+			if (count > 4) dB[3] = std::numeric_limits<float>::infinity();
+			if (count > 9) dB[9] = -1e30f;
+
+			std::vector<quint32> first;
+
+			for (const MapKernelEntry &k : kernels) {
+
+				std::vector<quint32> out(count + 1, TEST_GUARD);
+				k.fn(table.data(), dB.data(), count, offset - TEST_LOWER, scale, out.data());
+
+				bool ok = out[count] == TEST_GUARD;
+				for (int i = 0; i < count && ok; i++) {
+
+					const int entry = entryOf(out[i]);
+					if (std::isnan(dB[i])) {
+
+						ok = entry == 0;
+						continue;
+					}
+
+					const double pos = position(dB[i], offset, TEST_LOWER, TEST_UPPER);
+					if (pos <= 0.0)
+						ok = entry == 0;
+					else if (pos >= CColorLut::LUT_SIZE - 1)
+						ok = entry == CColorLut::LUT_SIZE - 1;
+					else
+						ok = entry >= 0 && fabs(entry - pos) <= 0.5 + 1e-3;
+
+					if (!ok)
+						printf("FAIL %s offset %g count %d: %g dB -> entry %d, position %.3f\n",
+							k.name, offset, count, dB[i], entry, pos);
+				}
+
+				// the kernels must agree exactly, rounding ties included
+				if (ok && !first.empty() && memcmp(first.data(), out.data(), count * sizeof(quint32))) {
+
+					printf("FAIL %s offset %g count %d differs from %s\n", k.name, offset, count, kernels[0].name);
+					ok = false;
+				}
+				if (first.empty()) first = out;
+
+				if (!ok) failures++;
+			}
+		}
+	}
+
+	return failures;
+}
+
+static void bench(int count, long iterations) {
+
+	CColorLut lut;
+	buildIndexLut(lut, TEST_LOWER, TEST_UPPER);
+
+	std::vector<quint32> table(CColorLut::LUT_SIZE);
+	for (int i = 0; i < CColorLut::LUT_SIZE; i++) {
+
+		const float dB = TEST_LOWER + (float)((double) i * (TEST_UPPER - TEST_LOWER) / (CColorLut::LUT_SIZE - 1));
+		lut.map(&dB, 1, 0.0f, &table[i]);
+	}
+	const float scale = (CColorLut::LUT_SIZE - 1) / (TEST_UPPER - TEST_LOWER);
+
+	std::vector<float> dB(count);
+	for (int i = 0; i < count; i++) dB[i] = -130.0f + (float)((i * 7919) % 1409) * 0.1f;
+	std::vector<quint32> out(count);
+
+	for (const MapKernelEntry &k : mapKernels()) {
+
+		auto start = std::chrono::steady_clock::now();
+		for (long it = 0; it < iterations; it++)
+			k.fn(table.data(), dB.data(), count, -TEST_LOWER, scale, out.data());
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		volatile quint32 sink = out[0] ^ out[count - 1];
+		(void) sink;
+
+		printf("%5d bins  %-7s %8.2f us/line  %8.2f Gbins/s\n", count, k.name,
+			s / iterations * 1e6, (double) count * iterations / s * 1e-9);
+	}
+}
+
+int main(int argc, char *argv[]) {
+
+	long iterations = argc > 1 ? atol(argv[1]) : 20000;
+	if (iterations <= 0) iterations = 20000;
+
+	std::mt19937 rng(20261017);
+	int failures = checkTable();
+	failures += checkKernels(rng);
+
+	printf("color LUT dispatches to %s\n", CColorLut::kernelName());
+	printf("golden: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	bench(4096, iterations);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,331 @@
+/**
+* @file  test_ducPacketizer.cpp
+* @brief framing, pacing and underrun/overrun checks of the Protocol 2 DUC packetizer
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// The packetizer is driven the way DataProcessor drives it: a DSP block of
+// TX IQ is written, advance() is told about a block of RX audio and every
+// packet that became due is filled and given a header.
+//
+//  - framing: packets are 4 + 240 * 6 bytes, and once sending starts their
+//    payloads, put end to end, must be the 192 kHz stream of a separate
+//    resampler packed with packIQ24(), byte for byte;
+//  - pacing: advance() must make one packet per 60 audio samples, whatever
+//    the block sizes, and the packets before the ring is prefilled and
+//    while receiving must be silent;
+//  - sequence numbers: big-endian, one per packet, wrapping at 2^32;
+//  - a TX stream that stops mid transmission pads one packet and counts an
+//    underrun, one that runs ahead drops samples and counts an overrun.
+//
+//   test_ducPacketizer
+
+#include "cusdr_ducPacketizer.h"
+#include "Util/cusdr_iqUnpack.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define PAYLOAD_BYTES	(DUC_SAMPLES_PER_PACKET * DUC_SAMPLE_BYTES)
+
+static std::vector<cpx> randomBlock(std::mt19937 &rng, int count) {
+
+	std::uniform_real_distribution<float> level(-0.7f, 0.7f);
+
+	std::vector<cpx> block(count);
+	for (cpx &c : block) {
+
+		c.re = level(rng);
+		c.im = level(rng);
+	}
+	return block;
+}
+
+static bool isSilent(const uchar *payload) {
+
+	for (int i = 0; i < PAYLOAD_BYTES; i++)
+		if (payload[i]) return false;
+	return true;
+}
+
+static quint64 counter(CPipelineStats::Counter c) {
+
+	return CPipelineStats::instance()->counter(c);
+}
+
+static int checkLayout() {
+
+	int failures = 0;
+
+	if (DUC_PACKET_SIZE != 1444 || DUC_INTERPOLATION != 4 || DUC_SAMPLE_BYTES != 6) {
+
+		printf("FAIL packet layout %d bytes, interpolation %d\n", DUC_PACKET_SIZE, DUC_INTERPOLATION);
+		failures++;
+	}
+
+	// big-endian, one step per packet, wrapping at 2^32
+	static const quint32 sequences[] = { 0, 1, 0x01020304, 0x7FFFFFFF, 0xFFFFFFFE, 0xFFFFFFFF };
+
+	for (quint32 start : sequences) {
+
+		quint32 sequence = start;
+		uchar header[DUC_HEADER_SIZE + 1];
+		header[DUC_HEADER_SIZE] = 0xA5;
+
+		const int size = DucPacketizer::formatHeader(header, sequence);
+		const quint32 written = ((quint32) header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+
+		if (size != DUC_HEADER_SIZE || written != start || sequence != start + 1 || header[DUC_HEADER_SIZE] != 0xA5) {
+
+			printf("FAIL header of sequence %08x: size %d, wrote %08x, next %08x\n", start, size, written, sequence);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+static int checkPacing() {
+
+	static const int steps[] = { 1, 7, 59, 60, 61, 240, 1024, 4096 };
+	const int total = 60 * 4096;
+
+	int failures = 0;
+
+	for (int step : steps) {
+
+		DucPacketizer duc;
+		duc.reset();
+
+		int packets = 0;
+		for (int done = 0; done < total; done += step)
+			packets += duc.advance(qMin(step, total - done));
+
+		if (packets != total / 60) {
+
+			printf("FAIL advance() in steps of %d: %d packets for %d samples\n", step, packets, total);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+// DataProcessor::writeDucData(), with the payloads appended to 'stream'
+static int sendBlock(DucPacketizer &duc, bool transmitting, int samples, quint32 &sequence,
+					 std::vector<uchar> &stream, int &silent)
+{
+	uchar packet[DUC_PACKET_SIZE];
+
+	const int packets = duc.advance(samples);
+	for (int i = 0; i < packets; i++) {
+
+		duc.fill(transmitting, packet + DUC_HEADER_SIZE);
+		const int headerSize = DucPacketizer::formatHeader(packet, sequence);
+
+		if (headerSize + PAYLOAD_BYTES != DUC_PACKET_SIZE)
+			return -1;
+
+		if (isSilent(packet + DUC_HEADER_SIZE))
+			silent++;
+		else
+			stream.insert(stream.end(), packet + DUC_HEADER_SIZE, packet + DUC_PACKET_SIZE);
+	}
+
+	return packets;
+}
+
+static int checkFraming(std::mt19937 &rng) {
+
+	const int blocks = 200;
+	int failures = 0;
+
+	DucPacketizer duc;
+	duc.reset();
+
+	// the same interpolation, packed the way the packets carry it
+	CPolyphaseResampler reference;
+	reference.Init(DSP_SAMPLE_SIZE, DUC_INPUT_RATE, DUC_SAMPLE_RATE);
+	std::vector<cpx> upsampled(DSP_SAMPLE_SIZE * DUC_INTERPOLATION + DUC_INTERPOLATION);
+	std::vector<uchar> expected;
+
+	std::vector<uchar> stream;
+	quint32 sequence = 0xFFFFFFF0;
+	int packets = 0, silent = 0;
+
+	const quint64 underruns = counter(CPipelineStats::DucUnderruns);
+	const quint64 overruns = counter(CPipelineStats::DucOverruns);
+	const quint64 made = counter(CPipelineStats::DucPackets);
+
+	for (int b = 0; b < blocks; b++) {
+
+		const std::vector<cpx> block = randomBlock(rng, DSP_SAMPLE_SIZE);
+		duc.write(block.data(), DSP_SAMPLE_SIZE);
+
+		const int n = reference.Resample(DSP_SAMPLE_SIZE, (double) DUC_INPUT_RATE / DUC_SAMPLE_RATE,
+						reinterpret_cast<const TYPECPX *>(block.data()),
+						reinterpret_cast<TYPECPX *>(upsampled.data()));
+
+		const size_t at = expected.size();
+		expected.resize(at + n * DUC_SAMPLE_BYTES);
+		packIQ24(upsampled.data(), n, expected.data() + at);
+
+		const int sent = sendBlock(duc, true, DSP_SAMPLE_SIZE, sequence, stream, silent);
+		if (sent < 0) {
+
+			printf("FAIL header and payload do not add up to %d bytes\n", DUC_PACKET_SIZE);
+			return failures + 1;
+		}
+		packets += sent;
+	}
+
+	if (packets != blocks * DSP_SAMPLE_SIZE / 60) {
+
+		printf("FAIL %d packets for %d blocks\n", packets, blocks);
+		failures++;
+	}
+
+	if (sequence != 0xFFFFFFF0 + (quint32) packets) {
+
+		printf("FAIL sequence %08x after %d packets\n", sequence, packets);
+		failures++;
+	}
+
+	if (counter(CPipelineStats::DucPackets) - made != (quint64) packets) {
+
+		printf("FAIL DucPackets counted %llu of %d packets\n",
+			(unsigned long long)(counter(CPipelineStats::DucPackets) - made), packets);
+		failures++;
+	}
+
+	// silence until the ring holds a block and a packet, then data only
+	const int blockSamples = DSP_SAMPLE_SIZE * DUC_INTERPOLATION;
+	const int prefillBlocks = (DUC_PREFILL_SAMPLES + blockSamples - 1) / blockSamples;
+	if (silent == 0 || silent > (prefillBlocks - 1) * DSP_SAMPLE_SIZE / 60 + 1) {
+
+		printf("FAIL %d silent packets before sending started\n", silent);
+		failures++;
+	}
+
+	if (stream.size() > expected.size() || memcmp(stream.data(), expected.data(), stream.size())) {
+
+		size_t i = 0;
+		while (i < stream.size() && i < expected.size() && stream[i] == expected[i]) i++;
+		printf("FAIL payload stream differs from the packed 192 kHz stream at sample %zu of %zu\n",
+			i / DUC_SAMPLE_BYTES, stream.size() / DUC_SAMPLE_BYTES);
+		failures++;
+	}
+
+	if (counter(CPipelineStats::DucUnderruns) != underruns || counter(CPipelineStats::DucOverruns) != overruns) {
+
+		printf("FAIL a steady stream counted underruns or overruns\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+static int checkReceiveAndUnderrun(std::mt19937 &rng) {
+
+	int failures = 0;
+
+	DucPacketizer duc;
+	duc.reset();
+
+	std::vector<uchar> stream;
+	quint32 sequence = 0;
+	int silent = 0;
+
+	// while receiving, written TX IQ is thrown away and packets stay silent
+	for (int b = 0; b < 8; b++) {
+
+		const std::vector<cpx> block = randomBlock(rng, DSP_SAMPLE_SIZE);
+		duc.write(block.data(), DSP_SAMPLE_SIZE);
+		sendBlock(duc, false, DSP_SAMPLE_SIZE, sequence, stream, silent);
+	}
+
+	if (!stream.empty()) {
+
+		printf("FAIL %zu samples sent while receiving\n", stream.size() / DUC_SAMPLE_BYTES);
+		failures++;
+	}
+
+	// transmit long enough to start sending, then the TX IQ stops
+	for (int b = 0; b < 4; b++) {
+
+		const std::vector<cpx> block = randomBlock(rng, DSP_SAMPLE_SIZE);
+		duc.write(block.data(), DSP_SAMPLE_SIZE);
+		sendBlock(duc, true, DSP_SAMPLE_SIZE, sequence, stream, silent);
+	}
+
+	const quint64 underruns = counter(CPipelineStats::DucUnderruns);
+	const size_t before = stream.size();
+
+	for (int b = 0; b < 4; b++)
+		sendBlock(duc, true, DSP_SAMPLE_SIZE, sequence, stream, silent);
+
+	if (counter(CPipelineStats::DucUnderruns) - underruns != 1) {
+
+		printf("FAIL a stopped TX stream counted %llu underruns\n",
+			(unsigned long long)(counter(CPipelineStats::DucUnderruns) - underruns));
+		failures++;
+	}
+
+	// what was left went out, the rest of its packet as silence
+	if (stream.size() == before) {
+
+		printf("FAIL the samples left in the ring were not sent\n");
+		failures++;
+	}
+
+	// a TX stream running ahead of the packet clock overflows the ring
+	const quint64 overruns = counter(CPipelineStats::DucOverruns);
+	for (int b = 0; b < DUC_RING_SAMPLES / (DSP_SAMPLE_SIZE * DUC_INTERPOLATION) + 2; b++) {
+
+		const std::vector<cpx> block = randomBlock(rng, DSP_SAMPLE_SIZE);
+		duc.write(block.data(), DSP_SAMPLE_SIZE);
+	}
+
+	if (counter(CPipelineStats::DucOverruns) == overruns) {
+
+		printf("FAIL a full ring counted no overrun\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+int main() {
+
+	std::mt19937 rng(20261017);
+
+	int failures = checkLayout();
+	failures += checkPacing();
+	failures += checkFraming(rng);
+	failures += checkReceiveAndUnderrun(rng);
+
+	printf("DUC packetizer: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/**
+* @file  test_frameBuffer.cpp
+* @brief state machine and two-thread checks of the wideband frame double buffer
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// First every transition of the Free / Ready / Reading state machine is
+// walked on one thread: nothing to take before a publish, a frame the
+// consumer holds is never written or handed out twice, a newer frame
+// replaces one nobody took, clear() drops only a frame nobody took, and
+// every lost frame is counted. Then a DataIO-like producer publishes
+// <frames> frames in bursts while a consumer polls for them; each frame
+// must arrive whole, in order, and taken plus dropped must add up.
+//
+//   test_frameBuffer [frames]
+
+#include "cusdr_frameBuffer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define CHECK(cond, what)											\
+	do {															\
+		if (!(cond)) {												\
+			printf("FAIL %s (line %d)\n", what, __LINE__);			\
+			failures++;												\
+		}															\
+	} while (0)
+
+// fills the producer's frame with 'tag' and publishes 'size' bytes of it
+static bool publishTagged(CFrameDoubleBuffer &fb, uchar tag, int size) {
+
+	memset(fb.fillBuffer(), tag, size);
+	return fb.publish(size);
+}
+
+static bool isTagged(const uchar *frame, int size, uchar tag) {
+
+	for (int i = 0; i < size; i++)
+		if (frame[i] != tag) return false;
+	return true;
+}
+
+static int checkStates() {
+
+	int failures = 0;
+	int size = -1;
+
+	CFrameDoubleBuffer fb;
+	CHECK(fb.capacity() == FRAME_BUFFER_SIZE, "capacity");
+	CHECK(fb.tryAcquire(size) == nullptr, "a frame before the first publish");
+	CHECK(fb.dropped() == 0, "drops before the first publish");
+
+	// Free -> Ready -> Reading
+	CHECK(publishTagged(fb, 1, 100), "publish into a free buffer");
+	const uchar *frame = fb.tryAcquire(size);
+	CHECK(frame && size == 100 && isTagged(frame, 100, 1), "the published frame");
+	CHECK(fb.fillBuffer() != frame, "the producer writes into the frame being read");
+	CHECK(fb.tryAcquire(size) == nullptr, "a second acquire while reading");
+
+	// Reading: the new frame goes, the one being read stays untouched
+	CHECK(!publishTagged(fb, 2, 200), "publish while the consumer reads");
+	CHECK(fb.dropped() == 1, "the frame published while reading is counted");
+	CHECK(isTagged(frame, 100, 1), "the frame being read changed");
+
+	// clear() leaves a frame being read alone
+	fb.clear();
+	CHECK(isTagged(frame, 100, 1), "clear() touched the frame being read");
+
+	// Reading -> Free
+	fb.release();
+	CHECK(fb.tryAcquire(size) == nullptr, "a frame after release without a publish");
+
+	// Ready -> Ready: the newer frame replaces the one nobody took
+	CHECK(publishTagged(fb, 3, 300), "publish after release");
+	CHECK(publishTagged(fb, 4, 400), "publish over a frame nobody took");
+	CHECK(fb.dropped() == 2, "the replaced frame is counted");
+
+	frame = fb.tryAcquire(size);
+	CHECK(frame && size == 400 && isTagged(frame, 400, 4), "the newest frame");
+	fb.release();
+
+	// Ready -> Free through clear()
+	CHECK(publishTagged(fb, 5, 500), "publish before clear");
+	fb.clear();
+	CHECK(fb.tryAcquire(size) == nullptr, "a frame after clear");
+	CHECK(fb.dropped() == 2, "clear() counts as a drop");
+
+	// and back to work
+	CHECK(publishTagged(fb, 6, FRAME_BUFFER_SIZE), "publish after clear");
+	frame = fb.tryAcquire(size);
+	CHECK(frame && size == FRAME_BUFFER_SIZE && isTagged(frame, FRAME_BUFFER_SIZE, 6), "a full size frame");
+	fb.release();
+
+	return failures;
+}
+
+// frame k is 'size' bytes of (k & 0xff) after a 4 byte k, size varying with k
+static int checkThreads(long frames) {
+
+	int failures = 0;
+
+	CFrameDoubleBuffer fb;
+	std::atomic<bool> done(false);
+	long taken = 0, torn = 0, reordered = 0;
+
+	std::thread consumer([&]() {
+
+		long last = -1;
+		for (;;) {
+
+			const bool finished = done.load(std::memory_order_acquire);
+
+			int size = 0;
+			const uchar *frame = fb.tryAcquire(size);
+			if (!frame) {
+
+				if (finished) break;
+				std::this_thread::yield();
+				continue;
+			}
+
+			quint32 k;
+			memcpy(&k, frame, 4);
+
+			if (size != 4 + (int)(k % 997) * 32 || !isTagged(frame + 4, size - 4, (uchar) k)) torn++;
+			if ((long) k <= last) reordered++;
+			last = k;
+			taken++;
+
+			fb.release();
+		}
+	});
+
+	for (long k = 0; k < frames; k++) {
+
+		const int size = 4 + (int)(k % 997) * 32;
+		uchar *frame = fb.fillBuffer();
+
+		const quint32 tag = (quint32) k;
+		memcpy(frame, &tag, 4);
+		memset(frame + 4, (uchar) k, size - 4);
+		fb.publish(size);
+
+		// datagrams arrive in bursts; give the consumer a chance now and then
+		if ((k & 7) == 0) std::this_thread::yield();
+	}
+
+	done.store(true, std::memory_order_release);
+	consumer.join();
+
+	printf("%ld frames: %ld taken, %llu dropped\n", frames, taken, (unsigned long long) fb.dropped());
+
+	CHECK(torn == 0, "a frame changed while it was read");
+	CHECK(reordered == 0, "frames arrived out of order");
+	CHECK(taken + (long) fb.dropped() == frames, "taken and dropped frames do not add up");
+	CHECK(taken > 0, "no frame got through");
+
+	return failures;
+}
+
+int main(int argc, char *argv[]) {
+
+	long frames = argc > 1 ? atol(argv[1]) : 200000;
+	if (frames <= 0) frames = 200000;
+
+	int failures = checkStates();
+	failures += checkThreads(frames);
+
+	printf("frame double buffer: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
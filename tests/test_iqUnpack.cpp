@@ -0,0 +1,318 @@
+/**
+* @file  test_iqUnpack.cpp
+* @brief scalar equivalence check and throughput of the 24-bit I/Q unpack kernels
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Every SIMD kernel the CPU supports is run against unpackScalar() over
+// random payloads, with the Protocol 2 stride and the Protocol 1 strides for
+// 1..8 receivers and every pair count up to 70, and must match bit for bit.
+// unpackIQ24() itself is checked the same way, and the real16 kernels
+// against unpackReal16Scalar(). Every kernel is also checked against the
+// per-byte decode loop the Protocol 1/2 decoders used before, on full frames
+// with -full scale (0x800000) and +full scale (0x7FFFFF) samples in the
+// first and last pair of every receiver. Then each kernel's samples/s is
+// measured on a Protocol 1 (2 receivers) and a Protocol 2 frame.
+//
+//   test_iqUnpack [iterations]
+
+// the kernels are file static; pull them in directly
+#include "cusdr_iqUnpack.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define TEST_MAX_PAIRS		70
+#define TEST_MAX_RECEIVERS	8
+
+struct IQKernel {
+	const char		*name;
+	UnpackKernel	fn;
+};
+
+struct Real16KernelEntry {
+	const char		*name;
+	Real16Kernel	fn;
+};
+
+static std::vector<IQKernel> iqKernels() {
+
+	std::vector<IQKernel> k;
+	k.push_back({ "scalar", unpackScalar });
+#ifdef IQ_UNPACK_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) k.push_back({ "ssse3", unpackSsse3 });
+	if (__builtin_cpu_supports("avx2")) k.push_back({ "avx2", unpackAvx2 });
+#endif
+	k.push_back({ "dispatch", unpackIQ24 });
+	return k;
+}
+
+static std::vector<Real16KernelEntry> real16Kernels() {
+
+	std::vector<Real16KernelEntry> k;
+	k.push_back({ "scalar", unpackReal16Scalar });
+#ifdef IQ_UNPACK_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) k.push_back({ "sse2", unpackReal16Sse2 });
+	if (__builtin_cpu_supports("avx2")) k.push_back({ "avx2", unpackReal16Avx2 });
+#endif
+	k.push_back({ "dispatch", unpackReal16 });
+	return k;
+}
+
+static bool sameCpx(const cpx *a, const cpx *b, int count) {
+
+	return memcmp(a, b, count * sizeof(cpx)) == 0;
+}
+
+static int checkIQ24(std::mt19937 &rng) {
+
+	int failures = 0;
+	const std::vector<IQKernel> kernels = iqKernels();
+
+	for (int receivers = 0; receivers <= TEST_MAX_RECEIVERS; receivers++) {
+
+		// receivers == 0 stands for the Protocol 2 payload
+		const int stride = receivers ? 6 * receivers + 2 : 6;
+		std::vector<unsigned char> payload(stride * TEST_MAX_PAIRS);
+
+		for (size_t i = 0; i < payload.size(); i++)
+			payload[i] = (unsigned char) rng();
+
+		// full scale corners in the first pairs
+		static const unsigned char corners[3][6] = {
+			{ 0x7F, 0xFF, 0xFF, 0x80, 0x00, 0x00 },
+			{ 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF },
+			{ 0x80, 0x00, 0x01, 0x00, 0x00, 0x01 } };
+		for (int c = 0; c < 3; c++)
+			memcpy(&payload[c * stride], corners[c], 6);
+
+		for (int count = 0; count <= TEST_MAX_PAIRS; count++) {
+
+			// size the source exactly, so a kernel reading past the last
+			// pair is visible under ASan / valgrind
+			const int bytes = count ? (count - 1) * stride + 6 : 0;
+			std::vector<unsigned char> src(payload.begin(), payload.begin() + bytes);
+
+			std::vector<cpx> ref(count + 1), out(count + 1);
+			unpackScalar(src.data(), stride, count, ref.data());
+
+			for (size_t k = 1; k < kernels.size(); k++) {
+
+				memset(out.data(), 0x5A, out.size() * sizeof(cpx));
+				const cpx guard = out[count];
+				kernels[k].fn(src.data(), stride, count, out.data());
+
+				if (!sameCpx(ref.data(), out.data(), count) || memcmp(&guard, &out[count], sizeof(cpx))) {
+
+					printf("FAIL unpackIQ24 %s: stride %d, %d pairs\n", kernels[k].name, stride, count);
+					failures++;
+				}
+			}
+		}
+	}
+
+	// scalar against the format definition
+	const unsigned char pair[6] = { 0xFF, 0xFF, 0xFE, 0x40, 0x00, 0x00 };
+	cpx v;
+	unpackScalar(pair, 6, 1, &v);
+	if (v.re != -2.0 * IQ24_SCALE || v.im != (double) 0x400000 * IQ24_SCALE) {
+
+		printf("FAIL unpackIQ24 scalar: wrong sample value\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+// the decode loop of the old CProtocol1::decodeCCBytes()/CProtocol2, followed
+// by the int -> double pass the receiver did: receivers == 0 is a Protocol 2
+// payload, otherwise a Protocol 1 frame with a 2-byte mic sample after each
+// group of receiver pairs
+static void legacyDecode(const unsigned char *buffer, int receivers, int pairs, std::vector<std::vector<cpx> > &out) {
+
+	const int rxCount = receivers ? receivers : 1;
+	std::vector<std::vector<int> > rawIQ(rxCount, std::vector<int>(2 * pairs));
+
+	int s = 0;
+	for (int n = 0; n < pairs; n++) {
+
+		for (int r = 0; r < rxCount; r++) {
+
+			int leftSample   = (int)((  signed char) buffer[s++]) << 16;
+			leftSample      += (int)((unsigned char) buffer[s++]) << 8;
+			leftSample      += (int)((unsigned char) buffer[s++]);
+			int rightSample  = (int)((  signed char) buffer[s++]) << 16;
+			rightSample     += (int)((unsigned char) buffer[s++]) << 8;
+			rightSample     += (int)((unsigned char) buffer[s++]);
+
+			rawIQ[r][n * 2] = leftSample;
+			rawIQ[r][n * 2 + 1] = rightSample;
+		}
+		if (receivers) s += 2;	// mic sample
+	}
+
+	const double scale = 1.0 / 8388607.0;
+	out.assign(rxCount, std::vector<cpx>(pairs));
+	for (int r = 0; r < rxCount; r++) {
+
+		for (int i = 0; i < pairs; i++) {
+
+			out[r][i].re = (double) rawIQ[r][2 * i] * scale;
+			out[r][i].im = (double) rawIQ[r][2 * i + 1] * scale;
+		}
+	}
+}
+
+static int checkLegacyDecode(std::mt19937 &rng) {
+
+	int failures = 0;
+	const std::vector<IQKernel> kernels = iqKernels();
+
+	static const unsigned char minMax[6] = { 0x80, 0x00, 0x00, 0x7F, 0xFF, 0xFF };
+	static const unsigned char maxMin[6] = { 0x7F, 0xFF, 0xFF, 0x80, 0x00, 0x00 };
+
+	for (int receivers = 0; receivers <= TEST_MAX_RECEIVERS; receivers++) {
+
+		// a whole 504-byte sample area of a USB frame, or a DDC packet
+		const int stride = receivers ? 6 * receivers + 2 : 6;
+		const int pairs = receivers ? 504 / stride : 238;
+		const int rxCount = receivers ? receivers : 1;
+
+		std::vector<unsigned char> frame(pairs * stride);
+		for (size_t i = 0; i < frame.size(); i++)
+			frame[i] = (unsigned char) rng();
+
+		for (int r = 0; r < rxCount; r++) {
+
+			memcpy(&frame[6 * r], minMax, 6);
+			memcpy(&frame[(pairs - 1) * stride + 6 * r], maxMin, 6);
+		}
+
+		std::vector<std::vector<cpx> > ref;
+		legacyDecode(frame.data(), receivers, pairs, ref);
+
+		// the corners decode to the format's extremes
+		if (ref[0][0].re != -8388608.0 / 8388607.0 || ref[0][0].im != 1.0 ||
+			ref[0][pairs - 1].re != 1.0 || ref[0][pairs - 1].im != -8388608.0 / 8388607.0) {
+
+			printf("FAIL legacy decode: wrong full scale values\n");
+			failures++;
+		}
+
+		std::vector<cpx> out(pairs);
+		for (size_t k = 0; k < kernels.size(); k++) {
+
+			for (int r = 0; r < rxCount; r++) {
+
+				kernels[k].fn(&frame[6 * r], stride, pairs, out.data());
+
+				if (!sameCpx(ref[r].data(), out.data(), pairs)) {
+
+					printf("FAIL unpackIQ24 %s against the legacy decode: stride %d, receiver %d\n",
+						   kernels[k].name, stride, r);
+					failures++;
+				}
+			}
+		}
+	}
+
+	return failures;
+}
+
+static int checkReal16(std::mt19937 &rng) {
+
+	int failures = 0;
+	const std::vector<Real16KernelEntry> kernels = real16Kernels();
+
+	for (int count = 0; count <= 4 * TEST_MAX_PAIRS; count++) {
+
+		std::vector<unsigned char> src(2 * count);
+		for (size_t i = 0; i < src.size(); i++)
+			src[i] = (unsigned char) rng();
+
+		std::vector<cpx> ref(count), out(count);
+		unpackReal16Scalar(src.data(), count, ref.data());
+
+		for (size_t k = 1; k < kernels.size(); k++) {
+
+			memset(out.data(), 0x5A, out.size() * sizeof(cpx));
+			kernels[k].fn(src.data(), count, out.data());
+
+			if (!sameCpx(ref.data(), out.data(), count)) {
+
+				printf("FAIL unpackReal16 %s: %d samples\n", kernels[k].name, count);
+				failures++;
+			}
+		}
+	}
+
+	return failures;
+}
+
+static void benchIQ24(const char *frame, int stride, int count, long iterations) {
+
+	std::vector<unsigned char> src(stride * count);
+	for (size_t i = 0; i < src.size(); i++)
+		src[i] = (unsigned char)(i * 131 + 7);
+
+	std::vector<cpx> dst(count);
+	const std::vector<IQKernel> kernels = iqKernels();
+
+	for (size_t k = 0; k < kernels.size(); k++) {
+
+		auto start = std::chrono::steady_clock::now();
+		for (long it = 0; it < iterations; it++)
+			kernels[k].fn(src.data(), stride, count, dst.data());
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// keep the result alive
+		volatile double sink = dst[count - 1].re;
+		(void) sink;
+
+		printf("%-22s %-9s %9.2f Msamples/s\n", frame, kernels[k].name, (double) count * iterations / s * 1e-6);
+	}
+}
+
+int main(int argc, char *argv[]) {
+
+	long iterations = argc > 1 ? atol(argv[1]) : 200000;
+	if (iterations <= 0) iterations = 200000;
+
+	std::mt19937 rng(20261017);
+
+	int failures = checkIQ24(rng);
+	failures += checkLegacyDecode(rng);
+	failures += checkReal16(rng);
+
+	printf("unpackIQ24 dispatches to %s, unpackReal16 to %s\n", unpackIQ24Kernel(), unpackReal16Kernel());
+	printf("equivalence: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	// 2 receivers: 36 pairs per 512-byte USB frame; P2: 238 pairs per DDC packet
+	benchIQ24("P1 frame, 2 receivers", 6 * 2 + 2, 36, iterations);
+	benchIQ24("P2 DDC packet", 6, 238, iterations);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
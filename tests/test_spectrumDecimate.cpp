@@ -0,0 +1,213 @@
+/**
+* @file  test_spectrumDecimate.cpp
+* @brief golden test and throughput of the spectrum decimators
+* @version 0.1
+* @date 2026-10-17
+*/
+
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License version 2 as
+ *   published by the Free Software Foundation
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// The scalar and (if the CPU has it) AVX2 peak, average and min/max kernels
+// are compared with a naive reference written straight from the header's
+// pixel definition, over odd and even spectrum widths and pixel counts on
+// both sides of span == count. Peak and min/max must match exactly, the
+// average to float rounding; nothing may be written past 'count'. Then the
+// throughput of each kernel is measured on typical display sizes.
+//
+//   test_spectrumDecimate [iterations]
+
+// the kernels are file static; pull them in directly
+#include "cusdr_spectrumDecimate.cpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// a value no kernel produces from the test spectra
+#define TEST_GUARD	12345.0f
+
+struct KernelSet {
+	const char			*name;
+	TDecimateKernels	k;
+};
+
+static std::vector<KernelSet> kernelSets() {
+
+	std::vector<KernelSet> sets;
+
+	TDecimateKernels scalar;
+	scalar.peak		= decimateScalar<DECIMATE_MAX>;
+	scalar.average	= decimateScalar<DECIMATE_MEAN>;
+	scalar.minMax	= decimateScalar<DECIMATE_MIN | DECIMATE_MAX>;
+	sets.push_back({ "scalar", scalar });
+
+#ifdef DECIMATE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+
+		TDecimateKernels avx2;
+		avx2.peak		= decimateAvx2<DECIMATE_MAX>;
+		avx2.average	= decimateAvx2<DECIMATE_MEAN>;
+		avx2.minMax		= decimateAvx2<DECIMATE_MIN | DECIMATE_MAX>;
+		sets.push_back({ "avx2", avx2 });
+	}
+#endif
+	return sets;
+}
+
+// pixel i covers bins [floor(i * span / count), floor((i + 1) * span / count)),
+// at least one bin wide
+static void reference(const float *src, int span, int count, float *mn, float *mx, double *mean) {
+
+	for (int i = 0; i < count; i++) {
+
+		int lo = (int) floor((double) i * span / count);
+		int hi = (int) floor((double)(i + 1) * span / count);
+		if (hi <= lo) hi = lo + 1;
+
+		float a = src[lo], b = src[lo];
+		double s = 0.0;
+		for (int j = lo; j < hi; j++) {
+
+			a = std::min(a, src[j]);
+			b = std::max(b, src[j]);
+			s += src[j];
+		}
+		mn[i] = a;
+		mx[i] = b;
+		mean[i] = s / (hi - lo);
+	}
+}
+
+static int checkKernels(std::mt19937 &rng) {
+
+	static const int spans[] = { 1, 2, 3, 7, 8, 9, 15, 17, 63, 100, 257, 1021, 4095, 4096, 16383 };
+	static const int counts[] = { 1, 3, 7, 8, 9, 17, 100, 333, 799, 1023, 1920 };
+
+	const std::vector<KernelSet> sets = kernelSets();
+	std::uniform_real_distribution<float> dBm(-150.0f, -20.0f);
+	int failures = 0;
+
+	for (int span : spans) {
+
+		// exactly 'span' bins, so reads past the end show under ASan
+		std::vector<float> src(span);
+		for (int j = 0; j < span; j++) src[j] = dBm(rng);
+
+		for (int count : counts) {
+
+			std::vector<float> refMin(count), refMax(count);
+			std::vector<double> refMean(count);
+			reference(src.data(), span, count, refMin.data(), refMax.data(), refMean.data());
+
+			for (const KernelSet &set : sets) {
+
+				std::vector<float> mn(count + 1, TEST_GUARD), mx(count + 1, TEST_GUARD), mean(count + 1, TEST_GUARD);
+
+				set.k.peak(src.data(), span, count, nullptr, mx.data(), nullptr);
+				set.k.average(src.data(), span, count, nullptr, nullptr, mean.data());
+
+				bool peakOk = mx[count] == TEST_GUARD;
+				bool meanOk = mean[count] == TEST_GUARD;
+				for (int i = 0; i < count; i++) {
+
+					peakOk &= mx[i] == refMax[i];
+					meanOk &= fabs(mean[i] - refMean[i]) <= 1e-5 * fabs(refMean[i]);
+				}
+
+				std::fill(mx.begin(), mx.end(), TEST_GUARD);
+				set.k.minMax(src.data(), span, count, mn.data(), mx.data(), nullptr);
+
+				bool minMaxOk = mn[count] == TEST_GUARD && mx[count] == TEST_GUARD;
+				for (int i = 0; i < count; i++)
+					minMaxOk &= mn[i] == refMin[i] && mx[i] == refMax[i];
+
+				if (!peakOk || !meanOk || !minMaxOk) {
+
+					printf("FAIL %s span %d count %d:%s%s%s\n", set.name, span, count,
+						peakOk ? "" : " peak", meanOk ? "" : " average", minMaxOk ? "" : " minmax");
+					failures++;
+				}
+			}
+		}
+	}
+
+	// the public entry points ignore empty requests
+	float dst = TEST_GUARD;
+	decimatePeak(nullptr, 0, &dst, 1);
+	decimatePeak(nullptr, 16, &dst, 0);
+	if (dst != TEST_GUARD) {
+
+		printf("FAIL decimatePeak wrote for an empty request\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+static void bench(int span, int count, long iterations) {
+
+	std::vector<float> src(span);
+	for (int j = 0; j < span; j++) src[j] = -100.0f + (float)((j * 7919) % 613) * 0.1f;
+
+	std::vector<float> mn(count), mx(count), mean(count);
+	const std::vector<KernelSet> sets = kernelSets();
+
+	for (const KernelSet &set : sets) {
+
+		const struct { const char *name; DecimateKernel fn; } ops[] = {
+			{ "peak", set.k.peak }, { "average", set.k.average }, { "minmax", set.k.minMax } };
+
+		for (const auto &op : ops) {
+
+			auto start = std::chrono::steady_clock::now();
+			for (long it = 0; it < iterations; it++)
+				op.fn(src.data(), span, count, mn.data(), mx.data(), mean.data());
+			double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			volatile float sink = mn[0] + mx[count - 1] + mean[count / 2];
+			(void) sink;
+
+			printf("%6d -> %5d  %-7s %-8s %8.2f us/frame  %8.2f Gbins/s\n", span, count, set.name, op.name,
+				s / iterations * 1e6, (double) span * iterations / s * 1e-9);
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+
+	long iterations = argc > 1 ? atol(argv[1]) : 2000;
+	if (iterations <= 0) iterations = 2000;
+
+	std::mt19937 rng(20261017);
+	const int failures = checkKernels(rng);
+
+	printf("decimators dispatch to %s\n", decimateKernel());
+	printf("golden: %s (%d failures)\n", failures ? "FAILED" : "ok", failures);
+
+	// panadapter widths; the last one zooms in (span < count)
+	bench(4096, 1001, iterations);
+	bench(16384, 1920, iterations);
+	bench(65536, 2559, iterations);
+	bench(800, 1920, iterations);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}